@@ -73,6 +73,7 @@ int QAlsaAudioSink::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        m_statistics.recordXrun();
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -389,6 +390,7 @@ bool QAlsaAudioSink::open()
     snd_pcm_start(handle);
 
     // Step 5: Setup timer
+    m_statistics.reset(period_time / 1000 * 1000);
     bytesAvailable = bytesFree();
 
     // Step 6: Start audio processing
@@ -431,6 +433,7 @@ qsizetype QAlsaAudioSink::bytesFree() const
     int frames = snd_pcm_avail_update(handle);
     if (frames == -EPIPE) {
         // Try and handle buffer underrun
+        m_statistics.recordXrun();
         int err = snd_pcm_recover(handle, frames, 0);
         if (err < 0)
             return 0;
@@ -507,6 +510,15 @@ qsizetype QAlsaAudioSink::bufferSize() const
     return buffer_size;
 }
 
+QAudioStreamStatistics QAlsaAudioSink::statistics() const
+{
+    qint64 latency = 0;
+    snd_pcm_sframes_t delay = 0;
+    if (handle && snd_pcm_delay(handle, &delay) == 0 && delay > 0)
+        latency = qint64(delay) * 1000000 / settings.sampleRate();
+    return m_statistics.statistics(latency);
+}
+
 qint64 QAlsaAudioSink::processedUSecs() const
 {
     return qint64(1000000) * totalTimeValue / settings.sampleRate();
@@ -570,6 +582,7 @@ void QAlsaAudioSink::userFeed()
     if(deviceState ==  QAudio::IdleState)
         bytesAvailable = bytesFree();
 
+    m_statistics.recordCallback();
     deviceReady();
 }
 
@@ -637,6 +650,9 @@ bool QAlsaAudioSink::deviceReady()
         }
     }
 
+    if (handle)
+        m_statistics.recordBufferFill(buffer_size - bytesAvailable);
+
     if(deviceState != QAudio::ActiveState)
         return true;
 
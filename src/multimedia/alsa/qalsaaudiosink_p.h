@@ -57,7 +57,7 @@ public:
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
-
+    QAudioStreamStatistics statistics() const override;
 
     QIODevice* audioSource = nullptr;
     QAudioFormat settings;
@@ -99,6 +99,7 @@ private:
     snd_pcm_format_t pcmformat = SND_PCM_FORMAT_S16;
     snd_pcm_hw_params_t *hwparams = nullptr;
     qreal m_volume = 1.0f;
+    mutable QAudioStreamStatisticsCollector m_statistics;
 };
 
 class AlsaOutputPrivate : public QIODevice
@@ -99,6 +99,7 @@ int QAlsaAudioSource::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        m_statistics.recordXrun();
         errorState = QAudio::UnderrunError;
         err = snd_pcm_prepare(handle);
         if(err < 0)
@@ -375,6 +376,7 @@ bool QAlsaAudioSource::open()
     // Step 6: Start audio processing
     chunks = buffer_size/period_size;
     timer->start(period_time*chunks/2000);
+    m_statistics.reset(period_time * chunks / 2000 * 1000);
 
     errorState  = QAudio::NoError;
 
@@ -409,6 +411,7 @@ int QAlsaAudioSource::checkBytesReady()
             if((int)frames > (int)buffer_frames)
                 frames = buffer_frames;
             bytesAvailable = snd_pcm_frames_to_bytes(handle, frames);
+            m_statistics.recordBufferFill(bytesAvailable + ringBuffer.bytesOfDataInBuffer());
         }
     }
     return bytesAvailable;
@@ -479,6 +482,7 @@ qint64 QAlsaAudioSource::read(char* data, qint64 len)
                 break;
             } else {
                 if(readFrames == -EPIPE) {
+                    m_statistics.recordXrun();
                     errorState = QAudio::UnderrunError;
                     err = snd_pcm_prepare(handle);
 #ifdef ESTRPIPE
@@ -607,6 +611,15 @@ qint64 QAlsaAudioSource::processedUSecs() const
     return result;
 }
 
+QAudioStreamStatistics QAlsaAudioSource::statistics() const
+{
+    qint64 latency = 0;
+    snd_pcm_sframes_t delay = 0;
+    if (handle && snd_pcm_delay(handle, &delay) == 0 && delay > 0)
+        latency = qint64(delay) * 1000000 / settings.sampleRate();
+    return m_statistics.statistics(latency);
+}
+
 void QAlsaAudioSource::suspend()
 {
     if(deviceState == QAudio::ActiveState||resuming) {
@@ -625,6 +638,7 @@ void QAlsaAudioSource::userFeed()
     QTime now(QTime::currentTime());
     qDebug()<<now.second()<<"s "<<now.msec()<<"ms :userFeed() IN";
 #endif
+    m_statistics.recordCallback();
     deviceReady();
 }
 
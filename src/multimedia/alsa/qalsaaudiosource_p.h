@@ -83,6 +83,7 @@ public:
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
+    QAudioStreamStatistics statistics() const override;
     bool resuming;
     snd_pcm_t* handle;
     qint64 totalTimeValue;
@@ -119,6 +120,7 @@ private:
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
     qreal m_volume;
+    QAudioStreamStatisticsCollector m_statistics;
 };
 
 class AlsaInputPrivate : public QIODevice
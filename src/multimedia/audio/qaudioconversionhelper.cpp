@@ -0,0 +1,392 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudioconversionhelper_p.h"
+
+#include <QtCore/qdebug.h>
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define QT_AUDIO_CONVERSION_NEON
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+
+using ConvertFunc = void(QT_FASTCALL *)(const void *src, void *dst, qsizetype samples);
+
+namespace {
+
+template<typename From, typename To>
+void QT_FASTCALL convertScalar(const void *src, void *dst, qsizetype samples)
+{
+    const From *in = static_cast<const From *>(src);
+    To *out = static_cast<To *>(dst);
+    for (qsizetype i = 0; i < samples; ++i)
+        out[i] = SampleTraits<To>::fromFloat(SampleTraits<From>::toFloat(in[i]));
+}
+
+void copySamples(const void *src, void *dst, qsizetype bytes)
+{
+    if (src != dst)
+        memmove(dst, src, bytes);
+}
+
+#ifdef QT_AUDIO_CONVERSION_NEON
+void QT_FASTCALL convertInt16ToFloatNeon(const void *src, void *dst, qsizetype samples)
+{
+    const qint16 *in = static_cast<const qint16 *>(src);
+    float *out = static_cast<float *>(dst);
+    const float32x4_t scale = vdupq_n_f32(1.f / 0x8000);
+
+    qsizetype i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+    convertScalar<qint16, float>(in + i, out + i, samples - i);
+}
+
+#ifdef __aarch64__
+void QT_FASTCALL convertFloatToInt16Neon(const void *src, void *dst, qsizetype samples)
+{
+    const float *in = static_cast<const float *>(src);
+    qint16 *out = static_cast<qint16 *>(dst);
+    const float32x4_t scale = vdupq_n_f32(0x8000);
+
+    qsizetype i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        // vcvtnq rounds to nearest even and saturates, vqmovn narrows with saturation
+        const int32x4_t lo = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(in + i), scale));
+        const int32x4_t hi = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(in + i + 4), scale));
+        vst1q_s16(out + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    convertScalar<float, qint16>(in + i, out + i, samples - i);
+}
+#endif
+#endif
+
+constexpr int NFormats = QAudioFormat::NSampleFormats;
+ConvertFunc convertFuncs[NFormats][NFormats] = {};
+
+std::once_flag initConvertFuncsFlag;
+
+template<typename From>
+void initConvertFuncsFrom(QAudioFormat::SampleFormat from)
+{
+    convertFuncs[from][QAudioFormat::UInt8] = convertScalar<From, quint8>;
+    convertFuncs[from][QAudioFormat::Int16] = convertScalar<From, qint16>;
+    convertFuncs[from][QAudioFormat::Int32] = convertScalar<From, qint32>;
+    convertFuncs[from][QAudioFormat::Float] = convertScalar<From, float>;
+}
+
+void initConvertFuncs()
+{
+    initConvertFuncsFrom<quint8>(QAudioFormat::UInt8);
+    initConvertFuncsFrom<qint16>(QAudioFormat::Int16);
+    initConvertFuncsFrom<qint32>(QAudioFormat::Int32);
+    initConvertFuncsFrom<float>(QAudioFormat::Float);
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    extern void QT_FASTCALL qt_convert_Int16_to_Float_sse2(const void *src, void *dst, qsizetype samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int16_sse2(const void *src, void *dst, qsizetype samples);
+    extern void QT_FASTCALL qt_convert_Int32_to_Float_sse2(const void *src, void *dst, qsizetype samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int32_sse2(const void *src, void *dst, qsizetype samples);
+
+    if (qCpuHasFeature(SSE2)) {
+        convertFuncs[QAudioFormat::Int16][QAudioFormat::Float] = qt_convert_Int16_to_Float_sse2;
+        convertFuncs[QAudioFormat::Float][QAudioFormat::Int16] = qt_convert_Float_to_Int16_sse2;
+        convertFuncs[QAudioFormat::Int32][QAudioFormat::Float] = qt_convert_Int32_to_Float_sse2;
+        convertFuncs[QAudioFormat::Float][QAudioFormat::Int32] = qt_convert_Float_to_Int32_sse2;
+    }
+#endif
+#ifdef QT_AUDIO_CONVERSION_NEON
+    convertFuncs[QAudioFormat::Int16][QAudioFormat::Float] = convertInt16ToFloatNeon;
+#  ifdef __aarch64__
+    // ARMv7 NEON only converts with truncation, keep the scalar version there
+    convertFuncs[QAudioFormat::Float][QAudioFormat::Int16] = convertFloatToInt16Neon;
+#  endif
+#endif
+}
+
+// Classifies speaker positions for folding channels that are missing in the target
+enum class Side { Left, Right, Center, Lfe };
+
+Side sideOf(QAudioFormat::AudioChannelPosition position)
+{
+    switch (position) {
+    case QAudioFormat::FrontLeft:
+    case QAudioFormat::BackLeft:
+    case QAudioFormat::FrontLeftOfCenter:
+    case QAudioFormat::SideLeft:
+    case QAudioFormat::TopFrontLeft:
+    case QAudioFormat::TopBackLeft:
+    case QAudioFormat::TopSideLeft:
+    case QAudioFormat::BottomFrontLeft:
+        return Side::Left;
+    case QAudioFormat::FrontRight:
+    case QAudioFormat::BackRight:
+    case QAudioFormat::FrontRightOfCenter:
+    case QAudioFormat::SideRight:
+    case QAudioFormat::TopFrontRight:
+    case QAudioFormat::TopBackRight:
+    case QAudioFormat::TopSideRight:
+    case QAudioFormat::BottomFrontRight:
+        return Side::Right;
+    case QAudioFormat::LFE:
+    case QAudioFormat::LFE2:
+        return Side::Lfe;
+    default:
+        return Side::Center;
+    }
+}
+
+QList<QAudioFormat::AudioChannelPosition> channelPositions(QAudioFormat::ChannelConfig config)
+{
+    QList<QAudioFormat::AudioChannelPosition> positions;
+    for (int i = 0; i < QAudioFormat::NChannelPositions; ++i) {
+        if (config & (1u << i))
+            positions.append(QAudioFormat::AudioChannelPosition(i));
+    }
+    return positions;
+}
+
+constexpr float MinusThreeDb = 0.70710678f;
+
+// Builds a row-major [dst channel][src channel] mixing matrix
+std::vector<float> remixMatrix(const QList<QAudioFormat::AudioChannelPosition> &srcPositions,
+                               const QList<QAudioFormat::AudioChannelPosition> &dstPositions)
+{
+    const qsizetype srcCount = srcPositions.size();
+    const qsizetype dstCount = dstPositions.size();
+    std::vector<float> matrix(srcCount * dstCount, 0.f);
+    auto gain = [&](qsizetype dst, qsizetype src) -> float & {
+        return matrix[dst * srcCount + src];
+    };
+
+    const qsizetype dstLeft = dstPositions.indexOf(QAudioFormat::FrontLeft);
+    const qsizetype dstRight = dstPositions.indexOf(QAudioFormat::FrontRight);
+    const qsizetype dstCenter = dstPositions.indexOf(QAudioFormat::FrontCenter);
+    const bool dstIsMono = dstCount == 1 && dstCenter == 0;
+    const bool srcIsMono = srcCount == 1 && srcPositions.front() == QAudioFormat::FrontCenter;
+
+    if (dstIsMono) {
+        qsizetype audible = std::count_if(srcPositions.cbegin(), srcPositions.cend(),
+                                          [](auto p) { return sideOf(p) != Side::Lfe; });
+        for (qsizetype s = 0; s < srcCount; ++s) {
+            if (sideOf(srcPositions[s]) != Side::Lfe)
+                gain(0, s) = 1.f / std::max(audible, qsizetype(1));
+        }
+        return matrix;
+    }
+
+    for (qsizetype s = 0; s < srcCount; ++s) {
+        const auto position = srcPositions[s];
+        const qsizetype d = dstPositions.indexOf(position);
+        if (d >= 0) {
+            gain(d, s) = 1.f;
+            continue;
+        }
+
+        switch (sideOf(position)) {
+        case Side::Lfe:
+            break;
+        case Side::Left:
+            if (dstLeft >= 0)
+                gain(dstLeft, s) += MinusThreeDb;
+            else if (dstCenter >= 0)
+                gain(dstCenter, s) += MinusThreeDb;
+            break;
+        case Side::Right:
+            if (dstRight >= 0)
+                gain(dstRight, s) += MinusThreeDb;
+            else if (dstCenter >= 0)
+                gain(dstCenter, s) += MinusThreeDb;
+            break;
+        case Side::Center:
+            if (dstLeft >= 0 && dstRight >= 0) {
+                // plain duplication when upmixing mono
+                const float centerGain = srcIsMono ? 1.f : MinusThreeDb;
+                gain(dstLeft, s) += centerGain;
+                gain(dstRight, s) += centerGain;
+            } else if (dstCenter >= 0) {
+                gain(dstCenter, s) += MinusThreeDb;
+            }
+            break;
+        }
+    }
+    return matrix;
+}
+
+QAudioFormat::ChannelConfig effectiveChannelConfig(const QAudioFormat &format)
+{
+    const auto config = format.channelConfig();
+    return config != QAudioFormat::ChannelConfigUnknown
+            ? config
+            : QAudioFormat::defaultChannelConfigForChannelCount(format.channelCount());
+}
+
+} // namespace
+
+void convertSamples(const void *src, QAudioFormat::SampleFormat srcFormat, void *dst,
+                    QAudioFormat::SampleFormat dstFormat, qsizetype samples)
+{
+    if (srcFormat <= QAudioFormat::Unknown || srcFormat >= QAudioFormat::NSampleFormats
+        || dstFormat <= QAudioFormat::Unknown || dstFormat >= QAudioFormat::NSampleFormats
+        || samples <= 0)
+        return;
+
+    if (srcFormat == dstFormat) {
+        QAudioFormat format;
+        format.setSampleFormat(srcFormat);
+        copySamples(src, dst, samples * format.bytesPerSample());
+        return;
+    }
+
+    std::call_once(initConvertFuncsFlag, &initConvertFuncs);
+    convertFuncs[srcFormat][dstFormat](src, dst, samples);
+}
+
+void interleave(const float *const *planes, int channels, float *dst, qsizetype frames)
+{
+    if (channels == 2) {
+        const float *left = planes[0];
+        const float *right = planes[1];
+        for (qsizetype i = 0; i < frames; ++i) {
+            dst[2 * i] = left[i];
+            dst[2 * i + 1] = right[i];
+        }
+        return;
+    }
+
+    for (int c = 0; c < channels; ++c) {
+        const float *plane = planes[c];
+        float *out = dst + c;
+        for (qsizetype i = 0; i < frames; ++i, out += channels)
+            *out = plane[i];
+    }
+}
+
+void deinterleave(const float *src, int channels, float *const *planes, qsizetype frames)
+{
+    if (channels == 2) {
+        float *left = planes[0];
+        float *right = planes[1];
+        for (qsizetype i = 0; i < frames; ++i) {
+            left[i] = src[2 * i];
+            right[i] = src[2 * i + 1];
+        }
+        return;
+    }
+
+    for (int c = 0; c < channels; ++c) {
+        float *plane = planes[c];
+        const float *in = src + c;
+        for (qsizetype i = 0; i < frames; ++i, in += channels)
+            plane[i] = *in;
+    }
+}
+
+void remixChannels(const float *src, QAudioFormat::ChannelConfig srcConfig, float *dst,
+                   QAudioFormat::ChannelConfig dstConfig, qsizetype frames)
+{
+    const auto srcPositions = channelPositions(srcConfig);
+    const auto dstPositions = channelPositions(dstConfig);
+    const qsizetype srcCount = srcPositions.size();
+    const qsizetype dstCount = dstPositions.size();
+    if (!srcCount || !dstCount)
+        return;
+
+    if (srcConfig == dstConfig) {
+        copySamples(src, dst, frames * srcCount * sizeof(float));
+        return;
+    }
+
+    // the most common cases, kept as simple loops the compiler can vectorize
+    if (srcConfig == QAudioFormat::ChannelConfigMono
+        && dstConfig == QAudioFormat::ChannelConfigStereo) {
+        for (qsizetype i = 0; i < frames; ++i)
+            dst[2 * i] = dst[2 * i + 1] = src[i];
+        return;
+    }
+    if (srcConfig == QAudioFormat::ChannelConfigStereo
+        && dstConfig == QAudioFormat::ChannelConfigMono) {
+        for (qsizetype i = 0; i < frames; ++i)
+            dst[i] = (src[2 * i] + src[2 * i + 1]) * 0.5f;
+        return;
+    }
+
+    const std::vector<float> matrix = remixMatrix(srcPositions, dstPositions);
+    for (qsizetype i = 0; i < frames; ++i, src += srcCount, dst += dstCount) {
+        const float *row = matrix.data();
+        for (qsizetype d = 0; d < dstCount; ++d, row += srcCount) {
+            float sum = 0.f;
+            for (qsizetype s = 0; s < srcCount; ++s)
+                sum += row[s] * src[s];
+            dst[d] = sum;
+        }
+    }
+}
+
+QAudioBuffer convertAudioBuffer(const QAudioBuffer &buffer, const QAudioFormat &format)
+{
+    const QAudioFormat srcFormat = buffer.format();
+    if (!buffer.isValid() || !format.isValid())
+        return {};
+
+    if (srcFormat.sampleRate() != format.sampleRate()) {
+        qWarning() << "convertAudioBuffer: sample rate conversion is not supported"
+                   << srcFormat.sampleRate() << format.sampleRate();
+        return {};
+    }
+
+    const auto srcConfig = effectiveChannelConfig(srcFormat);
+    const auto dstConfig = effectiveChannelConfig(format);
+    const bool sameChannels = srcConfig == dstConfig
+            && srcFormat.channelCount() == format.channelCount();
+
+    if (sameChannels && srcFormat.sampleFormat() == format.sampleFormat())
+        return buffer;
+
+    const qsizetype frames = buffer.frameCount();
+    QAudioBuffer result(int(frames), format, buffer.startTime());
+
+    if (sameChannels) {
+        convertSamples(buffer.constData(), srcFormat.sampleFormat(), result.data(),
+                       format.sampleFormat(), frames * format.channelCount());
+        return result;
+    }
+
+    std::vector<float> srcFloat;
+    const float *remixInput = buffer.constData<float>();
+    if (srcFormat.sampleFormat() != QAudioFormat::Float) {
+        srcFloat.resize(frames * srcFormat.channelCount());
+        convertSamples(buffer.constData(), srcFormat.sampleFormat(), srcFloat.data(),
+                       QAudioFormat::Float, qsizetype(srcFloat.size()));
+        remixInput = srcFloat.data();
+    }
+
+    if (format.sampleFormat() == QAudioFormat::Float) {
+        remixChannels(remixInput, srcConfig, result.data<float>(), dstConfig, frames);
+    } else {
+        std::vector<float> dstFloat(frames * format.channelCount());
+        remixChannels(remixInput, srcConfig, dstFloat.data(), dstConfig, frames);
+        convertSamples(dstFloat.data(), QAudioFormat::Float, result.data(),
+                       format.sampleFormat(), qsizetype(dstFloat.size()));
+    }
+
+    return result;
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
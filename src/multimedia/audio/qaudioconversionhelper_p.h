@@ -0,0 +1,100 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QAUDIOCONVERSIONHELPER_P_H
+#define QAUDIOCONVERSIONHELPER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qaudioformat.h>
+#include <qaudiobuffer.h>
+#include <private/qglobal_p.h>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal
+{
+// Sample <-> float conversions, also the scalar reference for the SIMD versions. Converting
+// to integers rounds to nearest, ties to even (the default FP environment, as with the SIMD
+// conversion instructions), and saturates.
+template<typename T>
+struct SampleTraits;
+
+template<>
+struct SampleTraits<quint8>
+{
+    static float toFloat(quint8 v) { return (int(v) - 0x80) * (1.f / 0x80); }
+    static quint8 fromFloat(float v)
+    {
+        return quint8(std::clamp(std::lrint(v * 0x80) + 0x80, 0l, 0xffl));
+    }
+};
+
+template<>
+struct SampleTraits<qint16>
+{
+    static float toFloat(qint16 v) { return v * (1.f / 0x8000); }
+    static qint16 fromFloat(float v)
+    {
+        return qint16(std::clamp(std::lrint(v * 0x8000), -0x8000l, 0x7fffl));
+    }
+};
+
+template<>
+struct SampleTraits<qint32>
+{
+    static float toFloat(qint32 v) { return float(v * (1. / 0x80000000u)); }
+    static qint32 fromFloat(float v)
+    {
+        return qint32(std::clamp(std::llrint(double(v) * 0x80000000u), -0x80000000ll,
+                                 0x7fffffffll));
+    }
+};
+
+template<>
+struct SampleTraits<float>
+{
+    static float toFloat(float v) { return v; }
+    static float fromFloat(float v) { return v; }
+};
+
+// Converts interleaved or planar samples between sample formats. Float samples are
+// normalized to [-1, 1]; converting to integer formats saturates. The source and
+// destination must not overlap, unless the formats have the same sample size.
+Q_MULTIMEDIA_EXPORT void convertSamples(const void *src, QAudioFormat::SampleFormat srcFormat,
+                                        void *dst, QAudioFormat::SampleFormat dstFormat,
+                                        qsizetype samples);
+
+Q_MULTIMEDIA_EXPORT void interleave(const float *const *planes, int channels, float *dst,
+                                    qsizetype frames);
+Q_MULTIMEDIA_EXPORT void deinterleave(const float *src, int channels, float *const *planes,
+                                      qsizetype frames);
+
+// Down- or upmixes interleaved float frames between channel configurations. Channels
+// present in both configurations are copied, others are folded into the nearest
+// available speakers; LFE is dropped if the target has none.
+Q_MULTIMEDIA_EXPORT void remixChannels(const float *src, QAudioFormat::ChannelConfig srcConfig,
+                                       float *dst, QAudioFormat::ChannelConfig dstConfig,
+                                       qsizetype frames);
+
+// Converts the buffer to the sample format and channel configuration of format.
+// Sample rate conversion is not supported; returns an invalid buffer if the rates differ.
+Q_MULTIMEDIA_EXPORT QAudioBuffer convertAudioBuffer(const QAudioBuffer &buffer,
+                                                    const QAudioFormat &format);
+}
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOCONVERSIONHELPER_P_H
@@ -0,0 +1,95 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudioconversionhelper_p.h"
+
+#include <QtCore/private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+template<typename From, typename To>
+void convertTail(const From *in, To *out, qsizetype samples)
+{
+    using namespace QAudioHelperInternal;
+    for (qsizetype i = 0; i < samples; ++i)
+        out[i] = SampleTraits<To>::fromFloat(SampleTraits<From>::toFloat(in[i]));
+}
+
+} // namespace
+
+void QT_FASTCALL qt_convert_Int16_to_Float_sse2(const void *src, void *dst, qsizetype samples)
+{
+    const qint16 *in = static_cast<const qint16 *>(src);
+    float *out = static_cast<float *>(dst);
+    const __m128 scale = _mm_set1_ps(1.f / 0x8000);
+
+    qsizetype i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        // sign extend by unpacking into the upper half and shifting back arithmetically
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    convertTail(in + i, out + i, samples - i);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int16_sse2(const void *src, void *dst, qsizetype samples)
+{
+    const float *in = static_cast<const float *>(src);
+    qint16 *out = static_cast<qint16 *>(dst);
+    const __m128 scale = _mm_set1_ps(0x8000);
+
+    qsizetype i = 0;
+    for (; i + 8 <= samples; i += 8) {
+        // out of range values become 0x80000000 in cvtps, which packs saturates to -0x8000;
+        // clamp first so positive overflow saturates to 0x7fff instead
+        const __m128 limit = _mm_set1_ps(0x7fff);
+        const __m128 lo = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i), scale), limit);
+        const __m128 hi = _mm_min_ps(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale), limit);
+        const __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+    }
+    convertTail(in + i, out + i, samples - i);
+}
+
+void QT_FASTCALL qt_convert_Int32_to_Float_sse2(const void *src, void *dst, qsizetype samples)
+{
+    const qint32 *in = static_cast<const qint32 *>(src);
+    float *out = static_cast<float *>(dst);
+    const __m128 scale = _mm_set1_ps(1.f / 0x80000000u);
+
+    qsizetype i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    convertTail(in + i, out + i, samples - i);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int32_sse2(const void *src, void *dst, qsizetype samples)
+{
+    const float *in = static_cast<const float *>(src);
+    qint32 *out = static_cast<qint32 *>(dst);
+    const __m128 scale = _mm_set1_ps(0x80000000u);
+
+    qsizetype i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        // cvtps turns everything out of range into 0x80000000, which is already the saturated
+        // value for negative overflow; flip it to 0x7fffffff where the input overflowed upwards
+        const __m128 v = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+        const __m128i overflow = _mm_castps_si128(_mm_cmpge_ps(v, scale));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm_xor_si128(_mm_cvtps_epi32(v), overflow));
+    }
+    convertTail(in + i, out + i, samples - i);
+}
+
+QT_END_NAMESPACE
+
+#endif
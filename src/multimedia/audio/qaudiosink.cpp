@@ -106,6 +106,11 @@ QAudioSink::QAudioSink(const QAudioDevice &audioDevice, const QAudioFormat &form
     \c false.
 */
 
+/*!
+    \fn QPlatformAudioSink *QAudioSink::handle() const
+    \internal
+*/
+
 /*!
     Destroys this audio output.
 
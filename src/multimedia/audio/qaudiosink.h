@@ -30,6 +30,7 @@ public:
     ~QAudioSink();
 
     bool isNull() const { return !d; }
+    QPlatformAudioSink *handle() const { return d; }
 
     QAudioFormat format() const;
 
@@ -116,6 +116,11 @@ QAudioSource::QAudioSource(const QAudioDevice &audioDevice, const QAudioFormat &
     Returns \c true if the audio source is \c null, otherwise returns \c false.
 */
 
+/*!
+    \fn QPlatformAudioSource *QAudioSource::handle() const
+    \internal
+*/
+
 /*!
     Destroy this audio input.
 */
@@ -28,6 +28,7 @@ public:
     ~QAudioSource();
 
     bool isNull() const { return !d; }
+    QPlatformAudioSource *handle() const { return d; }
 
     QAudioFormat format() const;
 
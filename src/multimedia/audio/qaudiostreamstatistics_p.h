@@ -0,0 +1,120 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QAUDIOSTREAMSTATISTICS_P_H
+#define QAUDIOSTREAMSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/qtmultimediaglobal.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmutex.h>
+
+#include <atomic>
+
+QT_BEGIN_NAMESPACE
+
+// Runtime statistics of an audio sink or source stream, as measured by the backend.
+// Buffer fill levels are in bytes; xrunCount counts underruns for sinks and
+// overruns for sources.
+struct QAudioStreamStatistics
+{
+    qint64 latencyUSecs = 0;
+    qsizetype bufferFill = 0;
+    qsizetype minBufferFill = 0;
+    qsizetype maxBufferFill = 0;
+    int xrunCount = 0;
+    qint64 maxCallbackJitterUSecs = 0;
+    qint64 averageCallbackJitterUSecs = 0;
+};
+
+// Accumulates QAudioStreamStatistics from within a backend.
+// recordXrun() may be called from any thread, e.g. from PulseAudio's mainloop;
+// the remaining recording functions are expected to be called from the thread
+// servicing the stream, while statistics() may be queried from any thread.
+class QAudioStreamStatisticsCollector
+{
+public:
+    void reset(qint64 expectedPeriodUSecs = 0)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_statistics = {};
+        m_expectedPeriodUSecs = expectedPeriodUSecs;
+        m_callbackCount = 0;
+        m_jitterSumUSecs = 0;
+        m_fillInitialized = false;
+        m_callbackTimer.invalidate();
+        m_xrunCount = 0;
+    }
+
+    void recordBufferFill(qsizetype bytes)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_statistics.bufferFill = bytes;
+        if (!m_fillInitialized) {
+            m_statistics.minBufferFill = m_statistics.maxBufferFill = bytes;
+            m_fillInitialized = true;
+        } else {
+            m_statistics.minBufferFill = qMin(m_statistics.minBufferFill, bytes);
+            m_statistics.maxBufferFill = qMax(m_statistics.maxBufferFill, bytes);
+        }
+    }
+
+    // Call once per processing callback or timer tick; the deviation of the interval
+    // from the expected period is accounted as jitter.
+    void recordCallback()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_callbackTimer.isValid()) {
+            m_callbackTimer.start();
+            return;
+        }
+
+        const qint64 intervalUSecs = m_callbackTimer.nsecsElapsed() / 1000;
+        m_callbackTimer.restart();
+
+        if (m_expectedPeriodUSecs <= 0)
+            return;
+
+        const qint64 jitter = qAbs(intervalUSecs - m_expectedPeriodUSecs);
+        m_statistics.maxCallbackJitterUSecs = qMax(m_statistics.maxCallbackJitterUSecs, jitter);
+        m_jitterSumUSecs += jitter;
+        ++m_callbackCount;
+    }
+
+    void recordXrun() { m_xrunCount.fetch_add(1, std::memory_order_relaxed); }
+
+    QAudioStreamStatistics statistics(qint64 latencyUSecs = 0) const
+    {
+        QMutexLocker locker(&m_mutex);
+        QAudioStreamStatistics result = m_statistics;
+        result.latencyUSecs = latencyUSecs;
+        result.xrunCount = m_xrunCount.load(std::memory_order_relaxed);
+        if (m_callbackCount)
+            result.averageCallbackJitterUSecs = m_jitterSumUSecs / m_callbackCount;
+        return result;
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QAudioStreamStatistics m_statistics;
+    QElapsedTimer m_callbackTimer;
+    qint64 m_expectedPeriodUSecs = 0;
+    qint64 m_callbackCount = 0;
+    qint64 m_jitterSumUSecs = 0;
+    bool m_fillInitialized = false;
+    std::atomic<int> m_xrunCount = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QAUDIOSTREAMSTATISTICS_P_H
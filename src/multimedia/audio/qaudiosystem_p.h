@@ -24,6 +24,8 @@
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/private/qglobal_p.h>
 
+#include <private/qaudiostreamstatistics_p.h>
+
 QT_BEGIN_NAMESPACE
 
 class QIODevice;
@@ -61,6 +63,11 @@ public:
     virtual QAudioFormat format() const = 0;
     virtual void setVolume(qreal) {}
     virtual qreal volume() const;
+    virtual QAudioStreamStatistics statistics() const { return {}; }
+
+    // Moves the running stream to another device without recreating the sink and
+    // dropping buffered data. Returns false if the backend doesn't support it.
+    virtual bool switchDevice(const QAudioDevice &) { return false; }
 
     QElapsedTimer elapsedTime;
 };
@@ -87,6 +94,7 @@ public:
     virtual QAudioFormat format() const = 0;
     virtual void setVolume(qreal) = 0;
     virtual qreal volume() const = 0;
+    virtual QAudioStreamStatistics statistics() const { return {}; }
 
     QElapsedTimer elapsedTime;
 };
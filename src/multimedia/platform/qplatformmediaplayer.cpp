@@ -38,6 +38,11 @@ void QPlatformMediaPlayer::error(int error, const QString &errorString)
     player->d_func()->setError(QMediaPlayer::Error(error), errorString);
 }
 
+void QPlatformMediaPlayer::nextMediaStarted()
+{
+    player->d_func()->onNextMediaStarted();
+}
+
 void *QPlatformMediaPlayer::nativePipeline(QMediaPlayer *player)
 {
     if (!player)
@@ -55,6 +55,14 @@ public:
     virtual QUrl media() const = 0;
     virtual const QIODevice *mediaStream() const = 0;
     virtual void setMedia(const QUrl &media, QIODevice *stream) = 0;
+    // The media to continue with after the current one; an empty url cancels it.
+    // Back ends that can't switch without a gap leave it to QMediaPlayer.
+    virtual void setNextMedia(const QUrl & /*media*/) {}
+
+    // Applies to the media set next
+    virtual void setLowLatency(bool /*lowLatency*/) {}
+    // In milliseconds, -1 if unknown
+    virtual qint64 latency() const { return -1; }
 
     virtual void play() = 0;
     virtual void pause() = 0;
@@ -103,6 +111,7 @@ public:
     }
     void playbackRateChanged(qreal rate) { emit player->playbackRateChanged(rate); }
     void bufferProgressChanged(float progress) { emit player->bufferProgressChanged(progress); }
+    void latencyChanged(qint64 latency) { emit player->latencyChanged(latency); }
     void metaDataChanged() { emit player->metaDataChanged(); }
     void tracksChanged() { emit player->tracksChanged(); }
     void activeTracksChanged() { emit player->activeTracksChanged(); }
@@ -110,6 +119,8 @@ public:
     void stateChanged(QMediaPlayer::PlaybackState newState);
     void mediaStatusChanged(QMediaPlayer::MediaStatus status);
     void error(int error, const QString &errorString);
+    // The next media has replaced the current one
+    void nextMediaStarted();
 
     void resetCurrentLoop() { m_currentLoop = 0; }
     bool doLoop() {
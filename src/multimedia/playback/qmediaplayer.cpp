@@ -114,6 +114,10 @@ void QMediaPlayerPrivate::setStatus(QMediaPlayer::MediaStatus s)
     Q_Q(QMediaPlayer);
 
     emit q->mediaStatusChanged(s);
+
+    // The back end couldn't continue with the next source on its own
+    if (s == QMediaPlayer::EndOfMedia && !nextSource.isEmpty())
+        QMetaObject::invokeMethod(q, [this] { playNextSource(); }, Qt::QueuedConnection);
 }
 
 void QMediaPlayerPrivate::setError(QMediaPlayer::Error error, const QString &errorString)
@@ -123,6 +127,13 @@ void QMediaPlayerPrivate::setError(QMediaPlayer::Error error, const QString &err
     this->error.setAndNotify(error, errorString, *q);
 }
 
+static QUrl resolvedMediaUrl(const QUrl &media)
+{
+    if (media.scheme().isEmpty() || media.scheme() == QLatin1String("file"))
+        return QUrl::fromUserInput(media.toString(), QDir::currentPath(), QUrl::AssumeLocalFile);
+    return media;
+}
+
 void QMediaPlayerPrivate::setMedia(const QUrl &media, QIODevice *stream)
 {
     if (!control)
@@ -188,9 +199,7 @@ void QMediaPlayerPrivate::setMedia(const QUrl &media, QIODevice *stream)
         }
     } else {
         qrcMedia = QUrl();
-        QUrl url = media;
-        if (url.scheme().isEmpty() || url.scheme() == QLatin1String("file"))
-            url = QUrl::fromUserInput(media.toString(), QDir::currentPath(), QUrl::AssumeLocalFile);
+        const QUrl url = resolvedMediaUrl(media);
         if (url.scheme() == QLatin1String("content") && !stream) {
             file.reset(new QFile(media.url()));
             stream = file.get();
@@ -200,6 +209,48 @@ void QMediaPlayerPrivate::setMedia(const QUrl &media, QIODevice *stream)
     }
 
     qrcFile.swap(file); // Cleans up any previous file
+
+    // The back end forgets the next source along with the current one
+    setNextMedia(nextSource);
+}
+
+void QMediaPlayerPrivate::setNextMedia(const QUrl &media)
+{
+    if (!control)
+        return;
+
+    // Resources and content URLs need a QFile of their own, so the back end
+    // doesn't get to pre-roll them; they are switched to with setSource() instead.
+    QUrl url = resolvedMediaUrl(media);
+    if (url.scheme() == QLatin1String("qrc") || url.scheme() == QLatin1String("content"))
+        url = QUrl();
+    control->setNextMedia(url);
+}
+
+void QMediaPlayerPrivate::onNextMediaStarted()
+{
+    Q_Q(QMediaPlayer);
+
+    source = std::exchange(nextSource, QUrl());
+    stream = nullptr;
+    qrcMedia = QUrl();
+    qrcFile.reset();
+
+    emit q->sourceChanged(source);
+    emit q->nextSourceChanged(nextSource);
+}
+
+void QMediaPlayerPrivate::playNextSource()
+{
+    Q_Q(QMediaPlayer);
+
+    if (!control || control->mediaStatus() != QMediaPlayer::EndOfMedia || nextSource.isEmpty())
+        return;
+
+    const QUrl next = std::exchange(nextSource, QUrl());
+    emit q->nextSourceChanged(nextSource);
+    q->setSource(next);
+    q->play();
 }
 
 QList<QMediaMetaData> QMediaPlayerPrivate::trackMetaData(QPlatformMediaPlayer::TrackType s) const
@@ -258,6 +309,44 @@ QUrl QMediaPlayer::source() const
     return d->source;
 }
 
+/*!
+    \qmlproperty url QtMultimedia::MediaPlayer::nextSource
+    \since 6.7
+
+    This property holds the source URL of the media to play once the current
+    source reaches its end.
+
+    The media is opened in the background while the current source is playing,
+    so that playback continues without a gap where the back end supports it.
+    When the next source starts, \l source takes its value, and this property
+    is cleared.
+
+    \sa QMediaPlayer::setNextSource()
+*/
+
+/*!
+    \property QMediaPlayer::nextSource
+    \brief the source URL of the media to play after the current one.
+    \since 6.7
+
+    When the current media reaches its end, the player continues with the
+    next source: source() takes its value, sourceChanged() is emitted, and
+    the next source is cleared. Back ends that can open the next media in
+    advance switch to it without a gap; the others switch to it the way
+    setSource() followed by play() would.
+
+    The next source is kept when the current source changes. Setting it to a
+    null QUrl cancels it.
+
+    \sa source
+*/
+QUrl QMediaPlayer::nextSource() const
+{
+    Q_D(const QMediaPlayer);
+
+    return d->nextSource;
+}
+
 /*!
     Returns the stream source of media data.
 
@@ -457,6 +546,80 @@ void QMediaPlayer::setLoops(int loops)
         d->control->setLoops(loops);
 }
 
+/*!
+    \qmlproperty bool QtMultimedia::MediaPlayer::lowLatency
+    \since 6.7
+
+    This property holds whether live streams are played with as little delay
+    as possible.
+
+    \sa QMediaPlayer::lowLatency
+*/
+
+/*!
+    \property QMediaPlayer::lowLatency
+    \brief whether live streams are played with as little delay as possible.
+    \since 6.7
+
+    Meant for live sources such as camera feeds and RTSP streams, where being
+    close to the live edge matters more than smooth playback. The back end
+    probes and buffers less media, decodes without delaying frames, drops
+    video frames that are late, and plays slightly faster while it is behind
+    the live edge.
+
+    The setting applies to the sources set after changing it. The default
+    value is \c false. Back ends that have no low latency mode ignore it.
+
+    \sa latency
+*/
+bool QMediaPlayer::isLowLatency() const
+{
+    Q_D(const QMediaPlayer);
+    return d->lowLatency;
+}
+
+void QMediaPlayer::setLowLatency(bool lowLatency)
+{
+    Q_D(QMediaPlayer);
+    if (d->lowLatency == lowLatency)
+        return;
+    d->lowLatency = lowLatency;
+    if (d->control)
+        d->control->setLowLatency(lowLatency);
+    emit lowLatencyChanged();
+}
+
+/*!
+    \qmlproperty qint64 QtMultimedia::MediaPlayer::latency
+    \since 6.7
+
+    This property holds how far, in milliseconds, the playback is behind the
+    live edge of the source, or \c -1 if it is not known.
+
+    \sa QMediaPlayer::latency
+*/
+
+/*!
+    \property QMediaPlayer::latency
+    \brief the delay of the playback behind the live edge in milliseconds.
+    \since 6.7
+
+    Only measured while playing a source with \l lowLatency enabled. When the
+    source reports its wall clock, as RTSP streams with RTCP sender reports
+    do, this is the delay from capture to presentation. Otherwise, it is only
+    the delay added by the player: the media buffered after the demuxer, in
+    the decoders, and in the audio output. Buffering on the sender's side and
+    in the network is not included then. The value is \c -1 if it is not
+    known.
+
+    \sa lowLatency
+*/
+qint64 QMediaPlayer::latency() const
+{
+    Q_D(const QMediaPlayer);
+    return d->control ? d->control->latency() : -1;
+}
+
 /*!
     Returns the current error state.
 */
@@ -615,7 +778,11 @@ void QMediaPlayer::setSource(const QUrl &source)
 
     The media data will be read from \a device. The \a sourceUrl can be provided
     to resolve additional information about the media, mime type etc. The
-    \a device must be open and readable.
+    \a device must be open and readable. It is read until another source is
+    set or the player is destroyed, and must not be deleted before. Reads
+    that block are waited for then, so sequential devices should implement
+    QIODevice::waitForReadyRead() and QIODevice::bytesAvailable() rather than
+    block in QIODevice::readData() until data arrives.
 
     For macOS the \a device should also be seek-able.
 
@@ -639,6 +806,25 @@ void QMediaPlayer::setSourceDevice(QIODevice *device, const QUrl &sourceUrl)
     emit sourceChanged(d->source);
 }
 
+/*!
+    \since 6.7
+
+    Sets the \a source to continue with once the current media ends.
+
+    \sa nextSource
+*/
+void QMediaPlayer::setNextSource(const QUrl &source)
+{
+    Q_D(QMediaPlayer);
+
+    if (d->nextSource == source)
+        return;
+
+    d->nextSource = source;
+    d->setNextMedia(source);
+    emit nextSourceChanged(d->nextSource);
+}
+
 /*!
     \qmlproperty AudioOutput QtMultimedia::MediaPlayer::audioOutput
 
@@ -1130,6 +1316,28 @@ QMediaMetaData QMediaPlayer::metaData() const
     Signals that the media source has been changed to \a media.
 */
 
+/*!
+    \fn void QMediaPlayer::nextSourceChanged(const QUrl &media);
+    \since 6.7
+
+    Signals that the next source has been changed to \a media.
+*/
+
+/*!
+    \fn void QMediaPlayer::lowLatencyChanged();
+    \since 6.7
+
+    Signals that the \l lowLatency property has changed.
+*/
+
+/*!
+    \fn void QMediaPlayer::latencyChanged(qint64 latency);
+    \since 6.7
+
+    Signals that the delay of the playback behind the live edge has changed
+    to \a latency milliseconds.
+*/
+
 /*!
     \fn void QMediaPlayer::playbackRateChanged(qreal rate);
 
@@ -23,6 +23,7 @@ class Q_MULTIMEDIA_EXPORT QMediaPlayer : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
+    Q_PROPERTY(QUrl nextSource READ nextSource WRITE setNextSource NOTIFY nextSourceChanged)
     Q_PROPERTY(qint64 duration READ duration NOTIFY durationChanged)
     Q_PROPERTY(qint64 position READ position WRITE setPosition NOTIFY positionChanged)
     Q_PROPERTY(float bufferProgress READ bufferProgress NOTIFY bufferProgressChanged)
@@ -32,6 +33,8 @@ class Q_MULTIMEDIA_EXPORT QMediaPlayer : public QObject
     Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged)
     Q_PROPERTY(qreal playbackRate READ playbackRate WRITE setPlaybackRate NOTIFY playbackRateChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
+    Q_PROPERTY(bool lowLatency READ isLowLatency WRITE setLowLatency NOTIFY lowLatencyChanged)
+    Q_PROPERTY(qint64 latency READ latency NOTIFY latencyChanged)
     Q_PROPERTY(PlaybackState playbackState READ playbackState NOTIFY playbackStateChanged)
     Q_PROPERTY(MediaStatus mediaStatus READ mediaStatus NOTIFY mediaStatusChanged)
     Q_PROPERTY(QMediaMetaData metaData READ metaData NOTIFY metaDataChanged)
@@ -118,6 +121,8 @@ public:
     QUrl source() const;
     const QIODevice *sourceDevice() const;
 
+    QUrl nextSource() const;
+
     PlaybackState playbackState() const;
     MediaStatus mediaStatus() const;
 
@@ -138,6 +143,11 @@ public:
     int loops() const;
     void setLoops(int loops);
 
+    bool isLowLatency() const;
+    void setLowLatency(bool lowLatency);
+
+    qint64 latency() const;
+
     Error error() const;
     QString errorString() const;
 
@@ -156,8 +166,11 @@ public Q_SLOTS:
     void setSource(const QUrl &source);
     void setSourceDevice(QIODevice *device, const QUrl &sourceUrl = QUrl());
 
+    void setNextSource(const QUrl &source);
+
 Q_SIGNALS:
     void sourceChanged(const QUrl &media);
+    void nextSourceChanged(const QUrl &media);
     void playbackStateChanged(QMediaPlayer::PlaybackState newState);
     void mediaStatusChanged(QMediaPlayer::MediaStatus status);
 
@@ -173,6 +186,8 @@ Q_SIGNALS:
     void playingChanged(bool playing);
     void playbackRateChanged(qreal rate);
     void loopsChanged();
+    void lowLatencyChanged();
+    void latencyChanged(qint64 latency);
 
     void metaDataChanged();
     void videoOutputChanged();
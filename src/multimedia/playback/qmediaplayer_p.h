@@ -50,11 +50,16 @@ public:
     std::unique_ptr<QFile> qrcFile;
     QUrl source;
     QIODevice *stream = nullptr;
+    QUrl nextSource;
+    bool lowLatency = false;
 
     QMediaPlayer::PlaybackState state = QMediaPlayer::StoppedState;
     QErrorInfo<QMediaPlayer::Error> error;
 
     void setMedia(const QUrl &media, QIODevice *stream = nullptr);
+    void setNextMedia(const QUrl &media);
+    void onNextMediaStarted();
+    void playNextSource();
 
     QList<QMediaMetaData> trackMetaData(QPlatformMediaPlayer::TrackType s) const;
 
@@ -280,11 +280,17 @@ static void contextStateCallback(pa_context *c, void *userdata)
 
 Q_GLOBAL_STATIC(QPulseAudioEngine, pulseEngine);
 
-QPulseAudioEngine::QPulseAudioEngine(QObject *parent)
+// Sinks lock the mainloop of their engine for every write. So that sinks playing at the same
+// time don't wait for each other, they are spread over up to this many engines, each with a
+// mainloop thread and a server connection of its own.
+static constexpr int MaxSinkEngines = 4;
+
+QPulseAudioEngine::QPulseAudioEngine(QObject *parent, bool monitorDevices)
     : QObject(parent)
     , m_mainLoopApi(nullptr)
     , m_context(nullptr)
     , m_prepared(false)
+    , m_monitorDevices(monitorDevices)
 {
     prepare();
 }
@@ -386,14 +392,16 @@ void QPulseAudioEngine::prepare()
     if (ok) {
         pa_context_set_state_callback(m_context, contextStateCallback, this);
 
-        pa_context_set_subscribe_callback(m_context, event_cb, this);
-        PAOperationUPtr op(pa_context_subscribe(
-                m_context,
-                pa_subscription_mask_t(PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SOURCE
-                                       | PA_SUBSCRIPTION_MASK_SERVER),
-                nullptr, nullptr));
-        if (!op)
-            qWarning("PulseAudioService: failed to subscribe to context notifications");
+        if (m_monitorDevices) {
+            pa_context_set_subscribe_callback(m_context, event_cb, this);
+            PAOperationUPtr op(pa_context_subscribe(
+                    m_context,
+                    pa_subscription_mask_t(PA_SUBSCRIPTION_MASK_SINK | PA_SUBSCRIPTION_MASK_SOURCE
+                                           | PA_SUBSCRIPTION_MASK_SERVER),
+                    nullptr, nullptr));
+            if (!op)
+                qWarning("PulseAudioService: failed to subscribe to context notifications");
+        }
     } else {
         pa_context_unref(m_context);
         m_context = nullptr;
@@ -402,7 +410,8 @@ void QPulseAudioEngine::prepare()
     unlock();
 
     if (ok) {
-        updateDevices();
+        if (m_monitorDevices)
+            updateDevices();
         m_prepared = true;
     } else {
         pa_threaded_mainloop_free(m_mainLoop);
@@ -479,6 +488,42 @@ QPulseAudioEngine *QPulseAudioEngine::instance()
     return pulseEngine();
 }
 
+// Returns the engine with the fewest sinks, starting with instance(). Another engine is only
+// created while all existing ones have sinks.
+QPulseAudioEngine *QPulseAudioEngine::acquireSinkEngine()
+{
+    QPulseAudioEngine *self = instance();
+    QMutexLocker locker(&self->m_sinkEnginesMutex);
+
+    QPulseAudioEngine *engine = self;
+    for (const auto &other : self->m_sinkEngines) {
+        if (other->m_sinkCount < engine->m_sinkCount)
+            engine = other.get();
+    }
+
+    if (engine->m_sinkCount > 0 && self->m_sinkEngines.size() + 1 < MaxSinkEngines) {
+        auto newEngine = std::make_unique<QPulseAudioEngine>(nullptr, false);
+        if (newEngine->context()) {
+            // reconnect after failures from the thread of instance(), like it does
+            newEngine->moveToThread(self->thread());
+            engine = newEngine.get();
+            self->m_sinkEngines.push_back(std::move(newEngine));
+        }
+    }
+
+    ++engine->m_sinkCount;
+    return engine;
+}
+
+void QPulseAudioEngine::releaseSinkEngine(QPulseAudioEngine *engine)
+{
+    if (!engine)
+        return;
+
+    QMutexLocker locker(&instance()->m_sinkEnginesMutex);
+    --engine->m_sinkCount;
+}
+
 QList<QAudioDevice> QPulseAudioEngine::availableDevices(QAudioDevice::Mode mode) const
 {
     if (mode == QAudioDevice::Output) {
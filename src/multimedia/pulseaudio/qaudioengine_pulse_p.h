@@ -18,10 +18,14 @@
 #include <QtCore/qmap.h>
 #include <QtCore/qbytearray.h>
 #include <QtCore/qreadwritelock.h>
+#include <QtCore/qmutex.h>
 #include <pulse/pulseaudio.h>
 #include "qpulsehelpers_p.h"
 #include <qaudioformat.h>
 
+#include <memory>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QPulseAudioEngine : public QObject
@@ -29,10 +33,13 @@ class QPulseAudioEngine : public QObject
     Q_OBJECT
 
 public:
-    QPulseAudioEngine(QObject *parent = 0);
+    // Engines that don't monitor the devices only serve streams, see acquireSinkEngine()
+    QPulseAudioEngine(QObject *parent = 0, bool monitorDevices = true);
     ~QPulseAudioEngine();
 
     static QPulseAudioEngine *instance();
+    static QPulseAudioEngine *acquireSinkEngine();
+    static void releaseSinkEngine(QPulseAudioEngine *engine);
     pa_threaded_mainloop *mainloop() { return m_mainLoop; }
     pa_context *context() { return m_context; }
 
@@ -86,6 +93,12 @@ private:
     pa_threaded_mainloop *m_mainLoop;
     pa_context *m_context;
     bool m_prepared;
+    bool m_monitorDevices;
+
+    // guarded by m_sinkEnginesMutex of the instance()
+    int m_sinkCount = 0;
+    std::vector<std::unique_ptr<QPulseAudioEngine>> m_sinkEngines;
+    QMutex m_sinkEnginesMutex;
  };
 
 QT_END_NAMESPACE
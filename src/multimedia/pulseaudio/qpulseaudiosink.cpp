@@ -4,6 +4,7 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qmath.h>
+#include <QtCore/qscopeguard.h>
 #include <private/qaudiohelpers_p.h>
 
 #include "qpulseaudiosink_p.h"
@@ -17,34 +18,44 @@
 QT_BEGIN_NAMESPACE
 
 static constexpr int SinkPeriodTimeMs = 20;
+// PulseAudio's default target length, used when no buffer size is requested
+static constexpr int DefaultBufferTimeMs = 2000;
 
 #define LOW_LATENCY_CATEGORY_NAME "game"
 
 static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
     qCDebug(qLcPulseAudioOut) << "Write callback:" << length;
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    QPulseAudioEngine *pulseEngine = static_cast<QPulseAudioSink *>(userdata)->engine();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
 static void outputStreamStateCallback(pa_stream *stream, void *userdata)
 {
-    Q_UNUSED(userdata);
     pa_stream_state_t state = pa_stream_get_state(stream);
     qCDebug(qLcPulseAudioOut) << "Stream state callback:" << state;
+    auto *sink = static_cast<QPulseAudioSink *>(userdata);
     switch (state) {
         case PA_STREAM_CREATING:
-        case PA_STREAM_READY:
         case PA_STREAM_TERMINATED:
             break;
 
+        case PA_STREAM_READY:
+            // finish opening on the sink's thread, open() doesn't wait for the stream
+            if (sink)
+                QMetaObject::invokeMethod(sink, &QPulseAudioSink::onStreamReady,
+                                          Qt::QueuedConnection);
+            break;
+
         case PA_STREAM_FAILED:
         default:
             qWarning() << QString::fromLatin1("Stream error: %1").arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(stream)))));
-            QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-            pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
+            if (sink) {
+                QMetaObject::invokeMethod(sink, &QPulseAudioSink::onStreamFailed,
+                                          Qt::QueuedConnection);
+                pa_threaded_mainloop_signal(sink->engine()->mainloop(), 0);
+            }
             break;
     }
 }
@@ -85,10 +96,9 @@ static void outputStreamLatencyCallback(pa_stream *stream, void *userdata)
 static void outputStreamSuccessCallback(pa_stream *stream, int success, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
 
     qCDebug(qLcPulseAudioOut) << "Stream successful:" << success;
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    QPulseAudioEngine *pulseEngine = static_cast<QPulseAudioEngine *>(userdata);
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
 
@@ -102,6 +112,17 @@ static void outputStreamDrainComplete(pa_stream *stream, int success, void *user
         static_cast<QPulseAudioSink *>(userdata)->streamDrainedCallback();
 }
 
+static void streamMoveCallback(pa_context *context, int success, void *userdata)
+{
+    Q_UNUSED(userdata);
+
+    if (success)
+        qCDebug(qLcPulseAudioOut) << "Stream moved to a new device";
+    else
+        qCWarning(qLcPulseAudioOut) << "Failed to move the stream to a new device:"
+                                    << pa_strerror(pa_context_errno(context));
+}
+
 static void streamAdjustPrebufferCallback(pa_stream *stream, int success, void *userdata)
 {
     Q_UNUSED(stream);
@@ -139,6 +160,7 @@ void QPulseAudioSink::streamUnderflowCallback()
 
         exchangeDrainOperation(pa_stream_drain(m_stream, outputStreamDrainComplete, this));
     } else if (!m_resuming) {
+        m_statistics.recordXrun();
         m_stateMachine.updateActiveOrIdle(false, QAudio::UnderrunError);
     }
 }
@@ -204,7 +226,11 @@ bool QPulseAudioSink::open()
     if (m_opened)
         return true;
 
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    m_engine = QPulseAudioEngine::acquireSinkEngine();
+    auto releaseEngine = qScopeGuard([this] {
+        QPulseAudioEngine::releaseSinkEngine(std::exchange(m_engine, nullptr));
+    });
+    QPulseAudioEngine *pulseEngine = m_engine;
 
     if (!pulseEngine->context() || pa_context_get_state(pulseEngine->context()) != PA_CONTEXT_READY) {
         m_stateMachine.stopOrUpdateError(QAudio::FatalError);
@@ -293,46 +319,116 @@ bool QPulseAudioSink::open()
         return false;
     }
 
-    while (pa_stream_get_state(m_stream) != PA_STREAM_READY)
-        pa_threaded_mainloop_wait(pulseEngine->mainloop());
-
-    const pa_buffer_attr *buffer = pa_stream_get_buffer_attr(m_stream);
+    // Don't block on the stream becoming ready, opening is finished in onStreamReady().
+    // Until then, data written in push mode is kept in m_pendingData.
     m_periodTime = SinkPeriodTimeMs;
     m_periodSize = pa_usec_to_bytes(m_periodTime * 1000, &m_spec);
-    m_bufferSize = buffer->tlength;
-    m_audioBuffer.resize(buffer->maxlength);
-
-    const qint64 streamSize = m_audioSource ? m_audioSource->size() : 0;
-    if (m_pullMode && streamSize > 0 && static_cast<qint64>(buffer->prebuf) > streamSize) {
-        pa_buffer_attr newBufferAttr;
-        newBufferAttr = *buffer;
-        newBufferAttr.prebuf = streamSize;
-        PAOperationUPtr(pa_stream_set_buffer_attr(m_stream, &newBufferAttr,
-                                                  streamAdjustPrebufferCallback, nullptr));
-    }
-
-    if (Q_UNLIKELY(qLcPulseAudioOut().isEnabled(QtDebugMsg))) {
-        qCDebug(qLcPulseAudioOut) << "Buffering info:";
-        qCDebug(qLcPulseAudioOut) << "\tMax length: " << buffer->maxlength;
-        qCDebug(qLcPulseAudioOut) << "\tTarget length: " << buffer->tlength;
-        qCDebug(qLcPulseAudioOut) << "\tPre-buffering: " << buffer->prebuf;
-        qCDebug(qLcPulseAudioOut) << "\tMinimum request: " << buffer->minreq;
-        qCDebug(qLcPulseAudioOut) << "\tFragment size: " << buffer->fragsize;
-    }
 
     pulseEngine->unlock();
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSink::onPulseContextFailed);
 
+    releaseEngine.dismiss();
     m_opened = true;
-
-    startReading();
+    m_streamReady = false;
 
     m_elapsedTimeOffset = 0;
 
     return true;
 }
 
+void QPulseAudioSink::onStreamReady()
+{
+    if (!m_opened || m_streamReady || !m_stream)
+        return;
+
+    QPulseAudioEngine *pulseEngine = m_engine;
+
+    {
+        std::lock_guard lock(*pulseEngine);
+
+        if (pa_stream_get_state(m_stream) != PA_STREAM_READY)
+            return;
+
+        const pa_buffer_attr *buffer = pa_stream_get_buffer_attr(m_stream);
+        m_bufferSize = buffer->tlength;
+        m_audioBuffer.resize(buffer->maxlength);
+        m_statistics.reset(m_periodTime * 1000);
+
+        const qint64 streamSize = m_audioSource ? m_audioSource->size() : 0;
+        if (m_pullMode && streamSize > 0 && static_cast<qint64>(buffer->prebuf) > streamSize) {
+            pa_buffer_attr newBufferAttr;
+            newBufferAttr = *buffer;
+            newBufferAttr.prebuf = streamSize;
+            PAOperationUPtr(pa_stream_set_buffer_attr(m_stream, &newBufferAttr,
+                                                      streamAdjustPrebufferCallback, nullptr));
+        }
+
+        if (Q_UNLIKELY(qLcPulseAudioOut().isEnabled(QtDebugMsg))) {
+            qCDebug(qLcPulseAudioOut) << "Buffering info:";
+            qCDebug(qLcPulseAudioOut) << "\tMax length: " << buffer->maxlength;
+            qCDebug(qLcPulseAudioOut) << "\tTarget length: " << buffer->tlength;
+            qCDebug(qLcPulseAudioOut) << "\tPre-buffering: " << buffer->prebuf;
+            qCDebug(qLcPulseAudioOut) << "\tMinimum request: " << buffer->minreq;
+            qCDebug(qLcPulseAudioOut) << "\tFragment size: " << buffer->fragsize;
+        }
+
+        // the sink might have been suspended while the stream was connecting
+        if (state() == QAudio::SuspendedState)
+            PAOperationUPtr(pa_stream_cork(m_stream, 1, nullptr, nullptr));
+    }
+
+    m_streamReady = true;
+
+    // a corked stream takes the data all the same, and plays it on resume()
+    flushPendingData();
+
+    if (state() != QAudio::SuspendedState)
+        startReading();
+}
+
+void QPulseAudioSink::onStreamFailed()
+{
+    if (!m_opened || m_streamReady)
+        return;
+
+    if (auto notifier = m_stateMachine.stopOrUpdateError(QAudio::OpenError))
+        close();
+}
+
+bool QPulseAudioSink::switchDevice(const QAudioDevice &device)
+{
+    const QByteArray deviceId = device.id();
+    if (deviceId.isEmpty())
+        return false;
+
+    if (deviceId == m_device)
+        return true;
+
+    if (!m_opened) {
+        m_device = deviceId;
+        return true;
+    }
+
+    QPulseAudioEngine *pulseEngine = m_engine;
+    std::lock_guard lock(*pulseEngine);
+
+    if (!m_stream || pa_stream_get_state(m_stream) != PA_STREAM_READY)
+        return false;
+
+    // Move the sink input to the new device asynchronously; the stream and all buffered
+    // data are preserved, and the server takes care of any format conversion.
+    PAOperationUPtr operation(pa_context_move_sink_input_by_name(
+            pulseEngine->context(), pa_stream_get_index(m_stream), deviceId.constData(),
+            streamMoveCallback, nullptr));
+    if (!operation)
+        return false;
+
+    qCDebug(qLcPulseAudioOut) << "Moving stream from" << m_device << "to" << deviceId;
+    m_device = deviceId;
+    return true;
+}
+
 void QPulseAudioSink::close()
 {
     if (!m_opened)
@@ -340,7 +436,7 @@ void QPulseAudioSink::close()
 
     m_tickTimer.stop();
 
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    QPulseAudioEngine *pulseEngine = m_engine;
 
     if (m_stream) {
         std::lock_guard lock(*pulseEngine);
@@ -363,6 +459,7 @@ void QPulseAudioSink::close()
     }
 
     disconnect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSink::onPulseContextFailed);
+    QPulseAudioEngine::releaseSinkEngine(std::exchange(m_engine, nullptr));
 
     if (m_audioSource) {
         if (m_pullMode) {
@@ -373,8 +470,10 @@ void QPulseAudioSink::close()
         }
     }
     m_opened = false;
+    m_streamReady = false;
     m_resuming = false;
     m_audioBuffer.clear();
+    m_pendingData.clear();
 }
 
 void QPulseAudioSink::timerEvent(QTimerEvent *event)
@@ -387,10 +486,11 @@ void QPulseAudioSink::timerEvent(QTimerEvent *event)
 
 void QPulseAudioSink::userFeed()
 {
-    if (!m_stateMachine.isActiveOrIdle())
+    if (!m_stateMachine.isActiveOrIdle() || !m_streamReady)
         return;
 
     m_resuming = false;
+    m_statistics.recordCallback();
 
     if (m_pullMode) {
         int writableSize = bytesFree();
@@ -400,29 +500,36 @@ void QPulseAudioSink::userFeed()
             return;
         }
 
-        const int input = std::min(m_periodSize, static_cast<int>(m_audioBuffer.size()));
+        // Pull everything PulseAudio accepts right now, in whole periods, and pass it on
+        // with a single write. This keeps the mainloop lock acquisitions per tick constant
+        // instead of locking (and requeueing userFeed) once per period, which matters when
+        // several streams share a mainloop, see QPulseAudioEngine::acquireSinkEngine().
+        const int input = std::min(chunks * m_periodSize, static_cast<int>(m_audioBuffer.size()));
 
         Q_ASSERT(!m_audioBuffer.empty());
-        int audioBytesPulled = m_audioSource->read(m_audioBuffer.data(), input);
-        Q_ASSERT(audioBytesPulled <= input);
-        if (audioBytesPulled > 0) {
-            if (audioBytesPulled > input) {
+        int audioBytesPulled = 0;
+        qint64 lastRead = 0;
+        while (audioBytesPulled < input) {
+            const int requested = input - audioBytesPulled;
+            lastRead = m_audioSource->read(m_audioBuffer.data() + audioBytesPulled, requested);
+            if (lastRead <= 0)
+                break;
+            if (lastRead > requested) {
                 qCWarning(qLcPulseAudioOut)
-                        << "Invalid audio data size provided by pull source:" << audioBytesPulled
-                        << "should be less than" << input;
-                audioBytesPulled = input;
+                        << "Invalid audio data size provided by pull source:" << lastRead
+                        << "should be less than" << requested;
+                lastRead = requested;
             }
+            audioBytesPulled += lastRead;
+        }
+
+        if (audioBytesPulled > 0) {
             auto bytesWritten = write(m_audioBuffer.data(), audioBytesPulled);
             if (bytesWritten != audioBytesPulled)
                 qWarning() << "Unfinished write should not happen since the data provided is "
                               "less than writableSize:"
                            << bytesWritten << "vs" << audioBytesPulled;
-
-            if (chunks > 1) {
-                // PulseAudio needs more data. Ask for it immediately.
-                QMetaObject::invokeMethod(this, &QPulseAudioSink::userFeed, Qt::QueuedConnection);
-            }
-        } else if (audioBytesPulled == 0) {
+        } else if (lastRead == 0) {
             m_tickTimer.stop();
             const auto atEnd = m_audioSource->atEnd();
             qCDebug(qLcPulseAudioOut) << "No more data available, source is done:" << atEnd;
@@ -431,6 +538,8 @@ void QPulseAudioSink::userFeed()
                                               atEnd ? QAudio::NoError : QAudio::UnderrunError);
         }
     } else {
+        flushPendingData();
+
         if (state() == QAudio::IdleState)
             m_stateMachine.setError(QAudio::UnderrunError);
     }
@@ -438,46 +547,105 @@ void QPulseAudioSink::userFeed()
 
 qint64 QPulseAudioSink::write(const char *data, qint64 len)
 {
-    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    if (!m_streamReady)
+        return bufferPendingData(data, len);
 
-    pulseEngine->lock();
+    // what was written while the stream connected goes first
+    flushPendingData();
+    if (!m_pendingData.isEmpty())
+        return 0;
 
-    size_t nbytes = len;
-    void *dest = nullptr;
+    return writeToStream(data, len);
+}
 
-    if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
-        pulseEngine->unlock();
-        qCWarning(qLcPulseAudioOut) << "pa_stream_begin_write error:"
-                                    << pa_strerror(pa_context_errno(pulseEngine->context()));
-        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+// Keeps data written in push mode until the stream is ready, up to the size of its buffer.
+qint64 QPulseAudioSink::bufferPendingData(const char *data, qint64 len)
+{
+    const qint64 chunk = qMin(len, qint64(pendingBufferSize() - m_pendingData.size()));
+    if (chunk <= 0)
         return 0;
-    }
 
-    len = qMin(len, qint64(nbytes));
+    m_pendingData.append(data, chunk);
+    m_stateMachine.updateActiveOrIdle(true);
+    return chunk;
+}
 
-    if (m_volume < 1.0f) {
-        // Don't use PulseAudio volume, as it might affect all other streams of the same category
-        // or even affect the system volume if flat volumes are enabled
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
-    } else {
-        memcpy(dest, data, len);
-    }
+void QPulseAudioSink::flushPendingData()
+{
+    if (m_pendingData.isEmpty())
+        return;
 
-    data = reinterpret_cast<char *>(dest);
+    const qint64 written = writeToStream(m_pendingData.constData(), m_pendingData.size());
+    m_pendingData.remove(0, written);
+}
 
-    if ((pa_stream_write(m_stream, data, len, nullptr, 0, PA_SEEK_RELATIVE)) < 0) {
-        pulseEngine->unlock();
-        qCWarning(qLcPulseAudioOut) << "pa_stream_write error:"
-                                    << pa_strerror(pa_context_errno(pulseEngine->context()));
-        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
-        return 0;
+qsizetype QPulseAudioSink::pendingBufferSize() const
+{
+    if (m_bufferSize > 0)
+        return m_bufferSize;
+    return pa_usec_to_bytes(DefaultBufferTimeMs * 1000, &m_spec);
+}
+
+qint64 QPulseAudioSink::writeToStream(const char *data, qint64 len)
+{
+    QPulseAudioEngine *pulseEngine = m_engine;
+
+    pulseEngine->lock();
+
+    // Writing more than the stream asks for goes past its target length, which only adds
+    // latency. pa_stream_begin_write may hand out a smaller buffer than requested, so keep
+    // writing under the same lock until that much is passed on.
+    len = qMin(len, qint64(pa_stream_writable_size(m_stream)));
+    qint64 written = 0;
+    bool failed = false;
+    while (written < len) {
+        size_t nbytes = len - written;
+        void *dest = nullptr;
+
+        if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0) {
+            qCWarning(qLcPulseAudioOut) << "pa_stream_begin_write error:"
+                                        << pa_strerror(pa_context_errno(pulseEngine->context()));
+            failed = true;
+            break;
+        }
+
+        const qint64 chunk = qMin(len - written, qint64(nbytes));
+        if (chunk <= 0) {
+            pa_stream_cancel_write(m_stream);
+            break;
+        }
+
+        if (m_volume < 1.0f) {
+            // Don't use PulseAudio volume, as it might affect all other streams of the same category
+            // or even affect the system volume if flat volumes are enabled
+            QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data + written, dest, chunk);
+        } else {
+            memcpy(dest, data + written, chunk);
+        }
+
+        if ((pa_stream_write(m_stream, dest, chunk, nullptr, 0, PA_SEEK_RELATIVE)) < 0) {
+            pa_stream_cancel_write(m_stream);
+            qCWarning(qLcPulseAudioOut) << "pa_stream_write error:"
+                                        << pa_strerror(pa_context_errno(pulseEngine->context()));
+            failed = true;
+            break;
+        }
+
+        written += chunk;
     }
 
+    m_statistics.recordBufferFill(m_bufferSize - qsizetype(pa_stream_writable_size(m_stream)));
+
     pulseEngine->unlock();
-    m_totalTimeValue += len;
 
-    m_stateMachine.updateActiveOrIdle(true);
-    return len;
+    // the chunks written before a failure are played all the same
+    m_totalTimeValue += written;
+
+    if (failed)
+        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+    else
+        m_stateMachine.updateActiveOrIdle(true);
+    return written;
 }
 
 void QPulseAudioSink::stop()
@@ -491,8 +659,23 @@ qsizetype QPulseAudioSink::bytesFree() const
     if (!m_stateMachine.isActiveOrIdle())
         return 0;
 
-    std::lock_guard lock(*QPulseAudioEngine::instance());
-    return pa_stream_writable_size(m_stream);
+    // while the stream connects, write() keeps up to a buffer's worth of data
+    if (!m_streamReady)
+        return pendingBufferSize() - m_pendingData.size();
+
+    std::lock_guard lock(*m_engine);
+    const qsizetype writable = pa_stream_writable_size(m_stream);
+    return qMax(writable - m_pendingData.size(), qsizetype(0));
+}
+
+QAudioStreamStatistics QPulseAudioSink::statistics() const
+{
+    qint64 latency = 0;
+    if (m_stream) {
+        std::lock_guard lock(*m_engine);
+        latency = QPulseAudioInternal::streamLatencyUSecs(m_stream);
+    }
+    return m_statistics.statistics(latency);
 }
 
 void QPulseAudioSink::setBufferSize(qsizetype value)
@@ -502,6 +685,9 @@ void QPulseAudioSink::setBufferSize(qsizetype value)
 
 qsizetype QPulseAudioSink::bufferSize() const
 {
+    // until the stream is ready, that's the size write() buffers
+    if (m_opened && !m_streamReady)
+        return pendingBufferSize();
     return m_bufferSize;
 }
 
@@ -575,18 +761,22 @@ qint64 QPulseAudioSink::processedUSecs() const
 void QPulseAudioSink::resume()
 {
     if (auto notifier = m_stateMachine.resume()) {
+        if (!m_streamReady)
+            return; // the stream is started uncorked once it's ready
+
         m_resuming = true;
 
         {
-            QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+            QPulseAudioEngine *pulseEngine = m_engine;
 
             std::lock_guard lock(*pulseEngine);
 
             PAOperationUPtr operation(
-                    pa_stream_cork(m_stream, 0, outputStreamSuccessCallback, nullptr));
+                    pa_stream_cork(m_stream, 0, outputStreamSuccessCallback, pulseEngine));
             pulseEngine->wait(operation.get());
 
-            operation.reset(pa_stream_trigger(m_stream, outputStreamSuccessCallback, nullptr));
+            operation.reset(
+                    pa_stream_trigger(m_stream, outputStreamSuccessCallback, pulseEngine));
             pulseEngine->wait(operation.get());
         }
 
@@ -609,12 +799,15 @@ void QPulseAudioSink::suspend()
     if (auto notifier = m_stateMachine.suspend()) {
         m_tickTimer.stop();
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+        if (!m_streamReady)
+            return; // corked in onStreamReady()
+
+        QPulseAudioEngine *pulseEngine = m_engine;
 
         std::lock_guard lock(*pulseEngine);
 
         PAOperationUPtr operation(
-                pa_stream_cork(m_stream, 1, outputStreamSuccessCallback, nullptr));
+                pa_stream_cork(m_stream, 1, outputStreamSuccessCallback, pulseEngine));
         pulseEngine->wait(operation.get());
     }
 }
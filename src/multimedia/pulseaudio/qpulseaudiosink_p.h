@@ -32,6 +32,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QPulseAudioEngine;
+
 class QPulseAudioSink : public QPlatformAudioSink
 {
     friend class PulseOutputPrivate;
@@ -58,9 +60,16 @@ public:
 
     void setVolume(qreal volume) override;
     qreal volume() const override;
+    QAudioStreamStatistics statistics() const override;
+
+    bool switchDevice(const QAudioDevice &device) override;
 
     void streamUnderflowCallback();
     void streamDrainedCallback();
+    void onStreamReady();
+    void onStreamFailed();
+
+    QPulseAudioEngine *engine() const { return m_engine; }
 
 protected:
     void timerEvent(QTimerEvent *event) override;
@@ -71,6 +80,10 @@ private:
     bool open();
     void close();
     qint64 write(const char *data, qint64 len);
+    qint64 writeToStream(const char *data, qint64 len);
+    qint64 bufferPendingData(const char *data, qint64 len);
+    void flushPendingData();
+    qsizetype pendingBufferSize() const;
 
 private Q_SLOTS:
     void userFeed();
@@ -91,8 +104,12 @@ private:
     QBasicTimer m_tickTimer;
 
     QIODevice *m_audioSource = nullptr;
+    // the engine the stream is created on while opened, see QPulseAudioEngine::acquireSinkEngine()
+    QPulseAudioEngine *m_engine = nullptr;
     pa_stream *m_stream = nullptr;
     std::vector<char> m_audioBuffer;
+    // written in push mode while the stream connects
+    QByteArray m_pendingData;
 
     qint64 m_totalTimeValue = 0;
     qint64 m_elapsedTimeOffset = 0;
@@ -106,9 +123,11 @@ private:
     int m_periodTime = 0;
     bool m_pullMode = true;
     bool m_opened = false;
+    bool m_streamReady = false;
     bool m_resuming = false;
 
     QAudioStateMachine m_stateMachine;
+    QAudioStreamStatisticsCollector m_statistics;
 };
 
 class PulseOutputPrivate : public QIODevice
@@ -73,8 +73,9 @@ static void inputStreamUnderflowCallback(pa_stream *stream, void *userdata)
 static void inputStreamOverflowCallback(pa_stream *stream, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
     qWarning() << "Got a buffer overflow!";
+    if (userdata)
+        static_cast<QPulseAudioSource *>(userdata)->streamOverflowCallback();
 }
 
 static void inputStreamSuccessCallback(pa_stream *stream, int success, void *userdata)
@@ -308,6 +309,10 @@ bool QPulseAudioSource::open()
 
     connect(pulseEngine, &QPulseAudioEngine::contextFailed, this, &QPulseAudioSource::onPulseContextFailed);
 
+    m_tempBuffer.clear();
+    m_tempBuffer.setChunkSize(m_periodSize);
+    m_statistics.reset(m_periodTime * 1000);
+
     m_opened = true;
     m_timer->start(m_periodTime);
 
@@ -345,6 +350,7 @@ void QPulseAudioSource::close()
         delete m_audioSource;
         m_audioSource = nullptr;
     }
+    m_tempBuffer.clear();
     m_opened = false;
 }
 
@@ -353,7 +359,8 @@ int QPulseAudioSource::checkBytesReady()
     if (m_deviceState != QAudio::ActiveState && m_deviceState != QAudio::IdleState) {
         m_bytesAvailable = 0;
     } else {
-        m_bytesAvailable = pa_stream_readable_size(m_stream);
+        m_bytesAvailable = pa_stream_readable_size(m_stream) + m_tempBuffer.size();
+        m_statistics.recordBufferFill(m_bytesAvailable);
     }
 
     return m_bytesAvailable;
@@ -364,6 +371,68 @@ qsizetype QPulseAudioSource::bytesReady() const
     return qMax(m_bytesAvailable, 0);
 }
 
+// Returns the next fragment captured by PulseAudio, pointing straight into the
+// stream's buffer. The fragment stays valid until dropFragment() is called, and
+// the engine has to stay locked in between. Returns an empty fragment if there is
+// nothing to read and std::nullopt on failure.
+// This peek/drop pair is internal to the backend: QAudioSource only exposes
+// QIODevice based reading, so the fragments reach users through the device.
+std::optional<QByteArrayView> QPulseAudioSource::peekFragment()
+{
+    for (;;) {
+        const void *audioBuffer = nullptr;
+        size_t length = 0;
+
+        if (pa_stream_peek(m_stream, &audioBuffer, &length) < 0) {
+            qWarning() << QString::fromLatin1("pa_stream_peek() failed: %1")
+                          .arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(m_stream)))));
+            return std::nullopt;
+        }
+
+        if (audioBuffer || !length)
+            return QByteArrayView(static_cast<const char *>(audioBuffer), qsizetype(length));
+
+        // A hole in the stream (e.g. after an overflow); there is no data to hand out,
+        // but it still has to be dropped.
+        pa_stream_drop(m_stream);
+    }
+}
+
+void QPulseAudioSource::dropFragment()
+{
+    pa_stream_drop(m_stream);
+}
+
+// Returns the fragment itself if no volume adjustment is needed, otherwise a view
+// of the reusable volume buffer holding the adjusted samples.
+QByteArrayView QPulseAudioSource::volumeAdjusted(QByteArrayView fragment)
+{
+    if (m_volume >= 1.f || fragment.isEmpty())
+        return fragment;
+
+    if (m_volumeBuffer.size() < size_t(fragment.size()))
+        m_volumeBuffer.resize(fragment.size());
+    applyVolume(fragment.data(), m_volumeBuffer.data(), fragment.size());
+    return QByteArrayView(m_volumeBuffer.data(), fragment.size());
+}
+
+// Writes the data left over from previous reads to the device in pull mode.
+// Returns false if the device didn't accept all of it.
+bool QPulseAudioSource::flushPendingData()
+{
+    while (!m_tempBuffer.isEmpty()) {
+        const qint64 blockSize = m_tempBuffer.nextDataBlockSize();
+        const qint64 written = m_audioSource->write(m_tempBuffer.readPointer(), blockSize);
+        if (written > 0) {
+            m_tempBuffer.free(written);
+            m_totalTimeValue += written;
+        }
+        if (written < blockSize)
+            return false;
+    }
+    return true;
+}
+
 qint64 QPulseAudioSource::read(char *data, qint64 len)
 {
     Q_ASSERT(data != nullptr || len == 0);
@@ -374,83 +443,75 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
     if (state() == QAudio::IdleState)
         setState(QAudio::ActiveState);
 
-    int readBytes = 0;
+    qint64 readBytes = 0;
 
-    if (!m_pullMode && !m_tempBuffer.isEmpty()) {
-        readBytes = qMin(static_cast<int>(len), m_tempBuffer.size());
-        if (readBytes)
-            memcpy(data, m_tempBuffer.constData(), readBytes);
+    if (m_pullMode) {
+        if (!flushPendingData()) {
+            setError(QAudio::UnderrunError);
+            setState(QAudio::IdleState);
+            return 0;
+        }
+    } else if (!m_tempBuffer.isEmpty()) {
+        readBytes = m_tempBuffer.read(data, len);
         m_totalTimeValue += readBytes;
 
-        if (readBytes < m_tempBuffer.size()) {
-            m_tempBuffer.remove(0, readBytes);
+        if (!m_tempBuffer.isEmpty())
             return readBytes;
-        }
-
-        m_tempBuffer.clear();
     }
 
-    while (pa_stream_readable_size(m_stream) > 0) {
-        size_t readLength = 0;
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    bool underrun = false;
 
+    while (!underrun && pa_stream_readable_size(m_stream) > 0) {
 #ifdef DEBUG_PULSE
         qDebug() << "QPulseAudioSource::read -- " << pa_stream_readable_size(m_stream) << " bytes available from pulse audio";
 #endif
 
-        QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
-        pulseEngine->lock();
-
-        const void *audioBuffer;
+        std::lock_guard lock(*pulseEngine);
 
-        // Second and third parameters (audioBuffer and length) to pa_stream_peek are output parameters,
-        // the audioBuffer pointer is set to point to the actual pulse audio data,
-        // and the length is set to the length of this data.
-        if (pa_stream_peek(m_stream, &audioBuffer, &readLength) < 0) {
-            qWarning() << QString::fromLatin1("pa_stream_peek() failed: %1")
-                          .arg(QString::fromUtf8(pa_strerror(pa_context_errno(pa_stream_get_context(m_stream)))));
-            pulseEngine->unlock();
-            return 0;
-        }
+        const std::optional<QByteArrayView> fragment = peekFragment();
+        if (!fragment)
+            return readBytes;
+        if (fragment->isEmpty())
+            break;
 
+        const qint64 readLength = fragment->size();
         qint64 actualLength = 0;
-        if (m_pullMode) {
-            QByteArray adjusted(readLength, Qt::Uninitialized);
-            applyVolume(audioBuffer, adjusted.data(), readLength);
-            actualLength = m_audioSource->write(adjusted);
-
-            if (actualLength < qint64(readLength)) {
-                pulseEngine->unlock();
 
-                setError(QAudio::UnderrunError);
-                setState(QAudio::IdleState);
+        if (m_pullMode) {
+            // with unity volume this hands the PulseAudio fragment to the device without a copy
+            const QByteArrayView adjusted = volumeAdjusted(*fragment);
+            actualLength = qMax(m_audioSource->write(adjusted.data(), adjusted.size()), qint64(0));
 
-                return actualLength;
+            if (actualLength < readLength) {
+#ifdef DEBUG_PULSE
+                qDebug() << "QPulseAudioSource::read -- keeping " << readLength - actualLength << " bytes of data in temp buffer";
+#endif
+                m_tempBuffer.append(adjusted.data() + actualLength, readLength - actualLength);
+                underrun = true;
             }
         } else {
-            actualLength = qMin(static_cast<int>(len - readBytes), static_cast<int>(readLength));
-            applyVolume(audioBuffer, data + readBytes, actualLength);
-        }
+            actualLength = qMin(len - readBytes, readLength);
+            applyVolume(fragment->data(), data + readBytes, actualLength);
 
+            if (actualLength < readLength) {
 #ifdef DEBUG_PULSE
-        qDebug() << "QPulseAudioSource::read -- wrote " << actualLength << " to client";
+                qDebug() << "QPulseAudioSource::read -- appending " << readLength - actualLength << " bytes of data to temp buffer";
 #endif
+                const qint64 diff = readLength - actualLength;
+                applyVolume(fragment->data() + actualLength, m_tempBuffer.reserve(diff), diff);
+                QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
+            }
+        }
 
-        if (actualLength < qint64(readLength)) {
 #ifdef DEBUG_PULSE
-            qDebug() << "QPulseAudioSource::read -- appending " << readLength - actualLength << " bytes of data to temp buffer";
+        qDebug() << "QPulseAudioSource::read -- wrote " << actualLength << " to client";
 #endif
-            int diff = readLength - actualLength;
-            int oldSize = m_tempBuffer.size();
-            m_tempBuffer.resize(m_tempBuffer.size() + diff);
-            applyVolume(static_cast<const char *>(audioBuffer) + actualLength, m_tempBuffer.data() + oldSize, diff);
-            QMetaObject::invokeMethod(this, "userFeed", Qt::QueuedConnection);
-        }
 
         m_totalTimeValue += actualLength;
         readBytes += actualLength;
 
-        pa_stream_drop(m_stream);
-        pulseEngine->unlock();
+        dropFragment();
 
         if (!m_pullMode && readBytes >= len)
             break;
@@ -460,6 +521,11 @@ qint64 QPulseAudioSource::read(char *data, qint64 len)
     qDebug() << "QPulseAudioSource::read -- returning after reading " << readBytes << " bytes";
 #endif
 
+    if (underrun) {
+        setError(QAudio::UnderrunError);
+        setState(QAudio::IdleState);
+    }
+
     return readBytes;
 }
 
@@ -504,6 +570,21 @@ qreal QPulseAudioSource::volume() const
     return m_volume;
 }
 
+QAudioStreamStatistics QPulseAudioSource::statistics() const
+{
+    qint64 latency = 0;
+    if (m_stream) {
+        std::lock_guard lock(*QPulseAudioEngine::instance());
+        latency = QPulseAudioInternal::streamLatencyUSecs(m_stream);
+    }
+    return m_statistics.statistics(latency);
+}
+
+void QPulseAudioSource::streamOverflowCallback()
+{
+    m_statistics.recordXrun();
+}
+
 void QPulseAudioSource::setBufferSize(qsizetype value)
 {
     m_bufferSize = value;
@@ -552,6 +633,7 @@ void QPulseAudioSource::userFeed()
 //    QTime now(QTime::currentTime());
 //    qDebug()<< now.second() << "s " << now.msec() << "ms :userFeed() IN";
 #endif
+    m_statistics.recordCallback();
     deviceReady();
 }
 
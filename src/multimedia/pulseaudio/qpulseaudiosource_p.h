@@ -21,6 +21,7 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/private/qringbuffer_p.h>
 
 #include "qaudio.h"
 #include "qaudiodevice.h"
@@ -28,6 +29,9 @@
 
 #include <pulse/pulseaudio.h>
 
+#include <optional>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class PulseInputPrivate;
@@ -59,6 +63,9 @@ public:
 
     void setVolume(qreal volume) override;
     qreal volume() const override;
+    QAudioStreamStatistics statistics() const override;
+
+    void streamOverflowCallback();
 
     qint64 m_totalTimeValue;
     QIODevice *m_audioSource;
@@ -77,6 +84,11 @@ private:
     void setError(QAudio::Error error);
 
     void applyVolume(const void *src, void *dest, int len);
+    QByteArrayView volumeAdjusted(QByteArrayView fragment);
+
+    std::optional<QByteArrayView> peekFragment();
+    void dropFragment();
+    bool flushPendingData();
 
     int checkBytesReady();
     bool open();
@@ -93,7 +105,13 @@ private:
     pa_stream *m_stream;
     QByteArray m_streamName;
     QByteArray m_device;
-    QByteArray m_tempBuffer;
+    // Captured data that didn't fit into the reader's buffer. In push mode the reader
+    // gets the data through QIODevice::read() into a buffer of its own, so there are
+    // no buffers to hand out from a pool; the ring buffer keeps its last chunk when
+    // drained, so steady capture reuses the same allocation instead.
+    QRingBuffer m_tempBuffer;
+    std::vector<char> m_volumeBuffer;
+    QAudioStreamStatisticsCollector m_statistics;
     pa_sample_spec m_spec;
 };
 
@@ -197,6 +197,16 @@ QAudioFormat sampleSpecToAudioFormat(const pa_sample_spec &spec)
     return format;
 }
 
+// Returns the current latency of the stream; the engine must be locked.
+qint64 streamLatencyUSecs(pa_stream *stream)
+{
+    pa_usec_t usecs = 0;
+    int negative = 0;
+    if (pa_stream_get_latency(stream, &usecs, &negative) < 0)
+        return 0;
+    return negative ? -qint64(usecs) : qint64(usecs);
+}
+
 }
 
 QT_END_NAMESPACE
@@ -37,6 +37,7 @@ pa_sample_spec audioFormatToSampleSpec(const QAudioFormat &format);
 QAudioFormat sampleSpecToAudioFormat(const pa_sample_spec &spec);
 pa_channel_map channelMapForAudioFormat(const QAudioFormat &format);
 QAudioFormat::ChannelConfig channelConfigFromMap(const pa_channel_map &map);
+qint64 streamLatencyUSecs(pa_stream *stream);
 
 static inline QString stateToQString(pa_stream_state_t state)
 {
@@ -10,6 +10,8 @@
 
 QT_BEGIN_NAMESPACE
 
+static Q_LOGGING_CATEGORY(qLcVideoTextureHelper, "qt.multimedia.video.texturehelper");
+
 namespace QVideoTextureHelper
 {
 
@@ -585,59 +587,6 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
     ud->maxLum = fromLinear(float(maxNits)/100.f);
 }
 
-static bool updateTextureWithMap(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, int plane, std::unique_ptr<QRhiTexture> &tex)
-{
-    if (!frame.map(QVideoFrame::ReadOnly)) {
-        qWarning() << "could not map data of QVideoFrame for upload";
-        return false;
-    }
-
-    auto unmapFrameGuard = qScopeGuard([&frame] { frame.unmap(); });
-
-    QVideoFrameFormat fmt = frame.surfaceFormat();
-    QVideoFrameFormat::PixelFormat pixelFormat = fmt.pixelFormat();
-    QSize size = fmt.frameSize();
-
-    const TextureDescription &texDesc = descriptions[pixelFormat];
-    QSize planeSize(size.width()/texDesc.sizeScale[plane].x, size.height()/texDesc.sizeScale[plane].y);
-
-    bool needsRebuild = !tex || tex->pixelSize() != planeSize || tex->format() != texDesc.textureFormat[plane];
-    if (!tex) {
-        tex.reset(rhi->newTexture(texDesc.textureFormat[plane], planeSize, 1, {}));
-        if (!tex) {
-            qWarning("Failed to create new texture (size %dx%d)", planeSize.width(), planeSize.height());
-            return false;
-        }
-    }
-
-    if (needsRebuild) {
-        tex->setFormat(texDesc.textureFormat[plane]);
-        tex->setPixelSize(planeSize);
-        if (!tex->create()) {
-            qWarning("Failed to create texture (size %dx%d)", planeSize.width(), planeSize.height());
-            return false;
-        }
-    }
-
-    QRhiTextureSubresourceUploadDescription subresDesc;
-    QImage image;
-    if (pixelFormat == QVideoFrameFormat::Format_Jpeg) {
-        image = frame.toImage();
-        image.convertTo(QImage::Format_ARGB32);
-        subresDesc.setData(QByteArray((const char *)image.bits(), image.bytesPerLine()*image.height()));
-        subresDesc.setDataStride(image.bytesPerLine());
-    } else {
-        subresDesc.setData(QByteArray::fromRawData((const char *)frame.bits(plane), frame.mappedBytes(plane)));
-        subresDesc.setDataStride(frame.bytesPerLine(plane));
-    }
-
-    QRhiTextureUploadEntry entry(0, 0, subresDesc);
-    QRhiTextureUploadDescription desc({ entry });
-    rub->uploadTexture(tex.get(), desc);
-
-    return true;
-}
-
 static std::unique_ptr<QRhiTexture> createTextureFromHandle(const QVideoFrame &frame, QRhi *rhi, int plane)
 {
     QVideoFrameFormat fmt = frame.surfaceFormat();
@@ -675,8 +624,21 @@ class QVideoFrameTexturesArray : public QVideoFrameTextures
 {
 public:
     using TextureArray = std::array<std::unique_ptr<QRhiTexture>, TextureDescription::maxPlanes>;
-    QVideoFrameTexturesArray(TextureArray &&textures)
+
+    // What was last uploaded to a texture, to skip uploading unchanged planes
+    struct PlaneState
+    {
+        size_t hash = 0;
+        bool hashValid = false;
+        // Consecutive frames in which the plane changed
+        int changedFrames = 0;
+    };
+    using PlaneStateArray = std::array<PlaneState, TextureDescription::maxPlanes>;
+
+    QVideoFrameTexturesArray(TextureArray &&textures, PlaneStateArray planes = {}, quint64 frameCount = 0)
         : m_textures(std::move(textures))
+        , m_planes(planes)
+        , m_frameCount(frameCount)
     {}
 
     QRhiTexture *texture(uint plane) const override
@@ -685,9 +647,13 @@ public:
     }
 
     TextureArray takeTextures() { return std::move(m_textures); }
+    const PlaneStateArray &planes() const { return m_planes; }
+    quint64 frameCount() const { return m_frameCount; }
 
 private:
     TextureArray m_textures;
+    PlaneStateArray m_planes;
+    quint64 m_frameCount = 0;
 };
 
 static std::unique_ptr<QVideoFrameTextures> createTexturesFromHandles(const QVideoFrame &frame, QRhi *rhi)
@@ -705,22 +671,127 @@ static std::unique_ptr<QVideoFrameTextures> createTexturesFromHandles(const QVid
         return {};
 }
 
-std::unique_ptr<QVideoFrameTextures> createTexturesFromMemory(const QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, QVideoFrameTextures *old)
+// Planes that changed in this many frames in a row are most likely video. Only
+// hash two consecutive frames out of every backoffHashInterval for them then, which
+// is enough to notice when they stop changing.
+static constexpr int changedFramesBeforeBackoff = 32;
+static constexpr int backoffHashInterval = 16;
+
+// Makes sure tex can hold the given plane, returns false if it had to be (re)created
+static bool ensureTexture(QRhi *rhi, const TextureDescription &texDesc, QSize size, int plane,
+                          std::unique_ptr<QRhiTexture> &tex, bool *ok)
 {
-    const TextureDescription &texDesc = descriptions[frame.surfaceFormat().pixelFormat()];
+    QSize planeSize(size.width()/texDesc.sizeScale[plane].x, size.height()/texDesc.sizeScale[plane].y);
+    *ok = true;
+
+    bool needsRebuild = !tex || tex->pixelSize() != planeSize || tex->format() != texDesc.textureFormat[plane];
+    if (!tex) {
+        tex.reset(rhi->newTexture(texDesc.textureFormat[plane], planeSize, 1, {}));
+        if (!tex) {
+            qWarning("Failed to create new texture (size %dx%d)", planeSize.width(), planeSize.height());
+            *ok = false;
+            return false;
+        }
+    }
+
+    if (needsRebuild) {
+        tex->setFormat(texDesc.textureFormat[plane]);
+        tex->setPixelSize(planeSize);
+        if (!tex->create()) {
+            qWarning("Failed to create texture (size %dx%d)", planeSize.width(), planeSize.height());
+            *ok = false;
+        }
+        return false;
+    }
+    return true;
+}
+
+static std::unique_ptr<QVideoFrameTextures> createTexturesFromJpeg(const QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, QVideoFrameTexturesArray::TextureArray &&textures)
+{
+    const TextureDescription &texDesc = descriptions[QVideoFrameFormat::Format_Jpeg];
+    bool ok = true;
+    ensureTexture(rhi, texDesc, frame.surfaceFormat().frameSize(), 0, textures[0], &ok);
+    if (!ok)
+        return {};
+
+    // toImage() maps the frame itself. The image is implicitly shared with the
+    // upload, so its pixels don't have to be copied again.
+    QImage image = frame.toImage();
+    image.convertTo(QImage::Format_ARGB32);
+    qCDebug(qLcVideoTextureHelper) << "uploading" << image.sizeInBytes() << "bytes of decoded JPEG";
+    QRhiTextureUploadEntry entry(0, 0, QRhiTextureSubresourceUploadDescription(image));
+    QRhiTextureUploadDescription desc({ entry });
+    rub->uploadTexture(textures[0].get(), desc);
+    return std::make_unique<QVideoFrameTexturesArray>(std::move(textures));
+}
+
+std::unique_ptr<QVideoFrameTextures> createTexturesFromMemory(QVideoFrame frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, QVideoFrameTextures *old)
+{
+    const QVideoFrameFormat fmt = frame.surfaceFormat();
+    const TextureDescription &texDesc = descriptions[fmt.pixelFormat()];
     QVideoFrameTexturesArray::TextureArray textures;
+    QVideoFrameTexturesArray::PlaneStateArray planes;
+    quint64 frameCount = 0;
     auto oldArray = dynamic_cast<QVideoFrameTexturesArray *>(old);
-    if (oldArray)
+    if (oldArray) {
         textures = oldArray->takeTextures();
+        planes = oldArray->planes();
+        frameCount = oldArray->frameCount() + 1;
+    }
 
-    bool ok = true;
+    if (fmt.pixelFormat() == QVideoFrameFormat::Format_Jpeg)
+        return createTexturesFromJpeg(frame, rhi, rub, std::move(textures));
+
+    // Map once for all planes
+    if (!frame.map(QVideoFrame::ReadOnly)) {
+        qWarning() << "could not map data of QVideoFrame for upload";
+        return {};
+    }
+    auto unmapFrameGuard = qScopeGuard([&frame] { frame.unmap(); });
+
+    qsizetype uploadedBytes = 0;
+    qsizetype skippedBytes = 0;
     for (quint8 plane = 0; plane < texDesc.nplanes; ++plane) {
-        ok &= updateTextureWithMap(frame, rhi, rub, plane, textures[plane]);
+        bool ok = true;
+        const bool reused = ensureTexture(rhi, texDesc, fmt.frameSize(), plane, textures[plane], &ok);
+        if (!ok)
+            return {};
+
+        const char *data = reinterpret_cast<const char *>(frame.bits(plane));
+        const qsizetype bytes = frame.mappedBytes(plane);
+        auto &state = planes[plane];
+
+        // Hashing is much cheaper than uploading, but still reads the whole
+        // plane, so only do it while it has a chance to pay off. New textures
+        // are hashed too, so that the next frame can already be skipped.
+        const bool hash = state.changedFrames < changedFramesBeforeBackoff
+                || frameCount % backoffHashInterval <= 1;
+        if (hash) {
+            const size_t h = qHashBits(data, size_t(bytes));
+            if (reused && state.hashValid && state.hash == h) {
+                state.changedFrames = 0;
+                skippedBytes += bytes;
+                continue;
+            }
+            state.hash = h;
+            state.hashValid = true;
+        } else {
+            state.hashValid = false;
+        }
+        ++state.changedFrames;
+
+        QRhiTextureSubresourceUploadDescription subresDesc;
+        subresDesc.setData(QByteArray::fromRawData(data, bytes));
+        subresDesc.setDataStride(frame.bytesPerLine(plane));
+        QRhiTextureUploadEntry entry(0, 0, subresDesc);
+        QRhiTextureUploadDescription desc({ entry });
+        rub->uploadTexture(textures[plane].get(), desc);
+        uploadedBytes += bytes;
     }
-    if (ok)
-        return std::make_unique<QVideoFrameTexturesArray>(std::move(textures));
-    else
-        return {};
+    qCDebug(qLcVideoTextureHelper) << "uploaded" << uploadedBytes << "bytes, skipped" << skippedBytes
+                                   << "bytes of unchanged planes";
+
+    return std::make_unique<QVideoFrameTexturesArray>(std::move(textures), planes, frameCount);
 }
 
 std::unique_ptr<QVideoFrameTextures> createTextures(QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, std::unique_ptr<QVideoFrameTextures> &&oldTextures)
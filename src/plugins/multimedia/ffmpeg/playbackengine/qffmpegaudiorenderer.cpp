@@ -5,6 +5,7 @@
 #include "qaudiosink.h"
 #include "qaudiooutput.h"
 #include "private/qplatformaudiooutput_p.h"
+#include "private/qaudiosystem_p.h"
 #include <QtCore/qloggingcategory.h>
 
 #include "qffmpegresampler_p.h"
@@ -20,30 +21,61 @@ using namespace std::chrono_literals;
 
 namespace {
 constexpr auto AudioSinkBufferTime = 100000us;
-constexpr auto MinDesiredBufferTime = AudioSinkBufferTime / 10;
-constexpr auto MaxDesiredBufferTime = 6 * AudioSinkBufferTime / 10;
-constexpr auto SampleCompenationOffset = AudioSinkBufferTime / 10;
+// Live streams in low-latency mode keep less audio queued in the sink
+constexpr auto LowLatencyAudioSinkBufferTime = 40000us;
+
+std::chrono::microseconds sinkBufferTime(bool lowLatency)
+{
+    return lowLatency ? LowLatencyAudioSinkBufferTime : AudioSinkBufferTime;
+}
+
+// The desired sink loading, relative to the sink buffer time
+constexpr std::chrono::microseconds minDesiredBufferTime(std::chrono::microseconds sinkBufferTime)
+{
+    return sinkBufferTime / 10;
+}
+
+constexpr std::chrono::microseconds maxDesiredBufferTime(std::chrono::microseconds sinkBufferTime)
+{
+    return 6 * sinkBufferTime / 10;
+}
 
 // actual playback rate chang during the soft compensation
 constexpr qreal CompensationAngleFactor = 0.01;
 
+// The shortest distance of the compensation while catching up, if it isn't synchronizing
+constexpr auto MinCatchUpCompensationTime = 1s;
+
 constexpr auto DurationBias = 2ms; // avoids extra timer events
 } // namespace
 
-AudioRenderer::AudioRenderer(const TimeController &tc, QAudioOutput *output)
-    : Renderer(tc, MinDesiredBufferTime), m_output(output)
+AudioRenderer::AudioRenderer(const TimeController &tc, QAudioOutput *output, bool lowLatency)
+    : Renderer(tc, minDesiredBufferTime(sinkBufferTime(lowLatency))),
+      m_output(output),
+      m_sinkBufferTime(sinkBufferTime(lowLatency))
 {
-    if (output) {
-        // TODO: implement the signals in QPlatformAudioOutput and connect to them, QTBUG-112294
-        connect(output, &QAudioOutput::deviceChanged, this, &AudioRenderer::onDeviceChanged);
-        connect(output, &QAudioOutput::volumeChanged, this, &AudioRenderer::updateVolume);
-        connect(output, &QAudioOutput::mutedChanged, this, &AudioRenderer::updateVolume);
-    }
+    connectOutput();
 }
 
 void AudioRenderer::setOutput(QAudioOutput *output)
 {
-    setOutputInternal(m_output, output, [this](QAudioOutput *) { onDeviceChanged(); });
+    setOutputInternal(m_output, output, [this](QAudioOutput *prev) {
+        if (prev)
+            prev->disconnect(this);
+        connectOutput();
+        onDeviceChanged();
+    });
+}
+
+void AudioRenderer::connectOutput()
+{
+    if (!m_output)
+        return;
+
+    // TODO: implement the signals in QPlatformAudioOutput and connect to them, QTBUG-112294
+    connect(m_output, &QAudioOutput::deviceChanged, this, &AudioRenderer::onDeviceChanged);
+    connect(m_output, &QAudioOutput::volumeChanged, this, &AudioRenderer::updateVolume);
+    connect(m_output, &QAudioOutput::mutedChanged, this, &AudioRenderer::updateVolume);
 }
 
 AudioRenderer::~AudioRenderer()
@@ -53,7 +85,7 @@ AudioRenderer::~AudioRenderer()
 
 void AudioRenderer::updateVolume()
 {
-    if (m_sink)
+    if (m_sink && m_output)
         m_sink->setVolume(m_output->isMuted() ? 0.f : m_output->volume());
 }
 
@@ -104,7 +136,7 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
         const auto remainingDuration = std::chrono::microseconds(
                 m_format.durationForBytes(m_bufferedData.byteCount() - m_bufferWritten));
 
-        return { false, std::min(remainingDuration + DurationBias, AudioSinkBufferTime / 2) };
+        return { false, std::min(remainingDuration + DurationBias, m_sinkBufferTime / 2) };
     }
 
     return {};
@@ -140,6 +172,7 @@ void AudioRenderer::initResempler(const Codec *codec)
     resamplerFormat.setSampleRate(
             qRound(m_format.sampleRate() / playbackRate() * PlaybackRateDeviation));
     m_resampler = std::make_unique<Resampler>(codec, resamplerFormat);
+    m_resamplerCodec = *codec;
 }
 
 void AudioRenderer::freeOutput()
@@ -159,12 +192,36 @@ void AudioRenderer::freeOutput()
     m_deviceChanged = false;
 }
 
+bool AudioRenderer::moveOutputToNewDevice()
+{
+    if (!m_sink || !m_output)
+        return false;
+
+    const QAudioDevice device = m_output->device();
+    if (device.isNull() || device.channelConfiguration() != m_format.channelConfig())
+        return false;
+
+    QPlatformAudioSink *platformSink = m_sink->handle();
+    if (!platformSink || !platformSink->switchDevice(device))
+        return false;
+
+    qCDebug(qLcAudioRenderer) << "Moved audio output to" << device.description();
+    // the output may be another QAudioOutput now, with a volume of its own
+    updateVolume();
+    return true;
+}
+
 void AudioRenderer::updateOutput(const Codec *codec)
 {
     if (m_deviceChanged) {
-        freeOutput();
-        m_format = {};
-        m_resampler.reset();
+        m_deviceChanged = false;
+
+        // keep the sink and its buffered data if the backend can migrate the stream
+        if (!moveOutputToNewDevice()) {
+            freeOutput();
+            m_format = {};
+            m_resampler.reset();
+        }
     }
 
     if (!m_output) {
@@ -181,10 +238,14 @@ void AudioRenderer::updateOutput(const Codec *codec)
         // Insert a delay here to test time offset synchronization, e.g. QThread::sleep(1)
         m_sink = std::make_unique<QAudioSink>(m_output->device(), m_format);
         updateVolume();
-        m_sink->setBufferSize(m_format.bytesForDuration(AudioSinkBufferTime.count()));
+        m_sink->setBufferSize(m_format.bytesForDuration(m_sinkBufferTime.count()));
         m_ioDevice = m_sink->start();
     }
 
+    // The sink keeps its format, only the conversion into it changes
+    if (m_resamplerCodec && m_resamplerCodec->context() != codec->context())
+        m_resampler.reset();
+
     if (!m_resampler) {
         initResempler(codec);
     }
@@ -195,7 +256,7 @@ void AudioRenderer::updateSynchronization(const Frame &currentFrame)
     // Currently we use "soft" compensation with a positive/negative delta
     // for slight increasing/decreasing of the sound delay (roughly equal to buffer loading on a
     // normal playng) if it's out of the range [min; max]. If the delay more than
-    // AudioSinkBufferTime we synchronize rendering time to ensure free buffer size and than
+    // the sink buffer time we synchronize rendering time to ensure free buffer size and than
     // decrease it more with "soft" synchronization.
     //
     // TODO:
@@ -208,13 +269,21 @@ void AudioRenderer::updateSynchronization(const Frame &currentFrame)
     Q_ASSERT(currentFrame.isValid());
 
     const auto bufferLoadingTime = currentBufferLoadingTime();
+    setOutputDelay(bufferLoadingTime);
     const auto currentFrameDelay = frameDelay(currentFrame);
     auto soundDelay = currentFrameDelay + bufferLoadingTime;
 
-    const auto activeCompensationDelta = m_resampler->activeSampleCompensationDelta();
+    // Catching up drops samples on top of the synchronization, see Renderer::setCatchUpFactor()
+    const auto activeTotalDelta = m_resampler->activeSampleCompensationDelta();
+    const auto activeCompensationDelta =
+            activeTotalDelta != 0 ? activeTotalDelta - m_catchUpCompensationDelta : 0;
+
+    const auto minBufferTime = minDesiredBufferTime(m_sinkBufferTime);
+    const auto maxBufferTime = maxDesiredBufferTime(m_sinkBufferTime);
+    const auto sampleCompensationOffset = m_sinkBufferTime / 10;
 
-    if (soundDelay > AudioSinkBufferTime) {
-        const auto targetSoundDelay = (AudioSinkBufferTime + MaxDesiredBufferTime) / 2;
+    if (soundDelay > m_sinkBufferTime) {
+        const auto targetSoundDelay = (m_sinkBufferTime + maxBufferTime) / 2;
         changeRendererTime(soundDelay - targetSoundDelay);
         qCDebug(qLcAudioRenderer) << "Change rendering time: Audio time offset."
                                   << "Prev sound delay:" << soundDelay.count()
@@ -225,25 +294,35 @@ void AudioRenderer::updateSynchronization(const Frame &currentFrame)
         soundDelay = targetSoundDelay;
     }
 
-    constexpr auto AvgDesiredBufferTime = (MinDesiredBufferTime + MaxDesiredBufferTime) / 2;
+    const auto avgBufferTime = (minBufferTime + maxBufferTime) / 2;
 
     std::optional<int> newCompensationSign;
-    if (soundDelay < MinDesiredBufferTime && activeCompensationDelta <= 0)
+    if (soundDelay < minBufferTime && activeCompensationDelta <= 0)
         newCompensationSign = 1;
-    else if (soundDelay > MaxDesiredBufferTime && activeCompensationDelta >= 0)
+    else if (soundDelay > maxBufferTime && activeCompensationDelta >= 0)
         newCompensationSign = -1;
-    else if ((soundDelay <= AvgDesiredBufferTime && activeCompensationDelta < 0)
-             || (soundDelay >= AvgDesiredBufferTime && activeCompensationDelta > 0))
+    else if ((soundDelay <= avgBufferTime && activeCompensationDelta < 0)
+             || (soundDelay >= avgBufferTime && activeCompensationDelta > 0))
         newCompensationSign = 0;
+    else if (catchUpFactor() != m_compensatedCatchUpFactor
+             || (activeTotalDelta == 0 && catchUpFactor() != 1.f))
+        newCompensationSign = 0; // (re)starts catching up with the current factor
 
     // qDebug() << soundDelay.count() << bufferLoadingTime.count();
 
     if (newCompensationSign) {
         const auto target = *newCompensationSign == 0 ? soundDelay
-                : *newCompensationSign > 0 ? MinDesiredBufferTime + SampleCompenationOffset
-                                           : MaxDesiredBufferTime - SampleCompenationOffset;
+                : *newCompensationSign > 0 ? minBufferTime + sampleCompensationOffset
+                                           : maxBufferTime - sampleCompensationOffset;
         const auto delta = m_format.sampleRate() * (target - soundDelay) / 1s;
-        const auto interval = std::abs(delta) / CompensationAngleFactor;
+        auto interval = std::abs(delta) / CompensationAngleFactor;
+
+        // Consumes the factor times more samples than the interval has
+        if (catchUpFactor() != 1.f)
+            interval = std::max<qreal>(interval,
+                                       m_format.sampleRate() * MinCatchUpCompensationTime / 1s);
+        m_catchUpCompensationDelta = static_cast<qint32>(-interval * (catchUpFactor() - 1.));
+        m_compensatedCatchUpFactor = catchUpFactor();
 
         qDebug(qLcAudioRenderer) << "Set audio sample compensation. Delta (samples and us):"
                                  << delta << (target - soundDelay).count()
@@ -251,9 +330,10 @@ void AudioRenderer::updateSynchronization(const Frame &currentFrame)
                                  << "Interval:" << interval
                                  << "SampleRate:" << m_format.sampleRate()
                                  << "Delay(us):" << soundDelay.count()
+                                 << "CatchUpDelta:" << m_catchUpCompensationDelta
                                  << "SamplesProcessed:" << m_resampler->samplesProcessed();
 
-        m_resampler->setSampleCompensation(static_cast<qint32>(delta),
+        m_resampler->setSampleCompensation(static_cast<qint32>(delta) + m_catchUpCompensationDelta,
                                            static_cast<quint32>(interval));
     }
 }
@@ -262,7 +342,7 @@ std::chrono::microseconds AudioRenderer::currentBufferLoadingTime() const
 {
     Q_ASSERT(m_sink);
 
-    return AudioSinkBufferTime * qMax(m_sink->bufferSize() - m_sink->bytesFree(), 0)
+    return m_sinkBufferTime * qMax(m_sink->bufferSize() - m_sink->bytesFree(), 0)
             / m_sink->bufferSize();
 }
 
@@ -33,7 +33,7 @@ class AudioRenderer : public Renderer
 {
     Q_OBJECT
 public:
-    AudioRenderer(const TimeController &tc, QAudioOutput *output);
+    AudioRenderer(const TimeController &tc, QAudioOutput *output, bool lowLatency = false);
 
     void setOutput(QAudioOutput *output);
 
@@ -48,10 +48,14 @@ protected:
 
     void updateOutput(const Codec *codec);
 
+    bool moveOutputToNewDevice();
+
     void initResempler(const Codec *codec);
 
     void onDeviceChanged();
 
+    void connectOutput();
+
     void updateVolume();
 
     void updateSynchronization(const Frame &currentFrame);
@@ -62,12 +66,19 @@ private:
     QPointer<QAudioOutput> m_output;
     std::unique_ptr<QAudioSink> m_sink;
     std::unique_ptr<Resampler> m_resampler;
+    // The codec the resampler converts from; it changes when the next media is spliced in
+    std::optional<Codec> m_resamplerCodec;
     QAudioFormat m_format;
+    const std::chrono::microseconds m_sinkBufferTime;
 
     QAudioBuffer m_bufferedData;
     qsizetype m_bufferWritten = 0;
     QIODevice *m_ioDevice = nullptr;
 
+    // The part of the sample compensation that catches up, and the factor it's for
+    qint32 m_catchUpCompensationDelta = 0;
+    float m_compensatedCatchUpFactor = 1.f;
+
     bool m_deviceChanged = false;
     bool m_drained = false;
 };
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "playbackengine/qffmpegcodec_p.h"
+#include "playbackengine/qffmpegsoftwaredecoding_p.h"
 #include "qloggingcategory.h"
 
 QT_BEGIN_NAMESPACE
@@ -23,7 +24,7 @@ Codec::Data::~Data()
     avcodec_close(context.get());
 }
 
-QMaybe<Codec> Codec::create(AVStream *stream)
+QMaybe<Codec> Codec::create(AVStream *stream, bool lowLatency, int lowres)
 {
     if (!stream)
         return { "Invalid stream" };
@@ -62,10 +63,16 @@ QMaybe<Codec> Codec::create(AVStream *stream)
     // But it would be good to get so we can filter out pixel format we don't support natively
     context->get_format = QFFmpeg::getFormat;
 
+    if (lowLatency)
+        context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+
     /* Init the decoder, with reference counting and threading */
     AVDictionaryHolder opts;
     av_dict_set(opts, "refcounted_frames", "1", 0);
-    av_dict_set(opts, "threads", "auto", 0);
+    if (!hwAccel && context->codec_type == AVMEDIA_TYPE_VIDEO && HWAccel::isSoftwareOnly())
+        setupSoftwareVideoDecoder(context.get(), decoder, lowLatency, lowres);
+    else
+        av_dict_set(opts, "threads", "auto", 0);
 
     ret = avcodec_open2(context.get(), decoder, opts);
     if (ret < 0)
@@ -39,7 +39,9 @@ class Codec
     };
 
 public:
-    static QMaybe<Codec> create(AVStream *);
+    // In low-latency mode, decoders output frames as soon as possible.
+    // Video is decoded with the lowres level only in software-only mode.
+    static QMaybe<Codec> create(AVStream *, bool lowLatency = false, int lowres = 0);
 
     AVCodecContext *context() const { return d->context.get(); }
     AVStream *stream() const { return d->stream; }
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "playbackengine/qffmpegdemuxer_p.h"
+#include "playbackengine/qffmpegkeyframeindex_p.h"
 #include <qloggingcategory.h>
 
 QT_BEGIN_NAMESPACE
@@ -9,6 +10,9 @@ QT_BEGIN_NAMESPACE
 // 4 sec for buffering. TODO: maybe move to env var customization
 static constexpr qint64 MaxBufferingTimeUs = 4'000'000;
 
+// Live streams in low-latency mode are played as they come, there's little to buffer
+static constexpr qint64 LowLatencyMaxBufferingTimeUs = 1'000'000;
+
 // Currently, consider only time. TODO: maybe move to env var customization
 static constexpr qint64 MaxBufferingSize = std::numeric_limits<qint64>::max();
 
@@ -25,8 +29,13 @@ static qint64 streamTimeToUs(const AVStream *stream, qint64 time)
 }
 
 Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-                 const StreamIndexes &streamIndexes, int loops)
-    : m_context(context), m_posWithOffset(posWithOffset), m_loops(loops)
+                 const StreamIndexes &streamIndexes, int loops,
+                 std::shared_ptr<KeyframeIndex> keyframeIndex, bool lowLatency)
+    : m_context(context),
+      m_posWithOffset(posWithOffset),
+      m_maxBufferingTimeUs(lowLatency ? LowLatencyMaxBufferingTimeUs : MaxBufferingTimeUs),
+      m_loops(loops),
+      m_keyframeIndex(std::move(keyframeIndex))
 {
     qCDebug(qLcDemuxer) << "Create demuxer."
                         << "pos:" << posWithOffset.pos << "loop offset:" << posWithOffset.offset.pos
@@ -42,6 +51,24 @@ Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffs
             m_streams[streamIndexes[i]] = { trackType };
         }
     }
+
+    const qint64 startPos = m_posWithOffset.offset.pos + m_posWithOffset.pos;
+    for (auto &[index, data] : m_streams)
+        data.bufferedPosition = startPos;
+    m_bufferedPosition.store(startPos, std::memory_order_relaxed);
+
+    if (m_keyframeIndex) {
+        m_keyframeStream = streamIndexes[QPlatformMediaPlayer::VideoStream] >= 0
+                ? streamIndexes[QPlatformMediaPlayer::VideoStream]
+                : streamIndexes[QPlatformMediaPlayer::AudioStream];
+    }
+}
+
+Demuxer::~Demuxer()
+{
+    // Deleted in its own thread, like all playback engine objects
+    if (m_keyframeIndex)
+        m_keyframeIndex->saveToCache();
 }
 
 void Demuxer::doNextStep()
@@ -55,6 +82,9 @@ void Demuxer::doNextStep()
         const auto loops = m_loops.loadAcquire();
         if (loops >= 0 && m_posWithOffset.offset.index >= loops) {
             qCDebug(qLcDemuxer) << "finish demuxing";
+            m_endOffset = { m_endPts, m_posWithOffset.offset.index };
+            if (m_keyframeIndex)
+                m_keyframeIndex->saveToCache();
             setAtEnd(true);
         } else {
             m_seeked = false;
@@ -80,12 +110,18 @@ void Demuxer::doNextStep()
 
     auto it = m_streams.find(streamIndex);
 
+    if (streamIndex == m_keyframeStream)
+        updateKeyframeIndex(avPacket);
+
     if (it != m_streams.end()) {
         const auto packetEndPos = streamTimeToUs(stream, avPacket.pts + avPacket.duration);
         m_endPts = std::max(m_endPts, m_posWithOffset.offset.pos + packetEndPos);
 
         it->second.bufferingTime += streamTimeToUs(stream, avPacket.duration);
         it->second.bufferingSize += avPacket.size;
+        it->second.bufferedPosition = std::max(it->second.bufferedPosition,
+                                               m_posWithOffset.offset.pos + packetEndPos);
+        updateBufferState();
 
         if (!m_firstPacketFound) {
             m_firstPacketFound = true;
@@ -118,6 +154,8 @@ void Demuxer::onPacketProcessed(Packet packet)
 
         Q_ASSERT(it->second.bufferingTime >= 0);
         Q_ASSERT(it->second.bufferingSize >= 0);
+
+        updateBufferState();
     }
 
     scheduleNextStep();
@@ -128,21 +166,54 @@ bool Demuxer::canDoNextStep() const
     if (!PlaybackEngineObject::canDoNextStep() || isAtEnd() || m_streams.empty())
         return false;
 
-    auto checkBufferingTime = [](const auto &streamIndexToData) {
-        return streamIndexToData.second.bufferingTime < MaxBufferingTimeUs &&
+    auto checkBufferingTime = [this](const auto &streamIndexToData) {
+        return streamIndexToData.second.bufferingTime < m_maxBufferingTimeUs &&
                streamIndexToData.second.bufferingSize < MaxBufferingSize;
     };
 
     return std::all_of(m_streams.begin(), m_streams.end(), checkBufferingTime);
 }
 
+void Demuxer::updateBufferState()
+{
+    if (m_streams.empty())
+        return;
+
+    // Subtitles are sparse, so they neither limit what's buffered nor how full the
+    // buffers are, unless there's nothing else
+    const bool onlySubtitles = std::all_of(m_streams.begin(), m_streams.end(), [](const auto &s) {
+        return s.second.trackType == QPlatformMediaPlayer::SubtitleStream;
+    });
+
+    qint64 bufferedPosition = std::numeric_limits<qint64>::max();
+    float fillLevel = 0.f;
+    for (const auto &[index, data] : m_streams) {
+        if (!onlySubtitles && data.trackType == QPlatformMediaPlayer::SubtitleStream)
+            continue;
+        bufferedPosition = std::min(bufferedPosition, data.bufferedPosition);
+        // canDoNextStep() stops demuxing as soon as any stream is full, so the
+        // fullest stream tells how full the buffers can get
+        fillLevel = std::max(fillLevel, float(data.bufferingTime) / m_maxBufferingTimeUs);
+    }
+
+    m_bufferedPosition.store(bufferedPosition, std::memory_order_relaxed);
+    m_fillLevel.store(fillLevel, std::memory_order_relaxed);
+}
+
 void Demuxer::ensureSeeked()
 {
     if (std::exchange(m_seeked, true))
         return;
 
+    m_lastKeyframeUs.reset();
+
     if ((m_context->ctx_flags & AVFMTCTX_UNSEEKABLE) == 0) {
         const qint64 seekPos = m_posWithOffset.pos * AV_TIME_BASE / 1000000;
+        if (seekWithKeyframeIndex(seekPos)) {
+            setAtEnd(false);
+            return;
+        }
+
         auto err = av_seek_frame(m_context, -1, seekPos, AVSEEK_FLAG_BACKWARD);
 
         if (err < 0) {
@@ -159,6 +230,42 @@ void Demuxer::ensureSeeked()
     setAtEnd(false);
 }
 
+bool Demuxer::seekWithKeyframeIndex(qint64 seekPos)
+{
+    // Seeking to the start is fast anyway
+    if (!m_keyframeIndex || m_keyframeStream < 0 || seekPos <= 0)
+        return false;
+
+    const auto bytePos = m_keyframeIndex->findBytePos(m_keyframeStream, seekPos);
+    if (!bytePos)
+        return false;
+
+    if (av_seek_frame(m_context, -1, *bytePos, AVSEEK_FLAG_BYTE) < 0) {
+        qCDebug(qLcDemuxer) << "Failed to seek to indexed keyframe, pos" << *bytePos;
+        return false;
+    }
+
+    qCDebug(qLcDemuxer) << "Seeked to indexed keyframe, pos" << seekPos << "bytes" << *bytePos;
+    return true;
+}
+
+void Demuxer::updateKeyframeIndex(const AVPacket &packet)
+{
+    const qint64 time = packet.pts != AV_NOPTS_VALUE ? packet.pts : packet.dts;
+    if (time == AV_NOPTS_VALUE || packet.pos < 0) {
+        // we can't tell whether a keyframe is missing from here on
+        m_lastKeyframeUs.reset();
+        return;
+    }
+
+    if (!(packet.flags & AV_PKT_FLAG_KEY))
+        return;
+
+    const qint64 timeUs = streamTimeToUs(m_context->streams[packet.stream_index], time);
+    m_keyframeIndex->addKeyframe(packet.stream_index, timeUs, packet.pos, m_lastKeyframeUs);
+    m_lastKeyframeUs = timeUs;
+}
+
 Demuxer::RequestingSignal Demuxer::signalByTrackType(QPlatformMediaPlayer::TrackType trackType)
 {
     switch (trackType) {
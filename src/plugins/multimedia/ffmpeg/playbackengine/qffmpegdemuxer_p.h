@@ -19,24 +19,43 @@
 #include "playbackengine/qffmpegpacket_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
 
+#include <atomic>
+#include <memory>
+#include <optional>
 #include <unordered_map>
 
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
+class KeyframeIndex;
+
 class Demuxer : public PlaybackEngineObject
 {
     Q_OBJECT
 public:
     Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-            const StreamIndexes &streamIndexes, int loops);
+            const StreamIndexes &streamIndexes, int loops,
+            std::shared_ptr<KeyframeIndex> keyframeIndex = {}, bool lowLatency = false);
+    ~Demuxer() override;
 
     using RequestingSignal = void (Demuxer::*)(Packet);
     static RequestingSignal signalByTrackType(QPlatformMediaPlayer::TrackType trackType);
 
     void setLoops(int loopsCount);
 
+    // Position up to which all streams are demuxed, including the loop offset.
+    // Thread-safe, published whenever a packet is demuxed.
+    qint64 bufferedPosition() const { return m_bufferedPosition.load(std::memory_order_relaxed); }
+
+    // How full the fullest packet buffer is relative to its limit, from 0 to 1.
+    // Thread-safe, published whenever a packet is demuxed or processed.
+    float fillLevel() const { return m_fillLevel.load(std::memory_order_relaxed); }
+
+    // Where media continuing after this one starts on the same timeline.
+    // Valid once the demuxer is at end.
+    LoopOffset endOffset() const { return m_endOffset; }
+
 public slots:
     void onPacketProcessed(Packet);
 
@@ -53,12 +72,20 @@ private:
 
     void ensureSeeked();
 
+    bool seekWithKeyframeIndex(qint64 seekPos);
+
+    void updateKeyframeIndex(const AVPacket &packet);
+
+    void updateBufferState();
+
 private:
     struct StreamData
     {
         QPlatformMediaPlayer::TrackType trackType = QPlatformMediaPlayer::TrackType::NTrackTypes;
         qint64 bufferingTime = 0;
         qint64 bufferingSize = 0;
+        // End of the last demuxed packet, including the loop offset
+        qint64 bufferedPosition = 0;
     };
 
     AVFormatContext *m_context = nullptr;
@@ -66,8 +93,18 @@ private:
     bool m_firstPacketFound = false;
     std::unordered_map<int, StreamData> m_streams;
     PositionWithOffset m_posWithOffset;
+    const qint64 m_maxBufferingTimeUs;
     qint64 m_endPts = 0;
+    LoopOffset m_endOffset;
     QAtomicInt m_loops = QMediaPlayer::Once;
+    std::atomic<qint64> m_bufferedPosition = 0;
+    std::atomic<float> m_fillLevel = 0.f;
+
+    std::shared_ptr<KeyframeIndex> m_keyframeIndex;
+    // The stream whose keyframes are indexed: video if demuxed, audio otherwise
+    int m_keyframeStream = -1;
+    // The last keyframe read since seeking
+    std::optional<qint64> m_lastKeyframeUs;
 };
 
 } // namespace QFFmpeg
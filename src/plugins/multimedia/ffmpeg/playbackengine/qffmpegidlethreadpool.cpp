@@ -0,0 +1,199 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegidlethreadpool_p.h"
+
+#include <QtCore/qabstracteventdispatcher.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcIdleThreadPool, "qt.multimedia.ffmpeg.idlethreadpool");
+
+namespace QFFmpeg {
+
+namespace {
+
+// Enough for all objects of an engine
+constexpr int DefaultMaxIdleThreads = 8;
+constexpr int DefaultIdleTimeoutMs = 5000;
+
+int environmentValue(const char *name, int defaultValue)
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue(name, &ok);
+    return ok && value >= 0 ? value : defaultValue;
+}
+
+std::unique_ptr<QThread> startThread(const QString &name)
+{
+    auto thread = std::make_unique<QThread>();
+    thread->setObjectName(name);
+    thread->start();
+    return thread;
+}
+
+} // namespace
+
+Q_GLOBAL_STATIC(IdleThreadPool, idleThreadPool)
+
+IdleThreadPool::IdleThreadPool()
+    : m_maxIdleThreads(environmentValue("QT_FFMPEG_IDLE_THREADS", DefaultMaxIdleThreads)),
+      m_idleTimeout(environmentValue("QT_FFMPEG_IDLE_THREAD_TIMEOUT_MS", DefaultIdleTimeoutMs))
+{
+    m_expiryTimer.setSingleShot(true);
+    QObject::connect(&m_expiryTimer, &QTimer::timeout, &m_expiryTimer, [this]() {
+        releaseExpired();
+        scheduleExpiry();
+    });
+
+    // The pool may be created on an engine's thread; the timer needs one that lives on
+    if (auto *app = QCoreApplication::instance())
+        m_expiryTimer.moveToThread(app->thread());
+}
+
+IdleThreadPool::~IdleThreadPool()
+{
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (auto &idleThread : m_idleThreads)
+        threads.push_back(std::move(idleThread.thread));
+    stop(std::move(threads));
+}
+
+std::unique_ptr<QThread> IdleThreadPool::acquireThread(const QString &name)
+{
+    auto thread = takeIdleThread();
+    if (!thread)
+        return startThread(name);
+
+    qCDebug(qLcIdleThreadPool) << "Reusing idle thread for" << name;
+    thread->setObjectName(name);
+    return thread;
+}
+
+void IdleThreadPool::releaseThreads(std::vector<std::unique_ptr<QThread>> threads)
+{
+    if (m_maxIdleThreads == 0) {
+        stop(std::move(threads));
+        return;
+    }
+
+    std::vector<std::unique_ptr<QThread>> stoppedThreads;
+    for (auto &thread : threads) {
+        // Killed objects may still use resources of their engine until they're deleted
+        auto *dispatcher = QAbstractEventDispatcher::instance(thread.get());
+        if (dispatcher && thread->isRunning()) {
+            QMetaObject::invokeMethod(dispatcher, []() {}, Qt::BlockingQueuedConnection);
+            addIdleThread(std::move(thread));
+        } else {
+            stoppedThreads.push_back(std::move(thread));
+        }
+    }
+
+    stop(std::move(stoppedThreads));
+    releaseExpired();
+    scheduleExpiry();
+}
+
+size_t IdleThreadPool::idleThreadCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_idleThreads.size();
+}
+
+std::unique_ptr<QThread> IdleThreadPool::acquire(const QString &name)
+{
+    if (idleThreadPool.isDestroyed())
+        return startThread(name);
+    return idleThreadPool->acquireThread(name);
+}
+
+void IdleThreadPool::release(std::vector<std::unique_ptr<QThread>> threads)
+{
+    if (idleThreadPool.isDestroyed())
+        stop(std::move(threads));
+    else
+        idleThreadPool->releaseThreads(std::move(threads));
+}
+
+std::unique_ptr<QThread> IdleThreadPool::takeIdleThread()
+{
+    releaseExpired();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_idleThreads.empty())
+        return nullptr;
+
+    // the most recently used thread is the most likely to be warm
+    auto thread = std::move(m_idleThreads.back().thread);
+    m_idleThreads.pop_back();
+    return thread;
+}
+
+void IdleThreadPool::addIdleThread(std::unique_ptr<QThread> thread)
+{
+    std::unique_ptr<QThread> evictedThread;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_idleThreads.push_back({ std::move(thread), QDeadlineTimer(m_idleTimeout) });
+        if (m_idleThreads.size() > m_maxIdleThreads) {
+            evictedThread = std::move(m_idleThreads.front().thread);
+            m_idleThreads.erase(m_idleThreads.begin());
+        }
+    }
+
+    if (evictedThread) {
+        std::vector<std::unique_ptr<QThread>> threads;
+        threads.push_back(std::move(evictedThread));
+        stop(std::move(threads));
+    }
+}
+
+void IdleThreadPool::releaseExpired()
+{
+    std::vector<std::unique_ptr<QThread>> expiredThreads;
+    {
+        QMutexLocker locker(&m_mutex);
+        // all threads are kept for the same time, so they expire in the order of release
+        auto it = m_idleThreads.begin();
+        for (; it != m_idleThreads.end() && it->expiry.hasExpired(); ++it)
+            expiredThreads.push_back(std::move(it->thread));
+        m_idleThreads.erase(m_idleThreads.begin(), it);
+    }
+
+    if (!expiredThreads.empty()) {
+        qCDebug(qLcIdleThreadPool) << "Stopping" << expiredThreads.size() << "idle threads";
+        stop(std::move(expiredThreads));
+    }
+}
+
+void IdleThreadPool::scheduleExpiry()
+{
+    QMetaObject::invokeMethod(&m_expiryTimer, [this]() {
+        QMutexLocker locker(&m_mutex);
+        if (m_idleThreads.empty()) {
+            m_expiryTimer.stop();
+            return;
+        }
+
+        using namespace std::chrono;
+        const auto remaining = m_idleThreads.front().expiry.remainingTimeAsDuration();
+        m_expiryTimer.start(std::max(ceil<milliseconds>(remaining), milliseconds(0)));
+    });
+}
+
+void IdleThreadPool::stop(std::vector<std::unique_ptr<QThread>> threads)
+{
+    for (auto &thread : threads)
+        thread->quit();
+
+    for (auto &thread : threads)
+        thread->wait();
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
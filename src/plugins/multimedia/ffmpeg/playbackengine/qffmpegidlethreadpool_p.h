@@ -0,0 +1,84 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGIDLETHREADPOOL_P_H
+#define QFFMPEGIDLETHREADPOOL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Threads of playback engine objects, kept running for a while after their engine
+// has freed them, so that the next engines, e.g. of players created one after another,
+// take them over instead of starting threads of their own.
+// Only the threads are pooled. The engine objects living in them, their codec contexts
+// and audio sinks are still created per engine.
+// QT_FFMPEG_IDLE_THREADS caps the number of idle threads (8 by default; 0 disables
+// the pool), QT_FFMPEG_IDLE_THREAD_TIMEOUT_MS is how long they're kept (5 s by default).
+// Both are read when the pool is created.
+class IdleThreadPool
+{
+public:
+    IdleThreadPool();
+    ~IdleThreadPool();
+
+    // Returns a running thread, an idle one if there is any
+    std::unique_ptr<QThread> acquireThread(const QString &name);
+
+    // Takes threads no objects live in anymore. Returns after the objects deleted
+    // with deleteLater have been deleted, like stopping the threads would.
+    void releaseThreads(std::vector<std::unique_ptr<QThread>> threads);
+
+    size_t idleThreadCount() const;
+
+    // Use the pool of the process
+    static std::unique_ptr<QThread> acquire(const QString &name);
+    static void release(std::vector<std::unique_ptr<QThread>> threads);
+
+private:
+    std::unique_ptr<QThread> takeIdleThread();
+    void addIdleThread(std::unique_ptr<QThread> thread);
+    void releaseExpired();
+    void scheduleExpiry();
+
+    static void stop(std::vector<std::unique_ptr<QThread>> threads);
+
+    struct IdleThread
+    {
+        std::unique_ptr<QThread> thread;
+        QDeadlineTimer expiry;
+    };
+
+    const size_t m_maxIdleThreads;
+    const std::chrono::milliseconds m_idleTimeout;
+
+    mutable QMutex m_mutex;
+    std::vector<IdleThread> m_idleThreads; // the most recently released last
+    QTimer m_expiryTimer;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGIDLETHREADPOOL_P_H
@@ -0,0 +1,391 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegiodeviceinput_p.h"
+#include "playbackengine/qffmpegmediadataholder_p.h"
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <cstring>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcIODeviceInput, "qt.multimedia.ffmpeg.iodeviceinput");
+
+namespace QFFmpeg {
+
+namespace {
+
+constexpr qsizetype DefaultReadAheadSize = 4 * 1024 * 1024;
+constexpr qint64 ChunkSize = 64 * 1024;
+constexpr int MinAvioBufferSize = 32 * 1024;
+constexpr int MaxAvioBufferSize = 256 * 1024;
+// How often waiting callbacks check the cancel token
+constexpr unsigned long WaitIntervalMs = 50;
+// How long to wait for a device that has no data yet
+constexpr unsigned long RetryIntervalMs = 10;
+// How long to wait for the reading thread when destroyed before warning about it
+constexpr unsigned long StopTimeoutMs = 500;
+
+qsizetype readAheadSize(const QIODevice *device)
+{
+    // the data of in-memory devices is there already
+    if (qobject_cast<const QBuffer *>(device))
+        return 0;
+
+    bool ok = false;
+    const int size = qEnvironmentVariableIntValue("QT_FFMPEG_READ_AHEAD_SIZE", &ok);
+    if (!ok)
+        return DefaultReadAheadSize;
+    return size > 0 ? qMax<qsizetype>(size, ChunkSize * 2) : 0;
+}
+
+int avioBufferSize(qint64 deviceSize, bool readAhead)
+{
+    // reading the device directly, larger buffers only make each read stall longer
+    if (!readAhead)
+        return MinAvioBufferSize;
+    // seeks out of the AVIO buffer drop it, so smaller media get smaller buffers
+    if (deviceSize <= 0)
+        return MaxAvioBufferSize;
+    return int(qBound<qint64>(MinAvioBufferSize, deviceSize / 256, MaxAvioBufferSize));
+}
+
+int readDevice(void *opaque, uint8_t *buf, int bufSize)
+{
+    auto *dev = static_cast<QIODevice *>(opaque);
+    if (dev->atEnd())
+        return AVERROR_EOF;
+    return dev->read(reinterpret_cast<char *>(buf), bufSize);
+}
+
+int64_t seekDevice(void *opaque, int64_t offset, int whence)
+{
+    QIODevice *dev = static_cast<QIODevice *>(opaque);
+
+    if (dev->isSequential())
+        return AVERROR(EINVAL);
+
+    if (whence & AVSEEK_SIZE)
+        return dev->size();
+
+    whence &= ~AVSEEK_FORCE;
+
+    if (whence == SEEK_CUR)
+        offset += dev->pos();
+    else if (whence == SEEK_END)
+        offset += dev->size();
+
+    if (!dev->seek(offset))
+        return AVERROR(EINVAL);
+    return offset;
+}
+
+} // namespace
+
+class IODeviceInput::ReadAhead
+{
+public:
+    ReadAhead(QIODevice *device, const std::shared_ptr<ICancelToken> &cancelToken,
+              qsizetype size);
+
+    // AVIO callbacks
+    int read(uint8_t *buf, int bufSize);
+    int64_t seek(int64_t offset, int whence);
+
+    // The reading thread
+    void run();
+
+    // Makes the reading thread finish, once the device returns if it is reading
+    void stop();
+
+private:
+    // How much to read from the device, 0 if it has no data yet
+    qint64 sizeToRead(qint64 maxSize) const;
+    void append(const char *data, qint64 size);
+
+    bool isCancelled() const { return m_cancelToken && m_cancelToken->isCancelled(); }
+
+    QIODevice *const m_device;
+    const std::shared_ptr<ICancelToken> m_cancelToken;
+
+    // Everything below is guarded by m_mutex
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    QByteArray m_buffer;
+    // The buffer keeps the device data in [m_start, m_end); m_pos is where AVIO reads
+    qint64 m_start = 0;
+    qint64 m_end = 0;
+    qint64 m_pos = 0;
+    qint64 m_size = -1;
+    bool m_sequential = false;
+    bool m_atEnd = false;
+    bool m_error = false;
+    // Pending seek of the device, done by the reading thread
+    qint64 m_seekTarget = -1;
+    // Changes with every seek of the device; data read before is dropped
+    quint64 m_generation = 0;
+    bool m_stop = false;
+    bool m_finished = false;
+};
+
+IODeviceInput::ReadAhead::ReadAhead(QIODevice *device,
+                                    const std::shared_ptr<ICancelToken> &cancelToken,
+                                    qsizetype size)
+    : m_device(device), m_cancelToken(cancelToken), m_buffer(size, Qt::Uninitialized)
+{
+    m_sequential = device->isSequential();
+    m_size = m_sequential ? -1 : device->size();
+    m_start = m_end = m_pos = m_sequential ? 0 : device->pos();
+}
+
+int IODeviceInput::ReadAhead::read(uint8_t *buf, int bufSize)
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (m_pos >= m_end && !m_atEnd && !m_error) {
+        if (isCancelled())
+            return AVERROR_EXIT;
+        m_condition.wait(&m_mutex, WaitIntervalMs);
+    }
+
+    if (m_pos >= m_end)
+        return m_error ? AVERROR(EIO) : AVERROR_EOF;
+
+    const qint64 capacity = m_buffer.size();
+    const qint64 size = qMin<qint64>(bufSize, m_end - m_pos);
+    for (qint64 copied = 0; copied < size;) {
+        const qint64 offset = (m_pos + copied) % capacity;
+        const qint64 n = qMin(size - copied, capacity - offset);
+        std::memcpy(buf + copied, m_buffer.constData() + offset, n);
+        copied += n;
+    }
+
+    m_pos += size;
+    // there's room for more data now
+    m_condition.wakeAll();
+    return int(size);
+}
+
+int64_t IODeviceInput::ReadAhead::seek(int64_t offset, int whence)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (whence & AVSEEK_SIZE)
+        return m_size >= 0 ? m_size : AVERROR(EINVAL);
+
+    whence &= ~AVSEEK_FORCE;
+
+    if (whence == SEEK_CUR) {
+        offset += m_pos;
+    } else if (whence == SEEK_END) {
+        if (m_size < 0)
+            return AVERROR(EINVAL);
+        offset += m_size;
+    }
+
+    if (offset < 0)
+        return AVERROR(EINVAL);
+
+    // the data is still in the buffer, which also works for sequential devices
+    if (offset >= m_start && offset <= m_end) {
+        m_pos = offset;
+        m_condition.wakeAll();
+        return offset;
+    }
+
+    if (m_sequential)
+        return AVERROR(EINVAL);
+
+    qCDebug(qLcIODeviceInput) << "Seeking device to" << offset;
+
+    ++m_generation;
+    m_start = m_end = m_pos = offset;
+    m_atEnd = m_error = false;
+    m_seekTarget = offset;
+    m_condition.wakeAll();
+
+    while (m_seekTarget >= 0 && !m_finished) {
+        if (isCancelled())
+            return AVERROR_EXIT;
+        m_condition.wait(&m_mutex, WaitIntervalMs);
+    }
+
+    return m_error || m_finished ? AVERROR(EINVAL) : offset;
+}
+
+void IODeviceInput::ReadAhead::stop()
+{
+    QMutexLocker locker(&m_mutex);
+    m_stop = true;
+    m_condition.wakeAll();
+}
+
+qint64 IODeviceInput::ReadAhead::sizeToRead(qint64 maxSize) const
+{
+    if (!m_sequential)
+        return maxSize;
+
+    // Don't ask sequential devices for more than they have, so that the read returns
+    // as soon as possible if they block until they have it. Without any data, only
+    // devices that can't wait for it are read, so that the thread doesn't block in
+    // reading and notices being stopped or cancelled after the wait.
+    qint64 available = m_device->bytesAvailable();
+    if (available <= 0) {
+        QElapsedTimer timer;
+        timer.start();
+        if (m_device->waitForReadyRead(int(WaitIntervalMs)))
+            available = m_device->bytesAvailable();
+        else if (timer.elapsed() >= qint64(WaitIntervalMs / 2))
+            return 0;
+    }
+    return available > 0 ? qMin(maxSize, available) : maxSize;
+}
+
+void IODeviceInput::ReadAhead::run()
+{
+    // keep some of the data already read for the demuxer seeking back a bit
+    const qint64 capacity = m_buffer.size();
+    const qint64 aheadLimit = capacity - capacity / 4;
+    QByteArray chunk(ChunkSize, Qt::Uninitialized);
+
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_stop && !isCancelled()) {
+        if (m_seekTarget >= 0) {
+            // the reading side waits for the seek, so no other one can come in meanwhile
+            const qint64 target = m_seekTarget;
+            locker.unlock();
+            const bool seeked = m_device->seek(target);
+            locker.relock();
+
+            if (m_stop)
+                break;
+            if (!seeked)
+                qCWarning(qLcIODeviceInput) << "Cannot seek" << m_device << "to" << target;
+            m_error = !seeked;
+            m_seekTarget = -1;
+            m_condition.wakeAll();
+            continue;
+        }
+
+        const qint64 room = aheadLimit - (m_end - m_pos);
+        if (m_atEnd || m_error || room <= 0) {
+            // wake up now and then to notice cancellation
+            m_condition.wait(&m_mutex, WaitIntervalMs);
+            continue;
+        }
+
+        const quint64 generation = m_generation;
+        locker.unlock();
+        const bool atEnd = m_device->atEnd();
+        const qint64 toRead = atEnd ? 0 : sizeToRead(qMin(room, ChunkSize));
+        const qint64 bytesRead = toRead > 0 ? m_device->read(chunk.data(), toRead) : 0;
+        const qint64 size = m_sequential ? -1 : m_device->size();
+        locker.relock();
+
+        // the object reading the data is being destroyed
+        if (m_stop)
+            break;
+
+        // a seek came in, the data belongs to the previous position
+        if (generation != m_generation)
+            continue;
+
+        m_size = size;
+
+        if (atEnd) {
+            m_atEnd = true;
+        } else if (bytesRead < 0) {
+            qCWarning(qLcIODeviceInput) << "Cannot read" << m_device << m_device->errorString();
+            m_error = true;
+        } else if (bytesRead == 0) {
+            // no data available yet
+            m_condition.wait(&m_mutex, RetryIntervalMs);
+            continue;
+        } else {
+            append(chunk.constData(), bytesRead);
+        }
+
+        m_condition.wakeAll();
+    }
+
+    m_finished = true;
+    m_condition.wakeAll();
+}
+
+void IODeviceInput::ReadAhead::append(const char *data, qint64 size)
+{
+    const qint64 capacity = m_buffer.size();
+    for (qint64 written = 0; written < size;) {
+        const qint64 offset = (m_end + written) % capacity;
+        const qint64 n = qMin(size - written, capacity - offset);
+        std::memcpy(m_buffer.data() + offset, data + written, n);
+        written += n;
+    }
+
+    m_end += size;
+    // the oldest data has been overwritten
+    m_start = qMax(m_start, m_end - capacity);
+}
+
+IODeviceInput::IODeviceInput(QIODevice *device, const std::shared_ptr<ICancelToken> &cancelToken)
+{
+    Q_ASSERT(device && device->isOpen());
+
+    const qsizetype readAhead = readAheadSize(device);
+    const int bufferSize =
+            avioBufferSize(device->isSequential() ? -1 : device->size(), readAhead > 0);
+    auto *buffer = static_cast<unsigned char *>(av_malloc(bufferSize));
+
+    qCDebug(qLcIODeviceInput) << "Reading" << device << "with read-ahead buffer of" << readAhead
+                              << "bytes, AVIO buffer of" << bufferSize << "bytes";
+
+    if (readAhead == 0) {
+        m_avioContext = avio_alloc_context(buffer, bufferSize, false, device, &readDevice,
+                                           nullptr, &seekDevice);
+        return;
+    }
+
+    m_readAhead = std::make_unique<ReadAhead>(device, cancelToken, readAhead);
+    m_avioContext = avio_alloc_context(
+            buffer, bufferSize, false, m_readAhead.get(),
+            [](void *opaque, uint8_t *buf, int bufSize) {
+                return static_cast<ReadAhead *>(opaque)->read(buf, bufSize);
+            },
+            nullptr,
+            [](void *opaque, int64_t offset, int whence) {
+                return static_cast<ReadAhead *>(opaque)->seek(offset, whence);
+            });
+
+    m_thread.reset(QThread::create([readAhead = m_readAhead.get()] { readAhead->run(); }));
+    m_thread->setObjectName(QStringLiteral("IODeviceReadAhead"));
+    m_thread->start();
+}
+
+IODeviceInput::~IODeviceInput()
+{
+    if (m_thread) {
+        m_readAhead->stop();
+        if (!m_thread->wait(StopTimeoutMs)) {
+            qCWarning(qLcIODeviceInput) << "Waiting for the device to return from reading";
+            m_thread->wait();
+        }
+    }
+
+    if (m_avioContext) {
+        av_freep(&m_avioContext->buffer);
+        avio_context_free(&m_avioContext);
+    }
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,65 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGIODEVICEINPUT_P_H
+#define QFFMPEGIODEVICEINPUT_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QIODevice;
+class QThread;
+
+namespace QFFmpeg {
+
+struct ICancelToken;
+
+// The AVIO context of media read from a QIODevice.
+// Unless disabled, the device is read ahead into a ring buffer on a thread of its own,
+// so that slow devices don't stall the demuxer for every read. Seeks within the
+// buffer, which keeps some of the data already read, don't touch the device; others
+// make the thread continue reading at the new position.
+// QT_FFMPEG_READ_AHEAD_SIZE sets the size of the buffer in bytes; 0 disables it,
+// and the demuxer reads the device directly.
+// Reading stops when the cancel token is cancelled.
+class IODeviceInput
+{
+public:
+    // The device must be open, and outlive this object. The destructor waits for the
+    // reading thread, and so for a read of the device in progress to return.
+    // Sequential devices without data are waited for with waitForReadyRead() rather
+    // than read, so that for devices supporting it the thread doesn't block beyond
+    // that, and the destructor returns soon after the cancel token is cancelled.
+    IODeviceInput(QIODevice *device, const std::shared_ptr<ICancelToken> &cancelToken);
+    ~IODeviceInput();
+
+    AVIOContext *avioContext() const { return m_avioContext; }
+
+private:
+    // The ring buffer and the state of the reading thread
+    class ReadAhead;
+
+    std::unique_ptr<ReadAhead> m_readAhead;
+    AVIOContext *m_avioContext = nullptr;
+    std::unique_ptr<QThread> m_thread;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGIODEVICEINPUT_P_H
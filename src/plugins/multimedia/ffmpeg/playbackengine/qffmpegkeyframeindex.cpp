@@ -0,0 +1,129 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+#include "playbackengine/qffmpegprobecache_p.h"
+
+#include <QtCore/qdatastream.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+KeyframeIndex::KeyframeIndex(const QString &filePath) : m_filePath(filePath)
+{
+    if (m_filePath.isEmpty())
+        return;
+    if (auto *cache = ProbeCache::instance())
+        cache->restoreKeyframeIndex(m_filePath, *this);
+}
+
+bool KeyframeIndex::isUseful(const AVFormatContext *context)
+{
+    if ((context->ctx_flags & AVFMTCTX_UNSEEKABLE) || !context->iformat
+        || (context->iformat->flags & AVFMT_NO_BYTE_SEEK))
+        return false;
+
+    const QLatin1StringView names(context->iformat->name);
+    for (const auto name : names.tokenize(QLatin1Char(','))) {
+        // Streams without any index
+        if (name == QLatin1StringView("mpegts") || name == QLatin1StringView("mpeg"))
+            return true;
+
+        // Cues and idx1 chunks are optional, and read while opening if there are any
+        if (name == QLatin1StringView("matroska") || name == QLatin1StringView("avi")) {
+            for (unsigned int i = 0; i < context->nb_streams; ++i) {
+                if (avformat_index_get_entries_count(context->streams[i]) > 0)
+                    return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void KeyframeIndex::saveToCache()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_modified || m_filePath.isEmpty())
+            return;
+        m_modified = false;
+    }
+    if (auto *cache = ProbeCache::instance())
+        cache->storeKeyframeIndex(m_filePath, *this);
+}
+
+void KeyframeIndex::addKeyframe(int streamIndex, qint64 timeUs, qint64 bytePos,
+                                std::optional<qint64> previousTimeUs)
+{
+    QMutexLocker locker(&m_mutex);
+    auto &keyframes = m_streams[streamIndex];
+    auto [it, inserted] = keyframes.try_emplace(timeUs, Keyframe{ bytePos });
+    m_modified |= inserted;
+
+    if (!previousTimeUs || *previousTimeUs >= timeUs || it == keyframes.begin())
+        return;
+
+    auto previous = std::prev(it);
+    if (previous->first == *previousTimeUs && !previous->second.adjacentToNext) {
+        previous->second.adjacentToNext = true;
+        m_modified = true;
+    }
+}
+
+std::optional<qint64> KeyframeIndex::findBytePos(int streamIndex, qint64 timeUs) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto streamIt = m_streams.find(streamIndex);
+    if (streamIt == m_streams.end())
+        return {};
+
+    const auto &keyframes = streamIt->second;
+    auto it = keyframes.upper_bound(timeUs);
+    if (it == keyframes.begin())
+        return {};
+    --it;
+    // an exact match needs no neighbour; otherwise the next keyframe is beyond timeUs
+    if (it->first != timeUs && !it->second.adjacentToNext)
+        return {};
+    return it->second.bytePos;
+}
+
+void KeyframeIndex::save(QDataStream &stream) const
+{
+    QMutexLocker locker(&m_mutex);
+    stream << quint32(m_streams.size());
+    for (const auto &[streamIndex, keyframes] : m_streams) {
+        stream << qint32(streamIndex) << quint32(keyframes.size());
+        for (const auto &[timeUs, keyframe] : keyframes)
+            stream << timeUs << keyframe.bytePos << keyframe.adjacentToNext;
+    }
+}
+
+void KeyframeIndex::load(QDataStream &stream)
+{
+    QMutexLocker locker(&m_mutex);
+    m_streams.clear();
+    quint32 streamCount = 0;
+    stream >> streamCount;
+    for (quint32 i = 0; i < streamCount && stream.status() == QDataStream::Ok; ++i) {
+        qint32 streamIndex = -1;
+        quint32 count = 0;
+        stream >> streamIndex >> count;
+        auto &keyframes = m_streams[streamIndex];
+        for (quint32 j = 0; j < count && stream.status() == QDataStream::Ok; ++j) {
+            qint64 timeUs = 0;
+            Keyframe keyframe;
+            stream >> timeUs >> keyframe.bytePos >> keyframe.adjacentToNext;
+            keyframes.emplace_hint(keyframes.end(), timeUs, keyframe);
+        }
+    }
+    if (stream.status() != QDataStream::Ok)
+        m_streams.clear();
+    m_modified = false;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
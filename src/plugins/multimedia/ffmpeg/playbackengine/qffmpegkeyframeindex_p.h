@@ -0,0 +1,85 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGKEYFRAMEINDEX_P_H
+#define QFFMPEGKEYFRAMEINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qmutex.h>
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+QT_BEGIN_NAMESPACE
+
+class QDataStream;
+
+namespace QFFmpeg {
+
+// Positions of keyframes in the file, collected by the demuxer while playing.
+// Containers like MPEG-TS, Matroska without cues, or AVI without an idx1 chunk,
+// have no index of their own, and FFmpeg has to bisect or read through the file
+// to seek in them. Once the demuxer has read past a position, the index gives the
+// keyframe to start from, which can be seeked to directly by its byte position.
+// Thread-safe; shared by all demuxers of the same media. The demuxers save it to
+// the probe cache from their thread, so that no other thread waits for the disk.
+class KeyframeIndex
+{
+public:
+    // If filePath is set, the index is restored from the probe cache
+    explicit KeyframeIndex(const QString &filePath = {});
+
+    // Whether seeking in the container benefits from an index, as it has none
+    // of its own. Call after avformat_open_input.
+    static bool isUseful(const AVFormatContext *context);
+
+    // Writes the index to the probe cache if keyframes were added since it was
+    // restored or last saved, and a file path is set
+    void saveToCache();
+
+    // Adds a keyframe found at timeUs. previousTimeUs is the keyframe the demuxer read
+    // before without seeking in between, meaning that there's none between the two.
+    void addKeyframe(int streamIndex, qint64 timeUs, qint64 bytePos,
+                     std::optional<qint64> previousTimeUs);
+
+    // Returns the byte position of the last keyframe at or before timeUs, if it is
+    // known that there are no other keyframes between the two
+    std::optional<qint64> findBytePos(int streamIndex, qint64 timeUs) const;
+
+    void save(QDataStream &stream) const;
+    void load(QDataStream &stream);
+
+private:
+    struct Keyframe
+    {
+        qint64 bytePos = -1;
+        // there's no keyframe between this one and the next one in the index
+        bool adjacentToNext = false;
+    };
+
+    using Keyframes = std::map<qint64, Keyframe>;
+
+    mutable QMutex m_mutex;
+    std::unordered_map<int, Keyframes> m_streams;
+    QString m_filePath;
+    bool m_modified = false;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGKEYFRAMEINDEX_P_H
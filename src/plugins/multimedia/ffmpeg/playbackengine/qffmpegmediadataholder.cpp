@@ -2,9 +2,14 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "playbackengine/qffmpegmediadataholder_p.h"
+#include "playbackengine/qffmpegiodeviceinput_p.h"
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+#include "playbackengine/qffmpegprobecache_p.h"
+#include "playbackengine/qffmpegsoftwaredecoding_p.h"
 
 #include "qffmpegmediametadata_p.h"
 #include "qffmpegmediaformatinfo_p.h"
+#include "qffmpeghwaccel_p.h"
 #include "qiodevice.h"
 #include "qdatetime.h"
 #include "qloggingcategory.h"
@@ -107,36 +112,6 @@ static void insertMediaData(QMediaMetaData &metaData, QPlatformMediaPlayer::Trac
     }
 };
 
-static int readQIODevice(void *opaque, uint8_t *buf, int buf_size)
-{
-    auto *dev = static_cast<QIODevice *>(opaque);
-    if (dev->atEnd())
-        return AVERROR_EOF;
-    return dev->read(reinterpret_cast<char *>(buf), buf_size);
-}
-
-static int64_t seekQIODevice(void *opaque, int64_t offset, int whence)
-{
-    QIODevice *dev = static_cast<QIODevice *>(opaque);
-
-    if (dev->isSequential())
-        return AVERROR(EINVAL);
-
-    if (whence & AVSEEK_SIZE)
-        return dev->size();
-
-    whence &= ~AVSEEK_FORCE;
-
-    if (whence == SEEK_CUR)
-        offset += dev->pos();
-    else if (whence == SEEK_END)
-        offset += dev->size();
-
-    if (!dev->seek(offset))
-        return AVERROR(EINVAL);
-    return offset;
-}
-
 QPlatformMediaPlayer::TrackType MediaDataHolder::trackTypeFromMediaType(int mediaType)
 {
     switch (mediaType) {
@@ -152,8 +127,118 @@ QPlatformMediaPlayer::TrackType MediaDataHolder::trackTypeFromMediaType(int medi
 }
 
 namespace {
+
+// Fast start trades some robustness for a shorter time to the first frame: the
+// container is probed with smaller limits, and the stream info pass, which
+// decodes the beginning of every stream, is skipped if the header already gave
+// us what playback needs, or else stopped early. Opt-in with QT_FFMPEG_FAST_OPEN,
+// which is read whenever a source is loaded, so applications can also set it with
+// qputenv(); QT_FFMPEG_PROBESIZE and QT_FFMPEG_ANALYZEDURATION_US override the
+// limits in either mode.
+bool fastOpenEnabled()
+{
+    return qEnvironmentVariableIntValue("QT_FFMPEG_FAST_OPEN") != 0;
+}
+
+void setProbeLimits(AVDictionaryHolder &dict, bool lowLatency)
+{
+    constexpr auto FastProbeSize = "1048576";
+    constexpr auto FastAnalyzeDurationUs = "1000000";
+    // Whatever live streams are probed for is shown late
+    constexpr auto LowLatencyProbeSize = "524288";
+    constexpr auto LowLatencyAnalyzeDurationUs = "500000";
+    // The stream info pass keeps reading up to 20 frames per video stream to
+    // estimate the frame rate after everything else is known. A few frames are
+    // enough to get it from the timestamps.
+    constexpr auto FastFpsProbeFrames = "5";
+
+    const QByteArray probeSize = qgetenv("QT_FFMPEG_PROBESIZE");
+    if (!probeSize.isEmpty())
+        av_dict_set(dict, "probesize", probeSize.constData(), 0);
+    else if (lowLatency)
+        av_dict_set(dict, "probesize", LowLatencyProbeSize, 0);
+    else if (fastOpenEnabled())
+        av_dict_set(dict, "probesize", FastProbeSize, 0);
+
+    const QByteArray analyzeDuration = qgetenv("QT_FFMPEG_ANALYZEDURATION_US");
+    if (!analyzeDuration.isEmpty())
+        av_dict_set(dict, "analyzeduration", analyzeDuration.constData(), 0);
+    else if (lowLatency)
+        av_dict_set(dict, "analyzeduration", LowLatencyAnalyzeDurationUs, 0);
+    else if (fastOpenEnabled())
+        av_dict_set(dict, "analyzeduration", FastAnalyzeDurationUs, 0);
+
+    if (lowLatency || fastOpenEnabled())
+        av_dict_set(dict, "fpsprobesize", FastFpsProbeFrames, 0);
+}
+
+// Some decoders only know their sample format once they're opened, which is
+// cheap compared to decoding packets as avformat_find_stream_info does.
+bool completeAudioParameters(AVCodecParameters *codecpar)
+{
+    const AVCodec *decoder = avcodec_find_decoder(codecpar->codec_id);
+    if (!decoder)
+        return false;
+    AVCodecContextUPtr codecContext(avcodec_alloc_context3(decoder));
+    if (!codecContext || avcodec_parameters_to_context(codecContext.get(), codecpar) < 0
+        || avcodec_open2(codecContext.get(), decoder, nullptr) < 0)
+        return false;
+    if (codecContext->sample_fmt == AV_SAMPLE_FMT_NONE)
+        return false;
+    codecpar->format = codecContext->sample_fmt;
+    return true;
+}
+
+bool hasCompleteParameters(AVStream *stream)
+{
+    auto *codecpar = stream->codecpar;
+    if (codecpar->codec_id == AV_CODEC_ID_NONE)
+        return false;
+
+    switch (codecpar->codec_type) {
+    case AVMEDIA_TYPE_VIDEO:
+        return codecpar->width > 0 && codecpar->height > 0;
+    case AVMEDIA_TYPE_AUDIO: {
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+        const int channels = codecpar->channels;
+#else
+        const int channels = codecpar->ch_layout.nb_channels;
+#endif
+        if (codecpar->sample_rate <= 0 || channels <= 0)
+            return false;
+        // the resampler is set up from the stream parameters
+        return codecpar->format >= 0 || completeAudioParameters(codecpar);
+    }
+    default:
+        // not needed for playback to start, or selected later on
+        return true;
+    }
+}
+
+// Containers with a global header, like MP4 with its moov atom, describe all
+// streams up front, so probing packets only repeats what we already know.
+// Headerless ones like MPEG-TS announce streams in packets, and need packets to
+// fill in the video size and the duration; they get the shortened stream info
+// pass set up in setProbeLimits() instead.
+bool canSkipStreamInfo(const AVFormatContext *context)
+{
+    if (!fastOpenEnabled())
+        return false;
+    if (context->ctx_flags & AVFMTCTX_NOHEADER)
+        return false;
+    // otherwise the duration is estimated while probing
+    if (context->duration == AV_NOPTS_VALUE || context->nb_streams == 0)
+        return false;
+    for (unsigned int i = 0; i < context->nb_streams; ++i) {
+        if (!hasCompleteParameters(context->streams[i]))
+            return false;
+    }
+    return true;
+}
+
 QMaybe<AVFormatContextUPtr, MediaDataHolder::ContextError>
-loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancelToken> &cancelToken)
+loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancelToken> &cancelToken,
+          std::unique_ptr<IODeviceInput> &ioInput, bool lowLatency)
 {
     const QByteArray url = mediaUrl.toString(QUrl::PreferLocalFile).toUtf8();
 
@@ -169,15 +254,18 @@ loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancel
         if (!stream->isSequential())
             stream->seek(0);
 
-        constexpr int bufferSize = 32768;
-        unsigned char *buffer = (unsigned char *)av_malloc(bufferSize);
-        context->pb = avio_alloc_context(buffer, bufferSize, false, stream, &readQIODevice, nullptr,
-                                         &seekQIODevice);
+        ioInput = std::make_unique<IODeviceInput>(stream, cancelToken);
+        context->pb = ioInput->avioContext();
     }
 
     AVDictionaryHolder dict;
     constexpr auto NetworkTimeoutUs = "5000000";
     av_dict_set(dict, "timeout", NetworkTimeoutUs, 0);
+    setProbeLimits(dict, lowLatency);
+
+    // Packets are passed on as they're read, rather than buffered while probing
+    if (lowLatency)
+        av_dict_set(dict, "fflags", "+nobuffer", 0);
 
     context->interrupt_callback.opaque = cancelToken.get();
     context->interrupt_callback.callback = [](void *opaque) {
@@ -204,12 +292,24 @@ loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancel
         return MediaDataHolder::ContextError{ code, QMediaPlayer::tr("Could not open file") };
     }
 
-    ret = avformat_find_stream_info(context.get(), nullptr);
-    if (ret < 0) {
-        return MediaDataHolder::ContextError{
-            QMediaPlayer::FormatError,
-            QMediaPlayer::tr("Could not find stream information for media file")
-        };
+    const QString localFile =
+            !stream && mediaUrl.isLocalFile() ? mediaUrl.toLocalFile() : QString();
+    const ProbeCache *probeCache = localFile.isEmpty() ? nullptr : ProbeCache::instance();
+
+    if (probeCache && probeCache->restore(localFile, context.get())) {
+        // nothing to probe
+    } else if (canSkipStreamInfo(context.get())) {
+        qCDebug(qLcMediaDataHolder) << "Skipping stream info probing for" << mediaUrl;
+    } else {
+        ret = avformat_find_stream_info(context.get(), nullptr);
+        if (ret < 0) {
+            return MediaDataHolder::ContextError{
+                QMediaPlayer::FormatError,
+                QMediaPlayer::tr("Could not find stream information for media file")
+            };
+        }
+        if (probeCache)
+            probeCache->store(localFile, context.get());
     }
 
 #ifndef QT_NO_DEBUG
@@ -220,12 +320,29 @@ loadMedia(const QUrl &mediaUrl, QIODevice *stream, const std::shared_ptr<ICancel
 } // namespace
 
 MediaDataHolder::Maybe MediaDataHolder::create(const QUrl &url, QIODevice *stream,
-                                               const std::shared_ptr<ICancelToken> &cancelToken)
+                                               const std::shared_ptr<ICancelToken> &cancelToken,
+                                               bool lowLatency)
 {
-    QMaybe context = loadMedia(url, stream, cancelToken);
+    // Like the other variables, read per source, before any codec is looked up
+    HWAccel::setSoftwareOnlyFromEnvironment();
+
+    std::unique_ptr<IODeviceInput> ioInput;
+    QMaybe context = loadMedia(url, stream, cancelToken, ioInput, lowLatency);
     if (context) {
         // MediaDataHolder is wrapped in a shared pointer to interop with signal/slot mechanism
-        return QSharedPointer<MediaDataHolder>{ new MediaDataHolder{ std::move(context.value()), cancelToken } };
+        QSharedPointer<MediaDataHolder> holder{ new MediaDataHolder{ std::move(context.value()),
+                                                                     cancelToken } };
+        holder->m_ioInput = std::move(ioInput);
+        holder->m_lowLatency = lowLatency;
+        // Read per source as well, so that it applies to the sources that are loaded
+        // while it is set, e.g. for thumbnails
+        if (HWAccel::isSoftwareOnly())
+            holder->m_requestedLowres = requestedDecodingLowres();
+        if (KeyframeIndex::isUseful(holder->m_context.get())) {
+            const QString localFile = !stream && url.isLocalFile() ? url.toLocalFile() : QString();
+            holder->m_keyframeIndex = std::make_shared<KeyframeIndex>(localFile);
+        }
+        return holder;
     }
     return context.error();
 }
@@ -331,6 +448,17 @@ bool MediaDataHolder::setActiveTrack(QPlatformMediaPlayer::TrackType type, int s
     return true;
 }
 
+int MediaDataHolder::decodingLowres() const
+{
+    const int streamIndex = currentStreamIndex(QPlatformMediaPlayer::VideoStream);
+    if (m_requestedLowres <= 0 || streamIndex < 0)
+        return 0;
+
+    // The decoder Codec::create() picks in software-only mode
+    const auto *decoder = findAVDecoder(m_context->streams[streamIndex]->codecpar->codec_id);
+    return decoder ? supportedLowres(decoder, m_requestedLowres) : 0;
+}
+
 int MediaDataHolder::activeTrack(QPlatformMediaPlayer::TrackType type) const
 {
     return type < QPlatformMediaPlayer::NTrackTypes ? m_requestedStreams[type] : -1;
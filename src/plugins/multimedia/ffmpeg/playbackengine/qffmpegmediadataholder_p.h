@@ -22,12 +22,16 @@
 #include <private/qmultimediautils_p.h>
 
 #include <array>
+#include <memory>
 #include <optional>
 
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
+class IODeviceInput;
+class KeyframeIndex;
+
 struct ICancelToken
 {
     virtual ~ICancelToken() = default;
@@ -76,9 +80,19 @@ public:
 
     int currentStreamIndex(QPlatformMediaPlayer::TrackType trackType) const;
 
+    // nullptr if the container is expected to seek well on its own
+    const std::shared_ptr<KeyframeIndex> &keyframeIndex() const { return m_keyframeIndex; }
+
     using Maybe = QMaybe<QSharedPointer<MediaDataHolder>, ContextError>;
+    // In low-latency mode, live streams are opened and demuxed without buffering
     static Maybe create(const QUrl &url, QIODevice *stream,
-                        const std::shared_ptr<ICancelToken> &cancelToken);
+                        const std::shared_ptr<ICancelToken> &cancelToken,
+                        bool lowLatency = false);
+
+    bool isLowLatency() const { return m_lowLatency; }
+
+    // The lowres level the current video stream is decoded with, see Codec::create()
+    int decodingLowres() const;
 
     bool setActiveTrack(QPlatformMediaPlayer::TrackType type, int streamNumber);
 
@@ -88,15 +102,19 @@ private:
     std::shared_ptr<ICancelToken> m_cancelToken; // NOTE: Cancel token may be accessed by
                                                  // AVFormatContext during destruction and
                                                  // must outlive the context object
+    std::unique_ptr<IODeviceInput> m_ioInput; // Provides the AVIO context of m_context
     AVFormatContextUPtr m_context;
 
     bool m_isSeekable = false;
+    bool m_lowLatency = false;
+    int m_requestedLowres = 0;
 
     StreamIndexes m_currentAVStreamIndex = { -1, -1, -1 };
     StreamsMap m_streamMap;
     StreamIndexes m_requestedStreams = { -1, -1, -1 };
     qint64 m_duration = 0;
     QMediaMetaData m_metaData;
+    std::shared_ptr<KeyframeIndex> m_keyframeIndex;
 };
 
 } // namespace QFFmpeg
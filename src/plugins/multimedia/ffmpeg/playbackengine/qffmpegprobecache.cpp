@@ -0,0 +1,399 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegprobecache_p.h"
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qsavefile.h>
+
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcProbeCache, "qt.multimedia.ffmpeg.probecache");
+
+namespace QFFmpeg {
+
+namespace {
+
+// Bump when the layout of entries changes; older entries are ignored then
+constexpr quint32 EntryVersion = 2;
+constexpr quint32 EntryMagic = 0x51465043; // "QFPC"
+
+// Entries not used for this long are removed when pruning
+constexpr qint64 MaxEntryAgeDays = 30;
+
+using MetaData = QList<std::pair<QByteArray, QByteArray>>;
+
+struct Key
+{
+    QString path;
+    qint64 size = 0;
+    qint64 modified = 0;
+};
+
+struct StreamEntry
+{
+    qint32 codecType = AVMEDIA_TYPE_UNKNOWN;
+    qint32 codecId = AV_CODEC_ID_NONE;
+    qint32 format = -1;
+    qint32 sampleRate = 0;
+    qint32 channels = 0;
+    quint64 channelMask = 0;
+    qint32 width = 0;
+    qint32 height = 0;
+    AVRational sampleAspectRatio = { 0, 1 };
+    AVRational avgFrameRate = { 0, 1 };
+    AVRational realFrameRate = { 0, 1 };
+    qint64 duration = AV_NOPTS_VALUE;
+    qint64 startTime = AV_NOPTS_VALUE;
+    // Codec setup data such as SPS/PPS, which some containers only carry in-band
+    QByteArray extradata;
+    MetaData metaData;
+};
+
+QDataStream &operator<<(QDataStream &s, const AVRational &r)
+{
+    return s << qint32(r.num) << qint32(r.den);
+}
+
+QDataStream &operator>>(QDataStream &s, AVRational &r)
+{
+    qint32 num = 0, den = 1;
+    s >> num >> den;
+    r = { num, den };
+    return s;
+}
+
+QDataStream &operator<<(QDataStream &s, const StreamEntry &e)
+{
+    return s << e.codecType << e.codecId << e.format << e.sampleRate << e.channels
+             << e.channelMask << e.width << e.height << e.sampleAspectRatio << e.avgFrameRate
+             << e.realFrameRate << e.duration << e.startTime << e.extradata << e.metaData;
+}
+
+QDataStream &operator>>(QDataStream &s, StreamEntry &e)
+{
+    return s >> e.codecType >> e.codecId >> e.format >> e.sampleRate >> e.channels
+            >> e.channelMask >> e.width >> e.height >> e.sampleAspectRatio >> e.avgFrameRate
+            >> e.realFrameRate >> e.duration >> e.startTime >> e.extradata >> e.metaData;
+}
+
+MetaData metaDataFromDict(const AVDictionary *dict)
+{
+    MetaData metaData;
+    const AVDictionaryEntry *entry = nullptr;
+    while ((entry = av_dict_get(dict, "", entry, AV_DICT_IGNORE_SUFFIX)))
+        metaData.append({ QByteArray(entry->key), QByteArray(entry->value) });
+    return metaData;
+}
+
+// Tags found while probing packets are added, the ones from the header are kept
+void applyMetaData(const MetaData &metaData, AVDictionary **dict)
+{
+    for (const auto &[key, value] : metaData)
+        av_dict_set(dict, key.constData(), value.constData(), AV_DICT_DONT_OVERWRITE);
+}
+
+constexpr QLatin1StringView KeyframesSuffix(".keyframes");
+
+// Names of the files the cache writes: the hex SHA-1 of the path, and a suffix
+bool isEntryFileName(const QString &fileName)
+{
+    static const QRegularExpression pattern(
+            QRegularExpression::anchoredPattern(QStringLiteral("[0-9a-f]{40}(\\.keyframes)?")));
+    return pattern.match(fileName).hasMatch();
+}
+
+// Marks an entry as used, for pruning
+void touch(QFile &file)
+{
+    file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+}
+
+std::optional<Key> makeKey(const QFileInfo &fileInfo)
+{
+    const QString path = fileInfo.canonicalFilePath();
+    if (path.isEmpty())
+        return {};
+    return Key{ path, fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch() };
+}
+
+void writeHeader(QDataStream &out, const Key &key)
+{
+    out << EntryMagic << EntryVersion << key.path << key.size << key.modified;
+}
+
+bool readHeader(QDataStream &in, const Key &key)
+{
+    quint32 magic = 0, version = 0;
+    in >> magic >> version;
+    if (magic != EntryMagic || version != EntryVersion)
+        return false;
+
+    Key stored;
+    in >> stored.path >> stored.size >> stored.modified;
+    return in.status() == QDataStream::Ok && stored.path == key.path && stored.size == key.size
+            && stored.modified == key.modified;
+}
+
+StreamEntry streamEntry(const AVStream *stream)
+{
+    const auto *codecpar = stream->codecpar;
+    StreamEntry e;
+    e.codecType = codecpar->codec_type;
+    e.codecId = codecpar->codec_id;
+    e.format = codecpar->format;
+    e.sampleRate = codecpar->sample_rate;
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+    e.channels = codecpar->channels;
+    e.channelMask = codecpar->channel_layout;
+#else
+    e.channels = codecpar->ch_layout.nb_channels;
+    if (codecpar->ch_layout.order == AV_CHANNEL_ORDER_NATIVE)
+        e.channelMask = codecpar->ch_layout.u.mask;
+#endif
+    e.width = codecpar->width;
+    e.height = codecpar->height;
+    e.sampleAspectRatio = stream->sample_aspect_ratio;
+    e.avgFrameRate = stream->avg_frame_rate;
+    e.realFrameRate = stream->r_frame_rate;
+    e.duration = stream->duration;
+    e.startTime = stream->start_time;
+    if (codecpar->extradata && codecpar->extradata_size > 0)
+        e.extradata = QByteArray(reinterpret_cast<const char *>(codecpar->extradata),
+                                 codecpar->extradata_size);
+    e.metaData = metaDataFromDict(stream->metadata);
+    return e;
+}
+
+// Only fills in what the header didn't provide
+void applyStreamEntry(const StreamEntry &e, AVStream *stream)
+{
+    auto *codecpar = stream->codecpar;
+    if (codecpar->format < 0)
+        codecpar->format = e.format;
+    if (codecpar->sample_rate <= 0)
+        codecpar->sample_rate = e.sampleRate;
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+    if (codecpar->channels <= 0) {
+        codecpar->channels = e.channels;
+        codecpar->channel_layout = e.channelMask;
+    }
+#else
+    if (codecpar->ch_layout.nb_channels <= 0 && e.channels > 0) {
+        av_channel_layout_uninit(&codecpar->ch_layout);
+        if (e.channelMask)
+            av_channel_layout_from_mask(&codecpar->ch_layout, e.channelMask);
+        else
+            av_channel_layout_default(&codecpar->ch_layout, e.channels);
+    }
+#endif
+    if (codecpar->width <= 0 || codecpar->height <= 0) {
+        codecpar->width = e.width;
+        codecpar->height = e.height;
+    }
+    if (stream->sample_aspect_ratio.num == 0)
+        stream->sample_aspect_ratio = e.sampleAspectRatio;
+    if (stream->avg_frame_rate.num == 0)
+        stream->avg_frame_rate = e.avgFrameRate;
+    if (stream->r_frame_rate.num == 0)
+        stream->r_frame_rate = e.realFrameRate;
+    if (stream->duration == AV_NOPTS_VALUE)
+        stream->duration = e.duration;
+    if (stream->start_time == AV_NOPTS_VALUE)
+        stream->start_time = e.startTime;
+    if (codecpar->extradata_size <= 0 && !e.extradata.isEmpty()) {
+        av_freep(&codecpar->extradata);
+        codecpar->extradata = static_cast<uint8_t *>(
+                av_mallocz(e.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (codecpar->extradata) {
+            memcpy(codecpar->extradata, e.extradata.constData(), e.extradata.size());
+            codecpar->extradata_size = int(e.extradata.size());
+        }
+    }
+    applyMetaData(e.metaData, &stream->metadata);
+}
+
+} // namespace
+
+ProbeCache::ProbeCache(const QString &directory) : m_directory(directory) { }
+
+const ProbeCache *ProbeCache::instance()
+{
+    static const std::optional<ProbeCache> cache = []() -> std::optional<ProbeCache> {
+        const QString directory = qEnvironmentVariable("QT_FFMPEG_PROBE_CACHE_DIR");
+        if (directory.isEmpty())
+            return {};
+        if (!QDir().mkpath(directory)) {
+            qCWarning(qLcProbeCache) << "Cannot create probe cache directory" << directory;
+            return {};
+        }
+        ProbeCache cache(directory);
+        cache.prune();
+        return cache;
+    }();
+    return cache ? &*cache : nullptr;
+}
+
+void ProbeCache::prune(qint64 maxSize) const
+{
+    // Leave anything in the directory alone that the cache didn't write
+    QFileInfoList entries;
+    const QFileInfoList files = QDir(m_directory).entryInfoList(QDir::Files, QDir::Time);
+    for (const QFileInfo &file : files) {
+        if (isEntryFileName(file.fileName()))
+            entries.append(file);
+    }
+
+    // Sorted from the most recently used one
+    const QDateTime oldest = QDateTime::currentDateTimeUtc().addDays(-MaxEntryAgeDays);
+    qint64 size = 0;
+    int removed = 0;
+    for (const QFileInfo &entry : std::as_const(entries)) {
+        size += entry.size();
+        if (size <= maxSize && entry.lastModified() >= oldest)
+            continue;
+        if (QFile::remove(entry.filePath()))
+            ++removed;
+    }
+    if (removed)
+        qCDebug(qLcProbeCache) << "Pruned" << removed << "entries from" << m_directory;
+}
+
+QString ProbeCache::entryPath(const QFileInfo &fileInfo, QLatin1StringView suffix) const
+{
+    const QByteArray hash = QCryptographicHash::hash(fileInfo.canonicalFilePath().toUtf8(),
+                                                     QCryptographicHash::Sha1);
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(hash.toHex()) + suffix;
+}
+
+bool ProbeCache::restore(const QString &filePath, AVFormatContext *context) const
+{
+    const QFileInfo fileInfo(filePath);
+    const auto key = makeKey(fileInfo);
+    if (!key)
+        return false;
+
+    QFile file(entryPath(fileInfo));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    if (!readHeader(in, *key)) {
+        qCDebug(qLcProbeCache) << "Outdated entry for" << filePath;
+        return false;
+    }
+
+    qint64 duration = AV_NOPTS_VALUE;
+    qint64 startTime = AV_NOPTS_VALUE;
+    qint64 bitRate = 0;
+    MetaData metaData;
+    quint32 streamCount = 0;
+    in >> duration >> startTime >> bitRate >> metaData >> streamCount;
+    if (in.status() != QDataStream::Ok || streamCount != context->nb_streams)
+        return false;
+
+    std::vector<StreamEntry> streams(streamCount);
+    for (quint32 i = 0; i < streamCount; ++i) {
+        in >> streams[i];
+        // the header must describe the same streams, otherwise the file needs probing
+        const auto *codecpar = context->streams[i]->codecpar;
+        if (streams[i].codecType != codecpar->codec_type
+            || streams[i].codecId != codecpar->codec_id)
+            return false;
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    for (quint32 i = 0; i < streamCount; ++i)
+        applyStreamEntry(streams[i], context->streams[i]);
+    if (context->duration == AV_NOPTS_VALUE)
+        context->duration = duration;
+    if (context->start_time == AV_NOPTS_VALUE)
+        context->start_time = startTime;
+    if (context->bit_rate <= 0)
+        context->bit_rate = bitRate;
+    applyMetaData(metaData, &context->metadata);
+
+    touch(file);
+    qCDebug(qLcProbeCache) << "Restored stream info for" << filePath;
+    return true;
+}
+
+void ProbeCache::store(const QString &filePath, const AVFormatContext *context) const
+{
+    const QFileInfo fileInfo(filePath);
+    const auto key = makeKey(fileInfo);
+    if (!key)
+        return;
+
+    // concurrent writers of the same entry are fine, the last one wins
+    QSaveFile file(entryPath(fileInfo));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    writeHeader(out, *key);
+    out << qint64(context->duration) << qint64(context->start_time) << qint64(context->bit_rate)
+        << metaDataFromDict(context->metadata) << quint32(context->nb_streams);
+    for (unsigned int i = 0; i < context->nb_streams; ++i)
+        out << streamEntry(context->streams[i]);
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qCWarning(qLcProbeCache) << "Cannot write probe cache entry for" << filePath;
+}
+
+bool ProbeCache::restoreKeyframeIndex(const QString &filePath, KeyframeIndex &index) const
+{
+    const QFileInfo fileInfo(filePath);
+    const auto key = makeKey(fileInfo);
+    if (!key)
+        return false;
+
+    QFile file(entryPath(fileInfo, KeyframesSuffix));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    if (!readHeader(in, *key))
+        return false;
+
+    index.load(in);
+    if (in.status() != QDataStream::Ok)
+        return false;
+    touch(file);
+    return true;
+}
+
+void ProbeCache::storeKeyframeIndex(const QString &filePath, const KeyframeIndex &index) const
+{
+    const QFileInfo fileInfo(filePath);
+    const auto key = makeKey(fileInfo);
+    if (!key)
+        return;
+
+    QSaveFile file(entryPath(fileInfo, KeyframesSuffix));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    writeHeader(out, *key);
+    index.save(out);
+
+    if (out.status() != QDataStream::Ok || !file.commit())
+        qCWarning(qLcProbeCache) << "Cannot write keyframe index for" << filePath;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
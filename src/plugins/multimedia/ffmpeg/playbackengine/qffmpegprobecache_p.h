@@ -0,0 +1,69 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGPROBECACHE_P_H
+#define QFFMPEGPROBECACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+QT_BEGIN_NAMESPACE
+
+class QFileInfo;
+
+namespace QFFmpeg {
+
+class KeyframeIndex;
+
+// Keeps the results of avformat_find_stream_info for local files on disk, so that
+// reopening a file only needs to read its header. Entries are keyed by the canonical
+// path, size and modification time of the file; anything else invalidates them.
+// Keyframe indexes built while playing such files are kept next to the entries.
+// Enabled by setting QT_FFMPEG_PROBE_CACHE_DIR to a writable directory, which is
+// pruned to its size limit once per process, dropping the least recently used
+// entries first.
+class ProbeCache
+{
+public:
+    static constexpr qint64 DefaultMaxSize = 32 * 1024 * 1024;
+
+    explicit ProbeCache(const QString &directory);
+
+    // Returns nullptr if the cache is not enabled
+    static const ProbeCache *instance();
+
+    // Removes entries older than a month, and the least recently used ones
+    // beyond maxSize bytes
+    void prune(qint64 maxSize = DefaultMaxSize) const;
+
+    // Completes the stream parameters of a context opened with avformat_open_input.
+    // Returns false if there's no matching entry, leaving the context untouched.
+    bool restore(const QString &filePath, AVFormatContext *context) const;
+
+    // Stores the parameters of a context after avformat_find_stream_info
+    void store(const QString &filePath, const AVFormatContext *context) const;
+
+    bool restoreKeyframeIndex(const QString &filePath, KeyframeIndex &index) const;
+    void storeKeyframeIndex(const QString &filePath, const KeyframeIndex &index) const;
+
+private:
+    QString entryPath(const QFileInfo &fileInfo, QLatin1StringView suffix = {}) const;
+
+    QString m_directory;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGPROBECACHE_P_H
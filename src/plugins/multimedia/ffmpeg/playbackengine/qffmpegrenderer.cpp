@@ -12,6 +12,7 @@ static Q_LOGGING_CATEGORY(qLcRenderer, "qt.multimedia.ffmpeg.renderer");
 
 Renderer::Renderer(const TimeController &tc, const std::chrono::microseconds &seekPosTimeOffset)
     : m_timeController(tc),
+      m_playbackRate(tc.playbackRate()),
       m_lastPosition(tc.currentPosition()),
       m_seekPos(tc.currentPosition(-seekPosTimeOffset))
 {
@@ -35,15 +36,35 @@ qint64 Renderer::lastPosition() const
     return m_lastPosition;
 }
 
+std::chrono::microseconds Renderer::outputDelay() const
+{
+    return std::chrono::microseconds(m_outputDelayUs.loadRelaxed());
+}
+
+void Renderer::setOutputDelay(std::chrono::microseconds delay)
+{
+    m_outputDelayUs.storeRelaxed(delay.count());
+}
+
 void Renderer::setPlaybackRate(float rate)
 {
     QMetaObject::invokeMethod(this, [this, rate]() {
-        m_timeController.setPlaybackRate(rate);
+        m_playbackRate = rate;
+        m_timeController.setPlaybackRate(rate * m_catchUpFactor);
         onPlaybackRateChanged();
         scheduleNextStep();
     });
 }
 
+void Renderer::setCatchUpFactor(float factor)
+{
+    QMetaObject::invokeMethod(this, [this, factor]() {
+        m_catchUpFactor = factor;
+        m_timeController.setPlaybackRate(m_playbackRate * factor);
+        scheduleNextStep();
+    });
+}
+
 void Renderer::doForceStep()
 {
     if (m_isStepForced.testAndSetOrdered(false, true))
@@ -114,7 +135,7 @@ bool Renderer::canDoNextStep() const
 
 float Renderer::playbackRate() const
 {
-    return m_timeController.playbackRate();
+    return m_playbackRate;
 }
 
 int Renderer::timerInterval() const
@@ -155,7 +176,11 @@ void Renderer::doNextStep()
         // }
     }
 
-    const auto result = renderInternal(frame);
+    const bool dropFrame = shouldDropFrame();
+    if (dropFrame)
+        qCDebug(qLcRenderer) << "drop late frame, absPts:" << frame.absolutePts();
+
+    const auto result = dropFrame ? RenderingResult{} : renderInternal(frame);
 
     if (result.done) {
         m_explicitNextFrameTime.reset();
@@ -182,6 +207,16 @@ void Renderer::doNextStep()
     scheduleNextStep(false);
 }
 
+bool Renderer::shouldDropFrame() const
+{
+    if (!m_dropLateFrames || isPaused() || m_frames.size() < 2)
+        return false;
+
+    const auto &nextFrame = m_frames[1];
+    return m_frames.front().isValid() && nextFrame.isValid()
+            && m_timeController.timeFromPosition(nextFrame.absolutePts()) <= Clock::now();
+}
+
 std::chrono::microseconds Renderer::frameDelay(const Frame &frame) const
 {
     return std::chrono::duration_cast<std::chrono::microseconds>(
@@ -40,8 +40,14 @@ public:
 
     qint64 lastPosition() const;
 
+    // How long the output takes to present what has been rendered, e.g. the audio sink buffer
+    std::chrono::microseconds outputDelay() const;
+
     void setPlaybackRate(float rate);
 
+    // Plays faster than the playback rate by the factor, to catch up with a live stream
+    void setCatchUpFactor(float factor);
+
     void doForceStep();
 
     bool isStepForced() const;
@@ -79,12 +85,21 @@ protected:
 
     virtual RenderingResult renderInternal(Frame frame) = 0;
 
+    // The rate set by the user, without the catch-up factor
     float playbackRate() const;
 
+    float catchUpFactor() const { return m_catchUpFactor; }
+
     std::chrono::microseconds frameDelay(const Frame &frame) const;
 
     void changeRendererTime(std::chrono::microseconds offset);
 
+    void setOutputDelay(std::chrono::microseconds delay);
+
+    // Skip frames that are late enough for the next frame to be due already,
+    // instead of rendering all of them to catch up
+    void setDropLateFrames(bool drop) { m_dropLateFrames = drop; }
+
     template<typename Output, typename ChangeHandler>
     void setOutputInternal(QPointer<Output> &actual, Output *desired, ChangeHandler &&changeHandler)
     {
@@ -104,15 +119,21 @@ private:
 
     int timerInterval() const override;
 
+    bool shouldDropFrame() const;
+
 private:
     TimeController m_timeController;
+    float m_playbackRate = 1.f;
+    float m_catchUpFactor = 1.f;
     QAtomicInteger<qint64> m_lastPosition = 0;
+    QAtomicInteger<qint64> m_outputDelayUs = 0;
     QAtomicInteger<qint64> m_seekPos = 0;
     int m_loopIndex = 0;
     QQueue<Frame> m_frames;
 
     QAtomicInteger<bool> m_isStepForced = false;
     std::optional<TimePoint> m_explicitNextFrameTime;
+    bool m_dropLateFrames = false;
 };
 
 } // namespace QFFmpeg
@@ -0,0 +1,55 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegsoftwaredecoding_p.h"
+#include "qloggingcategory.h"
+#include "qthread.h"
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcSoftwareDecoding, "qt.multimedia.ffmpeg.softwaredecoding");
+
+namespace QFFmpeg {
+
+// Some decoders warn about, or perform worse with, more threads than that
+constexpr int MaxSoftwareDecodingThreads = 16;
+
+int requestedDecodingLowres()
+{
+    return qMax(0, qEnvironmentVariableIntValue("QT_FFMPEG_DECODING_LOWRES"));
+}
+
+int supportedLowres(const AVCodec *decoder, int requestedLowres)
+{
+    return qBound(0, requestedLowres, int(decoder->max_lowres));
+}
+
+QSize lowresFrameSize(QSize size, int lowres)
+{
+    // As decoders compute it, rounding up
+    const int factor = 1 << lowres;
+    return { (size.width() + factor - 1) / factor, (size.height() + factor - 1) / factor };
+}
+
+// Frame threading gives the best throughput; slice threading helps codecs lacking it.
+// Frame threading delays the output by a frame per thread, so low latency goes without.
+void setupSoftwareVideoDecoder(AVCodecContext *context, const AVCodec *decoder, bool lowLatency,
+                               int requestedLowres)
+{
+    context->thread_count = qBound(1, QThread::idealThreadCount(), MaxSoftwareDecodingThreads);
+    context->thread_type = 0;
+    if (!lowLatency && (decoder->capabilities & AV_CODEC_CAP_FRAME_THREADS))
+        context->thread_type |= FF_THREAD_FRAME;
+    if (decoder->capabilities & AV_CODEC_CAP_SLICE_THREADS)
+        context->thread_type |= FF_THREAD_SLICE;
+
+    context->lowres = supportedLowres(decoder, requestedLowres);
+
+    qCDebug(qLcSoftwareDecoding) << "decoding with" << context->thread_count
+                                 << "threads, thread type" << context->thread_type << "lowres"
+                                 << context->lowres;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,46 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGSOFTWAREDECODING_P_H
+#define QFFMPEGSOFTWAREDECODING_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qsize.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// How video is decoded in software-only mode, see HWAccel::isSoftwareOnly().
+// A lowres level halves the decoded size per step, 0 decodes the full size.
+
+// The lowres level requested with QT_FFMPEG_DECODING_LOWRES
+int requestedDecodingLowres();
+
+// The highest level up to requestedLowres the decoder supports
+int supportedLowres(const AVCodec *decoder, int requestedLowres);
+
+// The size of frames decoded with the lowres level
+QSize lowresFrameSize(QSize size, int lowres);
+
+// Decodes on all cores, and with the supported lowres level
+void setupSoftwareVideoDecoder(AVCodecContext *context, const AVCodec *decoder, bool lowLatency,
+                               int requestedLowres);
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGSOFTWAREDECODING_P_H
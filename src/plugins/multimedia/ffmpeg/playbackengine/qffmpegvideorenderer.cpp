@@ -9,9 +9,12 @@ QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 
-VideoRenderer::VideoRenderer(const TimeController &tc, QVideoSink *sink, QVideoFrame::RotationAngle rotationAngle)
+VideoRenderer::VideoRenderer(const TimeController &tc, QVideoSink *sink, QVideoFrame::RotationAngle rotationAngle,
+                             bool lowLatency)
     : Renderer(tc), m_sink(sink), m_rotationAngle(rotationAngle)
 {
+    // Showing every frame of a live stream after a stall only adds to the latency
+    setDropLateFrames(lowLatency);
 }
 
 void VideoRenderer::setOutput(QVideoSink *sink, bool cleanPrevSink)
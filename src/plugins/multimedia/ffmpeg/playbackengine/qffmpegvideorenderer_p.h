@@ -28,7 +28,8 @@ class VideoRenderer : public Renderer
 {
     Q_OBJECT
 public:
-    VideoRenderer(const TimeController &tc, QVideoSink *sink, QVideoFrame::RotationAngle rotationAngle);
+    VideoRenderer(const TimeController &tc, QVideoSink *sink, QVideoFrame::RotationAngle rotationAngle,
+                  bool lowLatency = false);
 
     void setOutput(QVideoSink *sink, bool cleanPrevSink = false);
 
@@ -192,62 +192,72 @@ bool isCodecValid(const AVCodec *codec, const std::vector<AVHWDeviceType> &avail
                        checkDeviceType);
 }
 
-const CodecsStorage &codecsStorage(CodecStorageType codecsType)
+using CodecsStorages = std::array<CodecsStorage, CODEC_STORAGE_TYPE_COUNT>;
+
+CodecsStorages createCodecsStorages(bool softwareOnly)
 {
-    static const auto &storages = []() {
-        std::array<CodecsStorage, CODEC_STORAGE_TYPE_COUNT> result;
-        void *opaque = nullptr;
-
-        while (auto codec = av_codec_iterate(&opaque)) {
-            // TODO: to be investigated
-            // FFmpeg functions avcodec_find_decoder/avcodec_find_encoder
-            // find experimental codecs in the last order,
-            // now we don't consider them at all since they are supposed to
-            // be not stable, maybe we shouldn't.
-            if (codec->capabilities & AV_CODEC_CAP_EXPERIMENTAL) {
-                qCDebug(qLcFFmpegUtils) << "Skip experimental codec" << codec->name;
-                continue;
-            }
+    CodecsStorages result;
+    void *opaque = nullptr;
+
+    while (auto codec = av_codec_iterate(&opaque)) {
+        // TODO: to be investigated
+        // FFmpeg functions avcodec_find_decoder/avcodec_find_encoder
+        // find experimental codecs in the last order,
+        // now we don't consider them at all since they are supposed to
+        // be not stable, maybe we shouldn't.
+        if (codec->capabilities & AV_CODEC_CAP_EXPERIMENTAL) {
+            qCDebug(qLcFFmpegUtils) << "Skip experimental codec" << codec->name;
+            continue;
+        }
 
-            if (av_codec_is_decoder(codec)) {
-                if (isCodecValid(codec, HWAccel::decodingDeviceTypes()))
-                    result[DECODERS].emplace_back(codec);
-                else
-                    qCDebug(qLcFFmpegUtils) << "Skip decoder" << codec->name
-                                            << "due to disabled matching hw acceleration";
-            }
+        if (av_codec_is_decoder(codec)) {
+            if (isCodecValid(codec, HWAccel::decodingDeviceTypes(softwareOnly)))
+                result[DECODERS].emplace_back(codec);
+            else
+                qCDebug(qLcFFmpegUtils) << "Skip decoder" << codec->name
+                                        << "due to disabled matching hw acceleration";
+        }
 
-            if (av_codec_is_encoder(codec)) {
-                if (isCodecValid(codec, HWAccel::encodingDeviceTypes()))
-                    result[ENCODERS].emplace_back(codec);
-                else
-                    qCDebug(qLcFFmpegUtils) << "Skip encoder" << codec->name
-                                            << "due to disabled matching hw acceleration";
-            }
+        if (av_codec_is_encoder(codec)) {
+            if (isCodecValid(codec, HWAccel::encodingDeviceTypes(softwareOnly)))
+                result[ENCODERS].emplace_back(codec);
+            else
+                qCDebug(qLcFFmpegUtils) << "Skip encoder" << codec->name
+                                        << "due to disabled matching hw acceleration";
         }
+    }
 
-        for (auto &storage : result) {
-            storage.shrink_to_fit();
+    for (auto &storage : result) {
+        storage.shrink_to_fit();
 
-            // we should ensure the original order
-            std::stable_sort(storage.begin(), storage.end(), CodecsComparator{});
-        }
+        // we should ensure the original order
+        std::stable_sort(storage.begin(), storage.end(), CodecsComparator{});
+    }
 
-        // It print pretty much logs, so let's print it only for special case
-        const bool shouldDumpCodecsInfo = qLcFFmpegUtils().isEnabled(QtDebugMsg)
-                && qEnvironmentVariableIsSet("QT_FFMPEG_DEBUG");
+    // It print pretty much logs, so let's print it only for special case
+    const bool shouldDumpCodecsInfo = qLcFFmpegUtils().isEnabled(QtDebugMsg)
+            && qEnvironmentVariableIsSet("QT_FFMPEG_DEBUG");
 
-        if (shouldDumpCodecsInfo) {
-            qCDebug(qLcFFmpegUtils) << "Advanced ffmpeg codecs info:";
-            for (auto &storage : result) {
-                std::for_each(storage.begin(), storage.end(), &dumpCodecInfo);
-                qCDebug(qLcFFmpegUtils) << "---------------------------";
-            }
+    if (shouldDumpCodecsInfo) {
+        qCDebug(qLcFFmpegUtils) << "Advanced ffmpeg codecs info:";
+        for (auto &storage : result) {
+            std::for_each(storage.begin(), storage.end(), &dumpCodecInfo);
+            qCDebug(qLcFFmpegUtils) << "---------------------------";
         }
+    }
 
-        return result;
-    }();
+    return result;
+}
 
+const CodecsStorage &codecsStorage(CodecStorageType codecsType)
+{
+    // Without hw devices, codecs that need one are left out. Software-only mode
+    // can be switched at runtime, so the codecs of each mode are kept separately.
+    if (HWAccel::isSoftwareOnly()) {
+        static const CodecsStorages softwareStorages = createCodecsStorages(true);
+        return softwareStorages[codecsType];
+    }
+    static const CodecsStorages storages = createCodecsStorages(false);
     return storages[codecsType];
 }
 
@@ -19,12 +19,14 @@
 #    include "qffmpeghwaccel_mediacodec_p.h"
 #endif
 #include "qffmpeg_p.h"
+#include "qffmpeghwcontextcache_p.h"
 #include "qffmpegvideobuffer_p.h"
 #include "qscopedvaluerollback.h"
 #include "QtCore/qfile.h"
 
 #include <rhi/qrhi.h>
 #include <qloggingcategory.h>
+#include <atomic>
 #include <unordered_set>
 
 /* Infrastructure for HW acceleration goes into this file. */
@@ -68,6 +70,8 @@ static AVBufferUPtr loadHWContext(AVHWDeviceType type)
     return nullptr;
 }
 
+Q_GLOBAL_STATIC(HWContextCache, hwContextCache, &loadHWContext)
+
 // FFmpeg might crash on loading non-existing hw devices.
 // Let's roughly precheck drivers/libraries.
 static bool precheckDriver(AVHWDeviceType type)
@@ -116,7 +120,11 @@ static bool checkHwType(AVHWDeviceType type)
     QScopedValueRollback rollback(FFmpegLogsEnabledInThread);
     FFmpegLogsEnabledInThread = false;
 
-    return loadHWContext(type) != nullptr;
+    // the context is kept for a while, for the first HWAccel of the type
+    auto context = hwContextCache->get(type);
+    const bool loaded = context != nullptr;
+    hwContextCache->release(std::move(context));
+    return loaded;
 }
 
 static const std::vector<AVHWDeviceType> &deviceTypes()
@@ -190,6 +198,9 @@ findCodecWithHwAccel(AVCodecID id, const std::vector<AVHWDeviceType> &deviceType
                      CodecFinder codecFinder,
                      const std::function<bool(const HWAccel &)> &hwAccelPredicate)
 {
+    if (deviceTypes.empty())
+        return { nullptr, nullptr };
+
     for (auto type : deviceTypes) {
         const auto codec = codecFinder(id, type, {});
 
@@ -342,11 +353,16 @@ TextureConverter::Data::~Data()
     delete backend;
 }
 
-HWAccel::~HWAccel() = default;
+HWAccel::~HWAccel()
+{
+    m_hwFramesContext.reset();
+    if (!hwContextCache.isDestroyed())
+        hwContextCache->release(std::move(m_hwDeviceContext));
+}
 
 std::unique_ptr<HWAccel> HWAccel::create(AVHWDeviceType deviceType)
 {
-    if (auto ctx = loadHWContext(deviceType))
+    if (auto ctx = hwContextCache->get(deviceType))
         return std::unique_ptr<HWAccel>(new HWAccel(std::move(ctx)));
     else
         return {};
@@ -362,14 +378,52 @@ AVPixelFormat HWAccel::format(AVFrame *frame)
     return AVPixelFormat(hwFramesContext->sw_format);
 }
 
-const std::vector<AVHWDeviceType> &HWAccel::encodingDeviceTypes()
+static bool softwareOnlyFromEnvironment()
+{
+    return qEnvironmentVariableIntValue("QT_FFMPEG_SOFTWARE_ONLY") != 0;
+}
+
+static std::atomic_bool &softwareOnlyFlag()
+{
+    static std::atomic_bool result = softwareOnlyFromEnvironment();
+    return result;
+}
+
+bool HWAccel::isSoftwareOnly()
 {
+    return softwareOnlyFlag().load(std::memory_order_relaxed);
+}
+
+void HWAccel::setSoftwareOnly(bool enabled)
+{
+    if (softwareOnlyFlag().exchange(enabled, std::memory_order_relaxed) != enabled)
+        qCDebug(qLHWAccel) << "Software-only mode" << (enabled ? "enabled" : "disabled");
+}
+
+void HWAccel::setSoftwareOnlyFromEnvironment()
+{
+    setSoftwareOnly(softwareOnlyFromEnvironment());
+}
+
+const std::vector<AVHWDeviceType> &HWAccel::encodingDeviceTypes(bool softwareOnly)
+{
+    // The device types are only probed if they are needed. The hardware doesn't
+    // change, so the result stays valid when software-only mode is left and
+    // entered again.
+    static const std::vector<AVHWDeviceType> noTypes;
+    if (softwareOnly)
+        return noTypes;
+
     static const auto &result = deviceTypes("QT_FFMPEG_ENCODING_HW_DEVICE_TYPES");
     return result;
 }
 
-const std::vector<AVHWDeviceType> &HWAccel::decodingDeviceTypes()
+const std::vector<AVHWDeviceType> &HWAccel::decodingDeviceTypes(bool softwareOnly)
 {
+    static const std::vector<AVHWDeviceType> noTypes;
+    if (softwareOnly)
+        return noTypes;
+
     static const auto &result = deviceTypes("QT_FFMPEG_DECODING_HW_DEVICE_TYPES");
     return result;
 }
@@ -114,10 +114,21 @@ public:
     AVBufferRef *hwFramesContextAsBuffer() const { return m_hwFramesContext.get(); }
     AVHWFramesContext *hwFramesContext() const;
 
+    // Whether codecs are never hardware accelerated, skipping the probing of hw devices.
+    // Process-wide, and applies to the codecs looked up afterwards; the device types
+    // and the codecs matching them are cached per mode. Initially, and whenever a
+    // source is loaded or a recording is started, set from QT_FFMPEG_SOFTWARE_ONLY.
+    static bool isSoftwareOnly();
+    static void setSoftwareOnly(bool enabled);
+    static void setSoftwareOnlyFromEnvironment();
+
     static AVPixelFormat format(AVFrame *frame);
-    static const std::vector<AVHWDeviceType> &encodingDeviceTypes();
+    // Empty in software-only mode
+    static const std::vector<AVHWDeviceType> &
+    encodingDeviceTypes(bool softwareOnly = isSoftwareOnly());
 
-    static const std::vector<AVHWDeviceType> &decodingDeviceTypes();
+    static const std::vector<AVHWDeviceType> &
+    decodingDeviceTypes(bool softwareOnly = isSoftwareOnly());
 
 private:
     HWAccel(AVBufferUPtr hwDeviceContext) : m_hwDeviceContext(std::move(hwDeviceContext)) { }
@@ -0,0 +1,135 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qffmpeghwcontextcache_p.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qloggingcategory.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcHWContextCache, "qt.multimedia.ffmpeg.hwcontextcache");
+
+namespace QFFmpeg {
+
+HWContextCache::HWContextCache(Loader loader, std::chrono::milliseconds idleTimeout,
+                               std::chrono::milliseconds retryInterval)
+    : m_loader(std::move(loader)), m_idleTimeout(idleTimeout), m_retryInterval(retryInterval)
+{
+    m_expiryTimer.setSingleShot(true);
+    QObject::connect(&m_expiryTimer, &QTimer::timeout, &m_expiryTimer, [this]() {
+        releaseExpired();
+        scheduleExpiry();
+    });
+
+    // The cache may be created on a codec's thread; the timer needs one that lives on
+    if (auto *app = QCoreApplication::instance())
+        m_expiryTimer.moveToThread(app->thread());
+}
+
+HWContextCache::~HWContextCache() = default;
+
+AVBufferUPtr HWContextCache::get(AVHWDeviceType type)
+{
+    // MediaCodec device contexts get the output surface of their codec
+    if (type == AV_HWDEVICE_TYPE_MEDIACODEC)
+        return m_loader(type);
+
+    QMutexLocker locker(&m_mutex);
+
+    auto failed = m_failedTypes.find(type);
+    if (failed != m_failedTypes.end()) {
+        if (!failed->second.hasExpired())
+            return nullptr;
+        m_failedTypes.erase(failed);
+    }
+
+    auto it = m_contexts.find(type);
+    if (it == m_contexts.end()) {
+        auto context = m_loader(type);
+        if (!context) {
+            m_failedTypes.emplace(type, QDeadlineTimer(m_retryInterval));
+            return nullptr;
+        }
+        it = m_contexts.emplace(type, Entry{ std::move(context) }).first;
+    } else {
+        qCDebug(qLcHWContextCache) << "Reusing hw context:" << av_hwdevice_get_type_name(type);
+    }
+
+    ++it->second.users;
+    it->second.expiry = QDeadlineTimer(QDeadlineTimer::Forever);
+    return AVBufferUPtr(av_buffer_ref(it->second.context.get()));
+}
+
+void HWContextCache::release(AVBufferUPtr context)
+{
+    if (!context)
+        return;
+
+    // references share the data of the context
+    const uint8_t *data = context->data;
+    context.reset();
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto &[type, entry] : m_contexts) {
+            if (entry.context->data != data)
+                continue;
+            Q_ASSERT(entry.users > 0);
+            if (--entry.users == 0)
+                entry.expiry = QDeadlineTimer(m_idleTimeout);
+            break;
+        }
+    }
+
+    releaseExpired();
+    scheduleExpiry();
+}
+
+void HWContextCache::releaseExpired()
+{
+    std::vector<AVBufferUPtr> expiredContexts;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = m_contexts.begin(); it != m_contexts.end();) {
+            if (it->second.users == 0 && it->second.expiry.hasExpired()) {
+                qCDebug(qLcHWContextCache)
+                        << "Releasing hw context:" << av_hwdevice_get_type_name(it->first);
+                expiredContexts.push_back(std::move(it->second.context));
+                it = m_contexts.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Codecs may still refer to them; the devices are closed with their last reference
+    expiredContexts.clear();
+}
+
+void HWContextCache::scheduleExpiry()
+{
+    QMetaObject::invokeMethod(&m_expiryTimer, [this]() {
+        QMutexLocker locker(&m_mutex);
+        QDeadlineTimer next(QDeadlineTimer::Forever);
+        for (const auto &[type, entry] : m_contexts) {
+            if (entry.users == 0)
+                next = std::min(next, entry.expiry);
+        }
+
+        if (next.isForever()) {
+            m_expiryTimer.stop();
+            return;
+        }
+
+        using namespace std::chrono;
+        const auto remaining = next.remainingTimeAsDuration();
+        m_expiryTimer.start(std::max(ceil<milliseconds>(remaining), milliseconds(0)));
+    });
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
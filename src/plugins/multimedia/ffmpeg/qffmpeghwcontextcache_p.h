@@ -0,0 +1,82 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+#ifndef QFFMPEGHWCONTEXTCACHE_P_H
+#define QFFMPEGHWCONTEXTCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qtimer.h>
+
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Device contexts shared by all HWAccel instances of a device type, be it for decoding or
+// encoding. Opening a device, e.g. a VA display or a CUDA context, is expensive, and there's
+// no need for more than one per process; every HWAccel creates frames contexts of its own.
+// A context is kept for the idle timeout after its last user has released it, so that
+// codecs created one after another share it as well. Types that failed to load are
+// retried after the retry interval.
+class HWContextCache
+{
+public:
+    using Loader = std::function<AVBufferUPtr(AVHWDeviceType)>;
+
+    static constexpr std::chrono::milliseconds DefaultIdleTimeout{ 5000 };
+    static constexpr std::chrono::milliseconds DefaultRetryInterval{ 30000 };
+
+    explicit HWContextCache(Loader loader,
+                            std::chrono::milliseconds idleTimeout = DefaultIdleTimeout,
+                            std::chrono::milliseconds retryInterval = DefaultRetryInterval);
+    ~HWContextCache();
+
+    // Returns a reference to the context of the type, loading it if there's none.
+    // Each reference is to be given back with release().
+    AVBufferUPtr get(AVHWDeviceType type);
+    void release(AVBufferUPtr context);
+
+private:
+    void releaseExpired();
+    void scheduleExpiry();
+
+    struct Entry
+    {
+        AVBufferUPtr context;
+        int users = 0;
+        // when the context is released if it stays unused
+        QDeadlineTimer expiry;
+    };
+
+    const Loader m_loader;
+    const std::chrono::milliseconds m_idleTimeout;
+    const std::chrono::milliseconds m_retryInterval;
+
+    QMutex m_mutex;
+    std::unordered_map<AVHWDeviceType, Entry> m_contexts;
+    // when to try loading the type again
+    std::unordered_map<AVHWDeviceType, QDeadlineTimer> m_failedTypes;
+    QTimer m_expiryTimer;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGHWCONTEXTCACHE_P_H
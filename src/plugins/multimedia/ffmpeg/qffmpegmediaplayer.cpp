@@ -40,6 +40,10 @@ QFFmpegMediaPlayer::QFFmpegMediaPlayer(QMediaPlayer *player)
     m_positionUpdateTimer.setInterval(50);
     m_positionUpdateTimer.setTimerType(Qt::PreciseTimer);
     connect(&m_positionUpdateTimer, &QTimer::timeout, this, &QFFmpegMediaPlayer::updatePosition);
+
+    // The buffers change with every packet, don't report more often than this
+    m_bufferUpdateTimer.setInterval(250);
+    connect(&m_bufferUpdateTimer, &QTimer::timeout, this, &QFFmpegMediaPlayer::updateBufferStatus);
 }
 
 QFFmpegMediaPlayer::~QFFmpegMediaPlayer()
@@ -47,6 +51,10 @@ QFFmpegMediaPlayer::~QFFmpegMediaPlayer()
     if (m_cancelToken)
         m_cancelToken->cancel();
 
+    cancelNextMedia();
+    // The loads still running post their results to this
+    for (QFuture<void> &load : m_loadNextMedia)
+        load.waitForFinished();
     m_loadMedia.waitForFinished();
 };
 
@@ -96,14 +104,106 @@ void QFFmpegMediaPlayer::onLoopChanged()
     m_positionUpdateTimer.start();
 }
 
+void QFFmpegMediaPlayer::onNextMediaStarted()
+{
+    // The engine plays the next media now, it's no longer the next one
+    m_url = std::exchange(m_nextUrl, QUrl());
+    m_device = nullptr;
+    m_cancelToken = std::exchange(m_nextCancelToken, nullptr);
+    m_bufferProgress = 0.f;
+
+    nextMediaStarted();
+
+    durationChanged(duration());
+    tracksChanged();
+    metaDataChanged();
+    seekableChanged(m_playbackEngine->isSeekable());
+
+    audioAvailableChanged(
+            !m_playbackEngine->streamInfo(QPlatformMediaPlayer::AudioStream).isEmpty());
+    videoAvailableChanged(
+            !m_playbackEngine->streamInfo(QPlatformMediaPlayer::VideoStream).isEmpty());
+
+    if (isStreamingSource())
+        m_bufferUpdateTimer.start();
+    else
+        m_bufferUpdateTimer.stop();
+
+    updatePosition();
+}
+
+void QFFmpegMediaPlayer::onLatencyChanged(qint64 latency)
+{
+    latencyChanged(latency / 1000);
+}
+
+bool QFFmpegMediaPlayer::isStreamingSource() const
+{
+    // Everything that is not read from the device itself has to be buffered
+    if (m_device || m_url.isLocalFile() || m_url.scheme().isEmpty())
+        return false;
+    const QString scheme = m_url.scheme();
+    return scheme != QLatin1StringView("qrc") && scheme != QLatin1StringView("content")
+            && scheme != QLatin1StringView("assets");
+}
+
+QMediaPlayer::MediaStatus QFFmpegMediaPlayer::bufferingStatus() const
+{
+    if (!isStreamingSource() || !m_playbackEngine)
+        return QMediaPlayer::BufferedMedia;
+
+    // The fill level drops a little with every packet played and recovers with
+    // the next one demuxed. Only go back to buffering once most of the buffered
+    // data is used up, so that the status doesn't flap around the limit.
+    constexpr float bufferedLevel = 0.9f;
+    constexpr float bufferingLevel = 0.25f;
+    const float fillLevel = m_playbackEngine->bufferFillLevel();
+    if (mediaStatus() == QMediaPlayer::BufferedMedia)
+        return fillLevel < bufferingLevel ? QMediaPlayer::BufferingMedia
+                                          : QMediaPlayer::BufferedMedia;
+    return fillLevel >= bufferedLevel ? QMediaPlayer::BufferedMedia
+                                      : QMediaPlayer::BufferingMedia;
+}
+
+void QFFmpegMediaPlayer::updateBufferStatus()
+{
+    if (!m_playbackEngine)
+        return;
+
+    const float progress = m_playbackEngine->bufferFillLevel();
+    // Report the edges exactly, but ignore tiny changes in between
+    if (progress != m_bufferProgress
+        && (qAbs(progress - m_bufferProgress) >= 0.01f || progress == 0.f || progress == 1.f)) {
+        m_bufferProgress = progress;
+        bufferProgressChanged(progress);
+    }
+
+    const auto status = mediaStatus();
+    if (state() != QMediaPlayer::StoppedState
+        && (status == QMediaPlayer::BufferingMedia || status == QMediaPlayer::BufferedMedia))
+        mediaStatusChanged(bufferingStatus());
+}
+
 float QFFmpegMediaPlayer::bufferProgress() const
 {
-    return 1.;
+    return isStreamingSource() ? m_bufferProgress : 1.f;
 }
 
 QMediaTimeRange QFFmpegMediaPlayer::availablePlaybackRanges() const
 {
-    return {};
+    if (!m_playbackEngine)
+        return {};
+
+    if (!isStreamingSource()) {
+        const qint64 duration = this->duration();
+        return duration > 0 ? QMediaTimeRange(0, duration) : QMediaTimeRange{};
+    }
+
+    const qint64 start = m_playbackEngine->currentPosition(false);
+    const qint64 end = m_playbackEngine->bufferedPosition();
+    if (end <= start)
+        return {};
+    return QMediaTimeRange(start / 1000, end / 1000);
 }
 
 qreal QFFmpegMediaPlayer::playbackRate() const
@@ -120,6 +220,18 @@ void QFFmpegMediaPlayer::setPlaybackRate(qreal rate)
         m_playbackEngine->setPlaybackRate(rate);
 }
 
+void QFFmpegMediaPlayer::setLowLatency(bool lowLatency)
+{
+    // Applies to the media set next
+    m_lowLatency = lowLatency;
+}
+
+qint64 QFFmpegMediaPlayer::latency() const
+{
+    const qint64 latency = m_playbackEngine ? m_playbackEngine->latency() : -1;
+    return latency < 0 ? -1 : latency / 1000;
+}
+
 QUrl QFFmpegMediaPlayer::media() const
 {
     return m_url;
@@ -148,9 +260,15 @@ void QFFmpegMediaPlayer::setMedia(const QUrl &media, QIODevice *stream)
 
     m_loadMedia.waitForFinished();
 
+    // QMediaPlayer sets the next media again afterwards
+    cancelNextMedia();
+    m_nextUrl.clear();
+
     m_url = media;
     m_device = stream;
     m_playbackEngine = nullptr;
+    m_bufferUpdateTimer.stop();
+    m_bufferProgress = 0.f;
 
     if (media.isEmpty() && !stream) {
         handleIncorrectMedia(QMediaPlayer::NoMedia);
@@ -164,10 +282,11 @@ void QFFmpegMediaPlayer::setMedia(const QUrl &media, QIODevice *stream)
     m_cancelToken = std::make_shared<CancelToken>();
 
     // Load media asynchronously to keep GUI thread responsive while loading media
-    m_loadMedia = QtConcurrent::run([this, media, stream, cancelToken = m_cancelToken] {
+    m_loadMedia = QtConcurrent::run([this, media, stream, cancelToken = m_cancelToken,
+                                     lowLatency = m_lowLatency] {
         // On worker thread
         const MediaDataHolder::Maybe mediaHolder =
-                MediaDataHolder::create(media, stream, cancelToken);
+                MediaDataHolder::create(media, stream, cancelToken, lowLatency);
 
         // Transition back to calling thread using invokeMethod because
         // QFuture continuations back on calling thread may deadlock (QTBUG-117918)
@@ -177,6 +296,58 @@ void QFFmpegMediaPlayer::setMedia(const QUrl &media, QIODevice *stream)
     });
 }
 
+void QFFmpegMediaPlayer::setNextMedia(const QUrl &media)
+{
+    if (m_playbackEngine)
+        m_playbackEngine->clearNextMedia();
+
+    cancelNextMedia();
+
+    m_nextUrl = media;
+    loadNextMedia();
+}
+
+void QFFmpegMediaPlayer::loadNextMedia()
+{
+    if (m_nextUrl.isEmpty() || !m_playbackEngine)
+        return;
+
+    m_nextCancelToken = std::make_shared<CancelToken>();
+
+    m_loadNextMedia.removeIf([](const QFuture<void> &load) { return load.isFinished(); });
+
+    // Open the media and its codecs while the current one is playing
+    m_loadNextMedia << QtConcurrent::run([this, media = m_nextUrl,
+                                         cancelToken = m_nextCancelToken,
+                                         lowLatency = m_lowLatency] {
+        // On worker thread
+        const MediaDataHolder::Maybe mediaHolder =
+                MediaDataHolder::create(media, nullptr, cancelToken, lowLatency);
+        PlaybackEngine::Codecs codecs;
+        if (mediaHolder && !cancelToken->isCancelled())
+            codecs = PlaybackEngine::createCodecs(*mediaHolder.value());
+
+        QMetaObject::invokeMethod(this, [this, mediaHolder, codecs, cancelToken] {
+            if (cancelToken->isCancelled() || !m_playbackEngine)
+                return;
+
+            // Errors are reported when QMediaPlayer switches to the media on its own
+            if (mediaHolder)
+                m_playbackEngine->setNextMedia(std::move(*mediaHolder.value()), codecs);
+        });
+    });
+}
+
+void QFFmpegMediaPlayer::cancelNextMedia()
+{
+    // Interrupts opening the media, and its result is dropped when it arrives.
+    // Don't wait for it, the GUI thread would block on a slow network.
+    if (m_nextCancelToken)
+        m_nextCancelToken->cancel();
+
+    m_nextCancelToken = nullptr;
+}
+
 void QFFmpegMediaPlayer::setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaDataHolder,
                                        const std::shared_ptr<QFFmpeg::CancelToken> &cancelToken)
 {
@@ -207,6 +378,10 @@ void QFFmpegMediaPlayer::setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaData
             &QFFmpegMediaPlayer::error);
     connect(m_playbackEngine.get(), &PlaybackEngine::loopChanged, this,
             &QFFmpegMediaPlayer::onLoopChanged);
+    connect(m_playbackEngine.get(), &PlaybackEngine::nextMediaStarted, this,
+            &QFFmpegMediaPlayer::onNextMediaStarted);
+    connect(m_playbackEngine.get(), &PlaybackEngine::latencyChanged, this,
+            &QFFmpegMediaPlayer::onLatencyChanged);
 
     m_playbackEngine->setMedia(std::move(*mediaDataHolder.value()));
 
@@ -227,6 +402,11 @@ void QFFmpegMediaPlayer::setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaData
 
     mediaStatusChanged(QMediaPlayer::LoadedMedia);
 
+    if (isStreamingSource())
+        m_bufferUpdateTimer.start();
+
+    loadNextMedia();
+
     if (m_requestedStatus != QMediaPlayer::StoppedState) {
         if (m_requestedStatus == QMediaPlayer::PlayingState)
             play();
@@ -258,7 +438,7 @@ void QFFmpegMediaPlayer::runPlayback()
     m_playbackEngine->play();
     m_positionUpdateTimer.start();
     stateChanged(QMediaPlayer::PlayingState);
-    mediaStatusChanged(QMediaPlayer::BufferedMedia);
+    mediaStatusChanged(bufferingStatus());
 }
 
 void QFFmpegMediaPlayer::pause()
@@ -278,7 +458,7 @@ void QFFmpegMediaPlayer::pause()
     m_playbackEngine->pause();
     m_positionUpdateTimer.stop();
     stateChanged(QMediaPlayer::PausedState);
-    mediaStatusChanged(QMediaPlayer::BufferedMedia);
+    mediaStatusChanged(bufferingStatus());
 }
 
 void QFFmpegMediaPlayer::stop()
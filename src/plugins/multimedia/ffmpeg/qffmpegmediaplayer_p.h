@@ -54,6 +54,7 @@ public:
     QUrl media() const override;
     const QIODevice *mediaStream() const override;
     void setMedia(const QUrl &media, QIODevice *stream) override;
+    void setNextMedia(const QUrl &media) override;
 
     void play() override;
     void pause() override;
@@ -72,23 +73,35 @@ public:
     void setActiveTrack(TrackType, int streamNumber) override;
     void setLoops(int loops) override;
 
+    void setLowLatency(bool lowLatency) override;
+    qint64 latency() const override;
+
 private:
     void runPlayback();
     void handleIncorrectMedia(QMediaPlayer::MediaStatus status);
     void setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaDataHolder,
                        const std::shared_ptr<QFFmpeg::CancelToken> &cancelToken);
+    void loadNextMedia();
+    void cancelNextMedia();
+    bool isStreamingSource() const;
+    QMediaPlayer::MediaStatus bufferingStatus() const;
 
 private slots:
     void updatePosition();
+    void updateBufferStatus();
     void endOfStream();
     void error(int error, const QString &errorString)
     {
         QPlatformMediaPlayer::error(error, errorString);
     }
     void onLoopChanged();
+    void onNextMediaStarted();
+    void onLatencyChanged(qint64 latency);
 
 private:
     QTimer m_positionUpdateTimer;
+    QTimer m_bufferUpdateTimer;
+    float m_bufferProgress = 0.f;
     QMediaPlayer::PlaybackState m_requestedStatus = QMediaPlayer::StoppedState;
 
     using PlaybackEngine = QFFmpeg::PlaybackEngine;
@@ -100,9 +113,15 @@ private:
     QUrl m_url;
     QPointer<QIODevice> m_device;
     float m_playbackRate = 1.;
+    bool m_lowLatency = false;
     QFuture<void> m_loadMedia;
     std::shared_ptr<QFFmpeg::CancelToken> m_cancelToken; // For interrupting ongoing
                                                          // network connection attempt
+
+    // Opened in the background, for the engine to switch to without a gap
+    QUrl m_nextUrl;
+    QList<QFuture<void>> m_loadNextMedia; // including cancelled ones still running
+    std::shared_ptr<QFFmpeg::CancelToken> m_nextCancelToken;
 };
 
 QT_END_NAMESPACE
@@ -11,6 +11,7 @@
 #include "qaudiobuffer.h"
 #include "qffmpegencoder_p.h"
 #include "qffmpegmediacapturesession_p.h"
+#include "qffmpeghwaccel_p.h"
 
 #include <qdebug.h>
 #include <qloggingcategory.h>
@@ -60,6 +61,8 @@ void QFFmpegMediaRecorder::record(QMediaEncoderSettings &settings)
 
     Q_ASSERT(!location.isEmpty());
 
+    // read per recording, like QT_FFMPEG_SOFTWARE_ONLY is per source for playback
+    QFFmpeg::HWAccel::setSoftwareOnlyFromEnvironment();
     m_encoder.reset(new Encoder(settings, location));
     m_encoder->setMetaData(m_metaData);
     connect(m_encoder.get(), &QFFmpeg::Encoder::durationChanged, this,
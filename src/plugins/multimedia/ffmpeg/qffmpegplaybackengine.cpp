@@ -12,9 +12,17 @@
 #include "playbackengine/qffmpegsubtitlerenderer_p.h"
 #include "playbackengine/qffmpegvideorenderer_p.h"
 #include "playbackengine/qffmpegaudiorenderer_p.h"
+#include "playbackengine/qffmpegidlethreadpool_p.h"
+#include "playbackengine/qffmpegsoftwaredecoding_p.h"
 
 #include <qloggingcategory.h>
 
+#include <algorithm>
+
+extern "C" {
+#include <libavutil/time.h>
+}
+
 QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
@@ -39,6 +47,23 @@ inline Array defaultObjectsArray()
 //
 static constexpr bool shouldPauseStreams = false;
 
+// Low latency playback holds the buffered media around the target latency
+// by playing slightly faster while there's more of it.
+static constexpr qint64 DefaultTargetLatencyUs = 200'000;
+static constexpr qint64 LatencyToleranceUs = 100'000;
+static constexpr std::chrono::milliseconds LatencyCheckInterval(250);
+static constexpr float MinCatchUpSpeedUp = 0.05f;
+static constexpr float MaxCatchUpSpeedUp = 0.25f;
+// The excess of latency that is caught up with the maximum speed up
+static constexpr qint64 MaxCatchUpExcessUs = 4'000'000;
+
+static qint64 targetLatencyUs()
+{
+    bool ok = false;
+    const int value = qEnvironmentVariableIntValue("QT_FFMPEG_TARGET_LATENCY_MS", &ok);
+    return ok && value >= 0 ? qint64(value) * 1000 : DefaultTargetLatencyUs;
+}
+
 PlaybackEngine::PlaybackEngine()
     : m_demuxer({}, {}),
       m_streams(defaultObjectsArray<decltype(m_streams)>()),
@@ -47,6 +72,9 @@ PlaybackEngine::PlaybackEngine()
     qCDebug(qLcPlaybackEngine) << "Create PlaybackEngine";
     qRegisterMetaType<QFFmpeg::Packet>();
     qRegisterMetaType<QFFmpeg::Frame>();
+
+    m_latencyTimer.setInterval(LatencyCheckInterval);
+    connect(&m_latencyTimer, &QTimer::timeout, this, &PlaybackEngine::updateLatency);
 }
 
 PlaybackEngine::~PlaybackEngine() {
@@ -91,7 +119,15 @@ void PlaybackEngine::onRendererLoopChanged(quint64 id, qint64 offset, int loopIn
 
     if (loopIndex > m_currentLoopOffset.index) {
         m_currentLoopOffset = { offset, loopIndex };
-        emit loopChanged();
+
+        if (m_previousMedia && loopIndex >= m_mediaOffset.index) {
+            qCDebug(qLcPlaybackEngine) << "Next media started, offset:" << offset;
+            m_previousMedia.reset();
+            updateVideoSinkSize();
+            emit nextMediaStarted();
+        } else {
+            emit loopChanged();
+        }
     } else if (loopIndex == m_currentLoopOffset.index && offset != m_currentLoopOffset.pos) {
         qWarning() << "Unexpected offset for loop" << loopIndex << ":" << offset << "vs"
                    << m_currentLoopOffset.pos;
@@ -133,6 +169,7 @@ void PlaybackEngine::setState(QMediaPlayer::PlaybackState state) {
     if (m_state == QMediaPlayer::StoppedState) {
         finalizeOutputs();
         finilizeTime(0);
+        setCatchUpFactor(1.f);
     }
 
     if (prevState == QMediaPlayer::StoppedState || m_state == QMediaPlayer::StoppedState)
@@ -186,11 +223,8 @@ void PlaybackEngine::registerObject(PlaybackEngineObject &object)
 
     auto threadName = objectThreadName(object);
     auto &thread = m_threads[threadName];
-    if (!thread) {
-        thread = std::make_unique<QThread>();
-        thread->setObjectName(threadName);
-        thread->start();
-    }
+    if (!thread)
+        thread = IdleThreadPool::acquire(threadName);
 
     Q_ASSERT(object.thread() != thread.get());
     object.moveToThread(thread.get());
@@ -202,11 +236,14 @@ PlaybackEngine::createRenderer(QPlatformMediaPlayer::TrackType trackType)
     switch (trackType) {
     case QPlatformMediaPlayer::VideoStream:
         return m_videoSink
-                ? createPlaybackEngineObject<VideoRenderer>(m_timeController, m_videoSink, m_media.getRotationAngle())
+                ? createPlaybackEngineObject<VideoRenderer>(m_timeController, m_videoSink,
+                                                           m_media.getRotationAngle(),
+                                                           m_media.isLowLatency())
                 : RendererPtr{ {}, {} };
     case QPlatformMediaPlayer::AudioStream:
         return m_audioOutput
-                ? createPlaybackEngineObject<AudioRenderer>(m_timeController, m_audioOutput)
+                ? createPlaybackEngineObject<AudioRenderer>(m_timeController, m_audioOutput,
+                                                           m_media.isLowLatency())
                 : RendererPtr{ {}, {} };
     case QPlatformMediaPlayer::SubtitleStream:
         return m_videoSink
@@ -261,7 +298,13 @@ void PlaybackEngine::setLoops(int loops)
                                << "index:" << m_currentLoopOffset.index;
 
     if (m_demuxer)
-        m_demuxer->setLoops(loops);
+        m_demuxer->setLoops(demuxerLoops());
+}
+
+int PlaybackEngine::demuxerLoops() const
+{
+    // The loops of spliced media continue counting from where the previous one ended
+    return m_loops < 0 ? m_loops : m_loops + m_mediaOffset.index;
 }
 
 void PlaybackEngine::triggerStepIfNeeded()
@@ -290,18 +333,85 @@ void PlaybackEngine::setPlaybackRate(float rate) {
     if (rate == playbackRate())
         return;
 
-    m_timeController.setPlaybackRate(rate);
+    m_playbackRate = rate;
+    m_timeController.setPlaybackRate(rate * m_catchUpFactor);
     forEachExistingObject<Renderer>([rate](auto &renderer) { renderer->setPlaybackRate(rate); });
 }
 
 float PlaybackEngine::playbackRate() const {
-    return m_timeController.playbackRate();
+    return m_playbackRate;
+}
+
+void PlaybackEngine::setCatchUpFactor(float factor)
+{
+    if (factor == m_catchUpFactor)
+        return;
+
+    m_catchUpFactor = factor;
+    m_timeController.setPlaybackRate(m_playbackRate * factor);
+    forEachExistingObject<Renderer>(
+            [factor](auto &renderer) { renderer->setCatchUpFactor(factor); });
+}
+
+qint64 PlaybackEngine::latency() const
+{
+    return m_latency;
+}
+
+void PlaybackEngine::updateLatency()
+{
+    if (!m_demuxer || m_state != QMediaPlayer::PlayingState)
+        return;
+
+    // From the demuxer over the decoders and renderers, which report the positions they've
+    // rendered, to the output, e.g. the audio sink buffer
+    const qint64 position = currentPosition(false);
+    qint64 outputDelay = 0;
+    for (const auto &renderer : m_renderers)
+        if (renderer)
+            outputDelay = std::max(outputDelay, qint64(renderer->outputDelay().count()));
+    const qint64 buffered =
+            std::max(m_demuxer->bufferedPosition() - m_currentLoopOffset.pos - position, qint64(0))
+            + outputDelay;
+
+    // The sender's wall clock, e.g. from RTCP sender reports, gives the delay behind
+    // the live edge; otherwise, only the delay added on the player side is known.
+    qint64 latency = buffered;
+    const AVFormatContext *context = m_media.avContext();
+    if (context->start_time_realtime != AV_NOPTS_VALUE && context->start_time_realtime > 0) {
+        const qint64 startTime = context->start_time != AV_NOPTS_VALUE ? context->start_time : 0;
+        latency = std::max(av_gettime() - (context->start_time_realtime + position - startTime),
+                           qint64(0));
+    }
+
+    // Only the buffered media can be caught up with
+    float catchUpFactor = m_catchUpFactor;
+    const qint64 target = targetLatencyUs();
+    if (buffered > target + LatencyToleranceUs) {
+        const float excess = float(buffered - target) / MaxCatchUpExcessUs;
+        catchUpFactor = 1.f + std::clamp(excess, MinCatchUpSpeedUp, MaxCatchUpSpeedUp);
+    } else if (buffered <= target) {
+        catchUpFactor = 1.f;
+    }
+
+    if (catchUpFactor != m_catchUpFactor) {
+        qCDebug(qLcPlaybackEngine) << "Catching up with latency" << buffered << "us, factor:"
+                                   << catchUpFactor;
+        setCatchUpFactor(catchUpFactor);
+    }
+
+    // Report changes of at least a few milliseconds only
+    if (m_latency < 0 || std::abs(latency - m_latency) >= 5000) {
+        m_latency = latency;
+        emit latencyChanged(latency);
+    }
 }
 
 void PlaybackEngine::recreateObjects()
 {
     m_timeController.setPaused(true);
 
+    cancelSplice();
     forEachExistingObject([](auto &object) { object.reset(); });
 
     createObjectsIfNeeded();
@@ -315,7 +425,7 @@ void PlaybackEngine::createObjectsIfNeeded()
     for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i)
         createStreamAndRenderer(static_cast<QPlatformMediaPlayer::TrackType>(i));
 
-    createDemuxer();
+    createDemuxer({ currentPosition(false), m_currentLoopOffset });
 }
 
 void PlaybackEngine::forceUpdate()
@@ -329,43 +439,175 @@ void PlaybackEngine::createStreamAndRenderer(QPlatformMediaPlayer::TrackType tra
 {
     auto codec = codecForTrack(trackType);
 
+    if (!codec || !ensureRenderer(trackType))
+        return;
+
+    createStreamDecoder(trackType, *codec, m_renderers[trackType]->seekPosition());
+}
+
+bool PlaybackEngine::ensureRenderer(QPlatformMediaPlayer::TrackType trackType)
+{
     auto &renderer = m_renderers[trackType];
+    if (renderer)
+        return true;
 
-    if (!codec)
-        return;
+    renderer = createRenderer(trackType);
 
-    if (!renderer) {
-        renderer = createRenderer(trackType);
+    if (!renderer)
+        return false;
 
-        if (!renderer)
-            return;
+    // The renderer takes the rate of the time controller, which includes the catch-up
+    if (m_catchUpFactor != 1.f) {
+        renderer->setPlaybackRate(m_playbackRate);
+        renderer->setCatchUpFactor(m_catchUpFactor);
+    }
 
-        connect(renderer.get(), &Renderer::synchronized, this,
-                &PlaybackEngine::onRendererSynchronized);
+    connect(renderer.get(), &Renderer::synchronized, this,
+            &PlaybackEngine::onRendererSynchronized);
 
-        connect(renderer.get(), &Renderer::loopChanged, this,
-                &PlaybackEngine::onRendererLoopChanged);
+    connect(renderer.get(), &Renderer::loopChanged, this,
+            &PlaybackEngine::onRendererLoopChanged);
 
-        if constexpr (shouldPauseStreams)
-            connect(renderer.get(), &Renderer::forceStepDone, this,
-                    &PlaybackEngine::updateObjectsPausedState);
+    if constexpr (shouldPauseStreams)
+        connect(renderer.get(), &Renderer::forceStepDone, this,
+                &PlaybackEngine::updateObjectsPausedState);
 
-        connect(renderer.get(), &PlaybackEngineObject::atEnd, this,
-                &PlaybackEngine::onRendererFinished);
-    }
+    connect(renderer.get(), &PlaybackEngineObject::atEnd, this,
+            &PlaybackEngine::onRendererFinished);
+
+    return true;
+}
+
+void PlaybackEngine::createStreamDecoder(QPlatformMediaPlayer::TrackType trackType,
+                                         const Codec &codec, qint64 absSeekPos)
+{
+    auto &renderer = m_renderers[trackType];
+    Q_ASSERT(renderer);
 
     auto &stream = m_streams[trackType] =
-            createPlaybackEngineObject<StreamDecoder>(*codec, renderer->seekPosition());
+            createPlaybackEngineObject<StreamDecoder>(codec, absSeekPos);
 
     Q_ASSERT(trackType == stream->trackType());
 
+    m_finalFrameSent[trackType] = false;
+
     connect(stream.get(), &StreamDecoder::requestHandleFrame, renderer.get(), &Renderer::render);
-    connect(stream.get(), &PlaybackEngineObject::atEnd, renderer.get(),
-            &Renderer::onFinalFrameReceived);
+    // The engine decides whether the renderer gets the final frame or the next media
+    connect(stream.get(), &PlaybackEngineObject::atEnd, this,
+            [this, trackType, id = stream->id()]() { onStreamFinished(trackType, id); });
     connect(renderer.get(), &Renderer::frameProcessed, stream.get(),
             &StreamDecoder::onFrameProcessed);
 }
 
+void PlaybackEngine::onStreamFinished(QPlatformMediaPlayer::TrackType trackType, quint64 id)
+{
+    const auto &stream = m_streams[trackType];
+    if (!stream || stream->id() != id)
+        return;
+
+    if (!m_nextMedia) {
+        sendFinalFrame(trackType);
+        return;
+    }
+
+    const bool allStreamsAtEnd = std::all_of(m_streams.begin(), m_streams.end(),
+                                             [](const auto &s) { return !s || s->isAtEnd(); });
+    if (!allStreamsAtEnd)
+        return;
+
+    if (canSpliceNextMedia()) {
+        spliceNextMedia();
+    } else {
+        for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i)
+            sendFinalFrame(static_cast<QPlatformMediaPlayer::TrackType>(i));
+    }
+}
+
+void PlaybackEngine::sendFinalFrame(QPlatformMediaPlayer::TrackType trackType)
+{
+    if (std::exchange(m_finalFrameSent[trackType], true))
+        return;
+
+    if (auto &renderer = m_renderers[trackType])
+        QMetaObject::invokeMethod(renderer.get(), &Renderer::onFinalFrameReceived);
+}
+
+bool PlaybackEngine::canSpliceNextMedia() const
+{
+    if (!m_nextMedia || m_previousMedia || !m_demuxer || !m_demuxer->isAtEnd())
+        return false;
+
+    for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i) {
+        if (m_streams[i] && m_finalFrameSent[i])
+            return false;
+    }
+
+    // Media without a known start needs the initial synchronization of a fresh start
+    const auto &next = m_nextMedia->media;
+    if (!next.isSeekable() || next.duration() <= 0)
+        return false;
+
+    // The video renderer rotates all frames the same way
+    return !m_renderers[QPlatformMediaPlayer::VideoStream]
+            || next.getRotationAngle() == m_media.getRotationAngle();
+}
+
+void PlaybackEngine::spliceNextMedia()
+{
+    const LoopOffset offset = m_demuxer->endOffset();
+
+    qCDebug(qLcPlaybackEngine) << "Splice next media, offset:" << offset.pos
+                               << "index:" << offset.index;
+
+    m_demuxer.reset();
+    m_streams = defaultObjectsArray<decltype(m_streams)>();
+
+    m_previousMedia = MediaWithCodecs{ std::move(m_media), std::exchange(m_codecs, {}) };
+    m_previousMediaOffset = m_mediaOffset;
+    m_media = std::move(m_nextMedia->media);
+    m_codecs = std::move(m_nextMedia->codecs);
+    m_nextMedia.reset();
+    m_mediaOffset = offset;
+
+    // The renderers keep their queued frames; the new ones follow at the offset
+    for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i) {
+        const auto trackType = static_cast<QPlatformMediaPlayer::TrackType>(i);
+        auto codec = codecForTrack(trackType);
+        if (codec && ensureRenderer(trackType))
+            createStreamDecoder(trackType, *codec, offset.pos);
+        else
+            sendFinalFrame(trackType);
+    }
+
+    createDemuxer({ 0, offset });
+    updateObjectsPausedState();
+}
+
+bool PlaybackEngine::cancelSplice()
+{
+    if (!m_previousMedia)
+        return false;
+
+    qCDebug(qLcPlaybackEngine) << "Cancel splicing the next media";
+
+    // The renderers hold frames of both media
+    forEachExistingObject([](auto &object) { object.reset(); });
+
+    MediaWithCodecs next{ std::move(m_media), std::exchange(m_codecs, {}) };
+    m_media = std::move(m_previousMedia->media);
+    m_codecs = std::move(m_previousMedia->codecs);
+    m_mediaOffset = m_previousMediaOffset;
+    m_previousMedia.reset();
+    m_nextMedia = std::move(next);
+
+    return true;
+}
+
+const MediaDataHolder &PlaybackEngine::reportedMedia() const
+{
+    return m_previousMedia ? m_previousMedia->media : m_media;
+}
+
 std::optional<Codec> PlaybackEngine::codecForTrack(QPlatformMediaPlayer::TrackType trackType)
 {
     const auto streamIndex = m_media.currentStreamIndex(trackType);
@@ -377,7 +619,8 @@ std::optional<Codec> PlaybackEngine::codecForTrack(QPlatformMediaPlayer::TrackTy
     if (!result) {
         qCDebug(qLcPlaybackEngine)
                 << "Create codec for stream:" << streamIndex << "trackType:" << trackType;
-        auto maybeCodec = Codec::create(m_media.avContext()->streams[streamIndex]);
+        auto maybeCodec = Codec::create(m_media.avContext()->streams[streamIndex],
+                                        m_media.isLowLatency(), m_media.decodingLowres());
 
         if (!maybeCodec) {
             emit errorOccured(QMediaPlayer::FormatError,
@@ -397,7 +640,7 @@ bool PlaybackEngine::hasMediaStream() const
             || m_renderers[QPlatformMediaPlayer::VideoStream];
 }
 
-void PlaybackEngine::createDemuxer()
+void PlaybackEngine::createDemuxer(const PositionWithOffset &positionWithOffset)
 {
     std::array<int, QPlatformMediaPlayer::NTrackTypes> streamIndexes = { -1, -1, -1 };
 
@@ -411,10 +654,10 @@ void PlaybackEngine::createDemuxer()
     if (!hasStreams)
         return;
 
-    const PositionWithOffset positionWithOffset{ currentPosition(false), m_currentLoopOffset };
-
     m_demuxer = createPlaybackEngineObject<Demuxer>(m_media.avContext(), positionWithOffset,
-                                                    streamIndexes, m_loops);
+                                                    streamIndexes, demuxerLoops(),
+                                                    m_media.keyframeIndex(),
+                                                    m_media.isLowLatency());
 
     forEachExistingObject<StreamDecoder>([&](auto &stream) {
         connect(m_demuxer.get(), Demuxer::signalByTrackType(stream->trackType()), stream.get(),
@@ -425,7 +668,7 @@ void PlaybackEngine::createDemuxer()
                 &Demuxer::onPacketProcessed);
     });
 
-    if (!isSeekable() || duration() <= 0) {
+    if (!m_media.isSeekable() || m_media.duration() <= 0) {
         // We need initial synchronization for such streams
         forEachExistingObject([&](auto &object) {
             using Type = std::remove_reference_t<decltype(*object)>;
@@ -450,11 +693,11 @@ void PlaybackEngine::deleteFreeThreads() {
         m_threads.insert(freeThreads.extract(objectThreadName(*object)));
     });
 
+    std::vector<std::unique_ptr<QThread>> threads;
     for (auto &[name, thr] : freeThreads)
-        thr->quit();
+        threads.push_back(std::move(thr));
 
-    for (auto &[name, thr] : freeThreads)
-        thr->wait();
+    IdleThreadPool::release(std::move(threads));
 }
 
 void PlaybackEngine::setMedia(MediaDataHolder media)
@@ -465,6 +708,51 @@ void PlaybackEngine::setMedia(MediaDataHolder media)
 
     m_media = std::move(media);
     updateVideoSinkSize();
+
+    if (m_media.isLowLatency())
+        m_latencyTimer.start();
+}
+
+PlaybackEngine::Codecs PlaybackEngine::createCodecs(MediaDataHolder &media)
+{
+    Codecs codecs;
+    for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i) {
+        const auto streamIndex =
+                media.currentStreamIndex(static_cast<QPlatformMediaPlayer::TrackType>(i));
+        if (streamIndex < 0)
+            continue;
+
+        // Failures are reported once the engine needs the codec
+        auto maybeCodec = Codec::create(media.avContext()->streams[streamIndex],
+                                        media.isLowLatency(), media.decodingLowres());
+        if (maybeCodec)
+            codecs[i] = maybeCodec.value();
+    }
+    return codecs;
+}
+
+void PlaybackEngine::setNextMedia(MediaDataHolder media, Codecs codecs)
+{
+    qCDebug(qLcPlaybackEngine) << "Set next media, duration:" << media.duration();
+
+    m_nextMedia = MediaWithCodecs{ std::move(media), std::move(codecs) };
+}
+
+void PlaybackEngine::clearNextMedia()
+{
+    const bool spliceCancelled = cancelSplice();
+    m_nextMedia.reset();
+
+    if (spliceCancelled) {
+        forceUpdate();
+        return;
+    }
+
+    // Streams that have finished while waiting for the next media
+    for (int i = 0; i < QPlatformMediaPlayer::NTrackTypes; ++i) {
+        if (m_streams[i] && m_streams[i]->isAtEnd())
+            sendFinalFrame(static_cast<QPlatformMediaPlayer::TrackType>(i));
+    }
 }
 
 void PlaybackEngine::setVideoSink(QVideoSink *sink)
@@ -518,36 +806,59 @@ qint64 PlaybackEngine::currentPosition(bool topPos) const {
                          : std::min(*pos, rendererPos);
     }
 
-    return boundPosition(pos ? *pos : m_timeController.currentPosition());
+    return boundPosition((pos ? *pos : m_timeController.currentPosition())
+                         - m_currentLoopOffset.pos);
 }
 
 qint64 PlaybackEngine::duration() const
 {
-    return m_media.duration();
+    return reportedMedia().duration();
 }
 
-bool PlaybackEngine::isSeekable() const { return m_media.isSeekable(); }
+qint64 PlaybackEngine::bufferedPosition() const
+{
+    if (!m_demuxer)
+        return -1;
+    if (m_demuxer->isAtEnd() && duration() > 0)
+        return duration();
+    return boundPosition(m_demuxer->bufferedPosition() - m_currentLoopOffset.pos);
+}
+
+float PlaybackEngine::bufferFillLevel() const
+{
+    if (!m_demuxer)
+        return 0.f;
+    return m_demuxer->isAtEnd() ? 1.f : std::min(m_demuxer->fillLevel(), 1.f);
+}
+
+bool PlaybackEngine::isSeekable() const { return reportedMedia().isSeekable(); }
 
 const QList<MediaDataHolder::StreamInfo> &
 PlaybackEngine::streamInfo(QPlatformMediaPlayer::TrackType trackType) const
 {
-    return m_media.streamInfo(trackType);
+    return reportedMedia().streamInfo(trackType);
 }
 
 const QMediaMetaData &PlaybackEngine::metaData() const
 {
-    return m_media.metaData();
+    return reportedMedia().metaData();
 }
 
 int PlaybackEngine::activeTrack(QPlatformMediaPlayer::TrackType type) const
 {
-    return m_media.activeTrack(type);
+    return reportedMedia().activeTrack(type);
 }
 
 void PlaybackEngine::setActiveTrack(QPlatformMediaPlayer::TrackType trackType, int streamNumber)
 {
-    if (!m_media.setActiveTrack(trackType, streamNumber))
+    // The track numbers refer to the reported media
+    const bool spliceCancelled = cancelSplice();
+
+    if (!m_media.setActiveTrack(trackType, streamNumber)) {
+        if (spliceCancelled)
+            forceUpdate();
         return;
+    }
 
     m_codecs[trackType] = {};
 
@@ -564,9 +875,12 @@ void PlaybackEngine::finilizeTime(qint64 pos)
 {
     Q_ASSERT(pos >= 0 && pos <= duration());
 
+    cancelSplice();
+
     m_timeController.setPaused(true);
     m_timeController.sync(pos);
     m_currentLoopOffset = {};
+    m_mediaOffset = {};
 }
 
 void PlaybackEngine::finalizeOutputs()
@@ -607,7 +921,9 @@ void PlaybackEngine::updateVideoSinkSize(QVideoSink *prevSink)
     if (prevSink && prevSink->platformVideoSink())
         platformVideoSink->setNativeSize(prevSink->platformVideoSink()->nativeSize());
     else if (auto size = metaData().value(QMediaMetaData::Resolution); size.isValid())
-        platformVideoSink->setNativeSize(size.value<QSize>());
+        // The size of the frames to come, so that it doesn't change with the first one
+        platformVideoSink->setNativeSize(
+                lowresFrameSize(size.value<QSize>(), m_media.decodingLowres()));
 }
 
 qint64 PlaybackEngine::boundPosition(qint64 position) const
@@ -34,6 +34,8 @@
  *   have free threads. If it does, the thread is to be reused.
  * - If all objects for some thread are deleted, the thread becomes free and the engine
  *   postpones its termination.
+ * - Threads are taken from and given back to IdleThreadPool, which keeps free threads
+ *   running for a while to be reused by the next engines.
  *
  * OBJECTS WEAK CONNECTIVITY
  *
@@ -43,6 +45,15 @@
  * - PlaybackEngine knows the objects object and is able to create/delete them and
  *   call their public methods.
  *
+ * GAPLESS SWITCHING
+ *
+ * - The next media, together with its codecs, can be opened in advance.
+ *   When the stream decoders have decoded everything of the current media, the engine
+ *   replaces the demuxer and the decoders, while the renderers keep playing what's
+ *   left in their queues. The next media starts at the end offset of the current one,
+ *   like another loop would, so the frames of both follow each other on the same
+ *   timeline; the switch is reported once the renderers get there.
+ *
  */
 
 #include "playbackengine/qffmpegplaybackenginedefs_p.h"
@@ -52,6 +63,7 @@
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
 
 #include <QtCore/qpointer.h>
+#include <QtCore/qtimer.h>
 
 #include <unordered_map>
 
@@ -75,6 +87,16 @@ public:
 
     void setMedia(MediaDataHolder media);
 
+    using Codecs = std::array<std::optional<Codec>, QPlatformMediaPlayer::NTrackTypes>;
+
+    // Creates the codecs of the active tracks; can be called on any thread
+    static Codecs createCodecs(MediaDataHolder &media);
+
+    // Sets the media to continue with after the current one
+    void setNextMedia(MediaDataHolder media, Codecs codecs);
+
+    void clearNextMedia();
+
     void setVideoSink(QVideoSink *sink);
 
     void setAudioSink(QAudioOutput *output);
@@ -107,6 +129,17 @@ public:
 
     qint64 duration() const;
 
+    // Position up to which the media has been demuxed ahead of playback,
+    // or -1 if nothing is being demuxed
+    qint64 bufferedPosition() const;
+
+    // How full the demuxer's buffers are, from 0 to 1
+    float bufferFillLevel() const;
+
+    // How far the playback is behind the live edge in microseconds, or -1 if unknown.
+    // Only measured for low latency media.
+    qint64 latency() const;
+
     bool isSeekable() const;
 
     const QList<MediaDataHolder::StreamInfo> &
@@ -120,6 +153,8 @@ signals:
     void endOfStream();
     void errorOccured(int, const QString &);
     void loopChanged();
+    void nextMediaStarted();
+    void latencyChanged(qint64 latency);
 
 protected: // objects managing
     struct ObjectDeleter
@@ -147,7 +182,14 @@ protected: // objects managing
 private:
     void createStreamAndRenderer(QPlatformMediaPlayer::TrackType trackType);
 
-    void createDemuxer();
+    bool ensureRenderer(QPlatformMediaPlayer::TrackType trackType);
+
+    void createStreamDecoder(QPlatformMediaPlayer::TrackType trackType, const Codec &codec,
+                             qint64 absSeekPos);
+
+    void createDemuxer(const PositionWithOffset &positionWithOffset);
+
+    int demuxerLoops() const;
 
     void registerObject(PlaybackEngineObject &object);
 
@@ -174,8 +216,28 @@ private:
 
     void onRendererLoopChanged(quint64 id, qint64 offset, int loopIndex);
 
+    void onStreamFinished(QPlatformMediaPlayer::TrackType trackType, quint64 id);
+
+    void sendFinalFrame(QPlatformMediaPlayer::TrackType trackType);
+
+    bool canSpliceNextMedia() const;
+
+    void spliceNextMedia();
+
+    bool cancelSplice();
+
+    // The media whose playback is reported; the previous one until the renderers
+    // get to a spliced media
+    const MediaDataHolder &reportedMedia() const;
+
     void triggerStepIfNeeded();
 
+    // Plays faster than the user's rate to catch up in low latency playback.
+    // The audio renderer drops samples for it rather than resampling anew.
+    void setCatchUpFactor(float factor);
+
+    void updateLatency();
+
     static QString objectThreadName(const PlaybackEngineObject &object);
 
     std::optional<Codec> codecForTrack(QPlatformMediaPlayer::TrackType trackType);
@@ -193,9 +255,27 @@ private:
     qint64 boundPosition(qint64 position) const;
 
 private:
+    struct MediaWithCodecs
+    {
+        MediaDataHolder media;
+        Codecs codecs;
+    };
+
     MediaDataHolder m_media;
+    // Where m_media starts on the timeline of the renderers
+    LoopOffset m_mediaOffset;
+    std::optional<MediaWithCodecs> m_nextMedia;
+    // The media spliced away from, while its last frames are still being rendered
+    std::optional<MediaWithCodecs> m_previousMedia;
+    LoopOffset m_previousMediaOffset;
 
     TimeController m_timeController;
+    // The rate set by the user; the time controller may run faster to catch up
+    float m_playbackRate = 1.f;
+    float m_catchUpFactor = 1.f;
+
+    QTimer m_latencyTimer;
+    qint64 m_latency = -1;
 
     std::unordered_map<QString, std::unique_ptr<QThread>> m_threads;
     bool m_threadsDirty = false;
@@ -209,7 +289,8 @@ private:
     std::array<StreamPtr, QPlatformMediaPlayer::NTrackTypes> m_streams;
     std::array<RendererPtr, QPlatformMediaPlayer::NTrackTypes> m_renderers;
 
-    std::array<std::optional<Codec>, QPlatformMediaPlayer::NTrackTypes> m_codecs;
+    Codecs m_codecs;
+    std::array<bool, QPlatformMediaPlayer::NTrackTypes> m_finalFrameSent = {};
     int m_loops = QMediaPlayer::Once;
     LoopOffset m_currentLoopOffset;
 };
@@ -130,6 +130,37 @@ void QAmbientSound::setAutoPlay(bool autoPlay)
         emit autoPlayChanged();
 }
 
+/*!
+    \property QAmbientSound::streaming
+    \since 6.7
+
+    Determines whether the sound file is decoded while playing instead of
+    being decoded completely upfront.
+
+    Streamed sounds only keep a short amount of decoded data ahead of the
+    current playback position in memory, which makes them suitable for long
+    sounds like background music. Their decoded data is not shared with
+    other sounds playing the same file.
+
+    Changing this property restarts loading the source.
+
+    The default value is \c false.
+ */
+bool QAmbientSound::isStreaming() const
+{
+    return d->streaming;
+}
+
+void QAmbientSound::setStreaming(bool streaming)
+{
+    if (d->streaming == streaming)
+        return;
+    d->streaming = streaming;
+    if (!d->url.isEmpty())
+        d->load();
+    emit streamingChanged();
+}
+
 /*!
     Starts playing back the sound. Does nothing if the sound is already playing.
  */
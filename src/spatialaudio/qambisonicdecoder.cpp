@@ -3,8 +3,12 @@
 #include "qambisonicdecoder_p.h"
 
 #include "qambisonicdecoderdata_p.h"
+#include <base/simd_utils.h>
 #include <cmath>
 #include <qdebug.h>
+#include <private/qaudioconversionhelper_p.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
@@ -98,31 +102,30 @@ public:
         b1_hf = -2.f*b0_hf;
     }
 
-    struct Output
-    {
-        float lf;
-        float hf;
-    };
-
-    Output next(float x)
+    // Splits n samples of input into their low and high frequency parts.
+    // The filter is recursive, so this runs sample by sample, but keeps the
+    // state in registers for the whole block.
+    void process(const float *input, float *lf, float *hf, int n)
     {
-        float r_lf = x*b0_lf +
-                  prevX[0]*b1_lf +
-                  prevX[1]*b0_lf -
-                  prevR_lf[0]*a1 -
-                  prevR_lf[1]*a2;
-        float r_hf = x*b0_hf +
-                  prevX[0]*b1_hf +
-                  prevX[1]*b0_hf -
-                  prevR_hf[0]*a1 -
-                  prevR_hf[1]*a2;
-        prevX[1] = prevX[0];
-        prevX[0] = x;
-        prevR_lf[1] = prevR_lf[0];
-        prevR_lf[0] = r_lf;
-        prevR_hf[1] = prevR_hf[0];
-        prevR_hf[0] = r_hf;
-        return { r_lf, r_hf };
+        float x1 = prevX[0], x2 = prevX[1];
+        float lf1 = prevR_lf[0], lf2 = prevR_lf[1];
+        float hf1 = prevR_hf[0], hf2 = prevR_hf[1];
+        for (int i = 0; i < n; ++i) {
+            const float x = input[i];
+            const float r_lf = x*b0_lf + x1*b1_lf + x2*b0_lf - lf1*a1 - lf2*a2;
+            const float r_hf = x*b0_hf + x1*b1_hf + x2*b0_hf - hf1*a1 - hf2*a2;
+            x2 = x1;
+            x1 = x;
+            lf2 = lf1;
+            lf1 = r_lf;
+            hf2 = hf1;
+            hf1 = r_hf;
+            lf[i] = r_lf;
+            hf[i] = r_hf;
+        }
+        prevX[0] = x1; prevX[1] = x2;
+        prevR_lf[0] = lf1; prevR_lf[1] = lf2;
+        prevR_hf[0] = hf1; prevR_hf[1] = hf2;
     }
 
 private:
@@ -143,10 +146,15 @@ private:
 
 QAmbisonicDecoder::QAmbisonicDecoder(AmbisonicLevel ambisonicLevel, const QAudioFormat &format)
     : level(ambisonicLevel)
+    , mixBuffer(new MixBuffer)
 {
     Q_ASSERT(level > 0 && level <= 3);
     inputChannels = (level+1)*(level+1);
     outputChannels = format.channelCount();
+    if (outputChannels > maxOutputChannels) {
+        outputChannels = 0;
+        return;
+    }
 
     channelConfig = format.channelConfig();
     if (channelConfig == QAudioFormat::ChannelConfigUnknown)
@@ -218,6 +226,7 @@ QAmbisonicDecoder::QAmbisonicDecoder(AmbisonicLevel ambisonicLevel, const QAudio
     filters = new QAmbisonicDecoderFilter[inputChannels];
     for (int i = 0; i < inputChannels; ++i)
         filters[i].configure(format.sampleRate());
+    bands.reset(new BandBuffers);
 }
 
 QAmbisonicDecoder::~QAmbisonicDecoder()
@@ -230,32 +239,8 @@ QAmbisonicDecoder::~QAmbisonicDecoder()
 
 void QAmbisonicDecoder::processBuffer(const float *input[], float *output, int nSamples)
 {
-    float *o = output;
-    memset(o, 0, nSamples*outputChannels*sizeof(float));
-
-    if (simpleDecoderFactors) {
-        for (int i = 0; i < nSamples; ++i) {
-            for (int j = 0; j < 4; ++j) {
-                for (int k = 0; k < outputChannels; ++k)
-                    o[k] += simpleDecoderFactors[k*4 + j]*input[j][i];
-            }
-            o += outputChannels;
-        }
-        return;
-    }
-
-    const float *matrix_hi = decoderData->hf[level - 1];
-    const float *matrix_lo = decoderData->lf[level - 1];
-    for (int i = 0; i < nSamples; ++i) {
-        QAmbisonicDecoderFilter::Output buf[maxAmbisonicChannels];
-        for (int j = 0; j < inputChannels; ++j)
-            buf[j] = filters[j].next(input[j][i]);
-        for (int j = 0; j < inputChannels; ++j) {
-            for (int k = 0; k < outputChannels; ++k)
-                o[k] += matrix_lo[k*inputChannels + j]*buf[j].lf + matrix_hi[k*inputChannels + j]*buf[j].hf;
-        }
-        o += outputChannels;
-    }
+    const float *reverb[] = { nullptr, nullptr };
+    return processBufferWithReverb(input, reverb, output, nSamples);
 }
 
 void QAmbisonicDecoder::processBuffer(const float *input[], short *output, int nSamples)
@@ -264,50 +249,97 @@ void QAmbisonicDecoder::processBuffer(const float *input[], short *output, int n
     return processBufferWithReverb(input, reverb, output, nSamples);
 }
 
+namespace {
+void interleave(const float *const *planes, int channels, float *output, int nSamples,
+                float * /*scratch*/)
+{
+    if (channels == 2)
+        vraudio::InterleaveStereo(nSamples, planes[0], planes[1], output);
+    else
+        QAudioHelperInternal::interleave(planes, channels, output, nSamples);
+}
+
+// Rounds and saturates like all other conversions to integer samples
+void interleave(const float *const *planes, int channels, short *output, int nSamples,
+                float *scratch)
+{
+    interleave(planes, channels, scratch, nSamples, nullptr);
+    QAudioHelperInternal::convertSamples(scratch, QAudioFormat::Float, output,
+                                         QAudioFormat::Int16, nSamples * channels);
+}
+
+inline void accumulate(int nSamples, float gain, const float *input, float *output)
+{
+    if (gain != 0.f)
+        vraudio::ScalarMultiplyAndAccumulate(nSamples, gain, input, output);
+}
+}
+
 void QAmbisonicDecoder::processBufferWithReverb(const float *input[], const float *reverb[2], short *output, int nSamples)
 {
-    if (simpleDecoderFactors) {
-        for (int i = 0; i < nSamples; ++i) {
-            float o[4] = {};
+    processBufferWithReverbImpl(input, reverb, output, nSamples);
+}
+
+void QAmbisonicDecoder::processBufferWithReverb(const float *input[], const float *reverb[2], float *output, int nSamples)
+{
+    processBufferWithReverbImpl(input, reverb, output, nSamples);
+}
+
+// The decoding matrix and the reverb are applied on planar data, one output
+// channel at a time, using Resonance Audio's SIMD routines, and the result is
+// interleaved at the end. Long buffers are processed in chunks that fit into
+// the scratch buffers.
+template<typename T>
+void QAmbisonicDecoder::processBufferWithReverbImpl(const float *input[], const float *reverb[2], T *output, int nSamples)
+{
+    const float *in[maxAmbisonicChannels];
+    const int nIn = simpleDecoderFactors ? 4 : inputChannels;
+    std::copy_n(input, nIn, in);
+    const float *rev[2] = { reverb[0], reverb[1] };
+
+    float *out[maxOutputChannels];
+    for (int k = 0; k < outputChannels; ++k)
+        out[k] = mixBuffer->out[k];
+
+    while (nSamples > 0) {
+        const int n = qMin(nSamples, chunkSize);
+        for (int k = 0; k < outputChannels; ++k)
+            std::fill_n(out[k], n, 0.f);
+
+        if (simpleDecoderFactors) {
             for (int k = 0; k < outputChannels; ++k) {
                 for (int j = 0; j < 4; ++j)
-                    o[k] += simpleDecoderFactors[k*4 + j]*input[j][i];
+                    accumulate(n, simpleDecoderFactors[k*4 + j], in[j], out[k]);
             }
-            if (reverb[0]) {
-                for (int k = 0; k < outputChannels; ++k) {
-                    o[k] += reverb[0][i]*reverbFactors[2*k] + reverb[1][i]*reverbFactors[2*k+1];
+        } else {
+            const float *matrix_hi = decoderData->hf[level - 1];
+            const float *matrix_lo = decoderData->lf[level - 1];
+            for (int j = 0; j < inputChannels; ++j)
+                filters[j].process(in[j], bands->lf[j], bands->hf[j], n);
+            for (int k = 0; k < outputChannels; ++k) {
+                for (int j = 0; j < inputChannels; ++j) {
+                    accumulate(n, matrix_lo[k*inputChannels + j], bands->lf[j], out[k]);
+                    accumulate(n, matrix_hi[k*inputChannels + j], bands->hf[j], out[k]);
                 }
             }
-
-            for (int k = 0; k < outputChannels; ++k)
-                output[k] = static_cast<short>(o[k]*32768.);
-            output += outputChannels;
         }
-        return;
-    }
 
-    //    qDebug() << "XXX" << inputChannels << outputChannels;
-    const float *matrix_hi = decoderData->hf[level - 1];
-    const float *matrix_lo = decoderData->lf[level - 1];
-    for (int i = 0; i < nSamples; ++i) {
-        QAmbisonicDecoderFilter::Output buf[maxAmbisonicChannels];
-        for (int j = 0; j < inputChannels; ++j)
-            buf[j] = filters[j].next(input[j][i]);
-        float o[32] = {}; // we can't support more than 32 channels from our API
-        for (int j = 0; j < inputChannels; ++j) {
-            for (int k = 0; k < outputChannels; ++k)
-                o[k] += matrix_lo[k*inputChannels + j]*buf[j].lf + matrix_hi[k*inputChannels + j]*buf[j].hf;
-        }
-        if (reverb[0]) {
+        if (rev[0]) {
             for (int k = 0; k < outputChannels; ++k) {
-                o[k] += reverb[0][i]*reverbFactors[2*k] + reverb[1][i]*reverbFactors[2*k+1];
+                accumulate(n, reverbFactors[2*k], rev[0], out[k]);
+                accumulate(n, reverbFactors[2*k + 1], rev[1], out[k]);
             }
+            rev[0] += n;
+            rev[1] += n;
         }
-        for (int k = 0; k < outputChannels; ++k)
-            output[k] = static_cast<short>(o[k]*32768.);
-        output += outputChannels;
-    }
 
+        interleave(out, outputChannels, output, n, mixBuffer->interleaved);
+
+        for (int j = 0; j < nIn; ++j)
+            in[j] += n;
+        output += n*outputChannels;
+        nSamples -= n;
+    }
 }
 
 QT_END_NAMESPACE
@@ -14,15 +14,17 @@
 // We mean it.
 //
 
-#include <qtspatialaudioglobal_p.h>
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
 #include <qaudioformat.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 struct QAmbisonicDecoderData;
 class QAmbisonicDecoderFilter;
 
-class QAmbisonicDecoder
+class Q_SPATIALAUDIO_EXPORT QAmbisonicDecoder
 {
 public:
     enum AmbisonicLevel
@@ -49,10 +51,29 @@ public:
     void processBuffer(const float *input[], short *output, int nSamples);
 
     void processBufferWithReverb(const float *input[], const float *reverb[2], short *output, int nSamples);
+    void processBufferWithReverb(const float *input[], const float *reverb[2], float *output, int nSamples);
 
     static constexpr int maxAmbisonicChannels = 16;
     static constexpr int maxAmbisonicLevel = 3;
+    static constexpr int maxOutputChannels = 8;
 private:
+    // frames processed at a time, and the planar scratch buffers for them
+    static constexpr int chunkSize = 256;
+    struct BandBuffers
+    {
+        alignas(64) float lf[maxAmbisonicChannels][chunkSize];
+        alignas(64) float hf[maxAmbisonicChannels][chunkSize];
+    };
+    struct MixBuffer
+    {
+        alignas(64) float out[maxOutputChannels][chunkSize];
+        // interleaved float frames before the conversion to integer samples
+        alignas(64) float interleaved[maxOutputChannels * chunkSize];
+    };
+
+    template<typename T>
+    void processBufferWithReverbImpl(const float *input[], const float *reverb[2], T *output, int nSamples);
+
     QAudioFormat::ChannelConfig channelConfig;
     AmbisonicLevel level = AmbisonicLevel1;
     int inputChannels = 0;
@@ -61,6 +82,8 @@ private:
     QAmbisonicDecoderFilter *filters = nullptr;
     float *simpleDecoderFactors = nullptr;
     const float *reverbFactors = nullptr;
+    std::unique_ptr<MixBuffer> mixBuffer;
+    std::unique_ptr<BandBuffers> bands;
 };
 
 
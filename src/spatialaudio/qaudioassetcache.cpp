@@ -0,0 +1,429 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#include "qaudioassetcache_p.h"
+#include <qdebug.h>
+#include <qloggingcategory.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcStreamedAudio, "qt.spatialaudio.streaming");
+
+static bool setDecoderSource(QAudioDecoder *decoder, const QUrl &url,
+                             std::unique_ptr<QFile> &sourceDeviceFile)
+{
+    if (url.scheme().compare(u"qrc", Qt::CaseInsensitive) == 0) {
+        auto qrcFile = std::make_unique<QFile>(u':' + url.path());
+        if (!qrcFile->open(QFile::ReadOnly))
+            return false;
+        sourceDeviceFile = std::move(qrcFile);
+        decoder->setSourceDevice(sourceDeviceFile.get());
+    } else {
+        decoder->setSource(url);
+    }
+    return true;
+}
+
+QDecodedAudioAsset::QDecodedAudioAsset(const QUrl &url, const QAudioFormat &format)
+    : url(url)
+    , format(format)
+    , m_decoder(new QAudioDecoder)
+{
+    m_decoder->setAudioFormat(format);
+    if (!setDecoderSource(m_decoder.get(), url, m_sourceDeviceFile)) {
+        m_failed = true;
+        m_loading = false;
+        return;
+    }
+    connect(m_decoder.get(), &QAudioDecoder::bufferReady, this, &QDecodedAudioAsset::bufferReady);
+    connect(m_decoder.get(), &QAudioDecoder::finished, this, &QDecodedAudioAsset::finished);
+    connect(m_decoder.get(), qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QDecodedAudioAsset::error);
+    m_decoder->start();
+}
+
+QDecodedAudioAsset::~QDecodedAudioAsset() = default;
+
+void QDecodedAudioAsset::bufferReady()
+{
+    // Some decoders report the end of the file from within read(), the last
+    // buffer has to be appended before loading is marked as done
+    m_inDecoderRead = true;
+    const QAudioBuffer b = m_decoder->read();
+    m_inDecoderRead = false;
+    if (b.isValid()) {
+        append(b);
+        m_byteCount.fetchAndAddRelaxed(b.byteCount());
+        emit bufferAdded();
+    }
+    if (std::exchange(m_finishedInRead, false))
+        finished();
+}
+
+void QDecodedAudioAsset::append(const QAudioBuffer &buffer)
+{
+    const qsizetype count = m_count.load(std::memory_order_relaxed);
+    BufferTable *table = m_table.load(std::memory_order_relaxed);
+    if (!table || count == table->capacity) {
+        // Readers may still use the old table, so copy into a new one and
+        // publish it before the count that requires it
+        auto newTable = std::make_unique<BufferTable>(table ? 2 * table->capacity : 64);
+        std::copy_n(table ? table->buffers.get() : nullptr, count, newTable->buffers.get());
+        table = newTable.get();
+        m_tables.push_back(std::move(newTable));
+        m_table.store(table, std::memory_order_release);
+    }
+    table->buffers[count] = buffer;
+    m_count.store(count + 1, std::memory_order_release);
+}
+
+void QDecodedAudioAsset::finished()
+{
+    if (!m_decoder)
+        return;
+    if (m_inDecoderRead) {
+        m_finishedInRead = true;
+        return;
+    }
+    m_loading.store(false, std::memory_order_release);
+    // The decoded data is all we need from here on
+    m_decoder->disconnect(this);
+    m_decoder.release()->deleteLater();
+    m_sourceDeviceFile.reset();
+    emit loadingFinished();
+}
+
+void QDecodedAudioAsset::error(QAudioDecoder::Error)
+{
+    qWarning() << "Failed to decode" << url << m_decoder->errorString();
+    m_failed = true;
+    finished();
+}
+
+QStreamedAudioAsset::QStreamedAudioAsset(const QUrl &url, const QAudioFormat &format,
+                                         qint64 prefetchFrames)
+    : url(url)
+    , format(format)
+    , prefetchFrames(prefetchFrames)
+    // often enough to refill before the reader could drain the prefetched data
+    , m_maxPollInterval(qMax(pollInterval, int(format.durationForFrames(prefetchFrames) / 4000)))
+    , m_decoder(new QAudioDecoder)
+    , m_queue(new Entry[queueCapacity])
+{
+    m_decoder->setAudioFormat(format);
+    if (!setDecoderSource(m_decoder.get(), url, m_sourceDeviceFile)) {
+        m_failed = true;
+        return;
+    }
+    connect(m_decoder.get(), &QAudioDecoder::bufferReady, this, &QStreamedAudioAsset::bufferReady);
+    connect(m_decoder.get(), &QAudioDecoder::finished, this, &QStreamedAudioAsset::finished);
+    connect(m_decoder.get(), qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QStreamedAudioAsset::error);
+    connect(&m_pollTimer, &QTimer::timeout, this, &QStreamedAudioAsset::poll);
+    m_decoder->start();
+}
+
+QStreamedAudioAsset::~QStreamedAudioAsset() = default;
+
+int QStreamedAudioAsset::read(float *dst, int frames, bool *endOfFile)
+{
+    const quint32 generation = m_generation.load(std::memory_order_acquire);
+    if (generation != m_readGeneration) {
+        m_readGeneration = generation;
+        m_readPos = 0;
+    }
+
+    const int channels = format.channelCount();
+    quint64 readIndex = m_readIndex.load(std::memory_order_relaxed);
+    const quint64 writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    int copied = 0;
+    while (copied < frames && readIndex != writeIndex) {
+        const Entry &e = m_queue[readIndex % queueCapacity];
+        if (e.generation != generation) {
+            // left over from before a rewind
+            ++readIndex;
+            m_readPos = 0;
+            continue;
+        }
+        if (e.endOfFile) {
+            ++readIndex;
+            *endOfFile = true;
+            break;
+        }
+        const QAudioBuffer &b = e.buffer;
+        const int toCopy = qMin(b.frameCount() - m_readPos, frames - copied);
+        memcpy(dst + copied * channels, b.constData<float>() + m_readPos * channels,
+               toCopy * channels * sizeof(float));
+        copied += toCopy;
+        m_readPos += toCopy;
+        if (m_readPos == b.frameCount()) {
+            ++readIndex;
+            m_readPos = 0;
+        }
+    }
+    // The producer releases the data of consumed entries, so that no memory
+    // gets freed on the audio thread
+    m_readIndex.store(readIndex, std::memory_order_release);
+
+    const quint64 progress = m_readProgress.load(std::memory_order_relaxed);
+    const quint64 readFrames = (progress >> frameBits) == (generation & generationMask)
+            ? (progress & frameMask) + copied
+            : copied;
+    m_readProgress.store((quint64(generation & generationMask) << frameBits) | readFrames,
+                         std::memory_order_release);
+
+    if (copied)
+        m_inUnderrun = false;
+
+    if (bufferedFrames() < prefetchFrames)
+        m_fillRequested.store(true, std::memory_order_relaxed);
+    return copied;
+}
+
+void QStreamedAudioAsset::recordUnderrun(int missingFrames)
+{
+    if (m_inUnderrun)
+        return;
+    m_inUnderrun = true;
+    m_lastUnderrunFrames.store(missingFrames, std::memory_order_relaxed);
+    m_underruns.fetchAndAddRelaxed(1);
+}
+
+void QStreamedAudioAsset::poll()
+{
+    reportUnderruns();
+    if (m_fillRequested.exchange(false, std::memory_order_relaxed)) {
+        m_pollTimer.setInterval(pollInterval);
+        fill();
+    } else {
+        // nothing has been read since the last poll, e.g. while paused
+        m_pollTimer.setInterval(qMin(m_pollTimer.interval() * 2, m_maxPollInterval));
+    }
+}
+
+void QStreamedAudioAsset::updatePolling()
+{
+    // The reader never posts events, so the producer has to poll for room in
+    // the queue, but only while it holds data back
+    if (!(m_pendingBuffer || m_pendingEndOfFile) || m_failed.loadRelaxed())
+        m_pollTimer.stop();
+    else if (!m_pollTimer.isActive())
+        m_pollTimer.start(pollInterval);
+}
+
+void QStreamedAudioAsset::reportUnderruns()
+{
+    const int underruns = m_underruns.loadRelaxed();
+    if (underruns != m_reportedUnderruns) {
+        m_reportedUnderruns = underruns;
+        qCDebug(qLcStreamedAudio) << "underrun of"
+                                  << m_lastUnderrunFrames.load(std::memory_order_relaxed)
+                                  << "frames in" << url << "total:" << underruns
+                                  << "buffered:" << bufferedFrames();
+    }
+}
+
+qint64 QStreamedAudioAsset::bufferedFrames() const
+{
+    // only data of the current generation counts, stale entries are skipped
+    // by the reader and released soon after
+    const quint32 generation = m_generation.load(std::memory_order_acquire) & generationMask;
+    const quint64 progress = m_readProgress.load(std::memory_order_acquire);
+    const qint64 readFrames =
+            (progress >> frameBits) == generation ? qint64(progress & frameMask) : 0;
+    return qMax<qint64>(m_writtenFrames.load(std::memory_order_relaxed) - readFrames, 0);
+}
+
+void QStreamedAudioAsset::rewind()
+{
+    m_writtenFrames.store(0, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+    m_pendingEndOfFile = false;
+    restartDecoder();
+}
+
+void QStreamedAudioAsset::reclaim()
+{
+    const quint64 readIndex = m_readIndex.load(std::memory_order_acquire);
+    for (; m_reclaimIndex < readIndex; ++m_reclaimIndex)
+        m_queue[m_reclaimIndex % queueCapacity].buffer = {};
+}
+
+bool QStreamedAudioAsset::push(const QAudioBuffer &buffer, bool endOfFile)
+{
+    reclaim();
+    const quint64 writeIndex = m_writeIndex.load(std::memory_order_relaxed);
+    if (writeIndex - m_reclaimIndex >= quint64(queueCapacity))
+        return false;
+    Entry &e = m_queue[writeIndex % queueCapacity];
+    e.buffer = buffer;
+    e.generation = m_generation.load(std::memory_order_relaxed);
+    e.endOfFile = endOfFile;
+    m_writeIndex.store(writeIndex + 1, std::memory_order_release);
+    return true;
+}
+
+void QStreamedAudioAsset::bufferReady()
+{
+    // Only take the buffer while below the prefetch limit and while the queue
+    // has room for it. Decoders producing buffers on demand will wait until it
+    // has been read.
+    reportUnderruns();
+    reclaim();
+    const bool queueFull =
+            m_writeIndex.load(std::memory_order_relaxed) - m_reclaimIndex >= quint64(queueCapacity);
+    if (m_pendingEndOfFile || queueFull || bufferedFrames() >= prefetchFrames) {
+        m_pendingBuffer = true;
+        updatePolling();
+        return;
+    }
+    m_pendingBuffer = false;
+    // Some decoders report the end of the file from within read(), the last
+    // buffer has to be queued before the end marker
+    m_inDecoderRead = true;
+    const QAudioBuffer b = m_decoder->read();
+    m_inDecoderRead = false;
+    if (b.isValid()) {
+        push(b, false);
+        m_passHasData = true;
+        m_writtenFrames.fetch_add(b.frameCount(), std::memory_order_relaxed);
+        emit bufferAdded();
+    }
+    if (std::exchange(m_finishedInRead, false))
+        finished();
+    updatePolling();
+}
+
+void QStreamedAudioAsset::fill()
+{
+    if (m_pendingEndOfFile && !pushEndOfFile())
+        return;
+    if (m_pendingBuffer)
+        bufferReady();
+    else
+        reclaim();
+    updatePolling();
+}
+
+void QStreamedAudioAsset::finished()
+{
+    if (m_inDecoderRead) {
+        m_finishedInRead = true;
+        return;
+    }
+    if (!m_passHasData) {
+        // nothing to loop over, don't restart
+        m_failed = true;
+        updatePolling();
+        return;
+    }
+    m_pendingEndOfFile = true;
+    pushEndOfFile();
+    updatePolling();
+}
+
+bool QStreamedAudioAsset::pushEndOfFile()
+{
+    if (!push({}, true))
+        return false;
+    m_pendingEndOfFile = false;
+    // continue with the next pass right away, so that looping is seamless
+    m_restartPending = true;
+    QMetaObject::invokeMethod(this, [this] {
+        if (m_restartPending)
+            restartDecoder();
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void QStreamedAudioAsset::error(QAudioDecoder::Error)
+{
+    qWarning() << "Failed to decode" << url << m_decoder->errorString();
+    m_failed = true;
+    updatePolling();
+}
+
+void QStreamedAudioAsset::restartDecoder()
+{
+    m_restartPending = false;
+    if (m_failed.loadRelaxed())
+        return;
+    {
+        // stop() emits finished(), which must not end the pass
+        QSignalBlocker blocker(m_decoder.get());
+        m_decoder->stop();
+    }
+    m_pendingBuffer = false;
+    updatePolling();
+    m_passHasData = false;
+    if (m_sourceDeviceFile)
+        m_sourceDeviceFile->seek(0);
+    m_decoder->start();
+}
+
+std::shared_ptr<QDecodedAudioAsset> QAudioAssetCache::acquire(const QUrl &url, int sampleRate,
+                                                              int channels)
+{
+    const Key key{ url, sampleRate, channels };
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        if (!it->asset->hasFailed()) {
+            ++m_hits;
+            it->lastUse = ++m_useCounter;
+            return it->asset;
+        }
+        // don't keep handing out an empty asset, the file might be fixed by now
+        m_entries.erase(it);
+    }
+
+    ++m_misses;
+    QAudioFormat f;
+    f.setSampleFormat(QAudioFormat::Float);
+    f.setSampleRate(sampleRate);
+    f.setChannelConfig(channels == 2 ? QAudioFormat::ChannelConfigStereo
+                                     : QAudioFormat::ChannelConfigMono);
+    auto asset = std::make_shared<QDecodedAudioAsset>(url, f);
+    m_entries.insert(key, { asset, ++m_useCounter });
+    trim();
+    return asset;
+}
+
+void QAudioAssetCache::setLimit(qint64 bytes)
+{
+    m_limit = qMax<qint64>(bytes, 0);
+    trim();
+}
+
+qint64 QAudioAssetCache::size() const
+{
+    qint64 total = 0;
+    for (const auto &entry : m_entries)
+        total += entry.asset->byteCount();
+    return total;
+}
+
+void QAudioAssetCache::trim()
+{
+    qint64 total = size();
+    while (total > m_limit) {
+        // evict the least recently used asset no sound refers to any more
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->asset.use_count() > 1)
+                continue;
+            if (victim == m_entries.end() || it->lastUse < victim->lastUse)
+                victim = it;
+        }
+        if (victim == m_entries.end())
+            return;
+        total -= victim->asset->byteCount();
+        m_entries.erase(victim);
+    }
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qaudioassetcache_p.cpp"
@@ -0,0 +1,245 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+
+#ifndef QAUDIOASSETCACHE_P_H
+#define QAUDIOASSETCACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of other Qt classes.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
+#include <qobject.h>
+#include <qaudiobuffer.h>
+#include <qaudiodecoder.h>
+#include <qaudioformat.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qtimer.h>
+#include <qurl.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// Decoded PCM data of one sound file at the engine's sample rate. Shared
+// between all sounds playing the same file. Buffers are only ever appended by
+// the decoder, and are published without locking: the audio thread can call
+// isLoading(), bufferCount() and buffer() at any time, and must do so in
+// that order to see a consistent state.
+class Q_SPATIALAUDIO_EXPORT QDecodedAudioAsset : public QObject
+{
+    Q_OBJECT
+public:
+    QDecodedAudioAsset(const QUrl &url, const QAudioFormat &format);
+    ~QDecodedAudioAsset();
+
+    const QUrl url;
+    const QAudioFormat format;
+
+    bool isLoading() const { return m_loading.load(std::memory_order_acquire); }
+    qsizetype bufferCount() const { return m_count.load(std::memory_order_acquire); }
+    const QAudioBuffer &buffer(qsizetype i) const
+    {
+        return m_table.load(std::memory_order_acquire)->buffers[i];
+    }
+
+    qint64 byteCount() const { return m_byteCount.loadRelaxed(); }
+    // The file could not be decoded (completely)
+    bool hasFailed() const { return m_failed.loadRelaxed(); }
+
+Q_SIGNALS:
+    void bufferAdded();
+    void loadingFinished();
+
+private:
+    void bufferReady();
+    void finished();
+    void error(QAudioDecoder::Error error);
+    void append(const QAudioBuffer &buffer);
+
+    struct BufferTable
+    {
+        explicit BufferTable(qsizetype capacity)
+            : buffers(new QAudioBuffer[capacity]), capacity(capacity)
+        {}
+        std::unique_ptr<QAudioBuffer[]> buffers;
+        qsizetype capacity;
+    };
+
+    std::unique_ptr<QAudioDecoder> m_decoder;
+    std::unique_ptr<QFile> m_sourceDeviceFile;
+    // Outgrown tables are kept until destruction, as the audio thread might
+    // still be reading from them. They only hold references to the same data.
+    std::vector<std::unique_ptr<BufferTable>> m_tables;
+    std::atomic<BufferTable *> m_table = nullptr;
+    std::atomic<qsizetype> m_count = 0;
+    std::atomic<bool> m_loading = true;
+    bool m_inDecoderRead = false;
+    bool m_finishedInRead = false;
+    QAtomicInteger<qint64> m_byteCount = 0;
+    QAtomicInteger<bool> m_failed = false;
+};
+
+// Decodes a sound file incrementally for a single sound, staying at most
+// prefetchFrames ahead of the playback position, so that long files can be
+// played with bounded memory. The end of each pass through the file is marked
+// in the queue, after which decoding continues from the start for the next loop.
+// Decoded buffers are passed to the audio thread through a single producer,
+// single consumer queue: read() and recordUnderrun() are called from the audio
+// thread, everything else from the thread the object lives in. The audio thread
+// only sets flags, which the owning thread polls to refill the queue and to log
+// underruns, so that it never has to post events or log itself.
+class Q_SPATIALAUDIO_EXPORT QStreamedAudioAsset : public QObject
+{
+    Q_OBJECT
+public:
+    QStreamedAudioAsset(const QUrl &url, const QAudioFormat &format, qint64 prefetchFrames);
+    ~QStreamedAudioAsset();
+
+    const QUrl url;
+    const QAudioFormat format;
+    const qint64 prefetchFrames;
+
+    // Copies up to frames frames to dst and returns the number of frames copied.
+    // Stops early at the end of the file, in which case endOfFile is set to true.
+    int read(float *dst, int frames, bool *endOfFile);
+    // Called by the reader when it could not get all the data it needed
+    void recordUnderrun(int missingFrames);
+
+    // Discards all queued data and restarts decoding at the start of the file
+    void rewind();
+
+    bool hasFailed() const { return m_failed.loadRelaxed(); }
+    qint64 bufferedFrames() const;
+    int underrunCount() const { return m_underruns.loadRelaxed(); }
+    // Whether the producer polls for room to queue the data it holds back
+    bool isPolling() const { return m_pollTimer.isActive(); }
+
+Q_SIGNALS:
+    void bufferAdded();
+
+private:
+    void bufferReady();
+    void finished();
+    void error(QAudioDecoder::Error error);
+    void poll();
+    void updatePolling();
+    void reportUnderruns();
+    void fill();
+    void restartDecoder();
+    bool push(const QAudioBuffer &buffer, bool endOfFile);
+    bool pushEndOfFile();
+    void reclaim();
+
+    static constexpr qsizetype queueCapacity = 1024;
+    static constexpr int pollInterval = 10; // ms, backs off up to m_maxPollInterval
+    // generation and frame count share the consumer's progress counter
+    static constexpr int frameBits = 40;
+    static constexpr quint64 frameMask = (quint64(1) << frameBits) - 1;
+    static constexpr quint32 generationMask = (quint32(1) << (64 - frameBits)) - 1;
+
+    struct Entry
+    {
+        QAudioBuffer buffer;
+        quint32 generation = 0;
+        bool endOfFile = false;
+    };
+
+    const int m_maxPollInterval;
+
+    std::unique_ptr<QAudioDecoder> m_decoder;
+    std::unique_ptr<QFile> m_sourceDeviceFile;
+
+    std::unique_ptr<Entry[]> m_queue;
+    std::atomic<quint64> m_writeIndex = 0;
+    std::atomic<quint64> m_readIndex = 0;
+    // bumped by rewind(), the reader skips entries of older generations
+    std::atomic<quint32> m_generation = 0;
+    std::atomic<qint64> m_writtenFrames = 0;
+    std::atomic<quint64> m_readProgress = 0;
+
+    // producer side
+    quint64 m_reclaimIndex = 0;
+    bool m_pendingBuffer = false;
+    bool m_pendingEndOfFile = false;
+    bool m_restartPending = false;
+    bool m_passHasData = false;
+    bool m_inDecoderRead = false;
+    bool m_finishedInRead = false;
+    int m_reportedUnderruns = 0;
+    QTimer m_pollTimer;
+
+    // consumer side
+    quint32 m_readGeneration = 0;
+    int m_readPos = 0;
+    bool m_inUnderrun = false;
+
+    std::atomic<bool> m_fillRequested = false;
+    std::atomic<int> m_lastUnderrunFrames = 0;
+    QAtomicInt m_underruns = 0;
+    QAtomicInteger<bool> m_failed = false;
+};
+
+// Engine wide cache of decoded assets, keyed by URL and output format.
+// Assets in use by a sound are never evicted; unused assets are kept around
+// until the total amount of decoded data exceeds the limit. Assets that failed
+// to decode are not handed out again, the next request decodes the file anew.
+// Only used from the thread the engine lives in.
+class Q_SPATIALAUDIO_EXPORT QAudioAssetCache
+{
+public:
+    static constexpr qint64 defaultLimit = 64 * 1024 * 1024;
+
+    std::shared_ptr<QDecodedAudioAsset> acquire(const QUrl &url, int sampleRate, int channels);
+
+    void setLimit(qint64 bytes);
+    qint64 limit() const { return m_limit; }
+    qint64 size() const;
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+
+    void trim();
+
+private:
+    struct Key
+    {
+        QUrl url;
+        int sampleRate = 0;
+        int channels = 0;
+
+        friend bool operator==(const Key &a, const Key &b) noexcept
+        {
+            return a.url == b.url && a.sampleRate == b.sampleRate && a.channels == b.channels;
+        }
+        friend size_t qHash(const Key &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.url, key.sampleRate, key.channels);
+        }
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<QDecodedAudioAsset> asset;
+        quint64 lastUse = 0;
+    };
+
+    QHash<Key, Entry> m_entries;
+    quint64 m_useCounter = 0;
+    qint64 m_limit = defaultLimit;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -13,9 +13,12 @@
 #include <qaudiosink.h>
 #include <qdebug.h>
 #include <qelapsedtimer.h>
+#include <qscopeguard.h>
 
 #include <QFile>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 // We'd like to have short buffer times, so the sound adjusts itself to changes
@@ -59,10 +62,15 @@ public:
         format.setChannelConfig(d->outputMode == QAudioEngine::Surround ?
                                     d->device.channelConfiguration() : QAudioFormat::ChannelConfigStereo);
         format.setSampleRate(d->sampleRate);
-        format.setSampleFormat(QAudioFormat::Int16);
+        // Render float directly where possible, avoiding quantization and a
+        // conversion pass in the backend
+        format.setSampleFormat(QAudioFormat::Float);
+        if (!d->device.isFormatSupported(format))
+            format.setSampleFormat(QAudioFormat::Int16);
+        m_sampleFormat = format.sampleFormat();
         d->ambisonicDecoder.reset(new QAmbisonicDecoder(QAmbisonicDecoder::HighQuality, format));
         sink.reset(new QAudioSink(d->device, format));
-        sink->setBufferSize(d->sampleRate*bufferTimeMs/1000*sizeof(qint16)*format.channelCount());
+        sink->setBufferSize(d->sampleRate*bufferTimeMs/1000*format.bytesPerFrame());
         sink->start(this);
     }
 
@@ -85,7 +93,11 @@ public:
     }
 
 private:
+    template<typename T>
+    qint64 render(T *output, qint64 frames);
+
     qint64 m_pos = 0;
+    QAudioFormat::SampleFormat m_sampleFormat = QAudioFormat::Int16;
     QAudioEnginePrivate *d = nullptr;
     std::unique_ptr<QAudioSink> sink;
 };
@@ -105,28 +117,46 @@ qint64 QAudioOutputStream::readData(char *data, qint64 len)
     if (d->paused.loadRelaxed())
         return 0;
 
-    d->updateRooms();
-
     int nChannels = d->ambisonicDecoder ? d->ambisonicDecoder->nOutputChannels() : 2;
-    if (len < nChannels*int(sizeof(float))*QAudioEnginePrivate::bufferSize)
+    if (len < nChannels*int(sizeof(float))*d->bufferSize)
         return 0;
 
-    short *fd = (short *)data;
-    qint64 frames = len / nChannels / sizeof(short);
+    const qint64 sampleSize = m_sampleFormat == QAudioFormat::Float ? sizeof(float) : sizeof(short);
+    d->updateRooms(len / nChannels / sampleSize);
+
+    qint64 bytesProcessed;
+    if (m_sampleFormat == QAudioFormat::Float)
+        bytesProcessed = render(reinterpret_cast<float *>(data), len / nChannels / sizeof(float));
+    else
+        bytesProcessed = render(reinterpret_cast<short *>(data), len / nChannels / sizeof(short));
+    m_pos += bytesProcessed;
+    return bytesProcessed;
+}
+
+template<typename T>
+qint64 QAudioOutputStream::render(T *output, qint64 frames)
+{
+    const int bufferSize = d->bufferSize;
+    int nChannels = d->ambisonicDecoder ? d->ambisonicDecoder->nOutputChannels() : 2;
+    T *fd = output;
     bool ok = true;
-    while (frames >= qint64(QAudioEnginePrivate::bufferSize)) {
+    while (frames >= qint64(bufferSize)) {
         // Fill input buffers
         for (auto *source : std::as_const(d->sources)) {
             auto *sp = QSpatialSoundPrivate::get(source);
-            float buf[QAudioEnginePrivate::bufferSize];
-            sp->getBuffer(buf, QAudioEnginePrivate::bufferSize, 1);
-            d->resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 1, QAudioEnginePrivate::bufferSize);
+            float buf[QAudioEnginePrivate::maxBufferSize];
+            sp->getBuffer(buf, bufferSize, 1);
+            // virtualized sounds keep playing, but are not rendered
+            if (!sp->virtualized.load(std::memory_order_relaxed))
+                d->resonanceAudio->api->SetInterleavedBuffer(
+                        sp->sourceId.load(std::memory_order_acquire), buf, 1, bufferSize);
         }
         for (auto *source : std::as_const(d->stereoSources)) {
             auto *sp = QAmbientSoundPrivate::get(source);
-            float buf[2*QAudioEnginePrivate::bufferSize];
-            sp->getBuffer(buf, QAudioEnginePrivate::bufferSize, 2);
-            d->resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 2, QAudioEnginePrivate::bufferSize);
+            float buf[2*QAudioEnginePrivate::maxBufferSize];
+            sp->getBuffer(buf, bufferSize, 2);
+            d->resonanceAudio->api->SetInterleavedBuffer(
+                    sp->sourceId.load(std::memory_order_acquire), buf, 2, bufferSize);
         }
 
         if (d->ambisonicDecoder && d->outputMode == QAudioEngine::Surround) {
@@ -136,18 +166,16 @@ qint64 QAudioOutputStream::readData(char *data, qint64 len)
             Q_ASSERT(d->ambisonicDecoder->nOutputChannels() <= 8);
             d->ambisonicDecoder->processBufferWithReverb(channels, reverbBuffers, fd, nSamples);
         } else {
-            ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, QAudioEnginePrivate::bufferSize, fd);
+            ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, bufferSize, fd);
             if (!ok) {
                 qWarning() << "    Reading failed!";
                 break;
             }
         }
-        fd += nChannels*QAudioEnginePrivate::bufferSize;
-        frames -= QAudioEnginePrivate::bufferSize;
+        fd += nChannels*bufferSize;
+        frames -= bufferSize;
     }
-    const int bytesProcessed = ((char *)fd - data);
-    m_pos += bytesProcessed;
-    return bytesProcessed;
+    return (fd - output) * qint64(sizeof(T));
 }
 
 
@@ -164,9 +192,13 @@ QAudioEnginePrivate::~QAudioEnginePrivate()
 
 void QAudioEnginePrivate::addSpatialSound(QSpatialSound *sound)
 {
-    QAmbientSoundPrivate *sd = QAmbientSoundPrivate::get(sound);
+    QSpatialSoundPrivate *sd = QSpatialSoundPrivate::get(sound);
 
-    sd->sourceId = resonanceAudio->api->CreateSoundObjectSource(vraudio::kBinauralHighQuality);
+    // Sounds start out at full quality, the voice manager picks them up on its next update
+    sd->renderingMode = vraudio::kBinauralHighQuality;
+    sd->virtualized.store(false, std::memory_order_relaxed);
+    sd->sourceId = resonanceAudio->api->CreateSoundObjectSource(sd->renderingMode);
+    sd->id = ++nextSoundId;
     sources.append(sound);
 }
 
@@ -199,77 +231,173 @@ void QAudioEnginePrivate::removeStereoSound(QAmbientSound *sound)
 void QAudioEnginePrivate::addRoom(QAudioRoom *room)
 {
     rooms.append(room);
+    QAudioRoomPrivate::get(room)->setDirty();
 }
 
 void QAudioEnginePrivate::removeRoom(QAudioRoom *room)
 {
     rooms.removeOne(room);
+    scheduleRoomIndexUpdate();
 }
 
-void QAudioEnginePrivate::updateRooms()
+void QAudioEnginePrivate::scheduleRoomIndexUpdate()
 {
-    if (!roomEffectsEnabled)
+    // Coalesce all changes made until we return to the event loop
+    if (roomIndexUpdatePending)
         return;
+    roomIndexUpdatePending = true;
+    QMetaObject::invokeMethod(q, [this] { updateRoomIndex(); }, Qt::QueuedConnection);
+}
 
-    bool needUpdate = listenerPositionDirty;
-    listenerPositionDirty = false;
+void QAudioEnginePrivate::updateRoomIndex()
+{
+    roomIndexUpdatePending = false;
+    std::unique_ptr<QAudioRoomIndex> index = QAudioRoomIndex::build(rooms);
+    publishedRoomIndex.store(index.get(), std::memory_order_seq_cst);
+    if (roomIndex)
+        retiredRoomIndexes.push_back(std::move(roomIndex));
+    roomIndex = std::move(index);
+    releaseRetiredRoomIndexes();
+    if (occlusionTracer)
+        occlusionTracer->invalidateOccluders();
+    updateListenerRoom();
+}
 
-    bool roomDirty = false;
-    for (const auto &room : rooms) {
-        auto *rd = QAudioRoomPrivate::get(room);
-        if (rd->dirty) {
-            roomDirty = true;
-            rd->update();
-            needUpdate = true;
-        }
-    }
+void QAudioEnginePrivate::releaseRetiredRoomIndexes()
+{
+    // Pairs with the store to roomIndexInUse in updateRooms()
+    QAudioRoomIndex *inUse = roomIndexInUse.load(std::memory_order_seq_cst);
+    retiredRoomIndexes.erase(std::remove_if(retiredRoomIndexes.begin(), retiredRoomIndexes.end(),
+                                            [inUse](const auto &i) { return i.get() != inUse; }),
+                             retiredRoomIndexes.end());
+}
 
-    if (!needUpdate)
-        return;
+const QAudioRoomIndex::Entry *QAudioEnginePrivate::listenerRoom() const
+{
+    if (!roomIndex)
+        return nullptr;
+    return roomIndex->find(listenerPosition() * distanceScale);
+}
 
-    QVector3D listenerPos = listenerPosition();
-    float roomVolume = float(qInf());
-    QAudioRoom *room = nullptr;
-    // Find the smallest room that contains the listener and apply its room effects
-    for (auto *r : std::as_const(rooms)) {
-        QVector3D dim2 = r->dimensions()/2.;
-        float vol = dim2.x()*dim2.y()*dim2.z();
-        if (vol > roomVolume)
-            continue;
-        QVector3D dist = r->position() - listenerPos;
-        // transform into room coordinates
-        dist = r->rotation().rotatedVector(dist);
-        if (qAbs(dist.x()) <= dim2.x() &&
-            qAbs(dist.y()) <= dim2.y() &&
-            qAbs(dist.z()) <= dim2.z()) {
-            room = r;
-            roomVolume = vol;
-        }
-    }
-    if (room != currentRoom)
-        roomDirty = true;
-    const bool previousRoom = currentRoom;
-    currentRoom = room;
+void QAudioEnginePrivate::updateListenerRoom()
+{
+    const QAudioRoomIndex::Entry *room = listenerRoom();
+    const QAudioRoom *r = room ? room->room : nullptr;
+    const quint64 revision = room ? room->revision : 0;
+    if (r == soundRoom && revision == soundRoomRevision)
+        return;
+    soundRoom = r;
+    soundRoomRevision = revision;
+    updateSourceRoomEffects(room);
+}
 
-    if (!roomDirty)
+void QAudioEnginePrivate::updateRooms(qint64 frames)
+{
+    // Called by the audio thread. It only applies the engine wide reflections and
+    // reverb. The room effects of the individual sounds depend on the QSpatialSound
+    // objects, which the thread owning the engine adds, removes and modifies without
+    // synchronizing with us, so that thread applies them in updateListenerRoom().
+    // Resonance Audio queues all calls and runs them before processing the next
+    // block, so the order of the two doesn't matter.
+    if (!roomEffectsEnabled)
         return;
 
-    // apply room to engine
-    if (!currentRoom) {
-        resonanceAudio->api->EnableRoomEffects(false);
+    // announce the index we are going to use, and make sure it is still the current one
+    QAudioRoomIndex *index = publishedRoomIndex.load(std::memory_order_seq_cst);
+    for (;;) {
+        roomIndexInUse.store(index, std::memory_order_seq_cst);
+        QAudioRoomIndex *current = publishedRoomIndex.load(std::memory_order_seq_cst);
+        if (current == index)
+            break;
+        index = current;
+    }
+    auto releaseIndex = qScopeGuard([this] {
+        roomIndexInUse.store(nullptr, std::memory_order_release);
+    });
+
+    const quint64 generation = index ? index->generation() : 0;
+    const bool transitioning = currentRoom.room != targetRoom.room
+            || (currentRoom.room && roomFade < 1.f) || roomEffectsRemainingFrames > 0;
+    const bool listenerMoved = listenerPositionDirty.exchange(false, std::memory_order_relaxed);
+    if (!listenerMoved && generation == roomIndexGeneration && !transitioning)
         return;
+    roomIndexGeneration = generation;
+
+    const QAudioRoomIndex::Entry *room =
+            index ? index->find(listenerPosition() * distanceScale) : nullptr;
+    if (!room) {
+        targetRoom = {};
+    } else if (room->room != targetRoom.room || room->revision != targetRoom.revision) {
+        targetRoom.room = room->room;
+        targetRoom.revision = room->revision;
+        targetRoom.reflections = room->reflections;
+        targetRoom.reverb = room->reverb;
+    }
+
+    auto *api = resonanceAudio->api;
+    // Half of the crossfade fades out the old room, the other half fades in the new one
+    const float fadeStep = float(frames) * 2000.f / (float(sampleRate) * roomCrossfadeMs);
+    bool applyReflections = false;
+
+    if (currentRoom.room != targetRoom.room) {
+        if (currentRoom.room) {
+            roomFade = std::max(0.f, roomFade - fadeStep);
+            applyReflections = true;
+        }
+        if (!currentRoom.room || roomFade == 0.f) {
+            if (currentRoom.room) {
+                vraudio::ReflectionProperties silent = currentRoom.reflections;
+                silent.gain = 0;
+                api->SetReflectionProperties(silent);
+            }
+            if (targetRoom.room) {
+                if (!roomEffectsActive) {
+                    api->EnableRoomEffects(true);
+                    roomEffectsActive = true;
+                }
+                roomEffectsRemainingFrames = 0;
+                api->SetReverbProperties(targetRoom.reverb);
+            } else {
+                // Keep room effects enabled until the reverb tail has faded out
+                vraudio::ReverbProperties silent = currentRoom.reverb;
+                silent.gain = 0;
+                api->SetReverbProperties(silent);
+                roomEffectsRemainingFrames = qint64(sampleRate) * roomReverbFadeMs / 1000;
+            }
+            currentRoom = targetRoom;
+            roomFade = 0;
+        }
+    } else if (currentRoom.revision != targetRoom.revision) {
+        // The properties of the room changed, Resonance Audio smoothes the transition
+        currentRoom = targetRoom;
+        api->SetReverbProperties(currentRoom.reverb);
+        applyReflections = true;
+    } else if (currentRoom.room && roomFade < 1.f) {
+        roomFade = std::min(1.f, roomFade + fadeStep);
+        applyReflections = true;
+    }
+
+    if (applyReflections && currentRoom.room) {
+        vraudio::ReflectionProperties reflections = currentRoom.reflections;
+        reflections.gain *= roomFade;
+        api->SetReflectionProperties(reflections);
     }
-    if (!previousRoom)
-        resonanceAudio->api->EnableRoomEffects(true);
 
-    QAudioRoomPrivate *rp = QAudioRoomPrivate::get(room);
-    resonanceAudio->api->SetReflectionProperties(rp->reflections);
-    resonanceAudio->api->SetReverbProperties(rp->reverb);
+    if (!currentRoom.room && roomEffectsRemainingFrames > 0) {
+        roomEffectsRemainingFrames -= frames;
+        if (roomEffectsRemainingFrames <= 0) {
+            roomEffectsRemainingFrames = 0;
+            api->EnableRoomEffects(false);
+            roomEffectsActive = false;
+        }
+    }
+}
 
-    // update room effects for all sound sources
+void QAudioEnginePrivate::updateSourceRoomEffects(const QAudioRoomIndex::Entry *room)
+{
     for (auto *s : std::as_const(sources)) {
         auto *sp = QSpatialSoundPrivate::get(s);
-        sp->updateRoomEffects();
+        sp->updateRoomEffects(room);
     }
 }
 
@@ -343,8 +471,50 @@ QAudioEngine::QAudioEngine(int sampleRate, QObject *parent)
     : QObject(parent)
     , d(new QAudioEnginePrivate)
 {
+    d->q = this;
     d->sampleRate = sampleRate;
-    d->resonanceAudio = new vraudio::ResonanceAudio(2, QAudioEnginePrivate::bufferSize, d->sampleRate);
+    d->resonanceAudio = new vraudio::ResonanceAudio(2, d->bufferSize, d->sampleRate);
+}
+
+/*!
+    \property QAudioEngine::blockSize
+    \since 6.7
+
+    Defines the number of frames the engine processes at a time.
+
+    Smaller blocks reduce the latency with which changes to the sound field
+    become audible, larger blocks reduce the processing overhead per frame.
+    The block size has to be a power of two between 32 and 1024. The default
+    is 128.
+
+    The block size can only be changed before the engine is started, and
+    before any sounds, rooms or listeners have been created for it.
+ */
+void QAudioEngine::setBlockSize(int frames)
+{
+    if (d->bufferSize == frames)
+        return;
+    if (frames < QAudioEnginePrivate::minBufferSize || frames > QAudioEnginePrivate::maxBufferSize
+        || (frames & (frames - 1))) {
+        qWarning() << "QAudioEngine: Invalid block size" << frames;
+        return;
+    }
+    if (d->outputStream || d->listener || !d->sources.isEmpty() || !d->stereoSources.isEmpty()
+        || !d->rooms.isEmpty()) {
+        qWarning() << "QAudioEngine: Changing the block size of an engine in use is not supported";
+        return;
+    }
+    d->bufferSize = frames;
+    const bool roomEffectsEnabled = d->resonanceAudio->roomEffectsEnabled;
+    delete d->resonanceAudio;
+    d->resonanceAudio = new vraudio::ResonanceAudio(2, d->bufferSize, d->sampleRate);
+    d->resonanceAudio->roomEffectsEnabled = roomEffectsEnabled;
+    emit blockSizeChanged();
+}
+
+int QAudioEngine::blockSize() const
+{
+    return d->bufferSize;
 }
 
 /*!
@@ -380,6 +550,9 @@ void QAudioEngine::setOutputMode(OutputMode mode)
     d->outputMode = mode;
     if (d->resonanceAudio->api)
         d->resonanceAudio->api->SetStereoSpeakerMode(mode != Headphone);
+    // which sounds may be panned depends on the output mode
+    if (d->voiceManager)
+        d->voiceManager->update();
 
     QMetaObject::invokeMethod(d->outputStream.get(), "restartOutput", Qt::BlockingQueuedConnection);
 
@@ -451,6 +624,9 @@ void QAudioEngine::start()
 
     d->resonanceAudio->api->SetStereoSpeakerMode(d->outputMode != Headphone);
     d->resonanceAudio->api->SetMasterVolume(d->masterVolume);
+    // rooms created right before starting should apply from the first block on
+    if (d->roomIndexUpdatePending)
+        d->updateRoomIndex();
 
     d->outputStream.reset(new QAudioOutputStream(d));
     d->outputStream->moveToThread(&d->audioThread);
@@ -536,6 +712,14 @@ void QAudioEngine::setDistanceScale(float scale)
     if (scale == d->distanceScale)
         return;
     d->distanceScale = scale;
+    // Room meshes are traced in meters, rescale them
+    for (auto *room : std::as_const(d->rooms)) {
+        auto *rp = QAudioRoomPrivate::get(room);
+        if (rp->geometry && rp->buildGeometry()) {
+            rp->startEstimation(room);
+            emit room->geometryChanged();
+        }
+    }
     emit distanceScaleChanged();
 }
 
@@ -544,48 +728,313 @@ float QAudioEngine::distanceScale() const
     return d->distanceScale*100.f;
 }
 
+/*!
+    \property QAudioEngine::soundCacheLimit
+    \since 6.7
+
+    Defines the amount of memory in bytes the engine may use to keep decoded
+    sound files around that are currently not used by any sound.
+
+    Sounds playing the same file share its decoded data, so the file only has
+    to be decoded once. Decoded data that is in use by at least one sound is
+    never released, even if that exceeds the limit. The default is 64 MB.
+
+    \sa soundCacheSize()
+*/
+void QAudioEngine::setSoundCacheLimit(qint64 bytes)
+{
+    if (d->assetCache.limit() == bytes)
+        return;
+    d->assetCache.setLimit(bytes);
+    emit soundCacheLimitChanged();
+}
+
+qint64 QAudioEngine::soundCacheLimit() const
+{
+    return d->assetCache.limit();
+}
+
+/*!
+    \since 6.7
+
+    Returns the amount of memory in bytes currently used by decoded sound
+    files, including files being used by sounds.
+*/
+qint64 QAudioEngine::soundCacheSize() const
+{
+    return d->assetCache.size();
+}
+
+/*!
+    \since 6.7
+
+    Returns how often a sound could reuse a file that had already been
+    decoded, or was being decoded, for another sound.
+
+    \sa soundCacheMisses()
+*/
+int QAudioEngine::soundCacheHits() const
+{
+    return d->assetCache.hits();
+}
+
+/*!
+    \since 6.7
+
+    Returns how often a sound file had to be decoded because it was not
+    in the cache.
+
+    \sa soundCacheHits()
+*/
+int QAudioEngine::soundCacheMisses() const
+{
+    return d->assetCache.misses();
+}
+
+/*!
+    \property QAudioEngine::occlusionUpdateRate
+    \since 6.7
+
+    Defines how many times per second the engine computes how much each
+    QSpatialSound is occluded by the geometry of rooms.
+
+    The engine casts a ray from the listener to every sound and sums up the
+    occlusion of the materials of all surfaces it passes. Rooms with a mesh set
+    with QAudioRoom::setGeometry() occlude with their triangles, all other rooms
+    with the six walls of their box. This happens on a worker thread, so higher
+    rates make the occlusion follow movement more closely at the cost of CPU time
+    but never block the application. The result is added to
+    QSpatialSound::occlusionIntensity, and replaces the estimate from the walls of
+    the listener's room that is used otherwise.
+
+    The default is 0, which disables computing occlusion.
+*/
+void QAudioEngine::setOcclusionUpdateRate(int rate)
+{
+    rate = qMax(rate, 0);
+    if (d->occlusionUpdateRate == rate)
+        return;
+    d->occlusionUpdateRate = rate;
+    if (!d->occlusionTracer && rate)
+        d->occlusionTracer = std::make_unique<QAudioOcclusionTracer>(this);
+    if (d->occlusionTracer)
+        d->occlusionTracer->setUpdateRate(rate);
+    emit occlusionUpdateRateChanged();
+}
+
+int QAudioEngine::occlusionUpdateRate() const
+{
+    return d->occlusionUpdateRate;
+}
+
+void QAudioEnginePrivate::updateVoiceLimits()
+{
+    if (!voiceManager && (voiceLimit >= 0 || highQualityVoiceLimit >= 0))
+        voiceManager = std::make_unique<QAudioVoiceManager>(q);
+    if (voiceManager)
+        voiceManager->setLimits(voiceLimit, highQualityVoiceLimit);
+}
+
+/*!
+    \property QAudioEngine::voiceLimit
+    \since 6.7
+
+    Defines the maximum number of spatial sounds the engine renders at the
+    same time.
+
+    The engine periodically ranks all QSpatialSound objects, first by their
+    \l{QSpatialSound::priority}{priority} and then by how loud they are at the
+    position of the listener, taking their volume and distance attenuation into
+    account. Sounds ranked beyond the limit, and sounds that are inaudible
+    because they are beyond their distance cutoff or have a volume of 0, are
+    virtualized: their playback position keeps advancing, so that they continue
+    at the right place once they are rendered again, but they don't cost any
+    processing time for spatialization.
+
+    A sound that is rendered only gives up its place to a sound of the same
+    priority once that one is clearly louder, so that sounds of similar
+    loudness don't keep switching.
+
+    The default is -1, which renders all sounds.
+
+    \sa highQualityVoiceLimit
+*/
+void QAudioEngine::setVoiceLimit(int limit)
+{
+    limit = qMax(limit, -1);
+    if (d->voiceLimit == limit)
+        return;
+    d->voiceLimit = limit;
+    d->updateVoiceLimits();
+    emit voiceLimitChanged();
+}
+
+int QAudioEngine::voiceLimit() const
+{
+    return d->voiceLimit;
+}
+
+/*!
+    \property QAudioEngine::highQualityVoiceLimit
+    \since 6.7
+
+    Defines how many of the spatial sounds ranked highest are rendered with
+    the full quality of spatialization.
+
+    Further sounds that are rendered are spatialized with a lower ambisonic
+    order, which is considerably cheaper. In the Stereo and Headphone output
+    modes, very quiet sounds are only panned between the left and the right
+    channel.
+
+    The default is -1, which renders all sounds at full quality.
+
+    \sa voiceLimit
+*/
+void QAudioEngine::setHighQualityVoiceLimit(int limit)
+{
+    limit = qMax(limit, -1);
+    if (d->highQualityVoiceLimit == limit)
+        return;
+    d->highQualityVoiceLimit = limit;
+    d->updateVoiceLimits();
+    emit highQualityVoiceLimitChanged();
+}
+
+int QAudioEngine::highQualityVoiceLimit() const
+{
+    return d->highQualityVoiceLimit;
+}
+
+
+QAmbientSoundPrivate::QAmbientSoundPrivate(QObject *parent, int nchannels)
+    : QObject(parent)
+    , nchannels(nchannels)
+{
+    retireTimer.setSingleShot(true);
+    retireTimer.setInterval(10);
+    connect(&retireTimer, &QTimer::timeout, this, &QAmbientSoundPrivate::releaseRetiredSources);
+}
+
+QAmbientSoundPrivate::~QAmbientSoundPrivate()
+{
+    publishSource(nullptr);
+    // the audio thread might still be inside getBuffer()
+    while (!retiredSources.empty()) {
+        QThread::yieldCurrentThread();
+        releaseRetiredSources();
+    }
+}
 
 void QAmbientSoundPrivate::load()
 {
-    decoder.reset(new QAudioDecoder);
-    buffers.clear();
-    currentBuffer = 0;
-    sourceDeviceFile.reset(nullptr);
-    bufPos = 0;
-    m_playing = false;
-    m_loading = true;
+    std::unique_ptr<PlaybackSource> newSource;
     auto *ep = QAudioEnginePrivate::get(engine);
-    QAudioFormat f;
-    f.setSampleFormat(QAudioFormat::Float);
-    f.setSampleRate(ep->sampleRate);
-    f.setChannelConfig(nchannels == 2 ? QAudioFormat::ChannelConfigStereo : QAudioFormat::ChannelConfigMono);
-    decoder->setAudioFormat(f);
-    if (url.scheme().compare(u"qrc", Qt::CaseInsensitive) == 0) {
-        auto qrcFile = std::make_unique<QFile>(u':' + url.path());
-        if (!qrcFile->open(QFile::ReadOnly))
-            return;
-        sourceDeviceFile = std::move(qrcFile);
-        decoder->setSourceDevice(sourceDeviceFile.get());
+    if (ep && !url.isEmpty()) {
+        newSource = std::make_unique<PlaybackSource>();
+        if (streaming) {
+            QAudioFormat f;
+            f.setSampleFormat(QAudioFormat::Float);
+            f.setSampleRate(ep->sampleRate);
+            f.setChannelConfig(nchannels == 2 ? QAudioFormat::ChannelConfigStereo
+                                              : QAudioFormat::ChannelConfigMono);
+            const qint64 prefetchFrames =
+                    qint64(ep->sampleRate) * QAudioEnginePrivate::streamingPrefetchMs / 1000;
+            newSource->stream = std::make_unique<QStreamedAudioAsset>(url, f, prefetchFrames);
+        } else {
+            newSource->asset = ep->assetCache.acquire(url, ep->sampleRate, nchannels);
+        }
+    }
+
+    if (source && source->asset)
+        source->asset->disconnect(this);
+    m_playing = false;
+    resetRequests.fetch_add(1, std::memory_order_release);
+    publishSource(std::move(newSource));
+    if (ep)
+        ep->assetCache.trim();
+
+    if (!source)
+        return;
+    if (source->stream) {
+        connect(source->stream.get(), &QStreamedAudioAsset::bufferAdded, this,
+                &QAmbientSoundPrivate::bufferReady, Qt::SingleShotConnection);
+    } else if (source->asset->bufferCount() > 0) {
+        bufferReady();
     } else {
-        decoder->setSource(url);
+        connect(source->asset.get(), &QDecodedAudioAsset::bufferAdded, this,
+                &QAmbientSoundPrivate::bufferReady, Qt::SingleShotConnection);
     }
-    connect(decoder.get(), &QAudioDecoder::bufferReady, this, &QAmbientSoundPrivate::bufferReady);
-    connect(decoder.get(), &QAudioDecoder::finished, this, &QAmbientSoundPrivate::finished);
-    decoder->start();
+}
+
+void QAmbientSoundPrivate::publishSource(std::unique_ptr<PlaybackSource> newSource)
+{
+    publishedSource.store(newSource.get(), std::memory_order_seq_cst);
+    if (source)
+        retiredSources.push_back(std::move(source));
+    source = std::move(newSource);
+    releaseRetiredSources();
+}
+
+void QAmbientSoundPrivate::releaseRetiredSources()
+{
+    // Pairs with the store to sourceInUse in getBuffer(): if the audio thread
+    // announced a source after this check, it will see the newly published one.
+    PlaybackSource *inUse = sourceInUse.load(std::memory_order_seq_cst);
+    retiredSources.erase(std::remove_if(retiredSources.begin(), retiredSources.end(),
+                                        [inUse](const auto &s) { return s.get() != inUse; }),
+                         retiredSources.end());
+    // The audio thread is done with it after the current block, don't hold on
+    // to the decoded data until the next load()
+    if (!retiredSources.empty())
+        retireTimer.start();
 }
 
 void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
 {
     Q_ASSERT(channels == nchannels);
-    QMutexLocker l(&mutex);
-    if (!m_playing || currentBuffer >= buffers.size()) {
+
+    const int resets = resetRequests.load(std::memory_order_acquire);
+    if (resets != handledResets) {
+        handledResets = resets;
+        currentBuffer = 0;
+        bufPos = 0;
+        m_currentLoop = 0;
+    }
+
+    // announce the source we are going to use, and make sure it is still the current one
+    PlaybackSource *src = publishedSource.load(std::memory_order_seq_cst);
+    for (;;) {
+        sourceInUse.store(src, std::memory_order_seq_cst);
+        PlaybackSource *current = publishedSource.load(std::memory_order_seq_cst);
+        if (current == src)
+            break;
+        src = current;
+    }
+    auto releaseSource = qScopeGuard([this] {
+        sourceInUse.store(nullptr, std::memory_order_release);
+    });
+
+    if (m_playing && src && src->stream) {
+        getStreamedBuffer(src->stream.get(), buf, nframes);
+        return;
+    }
+    if (!m_playing || !src || !src->asset) {
+        memset(buf, 0, channels * nframes * sizeof(float));
+        return;
+    }
+
+    const QDecodedAudioAsset *asset = src->asset.get();
+    // loading state first, so that the buffer count is final once loading is done
+    const bool loading = asset->isLoading();
+    const qsizetype bufferCount = asset->bufferCount();
+    if (currentBuffer >= bufferCount) {
         memset(buf, 0, channels * nframes * sizeof(float));
     } else {
         int frames = nframes;
         float *ff = buf;
         while (frames) {
-            if (currentBuffer < buffers.size()) {
-                const QAudioBuffer &b = buffers.at(currentBuffer);
+            if (currentBuffer < bufferCount) {
+                const QAudioBuffer &b = asset->buffer(currentBuffer);
 //            qDebug() << s << b.format().sampleRate() << b.format().channelCount() << b.format().sampleFormat();
                 auto *f = b.constData<float>() + bufPos*nchannels;
                 int toCopy = qMin(b.frameCount() - bufPos, frames);
@@ -600,14 +1049,12 @@ void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
                 }
             } else {
                 // no more data available
-                if (m_loading)
-                    qDebug() << "underrun" << frames << "frames when loading" << url;
                 memset(ff, 0, frames * channels * sizeof(float));
                 ff += frames * channels;
                 frames = 0;
             }
-            if (!m_loading) {
-                if (currentBuffer == buffers.size()) {
+            if (!loading) {
+                if (currentBuffer == bufferCount) {
                     currentBuffer = 0;
                     ++m_currentLoop;
                 }
@@ -621,19 +1068,41 @@ void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
     }
 }
 
-void QAmbientSoundPrivate::bufferReady()
+void QAmbientSoundPrivate::getStreamedBuffer(QStreamedAudioAsset *stream, float *buf, int nframes)
 {
-    QMutexLocker l(&mutex);
-    auto b = decoder->read();
-//    qDebug() << "read buffer" << b.format() << b.startTime() << b.duration();
-    buffers.append(b);
-    if (m_autoPlay)
-        m_playing = true;
+    float *ff = buf;
+    int frames = nframes;
+    bool emptyPass = false;
+    while (frames && m_playing) {
+        bool endOfFile = false;
+        const int read = stream->read(ff, frames, &endOfFile);
+        ff += read * nchannels;
+        frames -= read;
+        if (endOfFile) {
+            // guard against spinning on a file without any data
+            if (!read && std::exchange(emptyPass, true))
+                break;
+            ++m_currentLoop;
+            if (m_loops > 0 && m_currentLoop >= m_loops) {
+                m_playing = false;
+                m_currentLoop = 0;
+            }
+        } else if (frames) {
+            if (stream->hasFailed())
+                m_playing = false;
+            else
+                stream->recordUnderrun(frames);
+            break;
+        }
+    }
+    memset(ff, 0, frames * nchannels * sizeof(float));
 }
 
-void QAmbientSoundPrivate::finished()
+void QAmbientSoundPrivate::bufferReady()
 {
-    m_loading = false;
+    // start playback as soon as the first decoded data is available
+    if (m_autoPlay)
+        m_playing = true;
 }
 
 /*!
@@ -20,6 +20,11 @@ class Q_SPATIALAUDIO_EXPORT QAudioEngine : public QObject
     Q_PROPERTY(float masterVolume READ masterVolume WRITE setMasterVolume NOTIFY masterVolumeChanged)
     Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
     Q_PROPERTY(float distanceScale READ distanceScale WRITE setDistanceScale NOTIFY distanceScaleChanged)
+    Q_PROPERTY(int blockSize READ blockSize WRITE setBlockSize NOTIFY blockSizeChanged)
+    Q_PROPERTY(qint64 soundCacheLimit READ soundCacheLimit WRITE setSoundCacheLimit NOTIFY soundCacheLimitChanged)
+    Q_PROPERTY(int occlusionUpdateRate READ occlusionUpdateRate WRITE setOcclusionUpdateRate NOTIFY occlusionUpdateRateChanged)
+    Q_PROPERTY(int voiceLimit READ voiceLimit WRITE setVoiceLimit NOTIFY voiceLimitChanged)
+    Q_PROPERTY(int highQualityVoiceLimit READ highQualityVoiceLimit WRITE setHighQualityVoiceLimit NOTIFY highQualityVoiceLimitChanged)
 public:
     QAudioEngine() : QAudioEngine(nullptr) {};
     explicit QAudioEngine(QObject *parent) : QAudioEngine(44100, parent) {}
@@ -38,6 +43,9 @@ public:
 
     int sampleRate() const;
 
+    void setBlockSize(int frames);
+    int blockSize() const;
+
     void setOutputDevice(const QAudioDevice &device);
     QAudioDevice outputDevice() const;
 
@@ -56,12 +64,32 @@ public:
     void setDistanceScale(float scale);
     float distanceScale() const;
 
+    void setSoundCacheLimit(qint64 bytes);
+    qint64 soundCacheLimit() const;
+    qint64 soundCacheSize() const;
+    int soundCacheHits() const;
+    int soundCacheMisses() const;
+
+    void setOcclusionUpdateRate(int rate);
+    int occlusionUpdateRate() const;
+
+    void setVoiceLimit(int limit);
+    int voiceLimit() const;
+
+    void setHighQualityVoiceLimit(int limit);
+    int highQualityVoiceLimit() const;
+
 Q_SIGNALS:
     void outputModeChanged();
     void outputDeviceChanged();
     void masterVolumeChanged();
     void pausedChanged();
     void distanceScaleChanged();
+    void blockSizeChanged();
+    void soundCacheLimitChanged();
+    void occlusionUpdateRateChanged();
+    void voiceLimitChanged();
+    void highQualityVoiceLimitChanged();
 
 public Q_SLOTS:
     void start();
@@ -15,17 +15,26 @@
 // We mean it.
 //
 
-#include <qtspatialaudioglobal_p.h>
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
 #include <qaudioengine.h>
+#include <qaudioassetcache_p.h>
+#include <qaudioroomindex_p.h>
+#include <qaudioocclusion_p.h>
+#include <qaudiovoicemanager_p.h>
 #include <qaudiodevice.h>
 #include <qaudiodecoder.h>
 #include <qthread.h>
+#include <qtimer.h>
 #include <qmutex.h>
 #include <qurl.h>
 #include <qaudiobuffer.h>
 #include <qvector3d.h>
 #include <qfile.h>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 namespace vraudio {
 class ResonanceAudio;
 }
@@ -41,15 +50,25 @@ class QAudioDecoder;
 class QAudioRoom;
 class QAudioListener;
 
-class QAudioEnginePrivate
+class Q_SPATIALAUDIO_EXPORT QAudioEnginePrivate
 {
 public:
     static QAudioEnginePrivate *get(QAudioEngine *engine) { return engine ? engine->d : nullptr; }
 
-    static constexpr int bufferSize = 128;
+    // Number of frames processed per block, see QAudioEngine::blockSize
+    int bufferSize = 128;
+    static constexpr int minBufferSize = 32;
+    static constexpr int maxBufferSize = 1024;
+    // How far streamed sounds decode ahead of the playback position
+    static constexpr int streamingPrefetchMs = 2000;
+    // Duration of the fade of the reflections when the listener changes rooms. The
+    // reverb is interpolated by Resonance Audio itself over roomReverbFadeMs.
+    static constexpr int roomCrossfadeMs = 200;
+    static constexpr int roomReverbFadeMs = 1000;
 
     QAudioEnginePrivate();
     ~QAudioEnginePrivate();
+    QAudioEngine *q = nullptr;
     vraudio::ResonanceAudio *resonanceAudio = nullptr;
     int sampleRate = 44100;
     float masterVolume = 1.;
@@ -71,10 +90,54 @@ public:
 
     QAudioListener *listener = nullptr;
     QList<QSpatialSound *> sources;
+    quint64 nextSoundId = 0;
     QList<QAmbientSound *> stereoSources;
     QList<QAudioRoom *> rooms;
-    mutable bool listenerPositionDirty = true;
-    QAudioRoom *currentRoom = nullptr;
+    // Set when the listener moves, cleared by the audio thread
+    std::atomic<bool> listenerPositionDirty = true;
+
+    // Rooms indexed for finding the one containing the listener. Rebuilt by the thread
+    // owning the engine and handed to the audio thread without locking, the same way
+    // as the playback data of sounds.
+    std::unique_ptr<QAudioRoomIndex> roomIndex;
+    std::atomic<QAudioRoomIndex *> publishedRoomIndex = nullptr;
+    std::atomic<QAudioRoomIndex *> roomIndexInUse = nullptr;
+    std::vector<std::unique_ptr<QAudioRoomIndex>> retiredRoomIndexes;
+    bool roomIndexUpdatePending = false;
+    quint64 roomRevision = 0;
+    // The room the room effects of the sounds were last computed for, only used by
+    // the thread owning the engine
+    const QAudioRoom *soundRoom = nullptr;
+    quint64 soundRoomRevision = 0;
+
+    // The room applied to the engine and the transition to the room the listener
+    // is in, only used by the audio thread
+    struct RoomState
+    {
+        const QAudioRoom *room = nullptr;
+        quint64 revision = 0;
+        vraudio::ReflectionProperties reflections;
+        vraudio::ReverbProperties reverb;
+    };
+    RoomState currentRoom;
+    RoomState targetRoom;
+    quint64 roomIndexGeneration = 0;
+    // Gain of the current room's reflections, faded to 0 before switching rooms
+    float roomFade = 0;
+    // Frames until room effects get disabled after leaving all rooms
+    qint64 roomEffectsRemainingFrames = 0;
+    // Resonance Audio starts out with room effects enabled
+    bool roomEffectsActive = true;
+
+    QAudioAssetCache assetCache;
+
+    int occlusionUpdateRate = 0;
+    std::unique_ptr<QAudioOcclusionTracer> occlusionTracer;
+
+    int voiceLimit = -1;
+    int highQualityVoiceLimit = -1;
+    std::unique_ptr<QAudioVoiceManager> voiceManager;
+    void updateVoiceLimits();
 
     void addSpatialSound(QSpatialSound *sound);
     void removeSpatialSound(QSpatialSound *sound);
@@ -83,7 +146,17 @@ public:
 
     void addRoom(QAudioRoom *room);
     void removeRoom(QAudioRoom *room);
-    void updateRooms();
+    void scheduleRoomIndexUpdate();
+    void updateRoomIndex();
+    void releaseRetiredRoomIndexes();
+    // The room containing the listener, as seen by the thread owning the engine
+    const QAudioRoomIndex::Entry *listenerRoom() const;
+    // Updates the room effects of all sounds if the listener changed rooms. Called
+    // by the thread owning the engine.
+    void updateListenerRoom();
+    // Applies the reflections and reverb of the listener's room, called by the audio thread
+    void updateRooms(qint64 frames);
+    void updateSourceRoomEffects(const QAudioRoomIndex::Entry *room);
 
     QVector3D listenerPosition() const;
 };
@@ -91,10 +164,8 @@ public:
 class QAmbientSoundPrivate : public QObject
 {
 public:
-    QAmbientSoundPrivate(QObject *parent, int nchannels = 2)
-        : QObject(parent)
-        , nchannels(nchannels)
-    {}
+    QAmbientSoundPrivate(QObject *parent, int nchannels = 2);
+    ~QAmbientSoundPrivate();
 
     template<typename T>
     static QAmbientSoundPrivate *get(T *soundSource) { return soundSource ? soundSource->d : nullptr; }
@@ -102,21 +173,45 @@ public:
     QUrl url;
     float volume = 1.;
     int nchannels = 2;
-    std::unique_ptr<QAudioDecoder> decoder;
-    std::unique_ptr<QFile> sourceDeviceFile;
     QAudioEngine *engine = nullptr;
-
-    QMutex mutex;
+    bool streaming = false;
+
+    // The data the audio thread plays from. Replaced as a whole when loading a
+    // new source and handed to the audio thread without locking, so that
+    // getBuffer() never waits for the thread owning the sound.
+    struct PlaybackSource
+    {
+        // Decoded data is shared with all other sounds playing the same file,
+        // only the playback position is per sound.
+        std::shared_ptr<QDecodedAudioAsset> asset;
+        // Used instead of asset when streaming
+        std::unique_ptr<QStreamedAudioAsset> stream;
+    };
+    std::unique_ptr<PlaybackSource> source;
+    std::atomic<PlaybackSource *> publishedSource = nullptr;
+    // Set by the audio thread while it uses a source, which may therefore not
+    // be deleted yet
+    std::atomic<PlaybackSource *> sourceInUse = nullptr;
+    std::vector<std::unique_ptr<PlaybackSource>> retiredSources;
+    // Retries releasing sources the audio thread was still using
+    QTimer retireTimer;
+
+    // Playback position, only accessed from the audio thread. Other threads
+    // request rewinding it through resetRequests.
     int currentBuffer = 0;
     int bufPos = 0;
     int m_currentLoop = 0;
-    QList<QAudioBuffer> buffers;
-    int sourceId = -1; // kInvalidSourceId
+    int handledResets = 0;
+    std::atomic<int> resetRequests = 0;
+
+    // The Resonance Audio source, kInvalidSourceId while not added to an engine.
+    // Replaced by the thread owning the sound when the rendering mode of a spatial
+    // sound changes, while the audio thread reads it for every block.
+    std::atomic<int> sourceId = -1;
 
     QAtomicInteger<bool> m_autoPlay = true;
     QAtomicInteger<bool> m_playing = false;
     QAtomicInt m_loops = 1;
-    bool m_loading = false;
 
     void play() {
         m_playing = true;
@@ -125,20 +220,22 @@ public:
         m_playing = false;
     }
     void stop() {
-        QMutexLocker locker(&mutex);
         m_playing = false;
-        currentBuffer = 0;
-        bufPos = 0;
-        m_currentLoop = 0;
+        resetRequests.fetch_add(1, std::memory_order_release);
+        if (source && source->stream)
+            source->stream->rewind();
     }
 
     void load();
     void getBuffer(float *buf, int frames, int channels);
 
+private:
+    void publishSource(std::unique_ptr<PlaybackSource> newSource);
+    void releaseRetiredSources();
+    void getStreamedBuffer(QStreamedAudioAsset *stream, float *buf, int frames);
+
 private Q_SLOTS:
     void bufferReady();
-    void finished();
-
 };
 
 QT_END_NAMESPACE
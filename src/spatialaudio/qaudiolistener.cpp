@@ -65,6 +65,7 @@ void QAudioListener::setPosition(QVector3D pos)
     if (ep && ep->resonanceAudio->api) {
         ep->resonanceAudio->api->SetHeadPosition(pos.x(), pos.y(), pos.z());
         ep->listenerPositionDirty = true;
+        ep->updateListenerRoom();
     }
 }
 
@@ -0,0 +1,208 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#include <qaudioocclusion_p.h>
+#include <qaudioengine_p.h>
+#include <qaudioroom_p.h>
+#include <qspatialsound_p.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qpromise.h>
+#include <QtCore/qthreadpool.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Stop counting walls beyond this, the sound is inaudible anyway
+constexpr int maxCrossings = 16;
+// Step past a hit, so that the next ray doesn't hit the same triangle again
+constexpr float surfaceOffset = 1e-4f;
+
+// The walls of a room without a mesh, relative to its center
+std::shared_ptr<const QAudioRoomGeometry> boxGeometry(const QAudioRoomPrivate *rp)
+{
+    const auto &props = rp->roomProperties;
+    const QVector3D h =
+            QVector3D(props.dimensions[0], props.dimensions[1], props.dimensions[2]) / 2.f;
+    QList<QVector3D> vertices;
+    for (int i = 0; i < 8; ++i)
+        vertices.append(QVector3D(i & 1 ? h.x() : -h.x(), i & 2 ? h.y() : -h.y(),
+                                  i & 4 ? h.z() : -h.z()));
+    // In the order of QAudioRoom::Wall: left, right, floor, ceiling, front, back
+    constexpr int quads[vraudio::kNumRoomSurfaces][4] = {
+        { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 1, 3, 2 },
+        { 4, 6, 7, 5 }, { 2, 3, 7, 6 }, { 0, 4, 5, 1 }
+    };
+    QList<int> indices;
+    QList<QAudioRoom::Material> materials;
+    for (int wall = 0; wall < int(vraudio::kNumRoomSurfaces); ++wall) {
+        const auto &q = quads[wall];
+        indices << q[0] << q[1] << q[2] << q[0] << q[2] << q[3];
+        const auto material = QAudioRoom::Material(props.material_names[wall]);
+        materials << material << material;
+    }
+    return std::make_shared<const QAudioRoomGeometry>(vertices, indices, materials);
+}
+
+std::unique_ptr<QAudioRoomGeometry>
+mergeMeshes(const std::vector<QAudioOcclusionTracer::RoomMesh> &meshes)
+{
+    QList<QVector3D> vertices;
+    QList<int> indices;
+    QList<QAudioRoom::Material> materials;
+    for (const auto &mesh : meshes) {
+        for (const auto &tri : mesh.geometry->triangles()) {
+            for (const QVector3D &v : { tri.v0, tri.v0 + tri.edge1, tri.v0 + tri.edge2 }) {
+                indices.append(int(vertices.size()));
+                vertices.append(mesh.position + mesh.rotation.rotatedVector(v));
+            }
+            materials.append(tri.material);
+        }
+    }
+    if (indices.isEmpty())
+        return nullptr;
+    return std::make_unique<QAudioRoomGeometry>(vertices, indices, materials);
+}
+
+}
+
+QAudioOcclusionTracer::QAudioOcclusionTracer(QAudioEngine *engine)
+    : m_engine(engine)
+    , m_occluders(std::make_shared<Occluders>())
+{
+    QObject::connect(&m_timer, &QTimer::timeout, engine, [this] { update(); });
+}
+
+QAudioOcclusionTracer::~QAudioOcclusionTracer() = default;
+
+void QAudioOcclusionTracer::setUpdateRate(int rate)
+{
+    if (rate <= 0) {
+        m_timer.stop();
+        clear();
+        return;
+    }
+    const bool wasActive = m_timer.isActive();
+    m_timer.start(std::max(1, 1000 / rate));
+    if (!wasActive) {
+        // The traced occlusion replaces the estimate from the walls of the listener's room
+        clear();
+        update();
+    }
+}
+
+float QAudioOcclusionTracer::occlusion(const QAudioRoomGeometry &geometry, const QVector3D &from,
+                                       const QVector3D &to)
+{
+    QVector3D dir = to - from;
+    float remaining = dir.length();
+    if (remaining < surfaceOffset)
+        return 0;
+    dir /= remaining;
+
+    QVector3D origin = from;
+    float total = 0;
+    for (int i = 0; i < maxCrossings; ++i) {
+        float distance = 0;
+        const int hit = geometry.intersect(origin, dir, &distance);
+        if (hit < 0 || distance >= remaining)
+            break;
+        total += QAudioRoomPrivate::materialOcclusion(geometry.triangles()[hit].material);
+        origin += dir * (distance + surfaceOffset);
+        remaining -= distance + surfaceOffset;
+    }
+    return total;
+}
+
+void QAudioOcclusionTracer::update()
+{
+    if (m_running)
+        return;
+    auto *ep = QAudioEnginePrivate::get(m_engine);
+
+    const QVector3D listener = ep->listenerPosition() * ep->distanceScale;
+    // Sounds are matched by id when applying the results, a sound allocated at the
+    // address of one deleted in the meantime must not pick up its occlusion
+    std::vector<quint64> ids;
+    std::vector<QVector3D> positions;
+    ids.reserve(ep->sources.size());
+    positions.reserve(ep->sources.size());
+    for (auto *s : std::as_const(ep->sources)) {
+        auto *sp = QSpatialSoundPrivate::get(s);
+        ids.push_back(sp->id);
+        positions.push_back(sp->pos);
+    }
+
+    std::vector<RoomMesh> meshes;
+    const bool rebuild = m_occludersDirty;
+    if (rebuild) {
+        for (auto *room : std::as_const(ep->rooms)) {
+            auto *rp = QAudioRoomPrivate::get(room);
+            const auto &props = rp->roomProperties;
+            const QVector3D position(props.position[0], props.position[1], props.position[2]);
+            // resonance audio puts the scalar component last
+            const QQuaternion rotation(props.rotation[3], props.rotation[0], props.rotation[1],
+                                       props.rotation[2]);
+            if (rp->geometry) {
+                meshes.push_back({ rp->geometry, position, rotation });
+            } else {
+                // Rooms without a mesh are found by rotating into room coordinates, see
+                // QAudioRoomIndex::Entry::contains(), so rotate back for world space
+                meshes.push_back({ boxGeometry(rp), position, rotation.conjugated() });
+            }
+        }
+        m_occludersDirty = false;
+    }
+
+    m_running = true;
+    auto promise = std::make_shared<QPromise<std::vector<float>>>();
+    QFuture<std::vector<float>> future = promise->future();
+
+    QThreadPool::globalInstance()->start(
+            [promise, occluders = m_occluders, meshes = std::move(meshes), rebuild, listener,
+             positions = std::move(positions)]() {
+                promise->start();
+                if (rebuild)
+                    occluders->geometry = mergeMeshes(meshes);
+                std::vector<float> result(positions.size());
+                if (occluders->geometry) {
+                    for (size_t i = 0; i < positions.size(); ++i)
+                        result[i] = occlusion(*occluders->geometry, listener, positions[i]);
+                }
+                promise->addResult(std::move(result));
+                promise->finish();
+            });
+
+    future.then(m_engine, [this, ids = std::move(ids)](const std::vector<float> &result) {
+        m_running = false;
+        // disabled in the meantime
+        if (!m_timer.isActive())
+            return;
+        QHash<quint64, float> occlusionById;
+        occlusionById.reserve(qsizetype(ids.size()));
+        for (size_t i = 0; i < ids.size(); ++i)
+            occlusionById.insert(ids[i], result[i]);
+        // sounds may have been added or removed in the meantime
+        auto *ep = QAudioEnginePrivate::get(m_engine);
+        for (auto *s : std::as_const(ep->sources)) {
+            auto *sp = QSpatialSoundPrivate::get(s);
+            const auto it = occlusionById.constFind(sp->id);
+            if (it == occlusionById.cend() || sp->geometryOcclusion == *it)
+                continue;
+            sp->geometryOcclusion = *it;
+            sp->updateOcclusion();
+        }
+    });
+}
+
+void QAudioOcclusionTracer::clear()
+{
+    auto *ep = QAudioEnginePrivate::get(m_engine);
+    for (auto *s : std::as_const(ep->sources)) {
+        auto *sp = QSpatialSoundPrivate::get(s);
+        sp->geometryOcclusion = 0.f;
+        sp->updateOcclusion();
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,78 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#ifndef QAUDIOOCCLUSION_P_H
+#define QAUDIOOCCLUSION_P_H
+
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <qtspatialaudioglobal_p.h>
+#include <qaudioroomgeometry_p.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qquaternion.h>
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioEngine;
+
+// Computes how much spatial sounds are occluded by the walls of rooms, see
+// QAudioEngine::occlusionUpdateRate. At every update, the positions of the listener
+// and all sounds are handed to a worker thread, which casts a ray from the listener
+// to every sound. The results are applied once they are back on the thread owning
+// the engine; updates are skipped while the previous one is still running.
+class QAudioOcclusionTracer
+{
+public:
+    explicit QAudioOcclusionTracer(QAudioEngine *engine);
+    ~QAudioOcclusionTracer();
+
+    void setUpdateRate(int rate);
+
+    // The geometry or placement of rooms changed
+    void invalidateOccluders() { m_occludersDirty = true; }
+
+    // All geometry in world space, merged into one mesh with a single BVH
+    struct Occluders
+    {
+        std::unique_ptr<QAudioRoomGeometry> geometry;
+    };
+
+    // The mesh of a room, or a box for rooms without one. rotation maps room
+    // coordinates to world space.
+    struct RoomMesh
+    {
+        std::shared_ptr<const QAudioRoomGeometry> geometry;
+        QVector3D position;
+        QQuaternion rotation;
+    };
+
+    // Returns the occlusion along the line from from to to, summing up the
+    // occlusion of the materials of all triangles crossed
+    static float occlusion(const QAudioRoomGeometry &geometry, const QVector3D &from,
+                           const QVector3D &to);
+
+private:
+    void update();
+    void clear();
+
+    QAudioEngine *m_engine = nullptr;
+    QTimer m_timer;
+    bool m_running = false;
+    bool m_occludersDirty = true;
+    // Only accessed by the running update
+    std::shared_ptr<Occluders> m_occluders;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -1,6 +1,9 @@
 // Copyright (C) 2022 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
 #include <qaudioroom_p.h>
+#include <QtCore/qfuture.h>
+#include <QtCore/qpromise.h>
+#include <QtCore/qthreadpool.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -78,6 +81,11 @@ static_assert(QAudioRoom::Ceiling == 3);
 static_assert(QAudioRoom::FrontWall == 4);
 static_assert(QAudioRoom::BackWall == 5);
 
+float QAudioRoomPrivate::materialOcclusion(QAudioRoom::Material material)
+{
+    return occlusionAndDampening[material].occlusion;
+}
+
 float QAudioRoomPrivate::wallOcclusion(QAudioRoom::Wall wall) const
 {
     return m_wallOcclusion[wall] < 0 ? occlusionAndDampening[roomProperties.material_names[wall]].occlusion : m_wallOcclusion[wall];
@@ -88,12 +96,87 @@ float QAudioRoomPrivate::wallDampening(QAudioRoom::Wall wall) const
     return m_wallDampening[wall] < 0 ? occlusionAndDampening[roomProperties.material_names[wall]].dampening : m_wallDampening[wall];
 }
 
+bool QAudioRoomPrivate::buildGeometry()
+{
+    auto *ep = QAudioEnginePrivate::get(engine);
+    QList<QVector3D> scaled;
+    scaled.reserve(meshVertices.size());
+    for (const auto &v : std::as_const(meshVertices))
+        scaled.append(v * ep->distanceScale);
+
+    auto built = std::make_shared<const QAudioRoomGeometry>(scaled, meshIndices, meshMaterials);
+    if (built->isEmpty())
+        return false;
+    geometry = std::move(built);
+    return true;
+}
+
+void QAudioRoomPrivate::startEstimation(QAudioRoom *room)
+{
+    cancelEstimation();
+    if (!geometry)
+        return;
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    estimationCancelled = cancelled;
+    auto promise = std::make_shared<QPromise<QAudioRoomAcoustics>>();
+    QFuture<QAudioRoomAcoustics> future = promise->future();
+
+    QThreadPool::globalInstance()->start([promise, cancelled, geometry = geometry]() {
+        promise->start();
+        promise->addResult(QAudioRoomAcoustics::estimate(*geometry, *cancelled));
+        promise->finish();
+    });
+
+    // The continuation is dropped if the room gets destroyed in the meantime
+    future.then(room, [room, cancelled](const QAudioRoomAcoustics &result) {
+        if (cancelled->load())
+            return;
+        auto *d = QAudioRoomPrivate::get(room);
+        d->acoustics = result;
+        d->setDirty();
+        emit room->acousticsUpdated();
+    });
+}
+
+void QAudioRoomPrivate::cancelEstimation()
+{
+    if (estimationCancelled)
+        estimationCancelled->store(true);
+    estimationCancelled.reset();
+}
+
+void QAudioRoomPrivate::setDirty()
+{
+    dirty = true;
+    if (auto *ep = QAudioEnginePrivate::get(engine)) {
+        revision = ++ep->roomRevision;
+        ep->scheduleRoomIndexUpdate();
+    }
+}
+
 void QAudioRoomPrivate::update()
 {
     if (!dirty)
         return;
-    reflections = vraudio::ComputeReflectionProperties(roomProperties);
-    reverb = vraudio::ComputeReverbProperties(roomProperties);
+    if (acoustics) {
+        // Reflections from the proxy room, placed inside this room
+        vraudio::RoomProperties proxy = roomProperties;
+        const QVector3D center = toVector(roomProperties.position)
+                + toQuaternion(roomProperties.rotation).rotatedVector(acoustics->center);
+        toFloats(center, proxy.position);
+        toFloats(acoustics->dimensions, proxy.dimensions);
+        std::copy(std::begin(acoustics->materials), std::end(acoustics->materials),
+                  std::begin(proxy.material_names));
+        reflections = vraudio::ComputeReflectionProperties(proxy);
+        reverb = vraudio::ComputeReverbPropertiesFromRT60s(acoustics->rt60,
+                                                           roomProperties.reverb_brightness,
+                                                           roomProperties.reverb_time,
+                                                           roomProperties.reverb_gain);
+    } else {
+        reflections = vraudio::ComputeReflectionProperties(roomProperties);
+        reverb = vraudio::ComputeReverbProperties(roomProperties);
+    }
     dirty = false;
 }
 
@@ -116,6 +199,9 @@ void QAudioRoomPrivate::update()
 
     If multiple rooms cover the same position, the engine will use the room with the smallest
     volume.
+
+    For rooms that aren't well described by a box, setGeometry() can be used to
+    estimate reflections and reverb from a triangle mesh instead.
  */
 
 /*!
@@ -135,6 +221,7 @@ QAudioRoom::QAudioRoom(QAudioEngine *engine)
  */
 QAudioRoom::~QAudioRoom()
 {
+    d->cancelEstimation();
     auto *ep = QAudioEnginePrivate::get(d->engine);
     if (ep)
         ep->removeRoom(this);
@@ -201,7 +288,7 @@ void QAudioRoom::setPosition(QVector3D pos)
     if (toVector(d->roomProperties.position) == pos)
         return;
     toFloats(pos, d->roomProperties.position);
-    d->dirty = true;
+    d->setDirty();
     emit positionChanged();
 }
 
@@ -228,7 +315,7 @@ void QAudioRoom::setDimensions(QVector3D dim)
     if (toVector(d->roomProperties.dimensions) == dim)
         return;
     toFloats(dim, d->roomProperties.dimensions);
-    d->dirty = true;
+    d->setDirty();
     emit dimensionsChanged();
 }
 
@@ -250,7 +337,7 @@ void QAudioRoom::setRotation(const QQuaternion &q)
     if (toQuaternion(d->roomProperties.rotation) == q)
         return;
     toFloats(q, d->roomProperties.rotation);
-    d->dirty = true;
+    d->setDirty();
     emit rotationChanged();
 }
 
@@ -280,7 +367,7 @@ void QAudioRoom::setWallMaterial(Wall wall, Material material)
     if (d->roomProperties.material_names[int(wall)] == int(material))
         return;
     d->roomProperties.material_names[int(wall)] = vraudio::MaterialName(int(material));
-    d->dirty = true;
+    d->setDirty();
     emit wallsChanged();
 }
 
@@ -311,7 +398,7 @@ void QAudioRoom::setReflectionGain(float factor)
     if (d->roomProperties.reflection_scalar == factor)
         return;
     d->roomProperties.reflection_scalar = factor;
-    d->dirty = true;
+    d->setDirty();
     emit reflectionGainChanged();
 }
 
@@ -337,7 +424,7 @@ void QAudioRoom::setReverbGain(float factor)
     if (d->roomProperties.reverb_gain == factor)
         return;
     d->roomProperties.reverb_gain = factor;
-    d->dirty = true;
+    d->setDirty();
     emit reverbGainChanged();
 }
 
@@ -362,7 +449,7 @@ void QAudioRoom::setReverbTime(float factor)
     if (d->roomProperties.reverb_time == factor)
         return;
     d->roomProperties.reverb_time = factor;
-    d->dirty = true;
+    d->setDirty();
     emit reverbTimeChanged();
 }
 
@@ -385,7 +472,7 @@ void QAudioRoom::setReverbBrightness(float factor)
     if (d->roomProperties.reverb_brightness == factor)
         return;
     d->roomProperties.reverb_brightness = factor;
-    d->dirty = true;
+    d->setDirty();
     emit reverbBrightnessChanged();
 }
 
@@ -394,6 +481,95 @@ float QAudioRoom::reverbBrightness() const
     return d->roomProperties.reverb_brightness;
 }
 
+/*!
+    \fn void QAudioRoom::geometryChanged()
+    \since 6.7
+
+    Signals when the geometry of the room was set or cleared, and when it was
+    rescaled after a change of QAudioEngine::distanceScale.
+*/
+/*!
+    \fn void QAudioRoom::acousticsUpdated()
+    \since 6.7
+
+    Signals when reflections and reverb estimated from the geometry of the room
+    have been applied.
+
+    \sa setGeometry()
+*/
+/*!
+    \since 6.7
+
+    Sets the geometry of the room to a triangle mesh, given as a list of \a vertices
+    and a list of \a indices into it, three per triangle. Vertices are relative to
+    the room's position and rotate with the room. Units are in centimeters by default,
+    and the mesh follows later changes of QAudioEngine::distanceScale.
+
+    \a materials assigns a material to each triangle. Triangles without an entry
+    use the last material in the list, or UniformMaterial if the list is empty.
+
+    Reflections and reverb are then estimated by tracing sound rays through the mesh,
+    instead of from the box and wall materials of the room. As this is expensive, the
+    estimate runs in parallel on background threads; acousticsUpdated() is emitted
+    once it is in use. Until then, the box based properties remain in effect.
+
+    The position, rotation and dimensions of the room still define where the room
+    applies to the listener, so they should enclose the mesh. The gain, time and
+    brightness factors apply to the estimate as well.
+
+    The mesh also occludes sounds behind it if the engine computes occlusion, see
+    QAudioEngine::occlusionUpdateRate.
+
+    \sa clearGeometry(), hasGeometry(), QAudioEngine::distanceScale
+ */
+void QAudioRoom::setGeometry(const QList<QVector3D> &vertices, const QList<int> &indices,
+                             const QList<Material> &materials)
+{
+    d->meshVertices = vertices;
+    d->meshIndices = indices;
+    d->meshMaterials = materials;
+    if (!d->buildGeometry()) {
+        clearGeometry();
+        return;
+    }
+    d->startEstimation(this);
+    emit geometryChanged();
+}
+
+/*!
+    \since 6.7
+
+    Removes the geometry of the room, returning to reflections and reverb
+    computed from its box and wall materials.
+
+    \sa setGeometry()
+ */
+void QAudioRoom::clearGeometry()
+{
+    d->cancelEstimation();
+    d->meshVertices.clear();
+    d->meshIndices.clear();
+    d->meshMaterials.clear();
+    if (!d->geometry)
+        return;
+    d->geometry.reset();
+    d->acoustics.reset();
+    d->setDirty();
+    emit geometryChanged();
+}
+
+/*!
+    \since 6.7
+
+    Returns true if the room's acoustics are estimated from a triangle mesh.
+
+    \sa setGeometry()
+ */
+bool QAudioRoom::hasGeometry() const
+{
+    return d->geometry != nullptr;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qaudioroom.cpp"
@@ -87,6 +87,11 @@ public:
     void setReverbBrightness(float factor);
     float reverbBrightness() const;
 
+    void setGeometry(const QList<QVector3D> &vertices, const QList<int> &indices,
+                     const QList<Material> &materials = {});
+    void clearGeometry();
+    bool hasGeometry() const;
+
 Q_SIGNALS:
     void positionChanged();
     void dimensionsChanged();
@@ -96,6 +101,8 @@ Q_SIGNALS:
     void reverbGainChanged();
     void reverbTimeChanged();
     void reverbBrightnessChanged();
+    void geometryChanged();
+    void acousticsUpdated();
 
 private:
     friend class QAudioRoomPrivate;
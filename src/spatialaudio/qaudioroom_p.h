@@ -16,12 +16,17 @@
 #include <qtspatialaudioglobal_p.h>
 #include <qaudioroom.h>
 #include <qaudioengine_p.h>
+#include <qaudioroomgeometry_p.h>
 #include <QtGui/qquaternion.h>
 
 #include <resonance_audio.h>
 #include "platforms/common/room_effects_utils.h"
 #include "platforms/common/room_properties.h"
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class QAudioRoomPrivate
@@ -31,7 +36,10 @@ public:
 
     QAudioEngine *engine = nullptr;
     vraudio::RoomProperties roomProperties;
+    // Reflections and reverb need to be recomputed
     bool dirty = true;
+    // Changes with every property change, see QAudioRoomIndex
+    quint64 revision = 0;
 
     vraudio::ReverbProperties reverb;
     vraudio::ReflectionProperties reflections;
@@ -39,9 +47,30 @@ public:
     float m_wallOcclusion[6] = { -1.f, -1.f, -1.f, -1.f, -1.f, -1.f };
     float m_wallDampening[6] = { -1.f, -1.f, -1.f, -1.f, -1.f, -1.f };
 
+    // Mesh based acoustics, see QAudioRoom::setGeometry(). The mesh is kept as
+    // set, so that it can be rescaled when the engine's distance scale changes.
+    QList<QVector3D> meshVertices;
+    QList<int> meshIndices;
+    QList<QAudioRoom::Material> meshMaterials;
+    std::shared_ptr<const QAudioRoomGeometry> geometry;
+    std::shared_ptr<std::atomic<bool>> estimationCancelled;
+    // Set from the thread owning the room once an estimate is ready. Only read by
+    // update() on the same thread, the audio thread gets the results through
+    // QAudioRoomIndex, so this needs no lock.
+    std::optional<QAudioRoomAcoustics> acoustics;
+
+    // Default occlusion of sound passing through a surface made of material
+    static float materialOcclusion(QAudioRoom::Material material);
     float wallOcclusion(QAudioRoom::Wall wall) const;
     float wallDampening(QAudioRoom::Wall wall) const;
 
+    // Builds geometry from the mesh at the current distance scale, returns false
+    // if the mesh has no usable triangles
+    bool buildGeometry();
+    void startEstimation(QAudioRoom *room);
+    void cancelEstimation();
+    // Marks the room as changed and schedules an update of the engine's room index
+    void setDirty();
     void update();
 };
 
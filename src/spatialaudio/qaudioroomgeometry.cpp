@@ -0,0 +1,427 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#include <qaudioroomgeometry_p.h>
+#include <QtCore/qmath.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qthreadpool.h>
+
+#include "geometrical_acoustics/estimating_rt60.h"
+#include "platforms/common/room_effects_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+constexpr int maxLeafSize = 4;
+
+// Tracing parameters. The energy histograms are sampled at 1kHz, which is plenty
+// for fitting the decay of the reverb tail.
+constexpr int rayCount = 4096;
+constexpr int raysPerBatch = 64;
+constexpr int maxReflections = 256;
+constexpr float histogramRate = 1000.f;
+constexpr float maxReverbTime = 10.f;
+constexpr float minEnergy = 1e-7f;
+// Fraction of the energy reflected diffusely instead of specularly
+constexpr float scattering = 0.3f;
+// Attempts to find a ray origin enclosed by the mesh, before using the center
+constexpr int originAttempts = 16;
+
+// Air absorption coefficients as used by Resonance Audio's Eyring estimate.
+// The energy decays by exp(-4 * m * distance).
+constexpr float airAbsorption[vraudio::kNumReverbOctaveBands] = {
+    0.0006f, 0.0006f, 0.0007f, 0.0008f, 0.0010f, 0.0015f, 0.0026f, 0.0060f, 0.0207f
+};
+
+bool intersectBounds(const QVector3D &min, const QVector3D &max, const QVector3D &origin,
+                     const QVector3D &invDir, float maxDistance)
+{
+    float tmin = 0;
+    float tmax = maxDistance;
+    for (int i = 0; i < 3; ++i) {
+        float t0 = (min[i] - origin[i]) * invDir[i];
+        float t1 = (max[i] - origin[i]) * invDir[i];
+        if (t0 > t1)
+            std::swap(t0, t1);
+        tmin = std::max(tmin, t0);
+        tmax = std::min(tmax, t1);
+        if (tmin > tmax)
+            return false;
+    }
+    return true;
+}
+
+// Moeller-Trumbore intersection, returns the distance or a negative value on a miss
+float intersectTriangle(const QAudioRoomGeometry::Triangle &tri, const QVector3D &origin,
+                        const QVector3D &dir)
+{
+    constexpr float epsilon = 1e-7f;
+    const QVector3D p = QVector3D::crossProduct(dir, tri.edge2);
+    const float det = QVector3D::dotProduct(tri.edge1, p);
+    if (std::abs(det) < epsilon)
+        return -1;
+    const float invDet = 1.f / det;
+    const QVector3D s = origin - tri.v0;
+    const float u = QVector3D::dotProduct(s, p) * invDet;
+    if (u < 0 || u > 1)
+        return -1;
+    const QVector3D q = QVector3D::crossProduct(s, tri.edge1);
+    const float v = QVector3D::dotProduct(dir, q) * invDet;
+    if (v < 0 || u + v > 1)
+        return -1;
+    return QVector3D::dotProduct(tri.edge2, q) * invDet;
+}
+
+QVector3D triangleCenter(const QAudioRoomGeometry::Triangle &tri)
+{
+    return tri.v0 + (tri.edge1 + tri.edge2) / 3.f;
+}
+
+QVector3D uniformSphere(float r1, float r2)
+{
+    const float z = 1.f - 2.f * r1;
+    const float r = std::sqrt(std::max(0.f, 1.f - z * z));
+    const float phi = 2.f * float(M_PI) * r2;
+    return QVector3D(r * std::cos(phi), r * std::sin(phi), z);
+}
+
+QVector3D cosineHemisphere(const QVector3D &normal, float r1, float r2)
+{
+    const QVector3D a = std::abs(normal.x()) > 0.9f ? QVector3D(0, 1, 0) : QVector3D(1, 0, 0);
+    const QVector3D u = QVector3D::crossProduct(a, normal).normalized();
+    const QVector3D v = QVector3D::crossProduct(normal, u);
+    const float phi = 2.f * float(M_PI) * r1;
+    const float s = std::sqrt(r2);
+    return u * (std::cos(phi) * s) + v * (std::sin(phi) * s) + normal * std::sqrt(1.f - r2);
+}
+
+// A point is considered inside the room if the mesh surrounds it along all axes
+bool isEnclosed(const QAudioRoomGeometry &geometry, const QVector3D &point)
+{
+    static const QVector3D axes[] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 },
+                                      { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    float distance = 0;
+    return std::all_of(std::begin(axes), std::end(axes), [&](const QVector3D &axis) {
+        return geometry.intersect(point, axis, &distance) >= 0;
+    });
+}
+
+// Runs function(i) for i in [0, count) on the global thread pool. The calling
+// thread takes part, so that this cannot deadlock when called from a task of a
+// busy pool, and no threads besides the pool's get started.
+void parallelFor(int count, const std::function<void(int)> &function)
+{
+    struct Work
+    {
+        std::function<void(int)> function;
+        int count = 0;
+        std::atomic<int> next = 0;
+        QSemaphore done;
+
+        void run()
+        {
+            for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                function(i);
+                done.release();
+            }
+        }
+    };
+    auto work = std::make_shared<Work>();
+    work->function = function;
+    work->count = count;
+
+    // Helpers starting after all items were taken return right away, without
+    // touching the function or what it refers to
+    QThreadPool *pool = QThreadPool::globalInstance();
+    const int helpers = std::min(count, pool->maxThreadCount()) - 1;
+    for (int i = 0; i < helpers; ++i)
+        pool->start([work] { work->run(); });
+    work->run();
+    work->done.acquire(count);
+}
+
+// Picks the Resonance Audio material whose absorption is closest to the given one
+vraudio::MaterialName closestMaterial(const float *absorption)
+{
+    vraudio::MaterialName best = vraudio::kUniform;
+    float bestError = std::numeric_limits<float>::max();
+    // Transparent surfaces would open the proxy room, skip them
+    for (size_t i = vraudio::kTransparent + 1; i < size_t(vraudio::kNumMaterialNames); ++i) {
+        const auto material = vraudio::GetRoomMaterial(i);
+        float error = 0;
+        for (size_t band = 0; band < vraudio::kNumReverbOctaveBands; ++band) {
+            const float d = material.absorption_coefficients[band] - absorption[band];
+            error += d * d;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = material.name;
+        }
+    }
+    return best;
+}
+
+}
+
+QAudioRoomGeometry::QAudioRoomGeometry(const QList<QVector3D> &vertices,
+                                       const QList<int> &indices,
+                                       const QList<QAudioRoom::Material> &materials)
+{
+    m_triangles.reserve(indices.size() / 3);
+    for (qsizetype i = 0; i + 2 < indices.size(); i += 3) {
+        const int i0 = indices.at(i);
+        const int i1 = indices.at(i + 1);
+        const int i2 = indices.at(i + 2);
+        if (i0 < 0 || i1 < 0 || i2 < 0 || i0 >= vertices.size() || i1 >= vertices.size()
+            || i2 >= vertices.size())
+            continue;
+
+        Triangle tri;
+        tri.v0 = vertices.at(i0);
+        tri.edge1 = vertices.at(i1) - tri.v0;
+        tri.edge2 = vertices.at(i2) - tri.v0;
+        const QVector3D n = QVector3D::crossProduct(tri.edge1, tri.edge2);
+        tri.area = n.length() / 2.f;
+        if (qFuzzyIsNull(tri.area))
+            continue;
+        tri.normal = n.normalized();
+        const qsizetype triangle = i / 3;
+        if (!materials.isEmpty())
+            tri.material = materials.at(std::min(triangle, materials.size() - 1));
+        m_triangles.push_back(tri);
+    }
+
+    if (m_triangles.empty())
+        return;
+
+    m_nodes.reserve(2 * m_triangles.size() / maxLeafSize + 1);
+    build(0, int(m_triangles.size()));
+    m_min = m_nodes.front().min;
+    m_max = m_nodes.front().max;
+}
+
+int QAudioRoomGeometry::build(int first, int count)
+{
+    const int index = int(m_nodes.size());
+    m_nodes.emplace_back();
+
+    QVector3D min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::max());
+    QVector3D max = -min;
+    QVector3D centerMin = min;
+    QVector3D centerMax = max;
+    for (int i = first; i < first + count; ++i) {
+        const Triangle &tri = m_triangles[i];
+        for (const QVector3D &v : { tri.v0, tri.v0 + tri.edge1, tri.v0 + tri.edge2 }) {
+            for (int c = 0; c < 3; ++c) {
+                min[c] = std::min(min[c], v[c]);
+                max[c] = std::max(max[c], v[c]);
+            }
+        }
+        const QVector3D center = triangleCenter(tri);
+        for (int c = 0; c < 3; ++c) {
+            centerMin[c] = std::min(centerMin[c], center[c]);
+            centerMax[c] = std::max(centerMax[c], center[c]);
+        }
+    }
+    m_nodes[index].min = min;
+    m_nodes[index].max = max;
+
+    if (count <= maxLeafSize) {
+        m_nodes[index].first = first;
+        m_nodes[index].count = count;
+        return index;
+    }
+
+    // Split at the median along the axis with the largest spread of triangle centers
+    const QVector3D extent = centerMax - centerMin;
+    int axis = 0;
+    if (extent.y() > extent[axis])
+        axis = 1;
+    if (extent.z() > extent[axis])
+        axis = 2;
+    const int half = count / 2;
+    std::nth_element(m_triangles.begin() + first, m_triangles.begin() + first + half,
+                     m_triangles.begin() + first + count,
+                     [axis](const Triangle &a, const Triangle &b) {
+                         return triangleCenter(a)[axis] < triangleCenter(b)[axis];
+                     });
+
+    // The left child directly follows its parent
+    build(first, half);
+    const int right = build(first + half, count - half);
+    m_nodes[index].right = right;
+    return index;
+}
+
+int QAudioRoomGeometry::intersect(const QVector3D &origin, const QVector3D &dir,
+                                  float *distance) const
+{
+    if (m_nodes.empty())
+        return -1;
+
+    const QVector3D invDir(1.f / dir.x(), 1.f / dir.y(), 1.f / dir.z());
+    float closest = std::numeric_limits<float>::max();
+    int hit = -1;
+
+    int stack[64];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize) {
+        const int index = stack[--stackSize];
+        const Node &node = m_nodes[index];
+        if (!intersectBounds(node.min, node.max, origin, invDir, closest))
+            continue;
+        if (node.count) {
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                const float t = intersectTriangle(m_triangles[i], origin, dir);
+                if (t > 0 && t < closest) {
+                    closest = t;
+                    hit = i;
+                }
+            }
+        } else if (stackSize + 2 <= int(std::size(stack))) {
+            stack[stackSize++] = node.right;
+            stack[stackSize++] = index + 1;
+        }
+    }
+
+    if (hit >= 0)
+        *distance = closest;
+    return hit;
+}
+
+QAudioRoomAcoustics QAudioRoomAcoustics::estimate(const QAudioRoomGeometry &geometry,
+                                                  const std::atomic<bool> &cancelled)
+{
+    QAudioRoomAcoustics acoustics;
+    if (geometry.isEmpty())
+        return acoustics;
+
+    const QVector3D min = geometry.boundsMin();
+    const QVector3D max = geometry.boundsMax();
+    acoustics.center = (min + max) / 2.f;
+    acoustics.dimensions = max - min;
+
+    // Fit the proxy room: every triangle contributes its absorption to the wall of the
+    // bounding box closest to it.
+    float absorption[vraudio::kNumRoomSurfaces][vraudio::kNumReverbOctaveBands] = {};
+    float area[vraudio::kNumRoomSurfaces] = {};
+    const auto &triangles = geometry.triangles();
+    for (const auto &tri : triangles) {
+        const QVector3D c = triangleCenter(tri);
+        // In the order of the QAudioRoom::Wall enum
+        const float distances[vraudio::kNumRoomSurfaces] = {
+            c.x() - min.x(), max.x() - c.x(), c.y() - min.y(),
+            max.y() - c.y(), c.z() - min.z(), max.z() - c.z(),
+        };
+        const size_t wall = std::min_element(std::begin(distances), std::end(distances))
+                - std::begin(distances);
+        const auto material = vraudio::GetRoomMaterial(size_t(tri.material));
+        for (size_t band = 0; band < vraudio::kNumReverbOctaveBands; ++band)
+            absorption[wall][band] += material.absorption_coefficients[band] * tri.area;
+        area[wall] += tri.area;
+    }
+    for (size_t wall = 0; wall < vraudio::kNumRoomSurfaces; ++wall) {
+        if (qFuzzyIsNull(area[wall])) {
+            acoustics.materials[wall] = vraudio::kTransparent;
+            continue;
+        }
+        for (float &a : absorption[wall])
+            a /= area[wall];
+        acoustics.materials[wall] = closestMaterial(absorption[wall]);
+    }
+
+    // Trace rays from random points inside the room, collecting the energy remaining after
+    // each reflection into per band histograms. The decay of those gives the reverb time.
+    const size_t bins = size_t(maxReverbTime * histogramRate);
+    std::vector<std::vector<float>> histograms(vraudio::kNumReverbOctaveBands,
+                                               std::vector<float>(bins));
+    std::mutex mutex;
+    constexpr int batches = rayCount / raysPerBatch;
+
+    parallelFor(batches, [&](const int batch) {
+        std::vector<float> local(vraudio::kNumReverbOctaveBands * bins);
+        // Seeded per batch, so that the estimate doesn't depend on the scheduling
+        std::mt19937 generator(uint(batch));
+        std::uniform_real_distribution<float> random(0.f, 1.f);
+
+        for (int ray = 0; ray < raysPerBatch; ++ray) {
+            if (cancelled.load(std::memory_order_relaxed))
+                return;
+
+            QVector3D origin = acoustics.center;
+            for (int attempt = 0; attempt < originAttempts; ++attempt) {
+                const QVector3D candidate = min
+                        + QVector3D(random(generator), random(generator), random(generator))
+                                * acoustics.dimensions;
+                if (isEnclosed(geometry, candidate)) {
+                    origin = candidate;
+                    break;
+                }
+            }
+            QVector3D dir = uniformSphere(random(generator), random(generator));
+            float energy[vraudio::kNumReverbOctaveBands];
+            std::fill(std::begin(energy), std::end(energy), 1.f);
+            float travelled = 0;
+
+            for (int reflection = 0; reflection < maxReflections; ++reflection) {
+                float distance = 0;
+                const int hit = geometry.intersect(origin, dir, &distance);
+                if (hit < 0)
+                    break; // escaped through an opening
+
+                travelled += distance;
+                const size_t bin = size_t(travelled / vraudio::kSpeedOfSound * histogramRate);
+                if (bin >= bins)
+                    break;
+
+                const auto &tri = triangles[hit];
+                const auto material = vraudio::GetRoomMaterial(size_t(tri.material));
+                float maxEnergy = 0;
+                for (size_t band = 0; band < vraudio::kNumReverbOctaveBands; ++band) {
+                    energy[band] *= (1.f - material.absorption_coefficients[band])
+                            * std::exp(-4.f * airAbsorption[band] * distance);
+                    local[band * bins + bin] += energy[band];
+                    maxEnergy = std::max(maxEnergy, energy[band]);
+                }
+                if (maxEnergy < minEnergy)
+                    break;
+
+                QVector3D normal = tri.normal;
+                if (QVector3D::dotProduct(normal, dir) > 0)
+                    normal = -normal;
+                origin += dir * distance + normal * 1e-4f;
+                if (random(generator) < scattering)
+                    dir = cosineHemisphere(normal, random(generator), random(generator));
+                else
+                    dir -= 2.f * QVector3D::dotProduct(dir, normal) * normal;
+            }
+        }
+
+        std::lock_guard guard(mutex);
+        for (size_t band = 0; band < vraudio::kNumReverbOctaveBands; ++band) {
+            auto &histogram = histograms[band];
+            for (size_t i = 0; i < bins; ++i)
+                histogram[i] += local[band * bins + i];
+        }
+    });
+
+    if (cancelled.load(std::memory_order_relaxed))
+        return {};
+
+    for (size_t band = 0; band < vraudio::kNumReverbOctaveBands; ++band)
+        acoustics.rt60[band] = vraudio::EstimateRT60(histograms[band], histogramRate);
+    return acoustics;
+}
+
+QT_END_NAMESPACE
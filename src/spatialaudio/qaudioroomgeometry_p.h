@@ -0,0 +1,95 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#ifndef QAUDIOROOMGEOMETRY_P_H
+#define QAUDIOROOMGEOMETRY_P_H
+
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
+#include <qaudioroom.h>
+#include <QtCore/qlist.h>
+#include <QtGui/qvector3d.h>
+
+#include "base/constants_and_types.h"
+#include "platforms/common/room_properties.h"
+
+#include <atomic>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// A triangle mesh describing the surfaces of a room, in meters and relative to
+// the room's center. Triangles are kept in a bounding volume hierarchy, so that
+// rays can be traced against larger meshes.
+class Q_SPATIALAUDIO_EXPORT QAudioRoomGeometry
+{
+public:
+    QAudioRoomGeometry(const QList<QVector3D> &vertices, const QList<int> &indices,
+                       const QList<QAudioRoom::Material> &materials);
+
+    bool isEmpty() const { return m_triangles.empty(); }
+    QVector3D boundsMin() const { return m_min; }
+    QVector3D boundsMax() const { return m_max; }
+
+    struct Triangle
+    {
+        QVector3D v0;
+        QVector3D edge1;
+        QVector3D edge2;
+        QVector3D normal;
+        float area = 0;
+        QAudioRoom::Material material = QAudioRoom::UniformMaterial;
+    };
+    const std::vector<Triangle> &triangles() const { return m_triangles; }
+
+    // Finds the closest triangle hit by the ray. Returns the triangle index, or
+    // -1 if the ray leaves the mesh; distance is set to the distance along dir,
+    // which has to be normalized.
+    int intersect(const QVector3D &origin, const QVector3D &dir, float *distance) const;
+
+private:
+    struct Node
+    {
+        QVector3D min;
+        QVector3D max;
+        // Children for inner nodes, a range of m_triangles for leaves
+        int first = 0;
+        int count = 0;
+        int right = 0;
+    };
+    int build(int first, int count);
+
+    std::vector<Triangle> m_triangles;
+    std::vector<Node> m_nodes;
+    QVector3D m_min;
+    QVector3D m_max;
+};
+
+// Room acoustics estimated from a mesh: the RT60 of its reverb tail, and a
+// shoebox proxy room approximating its early reflections.
+struct Q_SPATIALAUDIO_EXPORT QAudioRoomAcoustics
+{
+    // Proxy room, relative to the room's center
+    QVector3D center;
+    QVector3D dimensions;
+    vraudio::MaterialName materials[vraudio::kNumRoomSurfaces] = {};
+    float rt60[vraudio::kNumReverbOctaveBands] = {};
+
+    // Traces rays through the mesh on all available cores; expensive, don't
+    // call from the audio or GUI thread. Returns early with an empty result
+    // once cancelled is set.
+    static QAudioRoomAcoustics estimate(const QAudioRoomGeometry &geometry,
+                                        const std::atomic<bool> &cancelled);
+};
+
+QT_END_NAMESPACE
+
+#endif
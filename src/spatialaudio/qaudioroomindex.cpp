@@ -0,0 +1,158 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#include <qaudioroomindex_p.h>
+#include <qaudioroom_p.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Upper bound for the number of cells along each axis
+constexpr int maxCells = 64;
+
+std::atomic<quint64> nextGeneration = 1;
+
+}
+
+bool QAudioRoomIndex::Entry::contains(const QVector3D &pos) const
+{
+    // transform into room coordinates
+    const QVector3D dist = rotation.rotatedVector(position - pos);
+    return qAbs(dist.x()) <= halfDimensions.x() && qAbs(dist.y()) <= halfDimensions.y()
+            && qAbs(dist.z()) <= halfDimensions.z();
+}
+
+std::unique_ptr<QAudioRoomIndex> QAudioRoomIndex::build(const QList<QAudioRoom *> &rooms)
+{
+    auto index = std::make_unique<QAudioRoomIndex>();
+    index->m_generation = nextGeneration.fetch_add(1, std::memory_order_relaxed);
+    if (rooms.isEmpty())
+        return index;
+
+    index->m_entries.reserve(rooms.size());
+    for (const QAudioRoom *room : rooms) {
+        auto *rp = QAudioRoomPrivate::get(room);
+        rp->update();
+
+        Entry e;
+        e.room = room;
+        e.revision = rp->revision;
+        const auto &props = rp->roomProperties;
+        e.position = QVector3D(props.position[0], props.position[1], props.position[2]);
+        e.halfDimensions =
+                QVector3D(props.dimensions[0], props.dimensions[1], props.dimensions[2]) / 2.f;
+        // resonance audio puts the scalar component last
+        e.rotation = QQuaternion(props.rotation[3], props.rotation[0], props.rotation[1],
+                                 props.rotation[2]);
+        e.volume = e.halfDimensions.x() * e.halfDimensions.y() * e.halfDimensions.z();
+        e.reflections = rp->reflections;
+        e.reverb = rp->reverb;
+        for (int wall = 0; wall < int(vraudio::kNumRoomSurfaces); ++wall) {
+            e.wallOcclusion[wall] = rp->wallOcclusion(QAudioRoom::Wall(wall));
+            e.wallDampening[wall] = rp->wallDampening(QAudioRoom::Wall(wall));
+        }
+        index->m_entries.push_back(e);
+    }
+    // Stable, so that equally sized rooms keep their order of creation
+    std::stable_sort(index->m_entries.begin(), index->m_entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.volume < b.volume; });
+
+    // World space bounds of each room
+    std::vector<std::pair<QVector3D, QVector3D>> bounds;
+    bounds.reserve(index->m_entries.size());
+    QVector3D min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                  std::numeric_limits<float>::max());
+    QVector3D max = -min;
+    for (const Entry &e : index->m_entries) {
+        // contains() rotates into room coordinates, so rotate back for the extents
+        const QQuaternion toWorld = e.rotation.conjugated();
+        QVector3D extent;
+        for (const QVector3D &axis : { QVector3D(e.halfDimensions.x(), 0, 0),
+                                       QVector3D(0, e.halfDimensions.y(), 0),
+                                       QVector3D(0, 0, e.halfDimensions.z()) }) {
+            const QVector3D v = toWorld.rotatedVector(axis);
+            extent += QVector3D(qAbs(v.x()), qAbs(v.y()), qAbs(v.z()));
+        }
+        bounds.emplace_back(e.position - extent, e.position + extent);
+        for (int c = 0; c < 3; ++c) {
+            min[c] = std::min(min[c], bounds.back().first[c]);
+            max[c] = std::max(max[c], bounds.back().second[c]);
+        }
+    }
+    index->m_min = min;
+    index->m_max = max;
+
+    // Aim for about one room per cell
+    const QVector3D size = max - min;
+    const float volume = std::max(size.x(), 1e-3f) * std::max(size.y(), 1e-3f)
+            * std::max(size.z(), 1e-3f);
+    const float cellSize = std::cbrt(volume / float(index->m_entries.size()));
+    int cellCount = 1;
+    for (int c = 0; c < 3; ++c) {
+        index->m_cells[c] = std::clamp(int(std::ceil(size[c] / cellSize)), 1, maxCells);
+        index->m_cellSize[c] = std::max(size[c] / float(index->m_cells[c]), 1e-6f);
+        cellCount *= index->m_cells[c];
+    }
+
+    // Two passes, counting the entries per cell first
+    auto forEachCell = [&](int entry, auto &&f) {
+        int lo[3];
+        int hi[3];
+        for (int c = 0; c < 3; ++c) {
+            const int last = index->m_cells[c] - 1;
+            lo[c] = std::clamp(int((bounds[entry].first[c] - min[c]) / index->m_cellSize[c]), 0, last);
+            hi[c] = std::clamp(int((bounds[entry].second[c] - min[c]) / index->m_cellSize[c]), 0, last);
+        }
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    f((z * index->m_cells[1] + y) * index->m_cells[0] + x);
+    };
+
+    index->m_cellStart.assign(cellCount + 1, 0);
+    for (int i = 0; i < int(index->m_entries.size()); ++i)
+        forEachCell(i, [&](int cell) { ++index->m_cellStart[cell + 1]; });
+    for (int cell = 0; cell < cellCount; ++cell)
+        index->m_cellStart[cell + 1] += index->m_cellStart[cell];
+
+    index->m_cellEntries.resize(index->m_cellStart.back());
+    std::vector<int> fill(index->m_cellStart.begin(), index->m_cellStart.end() - 1);
+    for (int i = 0; i < int(index->m_entries.size()); ++i)
+        forEachCell(i, [&](int cell) { index->m_cellEntries[fill[cell]++] = i; });
+
+    return index;
+}
+
+int QAudioRoomIndex::cellIndex(const QVector3D &pos) const
+{
+    int cell[3];
+    for (int c = 0; c < 3; ++c) {
+        if (pos[c] < m_min[c] || pos[c] > m_max[c])
+            return -1;
+        cell[c] = std::min(int((pos[c] - m_min[c]) / m_cellSize[c]), m_cells[c] - 1);
+    }
+    return (cell[2] * m_cells[1] + cell[1]) * m_cells[0] + cell[0];
+}
+
+const QAudioRoomIndex::Entry *QAudioRoomIndex::find(const QVector3D &pos) const
+{
+    if (m_entries.empty())
+        return nullptr;
+    const int cell = cellIndex(pos);
+    if (cell < 0)
+        return nullptr;
+    // Entries are sorted by volume, so the first match is the smallest room
+    for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+        const Entry &e = m_entries[m_cellEntries[i]];
+        if (e.contains(pos))
+            return &e;
+    }
+    return nullptr;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,86 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#ifndef QAUDIOROOMINDEX_P_H
+#define QAUDIOROOMINDEX_P_H
+
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
+#include <QtCore/qlist.h>
+#include <QtGui/qquaternion.h>
+#include <QtGui/qvector3d.h>
+
+#include "base/constants_and_types.h"
+#include "api/resonance_audio_api.h"
+
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioRoom;
+
+// An immutable snapshot of all rooms of an engine, with everything the audio thread
+// needs to apply them. Rooms are bucketed into a uniform grid, so that finding the
+// room containing the listener only tests the few rooms overlapping its cell.
+// All positions are in meters.
+class Q_SPATIALAUDIO_EXPORT QAudioRoomIndex
+{
+public:
+    struct Entry
+    {
+        // Identifies the room, but may only be dereferenced by the thread owning it
+        const QAudioRoom *room = nullptr;
+        // Changes whenever a property of the room changes
+        quint64 revision = 0;
+
+        QVector3D position;
+        QVector3D halfDimensions;
+        QQuaternion rotation;
+        float volume = 0;
+
+        vraudio::ReflectionProperties reflections;
+        vraudio::ReverbProperties reverb;
+        float wallOcclusion[vraudio::kNumRoomSurfaces] = {};
+        float wallDampening[vraudio::kNumRoomSurfaces] = {};
+
+        bool contains(const QVector3D &pos) const;
+    };
+
+    // Also brings the reflections and reverb of dirty rooms up to date, so it has to
+    // be called from the thread owning the rooms.
+    static std::unique_ptr<QAudioRoomIndex> build(const QList<QAudioRoom *> &rooms);
+
+    // Returns the smallest room containing pos, or nullptr
+    const Entry *find(const QVector3D &pos) const;
+
+    // Distinguishes snapshots, even if one is allocated where a previous one was
+    quint64 generation() const { return m_generation; }
+
+private:
+    int cellIndex(const QVector3D &pos) const;
+
+    // Sorted by volume
+    std::vector<Entry> m_entries;
+    // Entries overlapping each cell, in the order of m_entries. The entries of cell i
+    // are m_cellEntries[m_cellStart[i]] to m_cellEntries[m_cellStart[i + 1]].
+    std::vector<int> m_cellStart;
+    std::vector<int> m_cellEntries;
+    QVector3D m_min;
+    QVector3D m_max;
+    QVector3D m_cellSize;
+    int m_cells[3] = {};
+    quint64 m_generation = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,137 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#include <qaudiovoicemanager_p.h>
+#include <qaudioengine_p.h>
+#include <qspatialsound_p.h>
+#include <resonance_audio.h>
+
+#include "dsp/distance_attenuation.h"
+
+#include <algorithm>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Ranking is cheap, but changing the rendering mode of a sound recreates it in
+// Resonance Audio, so don't do it more often than needed
+constexpr int updateIntervalMs = 100;
+// Sounds quieter than this (about -30 dB) don't profit from HRTF rendering
+constexpr float quietGain = 0.03f;
+// A sound has to get this much (about 3.5 dB) louder than another one to take its
+// place in a better rendering mode. Otherwise two sounds of similar loudness would
+// keep swapping modes, and each swap drops a block of both.
+constexpr float hysteresis = 1.5f;
+
+}
+
+QAudioVoiceManager::QAudioVoiceManager(QAudioEngine *engine)
+    : m_engine(engine)
+{
+    QObject::connect(&m_timer, &QTimer::timeout, engine, [this] { update(); });
+}
+
+QAudioVoiceManager::~QAudioVoiceManager() = default;
+
+void QAudioVoiceManager::setLimits(int voiceLimit, int highQualityVoiceLimit)
+{
+    m_voiceLimit = voiceLimit;
+    m_highQualityVoiceLimit = highQualityVoiceLimit;
+    if (voiceLimit < 0 && highQualityVoiceLimit < 0) {
+        m_timer.stop();
+        clear();
+        return;
+    }
+    if (!m_timer.isActive())
+        m_timer.start(updateIntervalMs);
+    update();
+}
+
+float QAudioVoiceManager::audibility(const QSpatialSoundPrivate *sound, const QVector3D &listener)
+{
+    float attenuation = 1.f;
+    const vraudio::WorldPosition listenerPos(listener.x(), listener.y(), listener.z());
+    const vraudio::WorldPosition soundPos(sound->pos.x(), sound->pos.y(), sound->pos.z());
+    switch (sound->distanceModel) {
+    case QSpatialSound::DistanceModel::Logarithmic:
+        attenuation = vraudio::ComputeLogarithmicDistanceAttenuation(
+                listenerPos, soundPos, sound->size, sound->distanceCutoff);
+        break;
+    case QSpatialSound::DistanceModel::Linear:
+        attenuation = vraudio::ComputeLinearDistanceAttenuation(
+                listenerPos, soundPos, sound->size, sound->distanceCutoff);
+        break;
+    case QSpatialSound::DistanceModel::ManualAttenuation:
+        attenuation = sound->manualAttenuation;
+        break;
+    }
+    return sound->volume * sound->wallDampening * attenuation;
+}
+
+void QAudioVoiceManager::update()
+{
+    auto *ep = QAudioEnginePrivate::get(m_engine);
+    if (!ep->resonanceAudio->api)
+        return;
+
+    struct Voice
+    {
+        QSpatialSoundPrivate *sound;
+        float audibility;
+        // audibility, raised for sounds that are currently rendered in a better mode
+        float score;
+    };
+    const QVector3D listener = ep->listenerPosition() * ep->distanceScale;
+    std::vector<Voice> voices;
+    voices.reserve(ep->sources.size());
+    for (auto *s : std::as_const(ep->sources)) {
+        auto *sp = QSpatialSoundPrivate::get(s);
+        const float a = audibility(sp, listener);
+        float score = a;
+        if (!sp->virtualized.load(std::memory_order_relaxed)) {
+            score *= hysteresis;
+            if (sp->renderingMode == vraudio::kBinauralHighQuality)
+                score *= hysteresis;
+        }
+        voices.push_back({ sp, a, score });
+    }
+    std::stable_sort(voices.begin(), voices.end(), [](const Voice &a, const Voice &b) {
+        if (a.sound->priority != b.sound->priority)
+            return a.sound->priority > b.sound->priority;
+        return a.score > b.score;
+    });
+
+    // Stereo panned sounds don't end up in the ambisonic output used for surround
+    const bool canPan = ep->outputMode != QAudioEngine::Surround;
+    for (size_t i = 0; i < voices.size(); ++i) {
+        auto *sp = voices[i].sound;
+        const int rank = int(i);
+        const bool virtualize = voices[i].audibility <= 0.f
+                || (m_voiceLimit >= 0 && rank >= m_voiceLimit);
+        if (!virtualize) {
+            vraudio::RenderingMode mode = vraudio::kBinauralHighQuality;
+            if (m_highQualityVoiceLimit >= 0 && rank >= m_highQualityVoiceLimit) {
+                const float quiet = sp->renderingMode == vraudio::kStereoPanning
+                        ? quietGain * hysteresis
+                        : quietGain;
+                mode = canPan && voices[i].audibility < quiet ? vraudio::kStereoPanning
+                                                              : vraudio::kBinauralLowQuality;
+            }
+            sp->setRenderingMode(mode);
+        }
+        sp->virtualized.store(virtualize, std::memory_order_relaxed);
+    }
+}
+
+void QAudioVoiceManager::clear()
+{
+    auto *ep = QAudioEnginePrivate::get(m_engine);
+    for (auto *s : std::as_const(ep->sources)) {
+        auto *sp = QSpatialSoundPrivate::get(s);
+        sp->setRenderingMode(vraudio::kBinauralHighQuality);
+        sp->virtualized.store(false, std::memory_order_relaxed);
+    }
+}
+
+QT_END_NAMESPACE
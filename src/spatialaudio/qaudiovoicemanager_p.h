@@ -0,0 +1,56 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-3.0-only
+#ifndef QAUDIOVOICEMANAGER_P_H
+#define QAUDIOVOICEMANAGER_P_H
+
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qvector3d.h>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioEngine;
+class QSpatialSoundPrivate;
+
+// Limits the cost of rendering many spatial sounds, see QAudioEngine::voiceLimit.
+// Sounds are periodically ranked by priority and by how loud they currently are
+// at the listener. The most audible ones are rendered at high quality, the next
+// ones with cheaper rendering modes, and the rest is virtualized: their playback
+// position keeps advancing, but they are not rendered at all. Sounds keep their
+// mode until another one is clearly louder, so that similar sounds don't flip-flop.
+class Q_SPATIALAUDIO_EXPORT QAudioVoiceManager
+{
+public:
+    explicit QAudioVoiceManager(QAudioEngine *engine);
+    ~QAudioVoiceManager();
+
+    // Starts ranking sounds while a limit is set, restores all sounds otherwise
+    void setLimits(int voiceLimit, int highQualityVoiceLimit);
+
+    void update();
+
+    // Estimated gain of the direct sound at the listener
+    static float audibility(const QSpatialSoundPrivate *sound, const QVector3D &listener);
+
+private:
+    void clear();
+
+    QAudioEngine *m_engine = nullptr;
+    QTimer m_timer;
+    int m_voiceLimit = -1;
+    int m_highQualityVoiceLimit = -1;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -61,7 +61,7 @@ void QSpatialSound::setPosition(QVector3D pos)
     d->pos = pos;
     if (ep)
         ep->resonanceAudio->api->SetSourcePosition(d->sourceId, pos.x(), pos.y(), pos.z());
-    d->updateRoomEffects();
+    d->updateRoomEffects(ep ? ep->listenerRoom() : nullptr);
     emit positionChanged();
 }
 
@@ -144,6 +144,44 @@ void QSpatialSound::setDistanceModel(DistanceModel model)
     emit distanceModelChanged();
 }
 
+void QSpatialSoundPrivate::applyParameters()
+{
+    auto *ep = QAudioEnginePrivate::get(engine);
+    if (!ep || sourceId < 0)
+        return;
+    auto *api = ep->resonanceAudio->api;
+    api->SetSourcePosition(sourceId, pos.x(), pos.y(), pos.z());
+    api->SetSourceRotation(sourceId, rotation.x(), rotation.y(), rotation.z(), rotation.scalar());
+    api->SetSourceVolume(sourceId, volume*wallDampening);
+    api->SetSourceDistanceAttenuation(sourceId, manualAttenuation);
+    api->SetSoundObjectDirectivity(sourceId, directivity, directivityOrder);
+    api->SetSoundObjectNearFieldEffectGain(sourceId, nearFieldGain*9.f);
+    updateDistanceModel();
+    updateOcclusion();
+    updateRoomEffects(ep->listenerRoom());
+}
+
+void QSpatialSoundPrivate::setRenderingMode(vraudio::RenderingMode mode)
+{
+    if (renderingMode == mode)
+        return;
+    renderingMode = mode;
+    auto *ep = QAudioEnginePrivate::get(engine);
+    if (!ep || !ep->resonanceAudio->api || sourceId < 0)
+        return;
+
+    // The rendering mode of a Resonance Audio source is fixed, so replace the source.
+    // Both calls are queued and run by the audio thread before it passes on the next
+    // block, so at worst one block of the sound gets dropped. The new id is published
+    // after the creation has been queued, so the audio thread can't pass a block to a
+    // source that doesn't exist yet.
+    auto *api = ep->resonanceAudio->api;
+    const int oldSourceId = sourceId.load(std::memory_order_relaxed);
+    sourceId.store(api->CreateSoundObjectSource(mode), std::memory_order_release);
+    applyParameters();
+    api->DestroySource(oldSourceId);
+}
+
 void QSpatialSoundPrivate::updateDistanceModel()
 {
     if (!engine || sourceId < 0)
@@ -165,18 +203,17 @@ void QSpatialSoundPrivate::updateDistanceModel()
     ep->resonanceAudio->api->SetSourceDistanceModel(sourceId, dm, size, distanceCutoff);
 }
 
-void QSpatialSoundPrivate::updateRoomEffects()
+void QSpatialSoundPrivate::updateRoomEffects(const QAudioRoomIndex::Entry *room)
 {
     if (!engine || sourceId < 0)
         return;
     auto *ep = QAudioEnginePrivate::get(engine);
-    if (!ep->currentRoom)
+    if (!room)
         return;
-    auto *rp = QAudioRoomPrivate::get(ep->currentRoom);
 
-    QVector3D roomDim2 = ep->currentRoom->dimensions()/2.;
-    QVector3D roomPos = ep->currentRoom->position();
-    QQuaternion roomRot = ep->currentRoom->rotation();
+    QVector3D roomDim2 = room->halfDimensions;
+    QVector3D roomPos = room->position;
+    QQuaternion roomRot = room->rotation;
     QVector3D dist = pos - roomPos;
     // transform into room coordinates
     dist = roomRot.rotatedVector(dist);
@@ -193,7 +230,7 @@ void QSpatialSoundPrivate::updateRoomEffects()
         //
         // We basically cast a ray from the listener through the walls. If walls have different characteristics
         // and we get close to a corner, we try to use some averaging to avoid abrupt changes
-        auto relativeListenerPos = ep->listenerPosition() - roomPos;
+        auto relativeListenerPos = ep->listenerPosition()*ep->distanceScale - roomPos;
         relativeListenerPos = roomRot.rotatedVector(relativeListenerPos);
 
         auto direction = dist.normalized();
@@ -258,17 +295,28 @@ void QSpatialSoundPrivate::updateRoomEffects()
         wallDampening = 0;
         wallOcclusion = 0;
         for (int i = 0; i < 3; ++i) {
-            wallDampening += factors[i]*rp->wallDampening(walls[i]);
-            wallOcclusion += factors[i]*rp->wallOcclusion(walls[i]);
+            wallDampening += factors[i]*room->wallDampening[walls[i]];
+            wallOcclusion += factors[i]*room->wallOcclusion[walls[i]];
         }
 
 //        qDebug() << "intersection with wall" << walls[0] << walls[1] << walls[2] << factors[0] << factors[1] << factors[2] << wallDampening << wallOcclusion;
         ep->resonanceAudio->api->SetSourceRoomEffectsGain(sourceId, 0);
     }
-    ep->resonanceAudio->api->SetSoundObjectOcclusionIntensity(sourceId, occlusionIntensity + wallOcclusion);
+    updateOcclusion();
     ep->resonanceAudio->api->SetSourceVolume(sourceId, volume*wallDampening);
 }
 
+void QSpatialSoundPrivate::updateOcclusion()
+{
+    auto *ep = QAudioEnginePrivate::get(engine);
+    if (!ep || sourceId < 0)
+        return;
+    // Traced occlusion includes the walls of all rooms, so don't count them twice
+    const float walls = ep->occlusionUpdateRate > 0 ? geometryOcclusion : wallOcclusion;
+    ep->resonanceAudio->api->SetSoundObjectOcclusionIntensity(sourceId,
+                                                              occlusionIntensity + walls);
+}
+
 QSpatialSound::DistanceModel QSpatialSound::distanceModel() const
 {
     return d->distanceModel;
@@ -361,15 +409,18 @@ float QSpatialSound::manualAttenuation() const
     sound coming from the source.
 
     The default is 0.
+
+    If the engine computes occlusion from the geometry of rooms, that occlusion
+    is added to this value.
+
+    \sa QAudioEngine::occlusionUpdateRate
  */
 void QSpatialSound::setOcclusionIntensity(float occlusion)
 {
     if (d->occlusionIntensity == occlusion)
         return;
     d->occlusionIntensity = occlusion;
-    auto *ep = QAudioEnginePrivate::get(d->engine);
-    if (ep)
-        ep->resonanceAudio->api->SetSoundObjectOcclusionIntensity(d->sourceId, d->occlusionIntensity + d->wallOcclusion);
+    d->updateOcclusion();
     emit occlusionIntensityChanged();
 }
 
@@ -460,6 +511,32 @@ float QSpatialSound::nearFieldGain() const
     return d->nearFieldGain;
 }
 
+/*!
+    \property QSpatialSound::priority
+    \since 6.7
+
+    Defines the priority of the sound when the engine limits the number of
+    sounds it renders. Sounds with a higher priority are always rendered before
+    sounds with a lower one, sounds of equal priority are ranked by how loud they
+    are at the position of the listener.
+
+    The default is 0.
+
+    \sa QAudioEngine::voiceLimit
+ */
+void QSpatialSound::setPriority(int priority)
+{
+    if (d->priority == priority)
+        return;
+    d->priority = priority;
+    emit priorityChanged();
+}
+
+int QSpatialSound::priority() const
+{
+    return d->priority;
+}
+
 /*!
     \property QSpatialSound::source
 
@@ -528,6 +605,37 @@ void QSpatialSound::setAutoPlay(bool autoPlay)
         emit autoPlayChanged();
 }
 
+/*!
+    \property QSpatialSound::streaming
+    \since 6.7
+
+    Determines whether the sound file is decoded while playing instead of
+    being decoded completely upfront.
+
+    Streamed sounds only keep a short amount of decoded data ahead of the
+    current playback position in memory, which makes them suitable for long
+    sounds like background music. Their decoded data is not shared with
+    other sounds playing the same file.
+
+    Changing this property restarts loading the source.
+
+    The default value is \c false.
+ */
+bool QSpatialSound::isStreaming() const
+{
+    return d->streaming;
+}
+
+void QSpatialSound::setStreaming(bool streaming)
+{
+    if (d->streaming == streaming)
+        return;
+    d->streaming = streaming;
+    if (!d->url.isEmpty())
+        d->load();
+    emit streamingChanged();
+}
+
 /*!
     Starts playing back the sound. Does nothing if the sound is already playing.
  */
@@ -569,12 +677,7 @@ void QSpatialSound::setEngine(QAudioEngine *engine)
     ep = QAudioEnginePrivate::get(engine);
     if (ep) {
         ep->addSpatialSound(this);
-        ep->resonanceAudio->api->SetSourcePosition(d->sourceId, d->pos.x(), d->pos.y(), d->pos.z());
-        ep->resonanceAudio->api->SetSourceRotation(d->sourceId, d->rotation.x(), d->rotation.y(), d->rotation.z(), d->rotation.scalar());
-        ep->resonanceAudio->api->SetSourceVolume(d->sourceId, d->volume);
-        ep->resonanceAudio->api->SetSoundObjectDirectivity(d->sourceId, d->directivity, d->directivityOrder);
-        ep->resonanceAudio->api->SetSoundObjectNearFieldEffectGain(d->sourceId, d->nearFieldGain);
-        d->updateDistanceModel();
+        d->applyParameters();
     }
 }
 
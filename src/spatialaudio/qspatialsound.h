@@ -31,6 +31,8 @@ class Q_SPATIALAUDIO_EXPORT QSpatialSound : public QObject
     Q_PROPERTY(float nearFieldGain READ nearFieldGain WRITE setNearFieldGain NOTIFY nearFieldGainChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(bool streaming READ isStreaming WRITE setStreaming NOTIFY streamingChanged)
+    Q_PROPERTY(int priority READ priority WRITE setPriority NOTIFY priorityChanged)
 
 public:
     explicit QSpatialSound(QAudioEngine *engine);
@@ -52,6 +54,9 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    bool isStreaming() const;
+    void setStreaming(bool streaming);
+
     void setPosition(QVector3D pos);
     QVector3D position() const;
 
@@ -92,12 +97,16 @@ public:
     void setNearFieldGain(float gain);
     float nearFieldGain() const;
 
+    void setPriority(int priority);
+    int priority() const;
+
     QAudioEngine *engine() const;
 
 Q_SIGNALS:
     void sourceChanged();
     void loopsChanged();
     void autoPlayChanged();
+    void streamingChanged();
     void positionChanged();
     void rotationChanged();
     void volumeChanged();
@@ -109,6 +118,7 @@ Q_SIGNALS:
     void directivityChanged();
     void directivityOrderChanged();
     void nearFieldGainChanged();
+    void priorityChanged();
 
 public Q_SLOTS:
     void play();
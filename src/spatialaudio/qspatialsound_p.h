@@ -51,9 +51,23 @@ public:
     float nearFieldGain = 0.f;
     float wallDampening = 1.f;
     float wallOcclusion = 0.f;
+    // Computed from the geometry of rooms, see QAudioEngine::occlusionUpdateRate
+    float geometryOcclusion = 0.f;
+    // Identifies the sound within its engine, never reused
+    quint64 id = 0;
 
+    // See QAudioEngine::voiceLimit
+    int priority = 0;
+    vraudio::RenderingMode renderingMode = vraudio::kBinauralHighQuality;
+    // Set while the sound is virtualized. The audio thread then keeps advancing its
+    // playback position, but doesn't pass its data on to Resonance Audio.
+    std::atomic<bool> virtualized = false;
+
+    void applyParameters();
+    void setRenderingMode(vraudio::RenderingMode mode);
     void updateDistanceModel();
-    void updateRoomEffects();
+    void updateOcclusion();
+    void updateRoomEffects(const QAudioRoomIndex::Entry *room);
 };
 
 QT_END_NAMESPACE
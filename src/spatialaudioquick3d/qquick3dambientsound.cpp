@@ -31,6 +31,7 @@ QQuick3DAmbientSound::QQuick3DAmbientSound()
     connect(m_sound, &QAmbientSound::volumeChanged, this, &QQuick3DAmbientSound::volumeChanged);
     connect(m_sound, &QAmbientSound::loopsChanged, this, &QQuick3DAmbientSound::loopsChanged);
     connect(m_sound, &QAmbientSound::autoPlayChanged, this, &QQuick3DAmbientSound::autoPlayChanged);
+    connect(m_sound, &QAmbientSound::streamingChanged, this, &QQuick3DAmbientSound::streamingChanged);
 }
 
 QQuick3DAmbientSound::~QQuick3DAmbientSound()
@@ -112,6 +113,26 @@ void QQuick3DAmbientSound::setAutoPlay(bool autoPlay)
     m_sound->setAutoPlay(autoPlay);
 }
 
+/*!
+    \qmlproperty bool AmbientSound::streaming
+    \since 6.7
+
+    Determines whether the sound file is decoded while playing instead of
+    being decoded completely upfront, which is useful for long sounds like
+    background music.
+
+    The default value is \c false.
+ */
+bool QQuick3DAmbientSound::isStreaming() const
+{
+    return m_sound->isStreaming();
+}
+
+void QQuick3DAmbientSound::setStreaming(bool streaming)
+{
+    m_sound->setStreaming(streaming);
+}
+
 /*!
     \qmlmethod AmbientSound::play()
 
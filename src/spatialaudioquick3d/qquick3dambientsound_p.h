@@ -29,6 +29,7 @@ class QQuick3DAmbientSound : public QObject
     Q_PROPERTY(float volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(bool streaming READ isStreaming WRITE setStreaming NOTIFY streamingChanged REVISION(6, 7))
     QML_NAMED_ELEMENT(AmbientSound)
 
 public:
@@ -54,6 +55,9 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    bool isStreaming() const;
+    void setStreaming(bool streaming);
+
 public Q_SLOTS:
     void play();
     void pause();
@@ -64,6 +68,7 @@ Q_SIGNALS:
     void volumeChanged();
     void loopsChanged();
     void autoPlayChanged();
+    Q_REVISION(6, 7) void streamingChanged();
 
 private:
     QAmbientSound *m_sound = nullptr;
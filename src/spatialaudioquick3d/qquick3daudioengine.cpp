@@ -47,6 +47,11 @@ QQuick3DAudioEngine::QQuick3DAudioEngine()
     connect(e, &QAudioEngine::outputModeChanged, this, &QQuick3DAudioEngine::outputModeChanged);
     connect(e, &QAudioEngine::outputDeviceChanged, this, &QQuick3DAudioEngine::outputDeviceChanged);
     connect(e, &QAudioEngine::masterVolumeChanged, this, &QQuick3DAudioEngine::masterVolumeChanged);
+    connect(e, &QAudioEngine::blockSizeChanged, this, &QQuick3DAudioEngine::blockSizeChanged);
+    connect(e, &QAudioEngine::soundCacheLimitChanged, this, &QQuick3DAudioEngine::soundCacheLimitChanged);
+    connect(e, &QAudioEngine::occlusionUpdateRateChanged, this, &QQuick3DAudioEngine::occlusionUpdateRateChanged);
+    connect(e, &QAudioEngine::voiceLimitChanged, this, &QQuick3DAudioEngine::voiceLimitChanged);
+    connect(e, &QAudioEngine::highQualityVoiceLimitChanged, this, &QQuick3DAudioEngine::highQualityVoiceLimitChanged);
 }
 
 QQuick3DAudioEngine::~QQuick3DAudioEngine()
@@ -114,11 +119,130 @@ float QQuick3DAudioEngine::masterVolume() const
     return globalEngine->masterVolume();
 }
 
+/*!
+    \qmlproperty int AudioEngine::blockSize
+    \since 6.7
+
+    Defines the number of frames the engine processes at a time.
+
+    Smaller blocks reduce the latency with which changes to the sound field
+    become audible, larger blocks reduce the processing overhead per frame.
+    The block size has to be a power of two between 32 and 1024. The default
+    is 128.
+
+    The block size can only be set while the scene gets loaded, on an
+    AudioEngine that is declared before any other spatial audio element.
+ */
+void QQuick3DAudioEngine::setBlockSize(int frames)
+{
+    globalEngine->setBlockSize(frames);
+}
+
+int QQuick3DAudioEngine::blockSize() const
+{
+    return globalEngine->blockSize();
+}
+
+/*!
+    \qmlproperty qint64 AudioEngine::soundCacheLimit
+    \since 6.7
+
+    Defines the amount of memory in bytes the engine may use to keep decoded
+    sound files around that are currently not used by any sound.
+
+    Sounds playing the same file share its decoded data, so the file only has
+    to be decoded once. Decoded data that is in use by at least one sound is
+    never released, even if that exceeds the limit. The default is 64 MB.
+ */
+void QQuick3DAudioEngine::setSoundCacheLimit(qint64 bytes)
+{
+    globalEngine->setSoundCacheLimit(bytes);
+}
+
+qint64 QQuick3DAudioEngine::soundCacheLimit() const
+{
+    return globalEngine->soundCacheLimit();
+}
+
+/*!
+    \qmlproperty int AudioEngine::occlusionUpdateRate
+    \since 6.7
+
+    Defines how many times per second the engine computes how much each
+    SpatialSound is occluded by the walls of the rooms between it and the
+    listener.
+
+    Rooms with a \l{AudioRoom::model}{model} occlude with the triangles of its
+    geometry, all other rooms with the six walls of their box. The tracing
+    happens on a worker thread. The result is added to
+    SpatialSound::occlusionIntensity.
+
+    The default is 0, which disables computing occlusion.
+ */
+void QQuick3DAudioEngine::setOcclusionUpdateRate(int rate)
+{
+    globalEngine->setOcclusionUpdateRate(rate);
+}
+
+int QQuick3DAudioEngine::occlusionUpdateRate() const
+{
+    return globalEngine->occlusionUpdateRate();
+}
+
+/*!
+    \qmlproperty int AudioEngine::voiceLimit
+    \since 6.7
+
+    Defines the maximum number of spatial sounds the engine renders at the
+    same time.
+
+    Sounds are ranked by their \l{SpatialSound::priority}{priority} first,
+    and then by how loud they are at the position of the listener. Sounds
+    ranked beyond the limit keep their playback position advancing, but
+    don't cost any processing time for spatialization.
+
+    The default is -1, which renders all sounds.
+ */
+void QQuick3DAudioEngine::setVoiceLimit(int limit)
+{
+    globalEngine->setVoiceLimit(limit);
+}
+
+int QQuick3DAudioEngine::voiceLimit() const
+{
+    return globalEngine->voiceLimit();
+}
+
+/*!
+    \qmlproperty int AudioEngine::highQualityVoiceLimit
+    \since 6.7
+
+    Defines how many of the spatial sounds ranked highest are rendered with
+    the full quality of spatialization. Further sounds are spatialized with a
+    lower ambisonic order.
+
+    The default is -1, which renders all sounds at full quality.
+
+    \sa voiceLimit
+ */
+void QQuick3DAudioEngine::setHighQualityVoiceLimit(int limit)
+{
+    globalEngine->setHighQualityVoiceLimit(limit);
+}
+
+int QQuick3DAudioEngine::highQualityVoiceLimit() const
+{
+    return globalEngine->highQualityVoiceLimit();
+}
+
 QAudioEngine *QQuick3DAudioEngine::getEngine()
 {
     if (!globalEngine) {
         globalEngine = new QAudioEngine;
-        globalEngine->start();
+        // Start once the scene has been loaded, properties like the block size can
+        // only be set before
+        QMetaObject::invokeMethod(globalEngine, [] { globalEngine->start(); },
+                                  Qt::QueuedConnection);
     }
     return globalEngine;
 }
@@ -29,6 +29,11 @@ class QQuick3DAudioEngine : public QObject
     Q_PROPERTY(OutputMode outputMode READ outputMode WRITE setOutputMode NOTIFY outputModeChanged)
     Q_PROPERTY(QAudioDevice outputDevice READ outputDevice WRITE setOutputDevice NOTIFY outputDeviceChanged)
     Q_PROPERTY(float masterVolume READ masterVolume WRITE setMasterVolume NOTIFY masterVolumeChanged)
+    Q_PROPERTY(int blockSize READ blockSize WRITE setBlockSize NOTIFY blockSizeChanged REVISION(6, 7))
+    Q_PROPERTY(qint64 soundCacheLimit READ soundCacheLimit WRITE setSoundCacheLimit NOTIFY soundCacheLimitChanged REVISION(6, 7))
+    Q_PROPERTY(int occlusionUpdateRate READ occlusionUpdateRate WRITE setOcclusionUpdateRate NOTIFY occlusionUpdateRateChanged REVISION(6, 7))
+    Q_PROPERTY(int voiceLimit READ voiceLimit WRITE setVoiceLimit NOTIFY voiceLimitChanged REVISION(6, 7))
+    Q_PROPERTY(int highQualityVoiceLimit READ highQualityVoiceLimit WRITE setHighQualityVoiceLimit NOTIFY highQualityVoiceLimitChanged REVISION(6, 7))
 
 public:
     // Keep in sync with QAudioEngine::OutputMode
@@ -51,12 +56,32 @@ public:
     void setMasterVolume(float volume);
     float masterVolume() const;
 
+    void setBlockSize(int frames);
+    int blockSize() const;
+
+    void setSoundCacheLimit(qint64 bytes);
+    qint64 soundCacheLimit() const;
+
+    void setOcclusionUpdateRate(int rate);
+    int occlusionUpdateRate() const;
+
+    void setVoiceLimit(int limit);
+    int voiceLimit() const;
+
+    void setHighQualityVoiceLimit(int limit);
+    int highQualityVoiceLimit() const;
+
     static QAudioEngine *getEngine();
 
 Q_SIGNALS:
     void outputModeChanged();
     void outputDeviceChanged();
     void masterVolumeChanged();
+    Q_REVISION(6, 7) void blockSizeChanged();
+    Q_REVISION(6, 7) void soundCacheLimitChanged();
+    Q_REVISION(6, 7) void occlusionUpdateRateChanged();
+    Q_REVISION(6, 7) void voiceLimitChanged();
+    Q_REVISION(6, 7) void highQualityVoiceLimitChanged();
 };
 
 QT_END_NAMESPACE
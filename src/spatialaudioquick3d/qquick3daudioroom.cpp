@@ -3,6 +3,12 @@
 #include <qquick3daudioroom_p.h>
 #include <qquick3daudioengine_p.h>
 #include <qaudioroom.h>
+#include <private/qquick3dmodel_p.h>
+#include <QtQuick3D/qquick3dgeometry.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qtimer.h>
+
+#include <cstring>
 
 QT_BEGIN_NAMESPACE
 
@@ -24,6 +30,9 @@ QT_BEGIN_NAMESPACE
 
     If multiple rooms cover the same position, the engine will use the room with the smallest
     volume.
+
+    For rooms that aren't well described by a box, \l model can be set to a Model
+    whose mesh is used to estimate reflections and reverb, see QAudioRoom::setGeometry().
  */
 
 QQuick3DAudioRoom::QQuick3DAudioRoom()
@@ -257,14 +266,192 @@ float QQuick3DAudioRoom::reverbBrightness() const
     return m_room->reverbBrightness();
 }
 
+/*!
+    \qmlproperty Model AudioRoom::model
+    \since 6.7
+
+    A model whose mesh describes the surfaces of the room. Reflections and
+    reverb are then estimated by tracing sound rays through the mesh instead of
+    from the box and wall materials of the room, and the mesh occludes sounds
+    behind it. The mesh follows the model when either the model or the room
+    moves. As that needs a new estimation, move the room and the model
+    together where possible, for example by parenting both to the same node,
+    which leaves the mesh relative to the room unchanged.
+
+    Only models with a custom \l {QtQuick3D::Geometry}{geometry} made of
+    triangles are supported, with 32 bit float positions. The position,
+    rotation and dimensions of the room still define where the room applies to
+    the listener, so they should enclose the model.
+
+    \sa modelMaterial, QAudioRoom::setGeometry()
+ */
+void QQuick3DAudioRoom::setModel(QQuick3DModel *model)
+{
+    if (m_model == model)
+        return;
+    for (const auto &connection : std::as_const(m_modelConnections))
+        disconnect(connection);
+    m_modelConnections.clear();
+
+    m_model = model;
+    if (model) {
+        auto meshChanged = [this] { scheduleGeometryUpdate(true); };
+        auto moved = [this] { scheduleGeometryUpdate(); };
+        m_modelConnections = {
+            connect(model, &QQuick3DModel::geometryChanged, this, meshChanged),
+            connect(model, &QQuick3DNode::scenePositionChanged, this, moved),
+            connect(model, &QQuick3DNode::sceneRotationChanged, this, moved),
+            connect(model, &QQuick3DNode::sceneScaleChanged, this, moved),
+            connect(model, &QObject::destroyed, this, meshChanged),
+        };
+    }
+    scheduleGeometryUpdate(true);
+    emit modelChanged();
+}
+
+QQuick3DModel *QQuick3DAudioRoom::model() const
+{
+    return m_model;
+}
+
+/*!
+    \qmlproperty AudioRoom::Material AudioRoom::modelMaterial
+    \since 6.7
+
+    The material of all surfaces of \l model. Defaults to Uniform.
+ */
+void QQuick3DAudioRoom::setModelMaterial(Material material)
+{
+    if (m_modelMaterial == material)
+        return;
+    m_modelMaterial = material;
+    scheduleGeometryUpdate(true);
+    emit modelMaterialChanged();
+}
+
+QQuick3DAudioRoom::Material QQuick3DAudioRoom::modelMaterial() const
+{
+    return m_modelMaterial;
+}
+
+void QQuick3DAudioRoom::scheduleGeometryUpdate(bool meshChanged)
+{
+    m_meshChanged |= meshChanged;
+    // estimating the acoustics is expensive, handle changes in one go
+    if (std::exchange(m_geometryUpdatePending, true))
+        return;
+    QTimer::singleShot(0, this, &QQuick3DAudioRoom::updateGeometry);
+}
+
+static bool fuzzyCompareTransforms(const QMatrix4x4 &a, const QMatrix4x4 &b)
+{
+    // Unlike qFuzzyCompare(), tolerates rounding errors of elements close to
+    // zero. The translation is the difference of two scene positions, so its
+    // error grows with their distance from the origin rather than with itself.
+    for (int i = 0; i < 16; ++i) {
+        const float x = a.constData()[i];
+        const float y = b.constData()[i];
+        const bool translation = i >= 12 && i < 15;
+        const float tolerance =
+                translation ? 0.1f : 1e-4f * qMax(1.f, qMax(qAbs(x), qAbs(y)));
+        if (qAbs(x - y) > tolerance)
+            return false;
+    }
+    return true;
+}
+
+void QQuick3DAudioRoom::updateGeometry()
+{
+    m_geometryUpdatePending = false;
+
+    // Vertices are relative to the room, which is placed at its scene position
+    // and rotation. Moving the room together with its model leaves them as
+    // they are, and doesn't need a new estimation.
+    QMatrix4x4 modelToRoom;
+    if (m_model) {
+        modelToRoom.rotate(sceneRotation().inverted());
+        modelToRoom.translate(-scenePosition());
+        modelToRoom *= m_model->sceneTransform();
+    }
+    if (!std::exchange(m_meshChanged, false)
+        && fuzzyCompareTransforms(modelToRoom, m_modelToRoom))
+        return;
+    m_modelToRoom = modelToRoom;
+
+    QQuick3DGeometry *geometry = m_model ? m_model->geometry() : nullptr;
+    if (!geometry) {
+        if (m_model)
+            qWarning() << "AudioRoom: only models with a custom geometry can be used";
+        m_room->clearGeometry();
+        return;
+    }
+    if (geometry->primitiveType() != QQuick3DGeometry::PrimitiveType::Triangles) {
+        qWarning() << "AudioRoom: the geometry of the model has to consist of triangles";
+        m_room->clearGeometry();
+        return;
+    }
+
+    int positionOffset = -1;
+    QQuick3DGeometry::Attribute::ComponentType indexType =
+            QQuick3DGeometry::Attribute::U32Type;
+    for (int i = 0; i < geometry->attributeCount(); ++i) {
+        const auto attribute = geometry->attribute(i);
+        if (attribute.semantic == QQuick3DGeometry::Attribute::PositionSemantic
+            && attribute.componentType == QQuick3DGeometry::Attribute::F32Type)
+            positionOffset = attribute.offset;
+        else if (attribute.semantic == QQuick3DGeometry::Attribute::IndexSemantic)
+            indexType = attribute.componentType;
+    }
+    const QByteArray vertexData = geometry->vertexData();
+    const int stride = geometry->stride();
+    if (positionOffset < 0 || stride <= 0) {
+        qWarning() << "AudioRoom: the geometry of the model has no float positions";
+        m_room->clearGeometry();
+        return;
+    }
+
+    QList<QVector3D> vertices;
+    const qsizetype positionEnd = positionOffset + qsizetype(3 * sizeof(float));
+    const qsizetype vertexCount =
+            vertexData.size() >= positionEnd ? (vertexData.size() - positionEnd) / stride + 1 : 0;
+    vertices.reserve(vertexCount);
+    for (qsizetype i = 0; i < vertexCount; ++i) {
+        float position[3];
+        memcpy(position, vertexData.constData() + i * stride + positionOffset, sizeof(position));
+        vertices.append(modelToRoom.map(QVector3D(position[0], position[1], position[2])));
+    }
+
+    QList<int> indices;
+    const QByteArray indexData = geometry->indexData();
+    if (indexData.isEmpty()) {
+        indices.reserve(vertexCount);
+        for (int i = 0; i < vertexCount; ++i)
+            indices.append(i);
+    } else if (indexType == QQuick3DGeometry::Attribute::U16Type) {
+        const auto *data = reinterpret_cast<const quint16 *>(indexData.constData());
+        const qsizetype count = indexData.size() / qsizetype(sizeof(quint16));
+        indices.assign(data, data + count);
+    } else {
+        const auto *data = reinterpret_cast<const quint32 *>(indexData.constData());
+        const qsizetype count = indexData.size() / qsizetype(sizeof(quint32));
+        indices.assign(data, data + count);
+    }
+
+    m_room->setGeometry(vertices, indices, { QAudioRoom::Material(m_modelMaterial) });
+}
+
 void QQuick3DAudioRoom::updatePosition()
 {
     m_room->setPosition(scenePosition());
+    if (m_model)
+        scheduleGeometryUpdate();
 }
 
 void QQuick3DAudioRoom::updateRotation()
 {
     m_room->setRotation(sceneRotation());
+    if (m_model)
+        scheduleGeometryUpdate();
 }
 
 QT_END_NAMESPACE
@@ -16,6 +16,8 @@
 //
 
 #include <private/qquick3dnode_p.h>
+#include <QtCore/qpointer.h>
+#include <QtGui/qmatrix4x4.h>
 #include <QtGui/qvector3d.h>
 #include <qaudioroom.h>
 
@@ -23,6 +25,7 @@ QT_BEGIN_NAMESPACE
 
 class QAudioEngine;
 class QAudioRoomPrivate;
+class QQuick3DModel;
 
 class QQuick3DAudioRoom : public QQuick3DNode
 {
@@ -40,6 +43,8 @@ class QQuick3DAudioRoom : public QQuick3DNode
     Q_PROPERTY(float reverbGain READ reverbGain WRITE setReverbGain NOTIFY reverbGainChanged)
     Q_PROPERTY(float reverbTime READ reverbTime WRITE setReverbTime NOTIFY reverbTimeChanged)
     Q_PROPERTY(float reverbBrightness READ reverbBrightness WRITE setReverbBrightness NOTIFY reverbBrightnessChanged)
+    Q_PROPERTY(QQuick3DModel *model READ model WRITE setModel NOTIFY modelChanged REVISION(6, 7))
+    Q_PROPERTY(Material modelMaterial READ modelMaterial WRITE setModelMaterial NOTIFY modelMaterialChanged REVISION(6, 7))
     QML_NAMED_ELEMENT(AudioRoom)
 public:
     QQuick3DAudioRoom();
@@ -106,6 +111,12 @@ public:
     void setReverbBrightness(float factor);
     float reverbBrightness() const;
 
+    void setModel(QQuick3DModel *model);
+    QQuick3DModel *model() const;
+
+    void setModelMaterial(Material material);
+    Material modelMaterial() const;
+
 Q_SIGNALS:
     void positionChanged();
     void dimensionsChanged();
@@ -115,13 +126,25 @@ Q_SIGNALS:
     void reverbGainChanged();
     void reverbTimeChanged();
     void reverbBrightnessChanged();
+    Q_REVISION(6, 7) void modelChanged();
+    Q_REVISION(6, 7) void modelMaterialChanged();
 
 protected Q_SLOTS:
     void updatePosition();
     void updateRotation();
 
 private:
+    void scheduleGeometryUpdate(bool meshChanged = false);
+    void updateGeometry();
+
     QAudioRoom *m_room;
+    QPointer<QQuick3DModel> m_model;
+    QList<QMetaObject::Connection> m_modelConnections;
+    Material m_modelMaterial = Uniform;
+    // the transform the current mesh was built with
+    QMatrix4x4 m_modelToRoom;
+    bool m_meshChanged = false;
+    bool m_geometryUpdatePending = false;
 };
 
 QT_END_NAMESPACE
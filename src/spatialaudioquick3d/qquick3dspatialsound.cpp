@@ -44,6 +44,8 @@ QQuick3DSpatialSound::QQuick3DSpatialSound()
     connect(m_sound, &QSpatialSound::nearFieldGainChanged, this, &QQuick3DSpatialSound::nearFieldGainChanged);
     connect(m_sound, &QSpatialSound::loopsChanged, this, &QQuick3DSpatialSound::loopsChanged);
     connect(m_sound, &QSpatialSound::autoPlayChanged, this, &QQuick3DSpatialSound::autoPlayChanged);
+    connect(m_sound, &QSpatialSound::streamingChanged, this, &QQuick3DSpatialSound::streamingChanged);
+    connect(m_sound, &QSpatialSound::priorityChanged, this, &QQuick3DSpatialSound::priorityChanged);
 }
 
 QQuick3DSpatialSound::~QQuick3DSpatialSound()
@@ -289,6 +291,53 @@ void QQuick3DSpatialSound::setAutoPlay(bool autoPlay)
     m_sound->setAutoPlay(autoPlay);
 }
 
+/*!
+    \qmlproperty bool SpatialSound::streaming
+    \since 6.7
+
+    Determines whether the sound file is decoded while playing instead of
+    being decoded completely upfront.
+
+    Streamed sounds only keep a short amount of decoded data ahead of the
+    current playback position in memory, which makes them suitable for long
+    sounds. Their decoded data is not shared with other sounds playing the
+    same file.
+
+    The default value is \c false.
+ */
+bool QQuick3DSpatialSound::isStreaming() const
+{
+    return m_sound->isStreaming();
+}
+
+void QQuick3DSpatialSound::setStreaming(bool streaming)
+{
+    m_sound->setStreaming(streaming);
+}
+
+/*!
+    \qmlproperty int SpatialSound::priority
+    \since 6.7
+
+    Defines the priority of the sound when the engine limits the number of
+    sounds it renders. Sounds with a higher priority are always rendered before
+    sounds with a lower one, sounds of equal priority are ranked by how loud they
+    are at the position of the listener.
+
+    The default is 0.
+
+    \sa AudioEngine::voiceLimit
+ */
+int QQuick3DSpatialSound::priority() const
+{
+    return m_sound->priority();
+}
+
+void QQuick3DSpatialSound::setPriority(int priority)
+{
+    m_sound->setPriority(priority);
+}
+
 /*!
     \qmlmethod SpatialSound::play()
 
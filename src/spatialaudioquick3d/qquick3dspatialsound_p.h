@@ -36,6 +36,8 @@ class QQuick3DSpatialSound : public QQuick3DNode
     Q_PROPERTY(float nearFieldGain READ nearFieldGain WRITE setNearFieldGain NOTIFY nearFieldGainChanged)
     Q_PROPERTY(int loops READ loops WRITE setLoops NOTIFY loopsChanged)
     Q_PROPERTY(bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
+    Q_PROPERTY(bool streaming READ isStreaming WRITE setStreaming NOTIFY streamingChanged REVISION(6, 7))
+    Q_PROPERTY(int priority READ priority WRITE setPriority NOTIFY priorityChanged REVISION(6, 7))
     QML_NAMED_ELEMENT(SpatialSound)
 
 public:
@@ -92,6 +94,12 @@ public:
     bool autoPlay() const;
     void setAutoPlay(bool autoPlay);
 
+    bool isStreaming() const;
+    void setStreaming(bool streaming);
+
+    int priority() const;
+    void setPriority(int priority);
+
 public Q_SLOTS:
     void play();
     void pause();
@@ -110,6 +118,8 @@ Q_SIGNALS:
     void nearFieldGainChanged();
     void loopsChanged();
     void autoPlayChanged();
+    Q_REVISION(6, 7) void streamingChanged();
+    Q_REVISION(6, 7) void priorityChanged();
 
 private Q_SLOTS:
     void updatePosition();
@@ -16,6 +16,10 @@
 #include <qmediadevices.h>
 #include <qwavedecoder.h>
 
+#include <private/qaudiosystem_p.h>
+
+#include <memory>
+
 #define AUDIO_BUFFER 192000
 
 class tst_QAudioSink : public QObject
@@ -55,6 +59,11 @@ private slots:
     void pushUnderrun_data(){generate_audiofile_testrows();}
     void pushUnderrun();
 
+    void bytesFree_isWritable_whileOpening();
+    void write_takesAtMostBufferSize();
+    void pull_playsManySinksAtOnce();
+    void switchDevice_keepsStreamRunning();
+
     void volume_data();
     void volume();
 
@@ -988,6 +997,111 @@ void tst_QAudioSink::pushUnderrun()
     audioFile->close();
 }
 
+void tst_QAudioSink::bytesFree_isWritable_whileOpening()
+{
+    const QAudioFormat format = testFormats.first();
+    QAudioSink audioOutput(format, this);
+    audioOutput.setVolume(0.f);
+
+    createSineWaveData(format, format.bytesForDuration(1000000));
+    QIODevice *feed = audioOutput.start();
+    QVERIFY(feed);
+
+    // Backends opening the stream asynchronously take data before it is open
+    const QByteArray first = m_buffer->read(format.bytesForDuration(20000));
+    QCOMPARE(feed->write(first), qint64(first.size()));
+
+    // and don't report room that write() doesn't take
+    QElapsedTimer timer;
+    timer.start();
+    qint64 allWritten = first.size();
+    while (timer.elapsed() < 500 && !m_buffer->atEnd()) {
+        const qsizetype free = audioOutput.bytesFree();
+        QVERIFY(free <= audioOutput.bufferSize());
+        if (free > 0) {
+            const QByteArray data = m_buffer->read(free);
+            QCOMPARE(feed->write(data), qint64(data.size()));
+            allWritten += data.size();
+        }
+        QTest::qWait(5);
+    }
+
+    QVERIFY(allWritten > 0);
+    audioOutput.stop();
+}
+
+void tst_QAudioSink::write_takesAtMostBufferSize()
+{
+    const QAudioFormat format = testFormats.first();
+    QAudioSink audioOutput(format, this);
+    audioOutput.setVolume(0.f);
+
+    QIODevice *feed = audioOutput.start();
+    QVERIFY(feed);
+
+    // Data beyond the buffer would only add latency, both while the stream opens
+    // and once it is open
+    const QByteArray data(format.bytesForDuration(5000000), '\0');
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 500) {
+        QVERIFY(feed->write(data) <= audioOutput.bufferSize());
+        QTest::qWait(20);
+    }
+
+    audioOutput.stop();
+}
+
+void tst_QAudioSink::pull_playsManySinksAtOnce()
+{
+    // More sinks than backends like PulseAudio spread over mainloops of their own
+    constexpr int sinkCount = 6;
+    const QAudioFormat format = testFormats.first();
+    createSineWaveData(format, format.bytesForDuration(1000000));
+
+    std::vector<std::unique_ptr<QBuffer>> sources;
+    std::vector<std::unique_ptr<QAudioSink>> sinks;
+    for (int i = 0; i < sinkCount; ++i) {
+        sources.push_back(std::make_unique<QBuffer>(m_byteArray.get()));
+        QVERIFY(sources.back()->open(QIODevice::ReadOnly));
+        sinks.push_back(std::make_unique<QAudioSink>(format));
+        sinks.back()->setVolume(0.f);
+        sinks.back()->start(sources.back().get());
+    }
+
+    for (const auto &sink : sinks) {
+        QCOMPARE(sink->error(), QAudio::NoError);
+        QTRY_VERIFY_WITH_TIMEOUT(sink->processedUSecs() > 0, 5000);
+    }
+}
+
+void tst_QAudioSink::switchDevice_keepsStreamRunning()
+{
+    const QList<QAudioDevice> devices = QMediaDevices::audioOutputs();
+    if (devices.size() < 2)
+        QSKIP("Needs two audio outputs");
+
+    const QAudioFormat format = testFormats.first();
+    QAudioSink audioOutput(devices.at(0), format, this);
+    audioOutput.setVolume(0.f);
+
+    createSineWaveData(format, format.bytesForDuration(2000000));
+    audioOutput.start(m_buffer.data());
+    QTRY_COMPARE(audioOutput.state(), QAudio::ActiveState);
+    QTRY_VERIFY(audioOutput.processedUSecs() > 0);
+
+    if (!audioOutput.handle()->switchDevice(devices.at(1)))
+        QSKIP("The backend doesn't migrate streams between devices");
+
+    // The stream keeps its position and continues on the new device
+    const qint64 processedAtSwitch = audioOutput.processedUSecs();
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+    QTRY_VERIFY(audioOutput.processedUSecs() > processedAtSwitch);
+    QCOMPARE(audioOutput.error(), QAudio::NoError);
+
+    audioOutput.stop();
+}
+
 void tst_QAudioSink::volume_data()
 {
     QTest::addColumn<float>("actualFloat");
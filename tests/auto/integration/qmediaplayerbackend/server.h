@@ -8,9 +8,12 @@
 
 #ifdef QT_FEATURE_network
 
+#include <qregularexpression.h>
 #include <qstring.h>
 #include <qtcpserver.h>
+#include <qtcpsocket.h>
 #include <qtest.h>
+#include <qtimer.h>
 #include <qurl.h>
 
 QT_USE_NAMESPACE
@@ -43,6 +46,109 @@ private:
     bool m_connected = false;
 };
 
+/*
+ * Serves a single file over HTTP, including range requests for seeking.
+ * A limited rate makes the player wait for data like it would on a slow network.
+ */
+class HttpFileServer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit HttpFileServer(QByteArray data, qint64 bytesPerSecond = -1)
+        : m_server{ new QTcpServer{ this } },
+          m_data{ std::move(data) },
+          m_bytesPerSecond{ bytesPerSecond }
+    {
+        connect(m_server, &QTcpServer::newConnection, this, [this] {
+            while (QTcpSocket *socket = m_server->nextPendingConnection())
+                serve(socket);
+        });
+    }
+
+    bool listen() { return m_server->listen(QHostAddress::LocalHost); }
+
+    QUrl url(const QString &fileName) const
+    {
+        return QUrl{ QString{ "http://%1:%2/%3" }
+                             .arg(m_server->serverAddress().toString())
+                             .arg(m_server->serverPort())
+                             .arg(fileName) };
+    }
+
+private:
+    void serve(QTcpSocket *socket)
+    {
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QTcpSocket::readyRead, socket, [this, socket] {
+            // Only answer once the header is complete, and only once per connection
+            QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            socket->setProperty("request", request);
+            if (!request.contains("\r\n\r\n") || socket->property("answered").toBool())
+                return;
+            socket->setProperty("answered", true);
+
+            static const QRegularExpression rangeExpr(
+                    QStringLiteral("Range: *bytes=(\\d+)-(\\d*)"),
+                    QRegularExpression::CaseInsensitiveOption);
+            const auto match = rangeExpr.match(QString::fromLatin1(request));
+            const qint64 size = m_data.size();
+            qint64 begin = 0;
+            qint64 end = size - 1;
+            if (match.hasMatch()) {
+                begin = match.captured(1).toLongLong();
+                if (!match.captured(2).isEmpty())
+                    end = qMin(end, match.captured(2).toLongLong());
+            }
+            if (begin > end) {
+                socket->write("HTTP/1.1 416 Range Not Satisfiable\r\n"
+                              "Content-Length: 0\r\nConnection: close\r\n\r\n");
+                socket->disconnectFromHost();
+                return;
+            }
+
+            QByteArray header = match.hasMatch() ? "HTTP/1.1 206 Partial Content\r\n"
+                                                 : "HTTP/1.1 200 OK\r\n";
+            header += "Content-Type: application/octet-stream\r\n"
+                      "Accept-Ranges: bytes\r\n"
+                      "Connection: close\r\n";
+            header += "Content-Length: " + QByteArray::number(end - begin + 1) + "\r\n";
+            if (match.hasMatch()) {
+                header += "Content-Range: bytes " + QByteArray::number(begin) + "-"
+                        + QByteArray::number(end) + "/" + QByteArray::number(size) + "\r\n";
+            }
+            socket->write(header + "\r\n");
+            send(socket, begin, end + 1);
+        });
+    }
+
+    void send(QTcpSocket *socket, qint64 begin, qint64 end)
+    {
+        if (m_bytesPerSecond <= 0) {
+            socket->write(m_data.constData() + begin, end - begin);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        constexpr int intervalMs = 50;
+        const qint64 chunkSize = qMax(qint64(1), m_bytesPerSecond * intervalMs / 1000);
+        auto *timer = new QTimer{ socket };
+        connect(timer, &QTimer::timeout, socket, [socket, timer, this, begin, end, chunkSize]() mutable {
+            const qint64 bytes = qMin(chunkSize, end - begin);
+            socket->write(m_data.constData() + begin, bytes);
+            begin += bytes;
+            if (begin == end) {
+                timer->stop();
+                socket->disconnectFromHost();
+            }
+        });
+        timer->start(intervalMs);
+    }
+
+    QTcpServer *m_server;
+    QByteArray m_data;
+    qint64 m_bytesPerSecond;
+};
+
 #endif // QT_FEATURE_network
 
 #endif // SERVER_H
@@ -20,6 +20,7 @@
 #endif
 #include <qmediatimerange.h>
 #include <private/qplatformvideosink_p.h>
+#include <private/qmediaplayer_p.h>
 
 #include <QtQml/qqmlengine.h>
 #include <QtQml/qqmlcomponent.h>
@@ -98,6 +99,8 @@ private slots:
     void setSource_remainsInStoppedState_whenPlayerWasStopped();
     void setSource_entersStoppedState_whenPlayerWasPlaying();
 
+    void setNextSource_continuesWithoutGap_whenSourceEnds();
+
     void pause_doesNotChangePlayerState_whenInvalidFileLoaded();
     void pause_doesNothing_whenMediaIsNotLoaded();
     void pause_entersPauseState_whenPlayerWasPlaying();
@@ -110,6 +113,10 @@ private slots:
     void play_doesNotEnterMediaLoadingState_whenResumingPlayingAfterStop();
     void playAndSetSource_emitsExpectedSignalsAndStopsPlayback_whenSetSourceWasCalledWithEmptyUrl();
     void play_createsFramesWithExpectedContentAndIncreasingFrameTime_whenPlayingRtspMediaStream();
+    void play_reportsBufferingOnlyUntilBuffered_whenPlayingHttpStream_data();
+    void play_reportsBufferingOnlyUntilBuffered_whenPlayingHttpStream();
+    void play_catchesUpWithLiveEdge_whenLowLatencyStreamIsBufferedAhead_data();
+    void play_catchesUpWithLiveEdge_whenLowLatencyStreamIsBufferedAhead();
 
     void stop_entersStoppedState_whenPlayerWasPaused();
 
@@ -154,6 +161,8 @@ private slots:
     void videoSinkSignals();
     void nonAsciiFileName();
     void setMedia_setsVideoSinkSize_beforePlaying();
+    void timeToFirstFrame_data();
+    void timeToFirstFrame();
 
 private:
     QUrl selectVideoFile(const QStringList& mediaCandidates);
@@ -215,6 +224,34 @@ static std::unique_ptr<QTemporaryFile> copyResourceToTemporaryFile(QString resou
     return temporaryFile;
 }
 
+static QByteArray readResource(const QUrl &url)
+{
+    QFile resourceFile(u':' + url.path());
+    if (!resourceFile.open(QIODeviceBase::ReadOnly))
+        return {};
+    return resourceFile.readAll();
+}
+
+static bool isFFmpegPlayer(QMediaPlayer &player)
+{
+    auto *d = static_cast<QMediaPlayerPrivate *>(QObjectPrivate::get(&player));
+    const auto *control = dynamic_cast<const QObject *>(d->control);
+    return control && qstrcmp(control->metaObject()->className(), "QFFmpegMediaPlayer") == 0;
+}
+
+// Backends that can't switch to the next source without a gap leave it to QMediaPlayer,
+// which stops at the end of the media and plays the next source then
+static bool switchesToNextSourceWithoutGap(QMediaPlayer &player)
+{
+    return isFFmpegPlayer(player);
+}
+
+// Other backends ignore QMediaPlayer::lowLatency
+static bool hasLowLatencyMode(QMediaPlayer &player)
+{
+    return isFFmpegPlayer(player);
+}
+
 bool tst_QMediaPlayerBackend::isWavSupported() const
 {
     return !m_localWavFile.isEmpty();
@@ -686,6 +723,85 @@ void tst_QMediaPlayerBackend::setSource_entersStoppedState_whenPlayerWasPlaying(
     QCOMPARE(m_fixture->player.position(), 0);
 }
 
+void tst_QMediaPlayerBackend::setNextSource_continuesWithoutGap_whenSourceEnds()
+{
+    if (m_localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("Video format is not supported");
+    if (!switchesToNextSourceWithoutGap(m_fixture->player))
+        QSKIP("The backend stops before playing the next source");
+
+    // Media in resources are played from a QIODevice, which is not switched to
+    // without stopping
+    auto first = copyResourceToTemporaryFile(":/testdata/3colors_with_sound_1s.mp4",
+                                             "first.XXXXXX.mp4");
+    auto second = copyResourceToTemporaryFile(":/testdata/3colors_with_sound_1s.mp4",
+                                              "second.XXXXXX.mp4");
+    QVERIFY(first);
+    QVERIFY(second);
+    const QUrl firstUrl = QUrl::fromLocalFile(first->fileName());
+    const QUrl secondUrl = QUrl::fromLocalFile(second->fileName());
+
+    QMediaPlayer &player = m_fixture->player;
+    player.setSource(firstUrl);
+    player.setNextSource(secondUrl);
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+    const qint64 duration = player.duration();
+    const qreal frameRate = player.metaData().value(QMediaMetaData::VideoFrameRate).toReal();
+    QCOMPARE_GT(duration, 0);
+    QCOMPARE_GT(frameRate, 0.);
+
+    QElapsedTimer timer;
+    QList<qint64> frameTimes;
+    connect(&m_fixture->surface, &QVideoSink::videoFrameChanged, this,
+            [&] { frameTimes << timer.elapsed(); });
+
+    qint64 switchTime = -1;
+    qsizetype positionsBeforeSwitch = -1;
+    QMediaPlayer::PlaybackState stateAtSwitch = QMediaPlayer::StoppedState;
+    QMediaPlayer::MediaStatus statusAtSwitch = QMediaPlayer::NoMedia;
+    connect(&player, &QMediaPlayer::sourceChanged, this, [&] {
+        switchTime = timer.elapsed();
+        positionsBeforeSwitch = m_fixture->positionChanged.size();
+        stateAtSwitch = player.playbackState();
+        statusAtSwitch = player.mediaStatus();
+    });
+
+    m_fixture->clearSpies();
+    timer.start();
+    player.play();
+
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, 10000);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+    QCOMPARE(player.source(), secondUrl);
+    QVERIFY(player.nextSource().isEmpty());
+    QCOMPARE(m_fixture->sourceChanged, SignalList({ { secondUrl } }));
+    QCOMPARE(m_fixture->playbackStateChanged,
+             SignalList({ { QMediaPlayer::PlayingState }, { QMediaPlayer::StoppedState } }));
+    QCOMPARE_GE(switchTime, 0);
+    QCOMPARE(stateAtSwitch, QMediaPlayer::PlayingState);
+    QCOMPARE(statusAtSwitch, QMediaPlayer::BufferedMedia);
+
+    // The position runs up to the end of the first media and restarts from 0
+    constexpr qint64 positionTolerance = 250;
+    const auto &positions = m_fixture->positionChanged;
+    QCOMPARE_GT(positionsBeforeSwitch, 0);
+    QCOMPARE_LT(positionsBeforeSwitch, positions.size());
+    QCOMPARE_GE(positions.at(positionsBeforeSwitch - 1)[0].value<qint64>(),
+                duration - positionTolerance);
+    QCOMPARE_LE(positions.at(positionsBeforeSwitch)[0].value<qint64>(), positionTolerance);
+    for (qsizetype i = 1; i < positions.size(); ++i) {
+        if (i != positionsBeforeSwitch)
+            QCOMPARE_GE(positions.at(i)[0].value<qint64>(), positions.at(i - 1)[0].value<qint64>());
+    }
+
+    // No frame is held for much longer than usual around the switch
+    const qint64 maxFrameInterval = qRound64(1000. / frameRate) + 150;
+    for (qsizetype i = 1; i < frameTimes.size(); ++i) {
+        if (qAbs(frameTimes.at(i) - switchTime) < 500)
+            QCOMPARE_LE(frameTimes.at(i) - frameTimes.at(i - 1), maxFrameInterval);
+    }
+}
+
 void tst_QMediaPlayerBackend::pause_doesNotChangePlayerState_whenInvalidFileLoaded()
 {
     m_fixture->player.setSource({ "Some not existing media" });
@@ -943,6 +1059,128 @@ void tst_QMediaPlayerBackend::
     QCOMPARE(errorSpy.size(), 0);
 }
 
+void tst_QMediaPlayerBackend::play_reportsBufferingOnlyUntilBuffered_whenPlayingHttpStream_data()
+{
+    QTest::addColumn<bool>("throttled");
+
+    QTest::newRow("fast network") << false;
+    QTest::newRow("slow network") << true;
+}
+
+void tst_QMediaPlayerBackend::play_reportsBufferingOnlyUntilBuffered_whenPlayingHttpStream()
+{
+#ifdef QT_FEATURE_network
+    if (m_localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("No supported video file");
+
+    QFETCH(bool, throttled);
+
+    const QByteArray data = readResource(m_localVideoFile3ColorsWithSound);
+    QVERIFY(!data.isEmpty());
+    // The whole second of media arrives within about half a second
+    HttpFileServer server(data, throttled ? data.size() * 2 : -1);
+    QVERIFY(server.listen());
+
+    QMediaPlayer &player = m_fixture->player;
+    QSignalSpy bufferProgressChanged(&player, &QMediaPlayer::bufferProgressChanged);
+    player.setSource(server.url("3colors_with_sound_1s.mp4"));
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::LoadedMedia, 10000);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+
+    player.play();
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::EndOfMedia, 10000);
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+
+    QList<QMediaPlayer::MediaStatus> statuses;
+    for (const auto &args : std::as_const(m_fixture->mediaStatusChanged))
+        statuses.append(args.front().value<QMediaPlayer::MediaStatus>());
+
+    // Buffering may be skipped if the buffers fill up fast enough, but once
+    // buffered, the status doesn't go back and forth until the end
+    QList<QMediaPlayer::MediaStatus> expected = { QMediaPlayer::LoadingMedia,
+                                                  QMediaPlayer::LoadedMedia };
+    if (statuses.contains(QMediaPlayer::BufferingMedia))
+        expected.append(QMediaPlayer::BufferingMedia);
+    expected += { QMediaPlayer::BufferedMedia, QMediaPlayer::EndOfMedia };
+    QCOMPARE(statuses, expected);
+
+    QVERIFY(!bufferProgressChanged.isEmpty());
+    QCOMPARE(bufferProgressChanged.back().front().toFloat(), 1.f);
+#else
+    QSKIP("Test requires network feature");
+#endif
+}
+
+void tst_QMediaPlayerBackend::play_catchesUpWithLiveEdge_whenLowLatencyStreamIsBufferedAhead_data()
+{
+    QTest::addColumn<bool>("realTime");
+
+    // All of the media is there at once, so the player buffers as much as it can
+    QTest::newRow("fast network") << false;
+    // The media arrives as fast as it's played, like a live stream
+    QTest::newRow("real-time network") << true;
+}
+
+void tst_QMediaPlayerBackend::play_catchesUpWithLiveEdge_whenLowLatencyStreamIsBufferedAhead()
+{
+#ifdef QT_FEATURE_network
+    if (m_localFileWithMetadata.isEmpty())
+        QSKIP("Sound format is not supported");
+    if (!hasLowLatencyMode(m_fixture->player))
+        QSKIP("The backend has no low latency mode");
+
+    QFETCH(bool, realTime);
+
+    // The defaults of the FFmpeg backend
+    constexpr qint64 targetLatencyMs = 200;
+    constexpr qint64 latencyToleranceMs = 100;
+    constexpr qint64 maxBufferedMs = 1000;
+
+    QMediaPlayer &player = m_fixture->player;
+    player.setSource(m_localFileWithMetadata);
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+    const qint64 duration = player.duration();
+    QCOMPARE_GT(duration, 3000);
+    QCOMPARE(player.latency(), -1);
+
+    const QByteArray data = readResource(m_localFileWithMetadata);
+    QVERIFY(!data.isEmpty());
+    HttpFileServer server(data, realTime ? data.size() * 1000 / duration : -1);
+    QVERIFY(server.listen());
+
+    player.setLowLatency(true);
+    player.setSource(server.url("nokia-tune.mp3"));
+    QTRY_COMPARE_WITH_TIMEOUT(player.mediaStatus(), QMediaPlayer::LoadedMedia, 10000);
+    player.play();
+    QTRY_COMPARE_GE(player.latency(), 0);
+
+    if (realTime) {
+        // Whatever was buffered while opening the stream is caught up with
+        QTRY_COMPARE_LE_WITH_TIMEOUT(player.latency(), targetLatencyMs + latencyToleranceMs,
+                                     5000);
+    } else {
+        QTRY_COMPARE_GT_WITH_TIMEOUT(player.latency(), targetLatencyMs + latencyToleranceMs,
+                                     5000);
+        // Not much more than the demuxer buffers, with room for the decoded frames
+        QCOMPARE_LE(player.latency(), 2 * maxBufferedMs);
+
+        // Catching up gets the position ahead of the wall clock. The speed up shrinks
+        // with the latency, so no exact speed is checked. The rate is left to the user.
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 startPosition = player.position();
+        QTRY_VERIFY_WITH_TIMEOUT(player.position() - startPosition > timer.elapsed() + 100,
+                                 20000);
+        QCOMPARE(player.playbackRate(), 1.);
+    }
+
+    QCOMPARE(player.error(), QMediaPlayer::NoError);
+    QCOMPARE(player.playbackState(), QMediaPlayer::PlayingState);
+#else
+    QSKIP("Test requires network feature");
+#endif
+}
+
 void tst_QMediaPlayerBackend::stop_entersStoppedState_whenPlayerWasPaused()
 {
     if (!isWavSupported())
@@ -2490,6 +2728,44 @@ void tst_QMediaPlayerBackend::setMedia_setsVideoSinkSize_beforePlaying()
     QCOMPARE(spy2.size(), 1);
 }
 
+void tst_QMediaPlayerBackend::timeToFirstFrame_data()
+{
+    QTest::addColumn<bool>("fastOpen");
+
+    QTest::newRow("default") << false;
+    QTest::newRow("fastOpen") << true;
+}
+
+void tst_QMediaPlayerBackend::timeToFirstFrame()
+{
+    if (m_localVideoFile3ColorsWithSound.isEmpty())
+        QSKIP("No supported video file");
+
+    QFETCH(bool, fastOpen);
+
+    const QByteArray previousValue = qgetenv("QT_FFMPEG_FAST_OPEN");
+    auto restoreEnv = qScopeGuard([&previousValue]() {
+        if (previousValue.isNull())
+            qunsetenv("QT_FFMPEG_FAST_OPEN");
+        else
+            qputenv("QT_FFMPEG_FAST_OPEN", previousValue);
+    });
+    qputenv("QT_FFMPEG_FAST_OPEN", fastOpen ? "1" : "0");
+
+    QBENCHMARK {
+        QVideoSink sink;
+        QMediaPlayer player;
+        player.setVideoOutput(&sink);
+        QSignalSpy framesSpy(&sink, &QVideoSink::videoFrameChanged);
+
+        player.setSource(m_localVideoFile3ColorsWithSound);
+        player.play();
+
+        QVERIFY(!framesSpy.isEmpty() || framesSpy.wait());
+        QCOMPARE(player.error(), QMediaPlayer::NoError);
+    }
+}
+
 std::unique_ptr<QProcess> tst_QMediaPlayerBackend::createRtspStreamProcess(QString fileName,
                                                                            QString outputUrl)
 {
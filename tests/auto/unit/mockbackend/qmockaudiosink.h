@@ -0,0 +1,100 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QMOCKAUDIOSINK_H
+#define QMOCKAUDIOSINK_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <private/qaudiosystem_p.h>
+#include <qbuffer.h>
+
+QT_BEGIN_NAMESPACE
+
+class QMockAudioSink : public QPlatformAudioSink
+{
+public:
+    explicit QMockAudioSink(QObject *parent) : QPlatformAudioSink(parent) { }
+
+    void start(QIODevice *device) override
+    {
+        m_device = device;
+        m_statistics.reset();
+        setState(QAudio::ActiveState);
+    }
+
+    QIODevice *start() override
+    {
+        m_buffer.close();
+        m_buffer.setData({});
+        m_buffer.open(QIODevice::ReadWrite);
+        start(&m_buffer);
+        return &m_buffer;
+    }
+
+    void stop() override { setState(QAudio::StoppedState); }
+    void reset() override { stop(); }
+    void suspend() override { setState(QAudio::SuspendedState); }
+    void resume() override { setState(QAudio::ActiveState); }
+    qsizetype bytesFree() const override { return m_bufferSize - m_bufferFill; }
+    void setBufferSize(qsizetype value) override { m_bufferSize = value; }
+    qsizetype bufferSize() const override { return m_bufferSize; }
+    qint64 processedUSecs() const override { return 0; }
+    QAudio::Error error() const override { return m_error; }
+    QAudio::State state() const override { return m_state; }
+    void setFormat(const QAudioFormat &format) override { m_format = format; }
+    QAudioFormat format() const override { return m_format; }
+
+    QAudioStreamStatistics statistics() const override
+    {
+        return m_statistics.statistics(m_latency);
+    }
+
+    // Simulate backend events to drive the statistics
+    void simulateBufferFill(qsizetype fill)
+    {
+        m_bufferFill = fill;
+        m_statistics.recordBufferFill(fill);
+    }
+    void simulateUnderrun()
+    {
+        m_statistics.recordXrun();
+        m_error = QAudio::UnderrunError;
+        emit errorChanged(m_error);
+        setState(QAudio::IdleState);
+    }
+    void simulateCallback() { m_statistics.recordCallback(); }
+    void setLatency(qint64 latencyUSecs) { m_latency = latencyUSecs; }
+
+private:
+    void setState(QAudio::State state)
+    {
+        if (m_state == state)
+            return;
+        m_state = state;
+        emit stateChanged(state);
+    }
+
+    QBuffer m_buffer;
+    QIODevice *m_device = nullptr;
+    QAudioFormat m_format;
+    QAudio::State m_state = QAudio::StoppedState;
+    QAudio::Error m_error = QAudio::NoError;
+    qsizetype m_bufferSize = 4096;
+    qsizetype m_bufferFill = 0;
+    qint64 m_latency = 0;
+    QAudioStreamStatisticsCollector m_statistics;
+};
+
+QT_END_NAMESPACE
+
+#endif // QMOCKAUDIOSINK_H
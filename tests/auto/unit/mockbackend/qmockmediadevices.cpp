@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qmockmediadevices.h"
+#include "qmockaudiosink.h"
+#include "qmockaudiosource.h"
 #include "private/qcameradevice_p.h"
 
 QT_BEGIN_NAMESPACE
@@ -28,16 +30,14 @@ QPlatformAudioSource *QMockMediaDevices::createAudioSource(const QAudioDevice &i
                                                            QObject *parent)
 {
     Q_UNUSED(info);
-    Q_UNUSED(parent);
-    return nullptr;// ###
+    return new QMockAudioSource(parent);
 }
 
 QPlatformAudioSink *QMockMediaDevices::createAudioSink(const QAudioDevice &info,
                                                        QObject *parent)
 {
     Q_UNUSED(info);
-    Q_UNUSED(parent);
-    return nullptr; //###
+    return new QMockAudioSink(parent);
 }
 
 
@@ -81,6 +81,15 @@ public:
     }
     QIODevice *mediaStream() const override { return _stream; }
 
+    QUrl nextMedia() const { return _nextMedia; }
+    void setNextMedia(const QUrl &media) override { _nextMedia = media; }
+
+    bool lowLatency() const { return _lowLatency; }
+    void setLowLatency(bool lowLatency) override { _lowLatency = lowLatency; }
+
+    qint64 latency() const override { return _latency; }
+    void setLatency(qint64 latency) { _latency = latency; latencyChanged(latency); }
+
     bool streamPlaybackSupported() const override { return m_supportsStreamPlayback; }
     void setStreamPlaybackSupported(bool b) { m_supportsStreamPlayback = b; }
 
@@ -133,6 +142,9 @@ public:
         _isSeekable = false;
         _playbackRate = 0.0;
         _media = QUrl();
+        _nextMedia = QUrl();
+        _lowLatency = false;
+        _latency = -1;
         _stream = 0;
         _isValid = false;
         _errorString = QString();
@@ -150,6 +162,9 @@ public:
     QPair<qint64, qint64> _seekRange;
     qreal _playbackRate;
     QUrl _media;
+    QUrl _nextMedia;
+    bool _lowLatency = false;
+    qint64 _latency = -1;
     QIODevice *_stream;
     bool _isValid;
     QString _errorString;
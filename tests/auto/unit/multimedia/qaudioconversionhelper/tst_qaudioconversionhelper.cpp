@@ -0,0 +1,315 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <private/qaudioconversionhelper_p.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace QAudioHelperInternal;
+
+namespace {
+
+template<typename F>
+void withSampleType(QAudioFormat::SampleFormat format, F &&f)
+{
+    switch (format) {
+    case QAudioFormat::UInt8:
+        return f(quint8());
+    case QAudioFormat::Int16:
+        return f(qint16());
+    case QAudioFormat::Int32:
+        return f(qint32());
+    case QAudioFormat::Float:
+        return f(float());
+    default:
+        QFAIL("unexpected sample format");
+    }
+}
+
+// sample by sample conversion through SampleTraits, which the SIMD versions must match exactly
+void convertReference(const void *src, QAudioFormat::SampleFormat srcFormat, void *dst,
+                      QAudioFormat::SampleFormat dstFormat, qsizetype samples)
+{
+    withSampleType(srcFormat, [&](auto srcSample) {
+        using From = decltype(srcSample);
+        withSampleType(dstFormat, [&](auto dstSample) {
+            using To = decltype(dstSample);
+            const From *in = static_cast<const From *>(src);
+            To *out = static_cast<To *>(dst);
+            for (qsizetype i = 0; i < samples; ++i)
+                out[i] = SampleTraits<To>::fromFloat(SampleTraits<From>::toFloat(in[i]));
+        });
+    });
+}
+
+void compareSamples(const std::vector<char> &actual, const std::vector<char> &expected,
+                    int bytesPerSample)
+{
+    QCOMPARE(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); i += bytesPerSample) {
+        QVERIFY2(memcmp(actual.data() + i, expected.data() + i, bytesPerSample) == 0,
+                 qPrintable(QStringLiteral("sample %1 differs").arg(i / bytesPerSample)));
+    }
+}
+
+} // namespace
+
+class tst_QAudioConversionHelper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convertSamples_roundTripsInt16ThroughFloat();
+    void convertSamples_saturatesOutOfRangeFloats_data();
+    void convertSamples_saturatesOutOfRangeFloats();
+    void convertSamples_fullScaleFloatsReachIntegerLimits();
+    void convertSamples_matchesScalarReference_data();
+    void convertSamples_matchesScalarReference();
+    void interleave_deinterleave_roundTrip_data();
+    void interleave_deinterleave_roundTrip();
+    void remixChannels_stereoToMono_averages();
+    void remixChannels_monoToStereo_duplicates();
+    void remixChannels_surround5Dot1ToStereo_foldsCenterAndBack();
+    void convertAudioBuffer_changesFormatAndChannels();
+    void convertAudioBuffer_rejectsSampleRateChange();
+};
+
+void tst_QAudioConversionHelper::convertSamples_roundTripsInt16ThroughFloat()
+{
+    std::vector<qint16> input(1001);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = qint16(int(i * 65) - 0x8000);
+
+    std::vector<float> floats(input.size());
+    std::vector<qint16> output(input.size());
+    convertSamples(input.data(), QAudioFormat::Int16, floats.data(), QAudioFormat::Float,
+                   qsizetype(input.size()));
+    convertSamples(floats.data(), QAudioFormat::Float, output.data(), QAudioFormat::Int16,
+                   qsizetype(input.size()));
+
+    QCOMPARE(floats.front(), -1.f);
+    QVERIFY(output == input);
+}
+
+void tst_QAudioConversionHelper::convertSamples_saturatesOutOfRangeFloats_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("format");
+
+    QTest::newRow("UInt8") << QAudioFormat::UInt8;
+    QTest::newRow("Int16") << QAudioFormat::Int16;
+    QTest::newRow("Int32") << QAudioFormat::Int32;
+}
+
+void tst_QAudioConversionHelper::convertSamples_saturatesOutOfRangeFloats()
+{
+    QFETCH(QAudioFormat::SampleFormat, format);
+
+    // long enough to hit both the SIMD loops and the scalar tails
+    std::vector<float> input(19);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = i % 2 ? 3.f : -3.f;
+
+    QAudioFormat audioFormat;
+    audioFormat.setSampleFormat(format);
+    std::vector<char> output(input.size() * audioFormat.bytesPerSample());
+    convertSamples(input.data(), QAudioFormat::Float, output.data(), format,
+                   qsizetype(input.size()));
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        const float value =
+                audioFormat.normalizedSampleValue(output.data() + i * audioFormat.bytesPerSample());
+        if (i % 2)
+            QCOMPARE_GE(value, 0.99f);
+        else
+            QCOMPARE_LE(value, -0.99f);
+    }
+}
+
+void tst_QAudioConversionHelper::convertSamples_fullScaleFloatsReachIntegerLimits()
+{
+    std::vector<float> input(19);
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = i % 2 ? 1.f : -1.f;
+
+    std::vector<qint16> int16(input.size());
+    std::vector<qint32> int32(input.size());
+    convertSamples(input.data(), QAudioFormat::Float, int16.data(), QAudioFormat::Int16,
+                   qsizetype(input.size()));
+    convertSamples(input.data(), QAudioFormat::Float, int32.data(), QAudioFormat::Int32,
+                   qsizetype(input.size()));
+
+    for (size_t i = 0; i < input.size(); ++i) {
+        QCOMPARE(int16[i], i % 2 ? qint16(0x7fff) : qint16(-0x8000));
+        QCOMPARE(int32[i], i % 2 ? qint32(0x7fffffff) : qint32(-0x7fffffff - 1));
+    }
+}
+
+void tst_QAudioConversionHelper::convertSamples_matchesScalarReference_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("from");
+    QTest::addColumn<QAudioFormat::SampleFormat>("to");
+
+    const QAudioFormat::SampleFormat formats[] = { QAudioFormat::UInt8, QAudioFormat::Int16,
+                                                   QAudioFormat::Int32, QAudioFormat::Float };
+    for (auto from : formats) {
+        for (auto to : formats) {
+            if (from != to)
+                QTest::addRow("%d->%d", int(from), int(to)) << from << to;
+        }
+    }
+}
+
+void tst_QAudioConversionHelper::convertSamples_matchesScalarReference()
+{
+    QFETCH(QAudioFormat::SampleFormat, from);
+    QFETCH(QAudioFormat::SampleFormat, to);
+
+    // long enough to hit both the SIMD loops and the scalar tails; includes values halfway
+    // between two integer samples, full scale and out of range values
+    constexpr qsizetype Samples = 67;
+    std::vector<float> source(Samples);
+    for (qsizetype i = 0; i < Samples; ++i)
+        source[i] = std::sin(float(i)) * 0.9f;
+    const float special[] = { 1.f,         -1.f,          3.f,         -3.f,
+                              0.5f / 0x80, -0.5f / 0x80, 1.5f / 0x80, 0.5f / 0x8000,
+                              -0.5f / 0x8000, 1.5f / 0x8000, 2.5f / 0x8000, 0.99999994f };
+    std::copy(std::begin(special), std::end(special), source.begin() + 3);
+
+    QAudioFormat fromFormat;
+    fromFormat.setSampleFormat(from);
+    QAudioFormat toFormat;
+    toFormat.setSampleFormat(to);
+
+    std::vector<char> input(Samples * fromFormat.bytesPerSample());
+    std::vector<char> expectedInput(input.size());
+    convertSamples(source.data(), QAudioFormat::Float, input.data(), from, Samples);
+    convertReference(source.data(), QAudioFormat::Float, expectedInput.data(), from, Samples);
+    compareSamples(input, expectedInput, fromFormat.bytesPerSample());
+
+    std::vector<char> output(Samples * toFormat.bytesPerSample());
+    std::vector<char> expectedOutput(output.size());
+    convertSamples(input.data(), from, output.data(), to, Samples);
+    convertReference(input.data(), from, expectedOutput.data(), to, Samples);
+    compareSamples(output, expectedOutput, toFormat.bytesPerSample());
+}
+
+void tst_QAudioConversionHelper::interleave_deinterleave_roundTrip_data()
+{
+    QTest::addColumn<int>("channels");
+
+    QTest::newRow("mono") << 1;
+    QTest::newRow("stereo") << 2;
+    QTest::newRow("5.1") << 6;
+}
+
+void tst_QAudioConversionHelper::interleave_deinterleave_roundTrip()
+{
+    QFETCH(int, channels);
+    constexpr qsizetype Frames = 33;
+
+    std::vector<float> interleaved(Frames * channels);
+    for (size_t i = 0; i < interleaved.size(); ++i)
+        interleaved[i] = float(i);
+
+    std::vector<std::vector<float>> planes(channels, std::vector<float>(Frames));
+    std::vector<float *> planePointers;
+    for (auto &plane : planes)
+        planePointers.push_back(plane.data());
+
+    deinterleave(interleaved.data(), channels, planePointers.data(), Frames);
+    QCOMPARE(planes[channels - 1][1], float(channels + channels - 1));
+
+    std::vector<float> result(interleaved.size());
+    interleave(planePointers.data(), channels, result.data(), Frames);
+    QVERIFY(result == interleaved);
+}
+
+void tst_QAudioConversionHelper::remixChannels_stereoToMono_averages()
+{
+    const float stereo[] = { 1.f, 0.f, 0.5f, 0.5f, -1.f, 1.f };
+    float mono[3] = {};
+
+    remixChannels(stereo, QAudioFormat::ChannelConfigStereo, mono,
+                  QAudioFormat::ChannelConfigMono, 3);
+
+    QCOMPARE(mono[0], 0.5f);
+    QCOMPARE(mono[1], 0.5f);
+    QCOMPARE(mono[2], 0.f);
+}
+
+void tst_QAudioConversionHelper::remixChannels_monoToStereo_duplicates()
+{
+    const float mono[] = { 0.25f, -0.5f };
+    float stereo[4] = {};
+
+    remixChannels(mono, QAudioFormat::ChannelConfigMono, stereo,
+                  QAudioFormat::ChannelConfigStereo, 2);
+
+    QCOMPARE(stereo[0], 0.25f);
+    QCOMPARE(stereo[1], 0.25f);
+    QCOMPARE(stereo[2], -0.5f);
+    QCOMPARE(stereo[3], -0.5f);
+}
+
+void tst_QAudioConversionHelper::remixChannels_surround5Dot1ToStereo_foldsCenterAndBack()
+{
+    // FL, FR, FC, LFE, BL, BR
+    const float surround[] = { 0.1f, 0.2f, 0.4f, 1.f, 0.3f, 0.f };
+    float stereo[2] = {};
+
+    remixChannels(surround, QAudioFormat::ChannelConfigSurround5Dot1, stereo,
+                  QAudioFormat::ChannelConfigStereo, 1);
+
+    constexpr float g = 0.70710678f;
+    QVERIFY(qFuzzyCompare(stereo[0], 0.1f + g * 0.4f + g * 0.3f));
+    QVERIFY(qFuzzyCompare(stereo[1], 0.2f + g * 0.4f));
+}
+
+void tst_QAudioConversionHelper::convertAudioBuffer_changesFormatAndChannels()
+{
+    QAudioFormat srcFormat;
+    srcFormat.setSampleRate(48000);
+    srcFormat.setSampleFormat(QAudioFormat::Int16);
+    srcFormat.setChannelConfig(QAudioFormat::ChannelConfigStereo);
+
+    QAudioBuffer source(4, srcFormat, 1000);
+    qint16 *samples = source.data<qint16>();
+    for (int i = 0; i < 8; ++i)
+        samples[i] = i % 2 ? 0x4000 : 0;
+
+    QAudioFormat dstFormat = srcFormat;
+    dstFormat.setSampleFormat(QAudioFormat::Float);
+    dstFormat.setChannelConfig(QAudioFormat::ChannelConfigMono);
+
+    const QAudioBuffer result = convertAudioBuffer(source, dstFormat);
+    QVERIFY(result.isValid());
+    QCOMPARE(result.format(), dstFormat);
+    QCOMPARE(result.frameCount(), 4);
+    QCOMPARE(result.startTime(), 1000);
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(result.constData<float>()[i], 0.25f);
+}
+
+void tst_QAudioConversionHelper::convertAudioBuffer_rejectsSampleRateChange()
+{
+    QAudioFormat srcFormat;
+    srcFormat.setSampleRate(44100);
+    srcFormat.setSampleFormat(QAudioFormat::Int16);
+    srcFormat.setChannelCount(2);
+
+    QAudioFormat dstFormat = srcFormat;
+    dstFormat.setSampleRate(48000);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("sample rate conversion"));
+    QVERIFY(!convertAudioBuffer(QAudioBuffer(16, srcFormat), dstFormat).isValid());
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioConversionHelper)
+
+#include "tst_qaudioconversionhelper.moc"
@@ -0,0 +1,173 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <QtMultimedia/qaudiosink.h>
+#include <QtMultimedia/qaudiosource.h>
+#include <private/qaudiodevice_p.h>
+#include <private/qaudiostreamstatistics_p.h>
+
+#include "qmockaudiosink.h"
+#include "qmockaudiosource.h"
+#include "qmockmediadevices.h"
+
+QT_USE_NAMESPACE
+
+class tst_QAudioStreamStatistics : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void collector_isEmpty_afterReset();
+    void collector_tracksMinMaxFill();
+    void collector_countsXruns_fromAnyThread();
+    void collector_measuresCallbackJitter();
+
+    void sink_reportsLatencyFillAndUnderruns();
+    void source_reportsOverruns();
+
+    void audioSink_exposesBackendStatistics();
+    void audioSource_exposesBackendStatistics();
+
+private:
+    QMockMediaDevices m_mediaDevices;
+};
+
+void tst_QAudioStreamStatistics::collector_isEmpty_afterReset()
+{
+    QAudioStreamStatisticsCollector collector;
+    collector.recordBufferFill(100);
+    collector.recordXrun();
+
+    collector.reset();
+
+    const QAudioStreamStatistics stats = collector.statistics();
+    QCOMPARE(stats.bufferFill, 0);
+    QCOMPARE(stats.minBufferFill, 0);
+    QCOMPARE(stats.maxBufferFill, 0);
+    QCOMPARE(stats.xrunCount, 0);
+    QCOMPARE(stats.maxCallbackJitterUSecs, 0);
+}
+
+void tst_QAudioStreamStatistics::collector_tracksMinMaxFill()
+{
+    QAudioStreamStatisticsCollector collector;
+    collector.recordBufferFill(500);
+    collector.recordBufferFill(200);
+    collector.recordBufferFill(900);
+    collector.recordBufferFill(400);
+
+    const QAudioStreamStatistics stats = collector.statistics(1234);
+    QCOMPARE(stats.bufferFill, 400);
+    QCOMPARE(stats.minBufferFill, 200);
+    QCOMPARE(stats.maxBufferFill, 900);
+    QCOMPARE(stats.latencyUSecs, 1234);
+}
+
+void tst_QAudioStreamStatistics::collector_countsXruns_fromAnyThread()
+{
+    QAudioStreamStatisticsCollector collector;
+
+    std::unique_ptr<QThread> thread(QThread::create([&collector]() {
+        for (int i = 0; i < 100; ++i)
+            collector.recordXrun();
+    }));
+    thread->start();
+    for (int i = 0; i < 100; ++i)
+        collector.recordXrun();
+    thread->wait();
+
+    QCOMPARE(collector.statistics().xrunCount, 200);
+}
+
+void tst_QAudioStreamStatistics::collector_measuresCallbackJitter()
+{
+    QAudioStreamStatisticsCollector collector;
+    collector.reset(1000);
+
+    collector.recordCallback();
+    QCOMPARE(collector.statistics().maxCallbackJitterUSecs, 0);
+
+    QThread::msleep(20);
+    collector.recordCallback();
+
+    const QAudioStreamStatistics stats = collector.statistics();
+    QCOMPARE_GE(stats.maxCallbackJitterUSecs, 19000 - 1000);
+    QCOMPARE(stats.averageCallbackJitterUSecs, stats.maxCallbackJitterUSecs);
+}
+
+void tst_QAudioStreamStatistics::sink_reportsLatencyFillAndUnderruns()
+{
+    QMockAudioSink sink(nullptr);
+    sink.start();
+    QCOMPARE(sink.state(), QAudio::ActiveState);
+
+    sink.setLatency(20000);
+    sink.simulateBufferFill(1024);
+    sink.simulateBufferFill(0);
+    sink.simulateUnderrun();
+
+    const QAudioStreamStatistics stats = sink.statistics();
+    QCOMPARE(stats.latencyUSecs, 20000);
+    QCOMPARE(stats.minBufferFill, 0);
+    QCOMPARE(stats.maxBufferFill, 1024);
+    QCOMPARE(stats.xrunCount, 1);
+    QCOMPARE(sink.state(), QAudio::IdleState);
+    QCOMPARE(sink.error(), QAudio::UnderrunError);
+
+    // restarting the stream starts a fresh measurement
+    sink.stop();
+    sink.start();
+    QCOMPARE(sink.statistics().xrunCount, 0);
+}
+
+void tst_QAudioStreamStatistics::source_reportsOverruns()
+{
+    QMockAudioSource source(nullptr);
+    source.start();
+
+    source.simulateBufferFill(2048);
+    source.simulateOverrun();
+    source.simulateOverrun();
+
+    const QAudioStreamStatistics stats = source.statistics();
+    QCOMPARE(stats.bufferFill, 2048);
+    QCOMPARE(stats.xrunCount, 2);
+}
+
+void tst_QAudioStreamStatistics::audioSink_exposesBackendStatistics()
+{
+    const QAudioDevice device =
+            (new QAudioDevicePrivate("mockOutput", QAudioDevice::Output))->create();
+    QAudioSink sink(device);
+    QVERIFY(!sink.isNull());
+
+    auto *mockSink = static_cast<QMockAudioSink *>(sink.handle());
+    sink.start();
+    mockSink->simulateBufferFill(512);
+    mockSink->simulateUnderrun();
+
+    const QAudioStreamStatistics stats = sink.handle()->statistics();
+    QCOMPARE(stats.bufferFill, 512);
+    QCOMPARE(stats.xrunCount, 1);
+    QCOMPARE(sink.state(), QAudio::IdleState);
+}
+
+void tst_QAudioStreamStatistics::audioSource_exposesBackendStatistics()
+{
+    const QAudioDevice device =
+            (new QAudioDevicePrivate("mockInput", QAudioDevice::Input))->create();
+    QAudioSource source(device);
+    QVERIFY(!source.isNull());
+
+    auto *mockSource = static_cast<QMockAudioSource *>(source.handle());
+    source.start();
+    mockSource->simulateOverrun();
+
+    QCOMPARE(source.handle()->statistics().xrunCount, 1);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioStreamStatistics)
+
+#include "tst_qaudiostreamstatistics.moc"
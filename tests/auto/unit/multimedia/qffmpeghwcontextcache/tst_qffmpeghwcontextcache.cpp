@@ -0,0 +1,156 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "qffmpeghwcontextcache_p.h"
+
+#include <map>
+#include <set>
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Hands out plain buffers as device contexts, counting loads and frees per type
+class Loader
+{
+public:
+    AVBufferUPtr load(AVHWDeviceType type)
+    {
+        ++loads[type];
+        if (failingTypes.count(type))
+            return nullptr;
+
+        auto *data = static_cast<uint8_t *>(av_mallocz(1));
+        auto *counter = &frees[type];
+        return AVBufferUPtr(av_buffer_create(
+                data, 1,
+                [](void *opaque, uint8_t *data) {
+                    ++*static_cast<int *>(opaque);
+                    av_free(data);
+                },
+                counter, 0));
+    }
+
+    HWContextCache::Loader loader()
+    {
+        return [this](AVHWDeviceType type) { return load(type); };
+    }
+
+    std::map<AVHWDeviceType, int> loads;
+    std::map<AVHWDeviceType, int> frees;
+    std::set<AVHWDeviceType> failingTypes;
+};
+
+} // namespace
+
+class tst_QFFmpegHWContextCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void get_returnsSameContext_forSameType();
+    void get_keepsUnusedContextsOfOtherTypes();
+    void release_keepsContext_whileOtherUsersRemain();
+    void release_freesContext_afterIdleTimeout();
+    void get_retriesFailedType_afterRetryInterval();
+};
+
+void tst_QFFmpegHWContextCache::get_returnsSameContext_forSameType()
+{
+    Loader loader;
+    HWContextCache cache(loader.loader());
+
+    AVBufferUPtr first = cache.get(AV_HWDEVICE_TYPE_VAAPI);
+    AVBufferUPtr second = cache.get(AV_HWDEVICE_TYPE_VAAPI);
+    QVERIFY(first);
+    QVERIFY(second);
+    QVERIFY(first->data == second->data);
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_VAAPI], 1);
+
+    cache.release(std::move(first));
+    cache.release(std::move(second));
+}
+
+void tst_QFFmpegHWContextCache::get_keepsUnusedContextsOfOtherTypes()
+{
+    Loader loader;
+    HWContextCache cache(loader.loader(), 1h);
+
+    cache.release(cache.get(AV_HWDEVICE_TYPE_VAAPI));
+    AVBufferUPtr cuda = cache.get(AV_HWDEVICE_TYPE_CUDA);
+    QVERIFY(cuda);
+    cache.release(cache.get(AV_HWDEVICE_TYPE_VAAPI));
+
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_VAAPI], 1);
+    QCOMPARE(loader.frees[AV_HWDEVICE_TYPE_VAAPI], 0);
+    cache.release(std::move(cuda));
+}
+
+void tst_QFFmpegHWContextCache::release_keepsContext_whileOtherUsersRemain()
+{
+    Loader loader;
+    HWContextCache cache(loader.loader(), 10ms);
+
+    AVBufferUPtr first = cache.get(AV_HWDEVICE_TYPE_VAAPI);
+    AVBufferUPtr second = cache.get(AV_HWDEVICE_TYPE_VAAPI);
+    cache.release(std::move(first));
+
+    QTest::qWait(100);
+    QCOMPARE(loader.frees[AV_HWDEVICE_TYPE_VAAPI], 0);
+    AVBufferUPtr third = cache.get(AV_HWDEVICE_TYPE_VAAPI);
+    QVERIFY(third->data == second->data);
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_VAAPI], 1);
+
+    cache.release(std::move(second));
+    cache.release(std::move(third));
+    QTRY_COMPARE(loader.frees[AV_HWDEVICE_TYPE_VAAPI], 1);
+}
+
+void tst_QFFmpegHWContextCache::release_freesContext_afterIdleTimeout()
+{
+    Loader loader;
+    HWContextCache cache(loader.loader(), 200ms);
+
+    cache.release(cache.get(AV_HWDEVICE_TYPE_VAAPI));
+    QElapsedTimer timer;
+    timer.start();
+
+    // Reused while idle
+    cache.release(cache.get(AV_HWDEVICE_TYPE_VAAPI));
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_VAAPI], 1);
+
+    // Freed by the cache on its own, without any further calls
+    QTRY_COMPARE(loader.frees[AV_HWDEVICE_TYPE_VAAPI], 1);
+    QCOMPARE_GE(timer.elapsed(), 150);
+
+    cache.release(cache.get(AV_HWDEVICE_TYPE_VAAPI));
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_VAAPI], 2);
+}
+
+void tst_QFFmpegHWContextCache::get_retriesFailedType_afterRetryInterval()
+{
+    Loader loader;
+    HWContextCache cache(loader.loader(), 1h, 200ms);
+    loader.failingTypes.insert(AV_HWDEVICE_TYPE_CUDA);
+
+    QVERIFY(!cache.get(AV_HWDEVICE_TYPE_CUDA));
+    QVERIFY(!cache.get(AV_HWDEVICE_TYPE_CUDA));
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_CUDA], 1);
+
+    // The device works now, e.g. the driver has been loaded
+    loader.failingTypes.clear();
+    QTest::qWait(250);
+    AVBufferUPtr context = cache.get(AV_HWDEVICE_TYPE_CUDA);
+    QVERIFY(context);
+    QCOMPARE(loader.loads[AV_HWDEVICE_TYPE_CUDA], 2);
+    cache.release(std::move(context));
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegHWContextCache)
+
+#include "tst_qffmpeghwcontextcache.moc"
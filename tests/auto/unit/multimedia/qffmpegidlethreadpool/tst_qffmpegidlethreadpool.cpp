@@ -0,0 +1,140 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegidlethreadpool_p.h"
+
+#include <QtCore/qpointer.h>
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+
+namespace {
+
+std::vector<std::unique_ptr<QThread>> threadList(std::unique_ptr<QThread> thread)
+{
+    std::vector<std::unique_ptr<QThread>> threads;
+    threads.push_back(std::move(thread));
+    return threads;
+}
+
+} // namespace
+
+class tst_QFFmpegIdleThreadPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+
+    void acquire_reusesReleasedThread();
+    void release_waitsForDeferredDeletion();
+    void release_stopsOldestThreads_beyondCap();
+    void release_stopsThreads_whenDisabled();
+    void idleThreads_areStopped_afterTimeout();
+};
+
+void tst_QFFmpegIdleThreadPool::cleanup()
+{
+    qunsetenv("QT_FFMPEG_IDLE_THREADS");
+    qunsetenv("QT_FFMPEG_IDLE_THREAD_TIMEOUT_MS");
+}
+
+void tst_QFFmpegIdleThreadPool::acquire_reusesReleasedThread()
+{
+    IdleThreadPool pool;
+    auto thread = pool.acquireThread(QStringLiteral("first"));
+    QVERIFY(thread->isRunning());
+    QCOMPARE(thread->objectName(), QStringLiteral("first"));
+    QThread *const released = thread.get();
+
+    pool.releaseThreads(threadList(std::move(thread)));
+    QCOMPARE(pool.idleThreadCount(), size_t(1));
+    QVERIFY(released->isRunning());
+
+    thread = pool.acquireThread(QStringLiteral("second"));
+    QCOMPARE(thread.get(), released);
+    QCOMPARE(thread->objectName(), QStringLiteral("second"));
+    QCOMPARE(pool.idleThreadCount(), size_t(0));
+
+    // Without idle threads, new ones are started
+    auto other = pool.acquireThread(QStringLiteral("third"));
+    QVERIFY(other.get() != released);
+    QVERIFY(other->isRunning());
+
+    pool.releaseThreads(threadList(std::move(thread)));
+    pool.releaseThreads(threadList(std::move(other)));
+}
+
+void tst_QFFmpegIdleThreadPool::release_waitsForDeferredDeletion()
+{
+    IdleThreadPool pool;
+    auto thread = pool.acquireThread(QStringLiteral("engine"));
+    auto *object = new QObject;
+    object->moveToThread(thread.get());
+    QPointer<QObject> guard(object);
+    object->deleteLater();
+
+    pool.releaseThreads(threadList(std::move(thread)));
+    QVERIFY(guard.isNull());
+}
+
+void tst_QFFmpegIdleThreadPool::release_stopsOldestThreads_beyondCap()
+{
+    qputenv("QT_FFMPEG_IDLE_THREADS", "2");
+    IdleThreadPool pool;
+
+    std::vector<std::unique_ptr<QThread>> threads;
+    std::vector<QPointer<QThread>> released;
+    for (int i = 0; i < 3; ++i) {
+        threads.push_back(pool.acquireThread(QStringLiteral("engine")));
+        released.emplace_back(threads.back().get());
+    }
+
+    pool.releaseThreads(std::move(threads));
+    QCOMPARE(pool.idleThreadCount(), size_t(2));
+    // The most recently released ones are kept
+    QVERIFY(released[0].isNull());
+    QVERIFY(!released[1].isNull());
+    QVERIFY(!released[2].isNull());
+    QVERIFY(released[2]->isRunning());
+}
+
+void tst_QFFmpegIdleThreadPool::release_stopsThreads_whenDisabled()
+{
+    qputenv("QT_FFMPEG_IDLE_THREADS", "0");
+    IdleThreadPool pool;
+
+    auto thread = pool.acquireThread(QStringLiteral("engine"));
+    QVERIFY(thread->isRunning());
+    QPointer<QThread> released(thread.get());
+
+    pool.releaseThreads(threadList(std::move(thread)));
+    QVERIFY(released.isNull());
+    QCOMPARE(pool.idleThreadCount(), size_t(0));
+
+    thread = pool.acquireThread(QStringLiteral("engine"));
+    QVERIFY(thread->isRunning());
+    pool.releaseThreads(threadList(std::move(thread)));
+}
+
+void tst_QFFmpegIdleThreadPool::idleThreads_areStopped_afterTimeout()
+{
+    qputenv("QT_FFMPEG_IDLE_THREAD_TIMEOUT_MS", "100");
+    IdleThreadPool pool;
+
+    auto thread = pool.acquireThread(QStringLiteral("engine"));
+    QPointer<QThread> released(thread.get());
+    pool.releaseThreads(threadList(std::move(thread)));
+    QCOMPARE(pool.idleThreadCount(), size_t(1));
+
+    // by the timer, without the pool being used
+    QTRY_VERIFY(released.isNull());
+    QCOMPARE(pool.idleThreadCount(), size_t(0));
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegIdleThreadPool)
+
+#include "tst_qffmpegidlethreadpool.moc"
@@ -0,0 +1,285 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegiodeviceinput_p.h"
+#include "playbackengine/qffmpegmediadataholder_p.h"
+
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+
+namespace {
+
+class CancelToken : public ICancelToken
+{
+public:
+    bool isCancelled() const override { return m_cancelled.load(); }
+    void cancel() { m_cancelled.store(true); }
+
+private:
+    std::atomic_bool m_cancelled = false;
+};
+
+// Serves data from memory, and can be made to block in readData(). Like sockets, it
+// can be waited for data.
+class TestDevice : public QIODevice
+{
+public:
+    TestDevice(QByteArray data, bool sequential) : m_data(std::move(data)), m_sequential(sequential)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    bool isSequential() const override { return m_sequential; }
+    qint64 size() const override { return m_sequential ? 0 : m_data.size(); }
+    qint64 bytesAvailable() const override
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_data.size() - m_readPos;
+    }
+    bool atEnd() const override { return m_finished && bytesAvailable() <= 0; }
+
+    bool waitForReadyRead(int msecs) override
+    {
+        QMutexLocker locker(&m_mutex);
+        // the data doesn't grow, a live stream without data only ever times out
+        if (m_readPos < m_data.size())
+            return true;
+        m_condition.wait(&m_mutex, QDeadlineTimer(msecs));
+        return m_readPos < m_data.size();
+    }
+
+    bool seek(qint64 pos) override
+    {
+        QMutexLocker locker(&m_mutex);
+        m_readPos = pos;
+        return QIODevice::seek(pos);
+    }
+
+    // A live stream without data for now
+    void setFinished(bool finished) { m_finished = finished; }
+
+    void setBlocked(bool blocked)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_blocked = blocked;
+        m_condition.wakeAll();
+    }
+
+    int readsStarted() const { return m_readsStarted.load(); }
+    int readsFinished() const { return m_readsFinished.load(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        ++m_readsStarted;
+        QMutexLocker locker(&m_mutex);
+        while (m_blocked)
+            m_condition.wait(&m_mutex);
+
+        const qint64 size = qMin(maxSize, m_data.size() - m_readPos);
+        memcpy(data, m_data.constData() + m_readPos, size);
+        m_readPos += size;
+        ++m_readsFinished;
+        return size;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    const QByteArray m_data;
+    const bool m_sequential;
+    std::atomic_bool m_finished = true;
+    std::atomic_int m_readsStarted = 0;
+    std::atomic_int m_readsFinished = 0;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_condition;
+    qint64 m_readPos = 0;
+    bool m_blocked = false;
+};
+
+QByteArray makeData(qsizetype size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (qsizetype i = 0; i < size; ++i)
+        data[i] = char(i * 7 + i / 251);
+    return data;
+}
+
+// Reads up to size bytes, or until the end of the data
+QByteArray read(AVIOContext *context, qsizetype size)
+{
+    QByteArray result(size, Qt::Uninitialized);
+    qsizetype total = 0;
+    while (total < size) {
+        const int n = avio_read(context, reinterpret_cast<unsigned char *>(result.data()) + total,
+                                int(qMin<qsizetype>(size - total, 1024 * 1024)));
+        if (n <= 0)
+            break;
+        total += n;
+    }
+    result.truncate(total);
+    return result;
+}
+
+} // namespace
+
+class tst_QFFmpegIODeviceInput : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+
+    void read_returnsDeviceData_data();
+    void read_returnsDeviceData();
+    void seek_continuesAtNewPosition();
+    void seek_servesSequentialDeviceFromBuffer();
+    void read_returnsExit_whenCancelled();
+    void destructor_waitsUntilDeviceReturnsFromRead();
+    void destructor_returnsPromptly_whileDeviceHasNoData();
+};
+
+void tst_QFFmpegIODeviceInput::cleanup()
+{
+    qunsetenv("QT_FFMPEG_READ_AHEAD_SIZE");
+}
+
+void tst_QFFmpegIODeviceInput::read_returnsDeviceData_data()
+{
+    QTest::addColumn<bool>("sequential");
+    QTest::addColumn<QByteArray>("readAheadSize");
+
+    QTest::newRow("random access") << false << QByteArray();
+    QTest::newRow("sequential") << true << QByteArray();
+    QTest::newRow("small buffer") << false << QByteArray("131072");
+    QTest::newRow("direct reads") << false << QByteArray("0");
+}
+
+void tst_QFFmpegIODeviceInput::read_returnsDeviceData()
+{
+    QFETCH(const bool, sequential);
+    QFETCH(const QByteArray, readAheadSize);
+    if (!readAheadSize.isEmpty())
+        qputenv("QT_FFMPEG_READ_AHEAD_SIZE", readAheadSize);
+
+    const QByteArray data = makeData(3 * 1024 * 1024 + 123);
+    TestDevice device(data, sequential);
+    IODeviceInput input(&device, std::make_shared<CancelToken>());
+
+    QCOMPARE(read(input.avioContext(), data.size() + 1), data);
+    QVERIFY(avio_feof(input.avioContext()));
+}
+
+void tst_QFFmpegIODeviceInput::seek_continuesAtNewPosition()
+{
+    const QByteArray data = makeData(3 * 1024 * 1024);
+    TestDevice device(data, false);
+    IODeviceInput input(&device, std::make_shared<CancelToken>());
+    AVIOContext *context = input.avioContext();
+
+    QCOMPARE(avio_size(context), int64_t(data.size()));
+    QCOMPARE(read(context, 1000), data.left(1000));
+
+    QCOMPARE(avio_seek(context, 2000000, SEEK_SET), int64_t(2000000));
+    QCOMPARE(read(context, 1000), data.mid(2000000, 1000));
+
+    // Back to data already read
+    QCOMPARE(avio_seek(context, 500, SEEK_SET), int64_t(500));
+    QCOMPARE(read(context, 1000), data.mid(500, 1000));
+
+    QCOMPARE(avio_seek(context, data.size() - 100, SEEK_SET), int64_t(data.size() - 100));
+    QCOMPARE(read(context, 1000), data.right(100));
+}
+
+void tst_QFFmpegIODeviceInput::seek_servesSequentialDeviceFromBuffer()
+{
+    qputenv("QT_FFMPEG_READ_AHEAD_SIZE", QByteArray::number(1024 * 1024));
+
+    const QByteArray data = makeData(3 * 1024 * 1024);
+    TestDevice device(data, true);
+    IODeviceInput input(&device, std::make_shared<CancelToken>());
+    AVIOContext *context = input.avioContext();
+    QCOMPARE(read(context, data.size()), data);
+
+    // Further back than the AVIO buffer, but still in the read-ahead buffer
+    const qint64 inBuffer = data.size() - 700 * 1024;
+    QCOMPARE(avio_seek(context, inBuffer, SEEK_SET), int64_t(inBuffer));
+    QCOMPARE(read(context, 1000), data.mid(inBuffer, 1000));
+
+    // Overwritten already, and the device can't seek
+    QCOMPARE_LT(avio_seek(context, 1024 * 1024, SEEK_SET), 0);
+}
+
+void tst_QFFmpegIODeviceInput::read_returnsExit_whenCancelled()
+{
+    TestDevice device({}, true);
+    device.setFinished(false);
+    auto cancelToken = std::make_shared<CancelToken>();
+    IODeviceInput input(&device, cancelToken);
+
+    std::thread canceller([&] {
+        QThread::msleep(100);
+        cancelToken->cancel();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    unsigned char buf[16];
+    QCOMPARE(avio_read(input.avioContext(), buf, sizeof(buf)), AVERROR_EXIT);
+    canceller.join();
+    QCOMPARE_LT(timer.elapsed(), 5000);
+}
+
+void tst_QFFmpegIODeviceInput::destructor_waitsUntilDeviceReturnsFromRead()
+{
+    TestDevice device(makeData(1024 * 1024), true);
+    device.setBlocked(true);
+    auto input = std::make_unique<IODeviceInput>(&device, std::make_shared<CancelToken>());
+    QTRY_COMPARE(device.readsStarted(), 1);
+
+    std::thread unblocker([&] {
+        QThread::msleep(100);
+        device.setBlocked(false);
+    });
+    input.reset();
+    unblocker.join();
+
+    // The reading thread is done, and hasn't read any more after the device returned
+    QCOMPARE(device.readsFinished(), 1);
+    QTest::qWait(100);
+    QCOMPARE(device.readsStarted(), 1);
+}
+
+void tst_QFFmpegIODeviceInput::destructor_returnsPromptly_whileDeviceHasNoData()
+{
+    // A live stream whose reads would block until there is data
+    TestDevice device({}, true);
+    device.setFinished(false);
+    device.setBlocked(true);
+    auto cancelToken = std::make_shared<CancelToken>();
+    auto input = std::make_unique<IODeviceInput>(&device, cancelToken);
+    QTest::qWait(200);
+
+    QElapsedTimer timer;
+    timer.start();
+    cancelToken->cancel();
+    input.reset();
+    QCOMPARE_LT(timer.elapsed(), 5000);
+    QCOMPARE(device.readsStarted(), 0);
+    device.setBlocked(false);
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegIODeviceInput)
+
+#include "tst_qffmpegiodeviceinput.moc"
@@ -0,0 +1,162 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+#include "playbackengine/qffmpegprobecache_p.h"
+
+#include <memory>
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+
+namespace {
+
+struct ContextDeleter
+{
+    void operator()(AVFormatContext *context) const { avformat_free_context(context); }
+};
+
+using ContextPtr = std::unique_ptr<AVFormatContext, ContextDeleter>;
+
+// A context of the given input format with a video stream, as after avformat_open_input
+ContextPtr makeContext(const char *formatName)
+{
+    ContextPtr context(avformat_alloc_context());
+    context->iformat = av_find_input_format(formatName);
+    AVStream *video = avformat_new_stream(context.get(), nullptr);
+    video->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    return context;
+}
+
+} // namespace
+
+class tst_QFFmpegKeyframeIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void isUseful_returnsTrue_forFormatsWithoutIndex();
+    void isUseful_returnsFalse_forIndexedFormats();
+    void isUseful_returnsFalse_forMatroskaWithCues();
+    void isUseful_returnsFalse_forAviWithIndex();
+    void findBytePos_returnsKeyframe_onlyWhenNoneCanBeInBetween();
+    void saveToCache_storesIndex_forNextInstance();
+    void destructor_doesNotStoreIndex();
+
+private:
+    QString createMediaFile();
+
+    QTemporaryDir m_cacheDir;
+    QTemporaryDir m_mediaDir;
+    int m_mediaFileCount = 0;
+};
+
+void tst_QFFmpegKeyframeIndex::initTestCase()
+{
+    QVERIFY(m_cacheDir.isValid());
+    QVERIFY(m_mediaDir.isValid());
+    // Read by the first ProbeCache::instance() call
+    qputenv("QT_FFMPEG_PROBE_CACHE_DIR", m_cacheDir.path().toLocal8Bit());
+    QVERIFY(ProbeCache::instance());
+}
+
+QString tst_QFFmpegKeyframeIndex::createMediaFile()
+{
+    const QString path = m_mediaDir.filePath(QStringLiteral("media%1.ts").arg(m_mediaFileCount++));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write("media") != 5)
+        return {};
+    return path;
+}
+
+void tst_QFFmpegKeyframeIndex::isUseful_returnsTrue_forFormatsWithoutIndex()
+{
+    QVERIFY(KeyframeIndex::isUseful(makeContext("mpegts").get()));
+    QVERIFY(KeyframeIndex::isUseful(makeContext("mpeg").get()));
+    QVERIFY(KeyframeIndex::isUseful(makeContext("matroska").get()));
+    // Without an idx1 chunk, e.g. cut off while recording
+    QVERIFY(KeyframeIndex::isUseful(makeContext("avi").get()));
+}
+
+void tst_QFFmpegKeyframeIndex::isUseful_returnsFalse_forIndexedFormats()
+{
+    QVERIFY(!KeyframeIndex::isUseful(makeContext("mov").get()));
+
+    ContextPtr unseekable = makeContext("mpegts");
+    unseekable->ctx_flags |= AVFMTCTX_UNSEEKABLE;
+    QVERIFY(!KeyframeIndex::isUseful(unseekable.get()));
+}
+
+void tst_QFFmpegKeyframeIndex::isUseful_returnsFalse_forMatroskaWithCues()
+{
+    ContextPtr context = makeContext("matroska");
+    // What reading the cues leaves behind
+    QCOMPARE_GE(av_add_index_entry(context->streams[0], 0, 0, 0, 0, AVINDEX_KEYFRAME), 0);
+    QVERIFY(!KeyframeIndex::isUseful(context.get()));
+}
+
+void tst_QFFmpegKeyframeIndex::isUseful_returnsFalse_forAviWithIndex()
+{
+    ContextPtr context = makeContext("avi");
+    // What reading the idx1 chunk leaves behind
+    QCOMPARE_GE(av_add_index_entry(context->streams[0], 0, 0, 0, 0, AVINDEX_KEYFRAME), 0);
+    QVERIFY(!KeyframeIndex::isUseful(context.get()));
+}
+
+void tst_QFFmpegKeyframeIndex::findBytePos_returnsKeyframe_onlyWhenNoneCanBeInBetween()
+{
+    KeyframeIndex index;
+    index.addKeyframe(0, 0, 100, {});
+    index.addKeyframe(0, 2000000, 5000, 0);
+    // Found after a seek, so there may be keyframes between this one and the previous one
+    index.addKeyframe(0, 6000000, 9000, {});
+
+    QCOMPARE(index.findBytePos(0, 1000000).value_or(-1), qint64(100));
+    QCOMPARE(index.findBytePos(0, 2000000).value_or(-1), qint64(5000));
+    QVERIFY(!index.findBytePos(0, 3000000));
+    QCOMPARE(index.findBytePos(0, 6000000).value_or(-1), qint64(9000));
+    QVERIFY(!index.findBytePos(0, 7000000));
+    QVERIFY(!index.findBytePos(1, 0));
+
+    // Reading on from the keyframe at 2s closes the gap
+    index.addKeyframe(0, 4000000, 7000, 2000000);
+    index.addKeyframe(0, 6000000, 9000, 4000000);
+    QCOMPARE(index.findBytePos(0, 3000000).value_or(-1), qint64(5000));
+    QCOMPARE(index.findBytePos(0, 5000000).value_or(-1), qint64(7000));
+}
+
+void tst_QFFmpegKeyframeIndex::saveToCache_storesIndex_forNextInstance()
+{
+    const QString media = createMediaFile();
+    {
+        KeyframeIndex index(media);
+        index.addKeyframe(0, 0, 100, {});
+        index.addKeyframe(0, 2000000, 5000, 0);
+        index.saveToCache();
+    }
+
+    KeyframeIndex restored(media);
+    QCOMPARE(restored.findBytePos(0, 1000000).value_or(-1), qint64(100));
+    QCOMPARE(restored.findBytePos(0, 2000000).value_or(-1), qint64(5000));
+}
+
+void tst_QFFmpegKeyframeIndex::destructor_doesNotStoreIndex()
+{
+    const QString media = createMediaFile();
+    {
+        KeyframeIndex index(media);
+        index.addKeyframe(0, 0, 100, {});
+    }
+
+    KeyframeIndex restored(media);
+    QVERIFY(!restored.findBytePos(0, 0));
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegKeyframeIndex)
+
+#include "tst_qffmpegkeyframeindex.moc"
@@ -0,0 +1,340 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegkeyframeindex_p.h"
+#include "playbackengine/qffmpegprobecache_p.h"
+
+#include <memory>
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+
+namespace {
+
+using ContextPtr = std::unique_ptr<AVFormatContext,
+                                   AVDeleter<decltype(&avformat_close_input), &avformat_close_input>>;
+
+const QByteArray extradata("\x01\x64\x00\x1f\xff\xe1\x00\x19", 8);
+
+// A context as it is after avformat_open_input: the streams are known, but some of
+// their parameters are missing
+ContextPtr makeHeaderContext(AVCodecID videoCodec = AV_CODEC_ID_H264)
+{
+    ContextPtr context(avformat_alloc_context());
+    context->duration = AV_NOPTS_VALUE;
+    context->start_time = AV_NOPTS_VALUE;
+
+    AVStream *video = avformat_new_stream(context.get(), nullptr);
+    video->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+    video->codecpar->codec_id = videoCodec;
+
+    AVStream *audio = avformat_new_stream(context.get(), nullptr);
+    audio->codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+    audio->codecpar->codec_id = AV_CODEC_ID_AAC;
+    av_dict_set(&audio->metadata, "language", "ger", 0);
+    return context;
+}
+
+// The same context after avformat_find_stream_info
+ContextPtr makeProbedContext()
+{
+    ContextPtr context = makeHeaderContext();
+    context->duration = 10 * AV_TIME_BASE;
+    context->start_time = 12345;
+    context->bit_rate = 1000000;
+    av_dict_set(&context->metadata, "title", "Probed", 0);
+
+    AVStream *video = context->streams[0];
+    video->codecpar->width = 1280;
+    video->codecpar->height = 720;
+    video->codecpar->format = AV_PIX_FMT_YUV420P;
+    video->avg_frame_rate = { 25, 1 };
+    video->r_frame_rate = { 25, 1 };
+    video->sample_aspect_ratio = { 1, 1 };
+    video->start_time = 1000;
+    video->duration = 900000;
+    video->codecpar->extradata =
+            static_cast<uint8_t *>(av_mallocz(extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+    memcpy(video->codecpar->extradata, extradata.constData(), extradata.size());
+    video->codecpar->extradata_size = int(extradata.size());
+    av_dict_set(&video->metadata, "handler_name", "VideoHandler", 0);
+
+    AVStream *audio = context->streams[1];
+    audio->codecpar->sample_rate = 48000;
+    audio->codecpar->format = AV_SAMPLE_FMT_FLTP;
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+    audio->codecpar->channels = 2;
+    audio->codecpar->channel_layout = AV_CH_LAYOUT_STEREO;
+#else
+    av_channel_layout_default(&audio->codecpar->ch_layout, 2);
+#endif
+    audio->start_time = 2000;
+    // the header wins over what was found while probing
+    av_dict_set(&audio->metadata, "language", "eng", 0);
+    return context;
+}
+
+QByteArray metaDataValue(const AVDictionary *dict, const char *key)
+{
+    const AVDictionaryEntry *entry = av_dict_get(dict, key, nullptr, 0);
+    return entry ? QByteArray(entry->value) : QByteArray();
+}
+
+void setModified(const QString &path, const QDateTime &time)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QVERIFY(file.setFileTime(time, QFileDevice::FileModificationTime));
+}
+
+} // namespace
+
+class tst_QFFmpegProbeCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void restore_returnsFalse_withoutEntry();
+    void restore_completesStreams_afterStore();
+    void restore_keepsHeaderValues();
+    void restore_returnsFalse_whenFileChanged();
+    void restore_returnsFalse_whenStreamsDiffer();
+    void restoreKeyframeIndex_returnsStoredIndex();
+    void prune_removesLeastRecentlyUsedEntries();
+    void prune_removesOldEntries();
+    void restore_marksEntryAsUsed();
+
+private:
+    // Creates a media file in its own directory, so that it's not taken for an entry
+    QString createMediaFile(const QByteArray &content = "media");
+    // Stores the probed context for filePath, returns the path of the new entry
+    QString storeEntry(const QString &filePath);
+    QStringList entries() const;
+
+    std::unique_ptr<QTemporaryDir> m_cacheDir;
+    std::unique_ptr<QTemporaryDir> m_mediaDir;
+    std::unique_ptr<ProbeCache> m_cache;
+    int m_mediaFileCount = 0;
+};
+
+void tst_QFFmpegProbeCache::init()
+{
+    m_cacheDir = std::make_unique<QTemporaryDir>();
+    m_mediaDir = std::make_unique<QTemporaryDir>();
+    QVERIFY(m_cacheDir->isValid());
+    QVERIFY(m_mediaDir->isValid());
+    m_cache = std::make_unique<ProbeCache>(m_cacheDir->path());
+}
+
+void tst_QFFmpegProbeCache::cleanup()
+{
+    m_cache.reset();
+    m_mediaDir.reset();
+    m_cacheDir.reset();
+}
+
+QString tst_QFFmpegProbeCache::createMediaFile(const QByteArray &content)
+{
+    const QString path = m_mediaDir->filePath(QStringLiteral("media%1.mp4").arg(m_mediaFileCount++));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(content) != content.size())
+        return {};
+    return path;
+}
+
+QString tst_QFFmpegProbeCache::storeEntry(const QString &filePath)
+{
+    const QStringList before = entries();
+    m_cache->store(filePath, makeProbedContext().get());
+    for (const QString &entry : entries()) {
+        if (!before.contains(entry))
+            return QDir(m_cacheDir->path()).filePath(entry);
+    }
+    return {};
+}
+
+QStringList tst_QFFmpegProbeCache::entries() const
+{
+    return QDir(m_cacheDir->path()).entryList(QDir::Files, QDir::Name);
+}
+
+void tst_QFFmpegProbeCache::restore_returnsFalse_withoutEntry()
+{
+    const QString media = createMediaFile();
+    ContextPtr context = makeHeaderContext();
+    QVERIFY(!m_cache->restore(media, context.get()));
+    QCOMPARE(context->streams[0]->codecpar->width, 0);
+}
+
+void tst_QFFmpegProbeCache::restore_completesStreams_afterStore()
+{
+    const QString media = createMediaFile();
+    QVERIFY(!storeEntry(media).isEmpty());
+
+    ContextPtr context = makeHeaderContext();
+    QVERIFY(m_cache->restore(media, context.get()));
+
+    QCOMPARE(context->duration, int64_t(10 * AV_TIME_BASE));
+    QCOMPARE(context->start_time, int64_t(12345));
+    QCOMPARE(context->bit_rate, int64_t(1000000));
+    QCOMPARE(metaDataValue(context->metadata, "title"), QByteArray("Probed"));
+
+    const AVStream *video = context->streams[0];
+    QCOMPARE(video->codecpar->width, 1280);
+    QCOMPARE(video->codecpar->height, 720);
+    QCOMPARE(video->codecpar->format, int(AV_PIX_FMT_YUV420P));
+    QCOMPARE(video->avg_frame_rate.num, 25);
+    QCOMPARE(video->avg_frame_rate.den, 1);
+    QCOMPARE(video->r_frame_rate.num, 25);
+    QCOMPARE(video->sample_aspect_ratio.num, 1);
+    QCOMPARE(video->start_time, int64_t(1000));
+    QCOMPARE(video->duration, int64_t(900000));
+    QCOMPARE(QByteArray(reinterpret_cast<const char *>(video->codecpar->extradata),
+                        video->codecpar->extradata_size),
+             extradata);
+    QCOMPARE(metaDataValue(video->metadata, "handler_name"), QByteArray("VideoHandler"));
+
+    const AVStream *audio = context->streams[1];
+    QCOMPARE(audio->codecpar->sample_rate, 48000);
+    QCOMPARE(audio->codecpar->format, int(AV_SAMPLE_FMT_FLTP));
+#if QT_FFMPEG_OLD_CHANNEL_LAYOUT
+    QCOMPARE(audio->codecpar->channels, 2);
+    QCOMPARE(audio->codecpar->channel_layout, uint64_t(AV_CH_LAYOUT_STEREO));
+#else
+    QCOMPARE(audio->codecpar->ch_layout.nb_channels, 2);
+    QCOMPARE(audio->codecpar->ch_layout.order, AV_CHANNEL_ORDER_NATIVE);
+    QCOMPARE(audio->codecpar->ch_layout.u.mask, uint64_t(AV_CH_LAYOUT_STEREO));
+#endif
+    QCOMPARE(audio->start_time, int64_t(2000));
+}
+
+void tst_QFFmpegProbeCache::restore_keepsHeaderValues()
+{
+    const QString media = createMediaFile();
+    QVERIFY(!storeEntry(media).isEmpty());
+
+    ContextPtr context = makeHeaderContext();
+    context->streams[0]->codecpar->width = 640;
+    context->streams[0]->codecpar->height = 360;
+    context->start_time = 0;
+    QVERIFY(m_cache->restore(media, context.get()));
+
+    QCOMPARE(context->streams[0]->codecpar->width, 640);
+    QCOMPARE(context->streams[0]->codecpar->height, 360);
+    QCOMPARE(context->start_time, int64_t(0));
+    QCOMPARE(metaDataValue(context->streams[1]->metadata, "language"), QByteArray("ger"));
+}
+
+void tst_QFFmpegProbeCache::restore_returnsFalse_whenFileChanged()
+{
+    const QString media = createMediaFile();
+    QVERIFY(!storeEntry(media).isEmpty());
+
+    QFile file(media);
+    QVERIFY(file.open(QIODevice::Append));
+    file.write("more");
+    file.close();
+
+    ContextPtr context = makeHeaderContext();
+    QVERIFY(!m_cache->restore(media, context.get()));
+    QCOMPARE(context->streams[0]->codecpar->width, 0);
+    QCOMPARE(context->duration, AV_NOPTS_VALUE);
+}
+
+void tst_QFFmpegProbeCache::restore_returnsFalse_whenStreamsDiffer()
+{
+    const QString media = createMediaFile();
+    QVERIFY(!storeEntry(media).isEmpty());
+
+    ContextPtr context = makeHeaderContext(AV_CODEC_ID_HEVC);
+    QVERIFY(!m_cache->restore(media, context.get()));
+    QCOMPARE(context->streams[0]->codecpar->width, 0);
+    QCOMPARE(context->streams[1]->codecpar->sample_rate, 0);
+}
+
+void tst_QFFmpegProbeCache::restoreKeyframeIndex_returnsStoredIndex()
+{
+    const QString media = createMediaFile();
+
+    KeyframeIndex index;
+    index.addKeyframe(0, 0, 100, {});
+    index.addKeyframe(0, 2000000, 5000, 0);
+    index.addKeyframe(1, 1000000, 3000, {});
+    m_cache->storeKeyframeIndex(media, index);
+
+    KeyframeIndex restored;
+    QVERIFY(m_cache->restoreKeyframeIndex(media, restored));
+    QCOMPARE(restored.findBytePos(0, 0).value_or(-1), qint64(100));
+    QCOMPARE(restored.findBytePos(0, 1000000).value_or(-1), qint64(100));
+    QCOMPARE(restored.findBytePos(0, 2000000).value_or(-1), qint64(5000));
+    QCOMPARE(restored.findBytePos(1, 1000000).value_or(-1), qint64(3000));
+    QVERIFY(!restored.findBytePos(1, 1500000));
+}
+
+void tst_QFFmpegProbeCache::prune_removesLeastRecentlyUsedEntries()
+{
+    // Not written by the cache, never removed
+    const QString foreignFile = QDir(m_cacheDir->path()).filePath(QStringLiteral("notes.txt"));
+    {
+        QFile file(foreignFile);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(4096, 'x'));
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QStringList entryPaths;
+    for (int i = 0; i < 4; ++i) {
+        const QString entry = storeEntry(createMediaFile());
+        QVERIFY(!entry.isEmpty());
+        // the first one is the least recently used
+        setModified(entry, now.addSecs(-100 + i * 10));
+        entryPaths.append(entry);
+    }
+    const qint64 entrySize = QFileInfo(entryPaths.front()).size();
+
+    m_cache->prune(entrySize * 2);
+    QVERIFY(!QFile::exists(entryPaths[0]));
+    QVERIFY(!QFile::exists(entryPaths[1]));
+    QVERIFY(QFile::exists(entryPaths[2]));
+    QVERIFY(QFile::exists(entryPaths[3]));
+    QVERIFY(QFile::exists(foreignFile));
+}
+
+void tst_QFFmpegProbeCache::prune_removesOldEntries()
+{
+    const QString oldEntry = storeEntry(createMediaFile());
+    const QString newEntry = storeEntry(createMediaFile());
+    QVERIFY(!oldEntry.isEmpty());
+    QVERIFY(!newEntry.isEmpty());
+    setModified(oldEntry, QDateTime::currentDateTimeUtc().addDays(-31));
+
+    m_cache->prune();
+    QVERIFY(!QFile::exists(oldEntry));
+    QVERIFY(QFile::exists(newEntry));
+}
+
+void tst_QFFmpegProbeCache::restore_marksEntryAsUsed()
+{
+    const QString media = createMediaFile();
+    const QString entry = storeEntry(media);
+    QVERIFY(!entry.isEmpty());
+    const QDateTime longAgo = QDateTime::currentDateTimeUtc().addDays(-31);
+    setModified(entry, longAgo);
+
+    ContextPtr context = makeHeaderContext();
+    QVERIFY(m_cache->restore(media, context.get()));
+    QCOMPARE_GT(QFileInfo(entry).lastModified(), longAgo.addDays(1));
+
+    m_cache->prune();
+    QVERIFY(QFile::exists(entry));
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegProbeCache)
+
+#include "tst_qffmpegprobecache.moc"
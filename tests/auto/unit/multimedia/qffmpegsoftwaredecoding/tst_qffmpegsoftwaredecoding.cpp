@@ -0,0 +1,176 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegsoftwaredecoding_p.h"
+
+QT_USE_NAMESPACE
+
+using namespace QFFmpeg;
+
+namespace {
+
+// A single MJPEG frame of the size, empty if there is no MJPEG encoder
+QByteArray encodeMjpegFrame(QSize size)
+{
+    const AVCodec *encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (!encoder)
+        return {};
+
+    AVCodecContextUPtr context(avcodec_alloc_context3(encoder));
+    context->width = size.width();
+    context->height = size.height();
+    context->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    context->time_base = { 1, 25 };
+    if (avcodec_open2(context.get(), encoder, nullptr) < 0)
+        return {};
+
+    AVFrameUPtr frame = makeAVFrame();
+    frame->width = size.width();
+    frame->height = size.height();
+    frame->format = AV_PIX_FMT_YUVJ420P;
+    if (av_frame_get_buffer(frame.get(), 0) < 0)
+        return {};
+    for (int plane = 0; plane < 3; ++plane) {
+        const int height = plane ? (size.height() + 1) / 2 : size.height();
+        memset(frame->data[plane], 128, frame->linesize[plane] * height);
+    }
+
+    AVPacketUPtr packet(av_packet_alloc());
+    if (avcodec_send_frame(context.get(), frame.get()) < 0
+        || avcodec_receive_packet(context.get(), packet.get()) < 0)
+        return {};
+    return QByteArray(reinterpret_cast<const char *>(packet->data), packet->size);
+}
+
+} // namespace
+
+class tst_QFFmpegSoftwareDecoding : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void cleanup();
+
+    void requestedDecodingLowres_followsEnvironment();
+    void supportedLowres_isBoundByDecoder();
+    void lowresFrameSize_roundsUp_data();
+    void lowresFrameSize_roundsUp();
+    void lowresFrameSize_matchesDecodedFrames();
+    void setupSoftwareVideoDecoder_usesFrameThreads_unlessLowLatency();
+};
+
+void tst_QFFmpegSoftwareDecoding::cleanup()
+{
+    qunsetenv("QT_FFMPEG_DECODING_LOWRES");
+}
+
+void tst_QFFmpegSoftwareDecoding::requestedDecodingLowres_followsEnvironment()
+{
+    QCOMPARE(requestedDecodingLowres(), 0);
+
+    // Read each time, so that it applies to the sources loaded while it is set
+    qputenv("QT_FFMPEG_DECODING_LOWRES", "2");
+    QCOMPARE(requestedDecodingLowres(), 2);
+    qputenv("QT_FFMPEG_DECODING_LOWRES", "1");
+    QCOMPARE(requestedDecodingLowres(), 1);
+
+    qputenv("QT_FFMPEG_DECODING_LOWRES", "-1");
+    QCOMPARE(requestedDecodingLowres(), 0);
+    qputenv("QT_FFMPEG_DECODING_LOWRES", "abc");
+    QCOMPARE(requestedDecodingLowres(), 0);
+}
+
+void tst_QFFmpegSoftwareDecoding::supportedLowres_isBoundByDecoder()
+{
+    const AVCodec *mjpeg = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+    if (!mjpeg)
+        QSKIP("No MJPEG decoder");
+
+    QCOMPARE_GT(int(mjpeg->max_lowres), 0);
+    QCOMPARE(supportedLowres(mjpeg, 0), 0);
+    QCOMPARE(supportedLowres(mjpeg, 1), 1);
+    QCOMPARE(supportedLowres(mjpeg, 100), int(mjpeg->max_lowres));
+    QCOMPARE(supportedLowres(mjpeg, -1), 0);
+
+    // Decoders without lowres support decode the full size
+    if (const AVCodec *h264 = avcodec_find_decoder(AV_CODEC_ID_H264)) {
+        QCOMPARE(int(h264->max_lowres), 0);
+        QCOMPARE(supportedLowres(h264, 2), 0);
+    }
+}
+
+void tst_QFFmpegSoftwareDecoding::lowresFrameSize_roundsUp_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<int>("lowres");
+    QTest::addColumn<QSize>("expected");
+
+    QTest::newRow("full size") << QSize(1920, 1080) << 0 << QSize(1920, 1080);
+    QTest::newRow("half") << QSize(1920, 1080) << 1 << QSize(960, 540);
+    QTest::newRow("quarter") << QSize(1920, 1080) << 2 << QSize(480, 270);
+    QTest::newRow("odd half") << QSize(1919, 1079) << 1 << QSize(960, 540);
+    QTest::newRow("odd eighth") << QSize(101, 51) << 3 << QSize(13, 7);
+}
+
+void tst_QFFmpegSoftwareDecoding::lowresFrameSize_roundsUp()
+{
+    QFETCH(QSize, size);
+    QFETCH(int, lowres);
+    QFETCH(QSize, expected);
+
+    QCOMPARE(lowresFrameSize(size, lowres), expected);
+}
+
+void tst_QFFmpegSoftwareDecoding::lowresFrameSize_matchesDecodedFrames()
+{
+    constexpr QSize size(99, 61);
+    const QByteArray encoded = encodeMjpegFrame(size);
+    const AVCodec *decoder = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+    if (encoded.isEmpty() || !decoder)
+        QSKIP("No MJPEG encoder or decoder");
+
+    for (int lowres = 0; lowres <= decoder->max_lowres; ++lowres) {
+        AVCodecContextUPtr context(avcodec_alloc_context3(decoder));
+        setupSoftwareVideoDecoder(context.get(), decoder, false, lowres);
+        QCOMPARE(context->lowres, lowres);
+        QCOMPARE_GE(avcodec_open2(context.get(), decoder, nullptr), 0);
+
+        AVPacketUPtr packet(av_packet_alloc());
+        QCOMPARE(av_new_packet(packet.get(), encoded.size()), 0);
+        memcpy(packet->data, encoded.constData(), encoded.size());
+        QCOMPARE(avcodec_send_packet(context.get(), packet.get()), 0);
+        // Frame threading holds the frame back until the decoder is drained
+        QCOMPARE(avcodec_send_packet(context.get(), nullptr), 0);
+
+        AVFrameUPtr frame = makeAVFrame();
+        QCOMPARE(avcodec_receive_frame(context.get(), frame.get()), 0);
+        QCOMPARE(QSize(frame->width, frame->height), lowresFrameSize(size, lowres));
+    }
+}
+
+void tst_QFFmpegSoftwareDecoding::setupSoftwareVideoDecoder_usesFrameThreads_unlessLowLatency()
+{
+    const AVCodec *decoder = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if (!decoder)
+        QSKIP("No H.264 decoder");
+    QVERIFY(decoder->capabilities & AV_CODEC_CAP_FRAME_THREADS);
+
+    AVCodecContextUPtr context(avcodec_alloc_context3(decoder));
+    setupSoftwareVideoDecoder(context.get(), decoder, false, 0);
+    QCOMPARE_GE(context->thread_count, 1);
+    QCOMPARE_LE(context->thread_count, 16);
+    QVERIFY(context->thread_type & FF_THREAD_FRAME);
+    QCOMPARE(context->thread_type & FF_THREAD_SLICE,
+             decoder->capabilities & AV_CODEC_CAP_SLICE_THREADS ? FF_THREAD_SLICE : 0);
+
+    // Frame threading delays the output
+    context.reset(avcodec_alloc_context3(decoder));
+    setupSoftwareVideoDecoder(context.get(), decoder, true, 0);
+    QCOMPARE(context->thread_type & FF_THREAD_FRAME, 0);
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegSoftwareDecoding)
+
+#include "tst_qffmpegsoftwaredecoding.moc"
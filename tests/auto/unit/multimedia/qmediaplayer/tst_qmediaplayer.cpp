@@ -94,6 +94,10 @@ private slots:
     void testDestructor();
     void testQrc_data();
     void testQrc();
+    void testNextSource();
+    void testNextSourceStarted();
+    void testNextSourceAtEndOfMedia();
+    void testLowLatency();
 
 private:
     void setupCommonTestData();
@@ -795,5 +799,98 @@ void tst_QMediaPlayer::testQrc()
     QCOMPARE(bool(mockPlayer->mediaStream()), backendHasStream);
 }
 
+void tst_QMediaPlayer::testNextSource()
+{
+    const QUrl source(QUrl("file:///some.mp3"));
+    const QUrl nextSource(QUrl("file:///someother.mp3"));
+    QSignalSpy nextSourceSpy(player, &QMediaPlayer::nextSourceChanged);
+
+    player->setNextSource(nextSource);
+    QCOMPARE(player->nextSource(), nextSource);
+    QCOMPARE(nextSourceSpy.size(), 1);
+    QCOMPARE(mockPlayer->nextMedia(), nextSource);
+
+    player->setNextSource(nextSource);
+    QCOMPARE(nextSourceSpy.size(), 1);
+
+    // Changing the current source keeps the next one
+    player->setSource(source);
+    QCOMPARE(player->nextSource(), nextSource);
+    QCOMPARE(mockPlayer->nextMedia(), nextSource);
+
+    player->setNextSource(QUrl());
+    QVERIFY(player->nextSource().isEmpty());
+    QCOMPARE(nextSourceSpy.size(), 2);
+    QVERIFY(mockPlayer->nextMedia().isEmpty());
+}
+
+void tst_QMediaPlayer::testNextSourceStarted()
+{
+    const QUrl source(QUrl("file:///some.mp3"));
+    const QUrl nextSource(QUrl("file:///someother.mp3"));
+
+    player->setSource(source);
+    player->setNextSource(nextSource);
+
+    QSignalSpy sourceSpy(player, &QMediaPlayer::sourceChanged);
+    QSignalSpy nextSourceSpy(player, &QMediaPlayer::nextSourceChanged);
+
+    mockPlayer->nextMediaStarted();
+
+    QCOMPARE(player->source(), nextSource);
+    QVERIFY(player->nextSource().isEmpty());
+    QCOMPARE(sourceSpy.size(), 1);
+    QCOMPARE(qvariant_cast<QUrl>(sourceSpy.last().value(0)), nextSource);
+    QCOMPARE(nextSourceSpy.size(), 1);
+}
+
+void tst_QMediaPlayer::testNextSourceAtEndOfMedia()
+{
+    const QUrl source(QUrl("file:///some.mp3"));
+    const QUrl nextSource(QUrl("file:///someother.mp3"));
+
+    mockPlayer->setIsValid(true);
+    player->setSource(source);
+    player->setNextSource(nextSource);
+    player->play();
+
+    QSignalSpy sourceSpy(player, &QMediaPlayer::sourceChanged);
+
+    // The back end didn't continue on its own, so the player does
+    mockPlayer->setState(QMediaPlayer::StoppedState, QMediaPlayer::EndOfMedia);
+
+    QTRY_COMPARE(player->source(), nextSource);
+    QVERIFY(player->nextSource().isEmpty());
+    QCOMPARE(sourceSpy.size(), 1);
+    QCOMPARE(mockPlayer->media(), nextSource);
+    QCOMPARE(player->playbackState(), QMediaPlayer::PlayingState);
+}
+
+void tst_QMediaPlayer::testLowLatency()
+{
+    QSignalSpy lowLatencySpy(player, &QMediaPlayer::lowLatencyChanged);
+    QSignalSpy latencySpy(player, &QMediaPlayer::latencyChanged);
+
+    QCOMPARE(player->isLowLatency(), false);
+    QCOMPARE(player->latency(), qint64(-1));
+
+    player->setLowLatency(true);
+    QCOMPARE(player->isLowLatency(), true);
+    QCOMPARE(mockPlayer->lowLatency(), true);
+    QCOMPARE(lowLatencySpy.size(), 1);
+
+    player->setLowLatency(true);
+    QCOMPARE(lowLatencySpy.size(), 1);
+
+    mockPlayer->setLatency(150);
+    QCOMPARE(player->latency(), qint64(150));
+    QCOMPARE(latencySpy.size(), 1);
+    QCOMPARE(latencySpy.last().value(0).toLongLong(), qint64(150));
+
+    player->setLowLatency(false);
+    QCOMPARE(mockPlayer->lowLatency(), false);
+    QCOMPARE(lowLatencySpy.size(), 2);
+}
+
 QTEST_GUILESS_MAIN(tst_QMediaPlayer)
 #include "tst_qmediaplayer.moc"
@@ -0,0 +1,169 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <qvideoframe.h>
+#include <qvideoframeformat.h>
+#include <private/qvideotexturehelper_p.h>
+#include <rhi/qrhi.h>
+#include <QtGui/private/qrhi_p.h>
+
+#include <memory>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+constexpr QSize frameSize(64, 64);
+
+// An NV12 frame with constant luma and chroma
+QVideoFrame makeFrame(uchar luma, uchar chroma, QSize size = frameSize)
+{
+    QVideoFrame frame(QVideoFrameFormat(size, QVideoFrameFormat::Format_NV12));
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return {};
+    memset(frame.bits(0), luma, frame.mappedBytes(0));
+    memset(frame.bits(1), chroma, frame.mappedBytes(1));
+    frame.unmap();
+    return frame;
+}
+
+int uploadsTo(QRhiResourceUpdateBatch *rub, QRhiTexture *texture)
+{
+    int uploads = 0;
+    for (const auto &op : QRhiResourceUpdateBatchPrivate::get(rub)->textureOps) {
+        if (op.type == QRhiResourceUpdateBatchPrivate::TextureOp::Upload && op.dst == texture)
+            ++uploads;
+    }
+    return uploads;
+}
+
+} // namespace
+
+class tst_QVideoTextureHelper : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void createTextures_uploadsAllPlanes_forFirstFrame();
+    void createTextures_skipsUpload_whenPlaneIsUnchanged();
+    void createTextures_uploadsAllPlanes_whenSizeChanges();
+    void createTextures_skipsUpload_whenVideoBecomesStatic();
+
+private:
+    // Passes frame through createTextures(), keeping the textures for the next frame
+    void upload(QVideoFrame frame, int *lumaUploads, int *chromaUploads);
+
+    std::unique_ptr<QRhi> rhi;
+    std::unique_ptr<QVideoFrameTextures> textures;
+};
+
+void tst_QVideoTextureHelper::initTestCase()
+{
+    QRhiNullInitParams params;
+    rhi.reset(QRhi::create(QRhi::Null, &params));
+    if (!rhi)
+        QSKIP("Failed to create a null QRhi");
+}
+
+void tst_QVideoTextureHelper::cleanupTestCase()
+{
+    textures.reset();
+    rhi.reset();
+}
+
+void tst_QVideoTextureHelper::upload(QVideoFrame frame, int *lumaUploads, int *chromaUploads)
+{
+    QVERIFY(frame.isValid());
+    QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
+    QVERIFY(rub);
+    textures = QVideoTextureHelper::createTextures(frame, rhi.get(), rub, std::move(textures));
+    QVERIFY(textures);
+    QVERIFY(textures->texture(0));
+    QVERIFY(textures->texture(1));
+    *lumaUploads = uploadsTo(rub, textures->texture(0));
+    *chromaUploads = uploadsTo(rub, textures->texture(1));
+    rub->release();
+}
+
+void tst_QVideoTextureHelper::createTextures_uploadsAllPlanes_forFirstFrame()
+{
+    textures.reset();
+    int luma = 0, chroma = 0;
+    upload(makeFrame(16, 128), &luma, &chroma);
+    QCOMPARE(luma, 1);
+    QCOMPARE(chroma, 1);
+}
+
+void tst_QVideoTextureHelper::createTextures_skipsUpload_whenPlaneIsUnchanged()
+{
+    textures.reset();
+    int luma = 0, chroma = 0;
+    upload(makeFrame(16, 128), &luma, &chroma);
+    QRhiTexture *lumaTexture = textures->texture(0);
+
+    // A new frame with the same content
+    upload(makeFrame(16, 128), &luma, &chroma);
+    QCOMPARE(luma, 0);
+    QCOMPARE(chroma, 0);
+    // The textures are reused
+    QCOMPARE(textures->texture(0), lumaTexture);
+
+    // Only the luma changes
+    upload(makeFrame(200, 128), &luma, &chroma);
+    QCOMPARE(luma, 1);
+    QCOMPARE(chroma, 0);
+}
+
+void tst_QVideoTextureHelper::createTextures_uploadsAllPlanes_whenSizeChanges()
+{
+    textures.reset();
+    int luma = 0, chroma = 0;
+    upload(makeFrame(16, 128), &luma, &chroma);
+
+    // The same bytes, but the textures have to be recreated
+    upload(makeFrame(16, 128, frameSize * 2), &luma, &chroma);
+    QCOMPARE(luma, 1);
+    QCOMPARE(chroma, 1);
+    QCOMPARE(textures->texture(0)->pixelSize(), frameSize * 2);
+
+    upload(makeFrame(16, 128, frameSize * 2), &luma, &chroma);
+    QCOMPARE(luma, 0);
+    QCOMPARE(chroma, 0);
+}
+
+void tst_QVideoTextureHelper::createTextures_skipsUpload_whenVideoBecomesStatic()
+{
+    textures.reset();
+    int luma = 0, chroma = 0;
+    // Long enough for the planes to be considered video
+    for (int i = 0; i < 100; ++i) {
+        upload(makeFrame(uchar(i), uchar(i)), &luma, &chroma);
+        QCOMPARE(luma, 1);
+        QCOMPARE(chroma, 1);
+    }
+
+    // Planes are hashed less often then, so skipping resumes after a few frames
+    int framesUntilSkipped = 0;
+    for (; framesUntilSkipped < 100; ++framesUntilSkipped) {
+        upload(makeFrame(0, 0), &luma, &chroma);
+        if (luma == 0 && chroma == 0)
+            break;
+    }
+    QCOMPARE_LT(framesUntilSkipped, 20);
+
+    // And stays that way
+    for (int i = 0; i < 50; ++i) {
+        upload(makeFrame(0, 0), &luma, &chroma);
+        QCOMPARE(luma, 0);
+        QCOMPARE(chroma, 0);
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QVideoTextureHelper)
+
+#include "tst_qvideotexturehelper.moc"
@@ -0,0 +1,221 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <private/qambisonicdecoder_p.h>
+#include <private/qaudioconversionhelper_p.h>
+
+#include "qambisonicdecoderdata_p.h"
+
+#include <QtCore/qmath.h>
+
+#include <cmath>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+constexpr int sampleRate = 48000;
+// Not a multiple of the decoder's chunk size, and split into two calls
+constexpr int frameCount = 1000;
+constexpr int firstCallFrames = 333;
+
+// The decoder as it was before it got vectorized: one frame at a time, with
+// the band splitting filter of BLaH3, Appendix A.2
+class ReferenceFilter
+{
+public:
+    explicit ReferenceFilter(float cutoffFrequency = 380)
+    {
+        double k = tan(M_PI * cutoffFrequency / sampleRate);
+        a1 = float(2. * (k * k - 1.) / (k * k + 2 * k + 1.));
+        a2 = float((k * k - 2 * k + 1.) / (k * k + 2 * k + 1.));
+        b0_lf = float(k * k / (k * k + 2 * k + 1));
+        b1_lf = 2.f * b0_lf;
+        b0_hf = float(1. / (k * k + 2 * k + 1));
+        b1_hf = -2.f * b0_hf;
+    }
+
+    void next(float x, float *lf, float *hf)
+    {
+        *lf = x * b0_lf + x1 * b1_lf + x2 * b0_lf - lf1 * a1 - lf2 * a2;
+        *hf = x * b0_hf + x1 * b1_hf + x2 * b0_hf - hf1 * a1 - hf2 * a2;
+        x2 = x1;
+        x1 = x;
+        lf2 = lf1;
+        lf1 = *lf;
+        hf2 = hf1;
+        hf1 = *hf;
+    }
+
+private:
+    float a1, a2, b0_lf, b1_lf, b0_hf, b1_hf;
+    float x1 = 0, x2 = 0, lf1 = 0, lf2 = 0, hf1 = 0, hf2 = 0;
+};
+
+// Left and right get half of W and X each, see QAmbisonicDecoder
+constexpr float stereoFactors[2][4] = { { .5f, .5f, 0.f, 0.f }, { .5f, -.5f, 0.f, 0.f } };
+// L, R, C, LFE, Ls, Rs, Lb, Rb
+constexpr float surroundReverbFactors[8][2] = { { 1.f, 0.f }, { 0.f, 1.f }, { .7f, .7f },
+                                                { 0.f, 0.f }, { 1.f, 0.f }, { 0.f, 1.f },
+                                                { 1.f, 0.f }, { 0.f, 1.f } };
+
+const float *matrix(QAudioFormat::ChannelConfig config, int level, bool highFrequency)
+{
+    static const float *const surround5Dot1[2][3] = {
+        { decoderMatrix_5dot1_1_lf, decoderMatrix_5dot1_2_lf, decoderMatrix_5dot1_3_lf },
+        { decoderMatrix_5dot1_1_hf, decoderMatrix_5dot1_2_hf, decoderMatrix_5dot1_3_hf },
+    };
+    static const float *const surround7Dot1[2][3] = {
+        { decoderMatrix_7dot1_1_lf, decoderMatrix_7dot1_2_lf, decoderMatrix_7dot1_3_lf },
+        { decoderMatrix_7dot1_1_hf, decoderMatrix_7dot1_2_hf, decoderMatrix_7dot1_3_hf },
+    };
+    const auto &matrices =
+            config == QAudioFormat::ChannelConfigSurround5Dot1 ? surround5Dot1 : surround7Dot1;
+    return matrices[highFrequency][level - 1];
+}
+
+// Interleaved float frames
+std::vector<float> referenceDecode(int level, QAudioFormat::ChannelConfig config,
+                                   int outputChannels, const std::vector<float> *input,
+                                   const std::vector<float> *reverb)
+{
+    const int inputChannels = (level + 1) * (level + 1);
+    std::vector<ReferenceFilter> filters(inputChannels);
+    std::vector<float> output;
+    output.reserve(frameCount * outputChannels);
+
+    for (int i = 0; i < frameCount; ++i) {
+        float o[QAmbisonicDecoder::maxOutputChannels] = {};
+        if (config == QAudioFormat::ChannelConfigStereo) {
+            for (int k = 0; k < outputChannels; ++k) {
+                for (int j = 0; j < 4; ++j)
+                    o[k] += stereoFactors[k][j] * input[j][i];
+            }
+        } else {
+            const float *lo = matrix(config, level, false);
+            const float *hi = matrix(config, level, true);
+            for (int j = 0; j < inputChannels; ++j) {
+                float lf, hf;
+                filters[j].next(input[j][i], &lf, &hf);
+                for (int k = 0; k < outputChannels; ++k)
+                    o[k] += lo[k * inputChannels + j] * lf + hi[k * inputChannels + j] * hf;
+            }
+        }
+        if (reverb) {
+            for (int k = 0; k < outputChannels; ++k)
+                o[k] += reverb[0][i] * surroundReverbFactors[k][0]
+                        + reverb[1][i] * surroundReverbFactors[k][1];
+        }
+        output.insert(output.end(), o, o + outputChannels);
+    }
+    return output;
+}
+
+std::vector<float> noise(QRandomGenerator &random)
+{
+    std::vector<float> samples(frameCount);
+    for (float &s : samples)
+        s = float(random.bounded(1.)) - .5f;
+    return samples;
+}
+
+} // namespace
+
+class tst_QAmbisonicDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void processBuffer_matchesScalarReference_data();
+    void processBuffer_matchesScalarReference();
+};
+
+void tst_QAmbisonicDecoder::processBuffer_matchesScalarReference_data()
+{
+    QTest::addColumn<int>("level");
+    QTest::addColumn<int>("config");
+    QTest::addColumn<bool>("withReverb");
+
+    const std::pair<const char *, QAudioFormat::ChannelConfig> configs[] = {
+        { "stereo", QAudioFormat::ChannelConfigStereo },
+        { "5.1", QAudioFormat::ChannelConfigSurround5Dot1 },
+        { "7.1", QAudioFormat::ChannelConfigSurround7Dot1 },
+    };
+    for (int level = 1; level <= QAmbisonicDecoder::maxAmbisonicLevel; ++level) {
+        for (const auto &[name, config] : configs) {
+            QTest::addRow("order %d, %s", level, name) << level << int(config) << false;
+            QTest::addRow("order %d, %s, reverb", level, name) << level << int(config) << true;
+        }
+    }
+}
+
+void tst_QAmbisonicDecoder::processBuffer_matchesScalarReference()
+{
+    QFETCH(int, level);
+    QFETCH(int, config);
+    QFETCH(bool, withReverb);
+
+    QAudioFormat format;
+    format.setSampleRate(sampleRate);
+    format.setChannelConfig(QAudioFormat::ChannelConfig(config));
+    const int channels = format.channelCount();
+    {
+        const QAmbisonicDecoder decoder(QAmbisonicDecoder::AmbisonicLevel(level), format);
+        QVERIFY(decoder.hasValidConfig());
+        QCOMPARE(decoder.nInputChannels(), (level + 1) * (level + 1));
+        QCOMPARE(decoder.nOutputChannels(), channels);
+    }
+
+    QRandomGenerator random(level * 100 + channels);
+    std::vector<float> input[QAmbisonicDecoder::maxAmbisonicChannels];
+    for (auto &plane : input)
+        plane = noise(random);
+    std::vector<float> reverb[2] = { noise(random), noise(random) };
+    const std::vector<float> expected =
+            referenceDecode(level, QAudioFormat::ChannelConfig(config), channels, input,
+                            withReverb ? reverb : nullptr);
+
+    auto decode = [&](auto *output) {
+        QAmbisonicDecoder decoder(QAmbisonicDecoder::AmbisonicLevel(level), format);
+        // the filters have to carry their state over from one call to the next
+        for (int offset : { 0, firstCallFrames }) {
+            const int frames = offset ? frameCount - offset : firstCallFrames;
+            const float *in[QAmbisonicDecoder::maxAmbisonicChannels];
+            for (int j = 0; j < decoder.nInputChannels(); ++j)
+                in[j] = input[j].data() + offset;
+            const float *rev[2] = { nullptr, nullptr };
+            if (withReverb) {
+                rev[0] = reverb[0].data() + offset;
+                rev[1] = reverb[1].data() + offset;
+            }
+            decoder.processBufferWithReverb(in, rev, output + offset * channels, frames);
+        }
+    };
+
+    // The vectorized code sums in a different order, which only changes the
+    // result within the float precision
+    std::vector<float> floatOutput(expected.size());
+    decode(floatOutput.data());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (std::abs(floatOutput[i] - expected[i]) > 1e-5f)
+            QFAIL(qPrintable(QStringLiteral("float sample %1 is %2 instead of %3")
+                                     .arg(i).arg(floatOutput[i]).arg(expected[i])));
+    }
+
+    // Integer samples are rounded and saturated like all other conversions
+    std::vector<short> int16Output(expected.size());
+    decode(int16Output.data());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const int reference = QAudioHelperInternal::SampleTraits<qint16>::fromFloat(expected[i]);
+        if (std::abs(int16Output[i] - reference) > 1)
+            QFAIL(qPrintable(QStringLiteral("int16 sample %1 is %2 instead of %3")
+                                     .arg(i).arg(int16Output[i]).arg(reference)));
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QAmbisonicDecoder)
+
+#include "tst_qambisonicdecoder.moc"
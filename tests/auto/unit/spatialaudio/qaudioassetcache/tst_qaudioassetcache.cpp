@@ -0,0 +1,135 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <cstring>
+
+#include <private/qaudioassetcache_p.h>
+
+#include "qmockaudiodecoder.h"
+#include "qmockintegration.h"
+
+QT_USE_NAMESPACE
+
+class tst_QAudioAssetCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void acquire_reusesDecodedAsset();
+    void acquire_retriesFailedAsset();
+    void streamedAsset_read_handlesUnderrunEndOfFileAndRewind();
+
+private:
+    QMockIntegrationFactory mockIntegrationFactory;
+};
+
+void tst_QAudioAssetCache::acquire_reusesDecodedAsset()
+{
+    QAudioAssetCache cache;
+    const QUrl url(QStringLiteral("file:///sound.wav"));
+
+    const auto asset = cache.acquire(url, 48000, 1);
+    QTRY_VERIFY(!asset->isLoading());
+    QVERIFY(!asset->hasFailed());
+    QCOMPARE_GT(asset->bufferCount(), 0);
+
+    QVERIFY(cache.acquire(url, 48000, 1) == asset);
+    QCOMPARE(cache.hits(), 1);
+    QCOMPARE(cache.misses(), 1);
+
+    // a different output format needs its own decoding
+    QVERIFY(cache.acquire(url, 48000, 2) != asset);
+    QCOMPARE(cache.misses(), 2);
+}
+
+void tst_QAudioAssetCache::acquire_retriesFailedAsset()
+{
+    QAudioAssetCache cache;
+
+    // the mock decoder fails right away without a source
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Failed to decode"));
+    const auto failed = cache.acquire(QUrl(), 48000, 1);
+    QVERIFY(failed->hasFailed());
+    QVERIFY(!failed->isLoading());
+    QCOMPARE(failed->bufferCount(), 0);
+
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("Failed to decode"));
+    const auto retried = cache.acquire(QUrl(), 48000, 1);
+    QVERIFY(retried != failed);
+    QCOMPARE(cache.hits(), 0);
+    QCOMPARE(cache.misses(), 2);
+}
+
+void tst_QAudioAssetCache::streamedAsset_read_handlesUnderrunEndOfFileAndRewind()
+{
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setSampleRate(48000);
+    format.setChannelConfig(QAudioFormat::ChannelConfigMono);
+    QStreamedAudioAsset stream(QUrl(QStringLiteral("file:///sound.wav")), format, 4);
+
+    // The mock decoder produces MOCK_DECODER_MAX_BUFFERS buffers of a single
+    // frame, which holds the serial number of the buffer
+    float data[16] = {};
+    bool endOfFile = false;
+    QList<qint32> serials;
+    auto readAvailable = [&] {
+        const int read = stream.read(data, 16, &endOfFile);
+        for (int i = 0; i < read; ++i) {
+            qint32 serial;
+            memcpy(&serial, data + i, sizeof(serial));
+            serials.append(serial);
+        }
+        return read;
+    };
+
+    // nothing decoded yet, an underrun is only counted once until data arrives
+    QCOMPARE(readAvailable(), 0);
+    QVERIFY(!endOfFile);
+    stream.recordUnderrun(16);
+    stream.recordUnderrun(16);
+    QCOMPARE(stream.underrunCount(), 1);
+    QVERIFY(!stream.isPolling());
+
+    // decoding stays within the prefetch limit, and polls for room meanwhile
+    QTRY_COMPARE(stream.bufferedFrames(), qint64(4));
+    QTest::qWait(100);
+    QCOMPARE(stream.bufferedFrames(), qint64(4));
+    QVERIFY(stream.isPolling());
+
+    // refills after reading up to the end of the first pass
+    QTRY_VERIFY(readAvailable() >= 0 && endOfFile);
+    QList<qint32> expected;
+    for (qint32 i = 0; i < MOCK_DECODER_MAX_BUFFERS; ++i)
+        expected.append(i);
+    QCOMPARE(serials, expected);
+    QCOMPARE(stream.underrunCount(), 1);
+
+    // having received data, the next shortage is a new underrun
+    stream.recordUnderrun(1);
+    QCOMPARE(stream.underrunCount(), 2);
+
+    // the next pass starts at the beginning of the file again
+    endOfFile = false;
+    serials.clear();
+    QTRY_VERIFY(readAvailable() > 0);
+    QCOMPARE(serials.front(), 0);
+    QVERIFY(!endOfFile);
+
+    // data queued before rewinding is skipped
+    QTRY_VERIFY(stream.bufferedFrames() > 0);
+    stream.rewind();
+    QCOMPARE(stream.bufferedFrames(), qint64(0));
+    QVERIFY(!stream.isPolling());
+    serials.clear();
+    QTRY_VERIFY(readAvailable() > 0);
+    QCOMPARE(serials.front(), 0);
+    QVERIFY(!endOfFile);
+    QVERIFY(!stream.hasFailed());
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioAssetCache)
+
+#include "tst_qaudioassetcache.moc"
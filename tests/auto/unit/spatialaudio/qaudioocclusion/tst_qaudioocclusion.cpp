@@ -0,0 +1,166 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qaudiolistener.h>
+#include <QtSpatialAudio/qaudioroom.h>
+#include <QtSpatialAudio/qspatialsound.h>
+
+#include <private/qaudioengine_p.h>
+#include <private/qspatialsound_p.h>
+
+#include <memory>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+std::unique_ptr<QAudioRoom> makeRoom(QAudioEngine *engine, const QVector3D &position,
+                                     const QVector3D &dimensions)
+{
+    auto room = std::make_unique<QAudioRoom>(engine);
+    room->setPosition(position);
+    room->setDimensions(dimensions);
+    for (int wall = 0; wall < 6; ++wall)
+        room->setWallMaterial(QAudioRoom::Wall(wall), QAudioRoom::BrickBare);
+    return room;
+}
+
+// The walls of a box as a mesh, relative to its center
+void boxMesh(const QVector3D &dimensions, QList<QVector3D> &vertices, QList<int> &indices)
+{
+    const QVector3D h = dimensions / 2;
+    for (int i = 0; i < 8; ++i) {
+        vertices.append(QVector3D(i & 1 ? h.x() : -h.x(), i & 2 ? h.y() : -h.y(),
+                                  i & 4 ? h.z() : -h.z()));
+    }
+    const int quads[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 },
+                              { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+    for (const auto &q : quads)
+        indices << q[0] << q[1] << q[2] << q[0] << q[2] << q[3];
+}
+
+} // namespace
+
+class tst_QAudioOcclusion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void boxRooms_occludeSounds();
+    void meshRooms_occludeLikeBoxRooms();
+    void disabling_clearsOcclusion();
+    void soundIds_areNotReused();
+
+private:
+    std::unique_ptr<QAudioEngine> engine;
+};
+
+void tst_QAudioOcclusion::init()
+{
+    engine = std::make_unique<QAudioEngine>(44100);
+    // Work in meters
+    engine->setDistanceScale(100);
+}
+
+void tst_QAudioOcclusion::cleanup()
+{
+    engine.reset();
+}
+
+void tst_QAudioOcclusion::boxRooms_occludeSounds()
+{
+    QAudioListener listener(engine.get());
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    auto b = makeRoom(engine.get(), { 10, 0, 0 }, { 4, 4, 4 });
+
+    // Off the axes, so that rays don't run along the diagonals of walls
+    QSpatialSound inRoom(engine.get());
+    inRoom.setPosition({ 1, 0.5f, 0.3f });
+    QSpatialSound outside(engine.get());
+    outside.setPosition({ 5, 0.5f, 0.3f });
+    QSpatialSound inOtherRoom(engine.get());
+    inOtherRoom.setPosition({ 10, 0.5f, 0.3f });
+
+    engine->setOcclusionUpdateRate(100);
+
+    auto *outsideData = QSpatialSoundPrivate::get(&outside);
+    QTRY_COMPARE_GT(outsideData->geometryOcclusion, 0.f);
+    const float wall = outsideData->geometryOcclusion;
+    // Crosses the walls of both rooms
+    QTRY_COMPARE(QSpatialSoundPrivate::get(&inOtherRoom)->geometryOcclusion, 2 * wall);
+    QCOMPARE(QSpatialSoundPrivate::get(&inRoom)->geometryOcclusion, 0.f);
+
+    // Follows changes of the rooms
+    b->setWallMaterial(QAudioRoom::LeftWall, QAudioRoom::Transparent);
+    QTRY_COMPARE(QSpatialSoundPrivate::get(&inOtherRoom)->geometryOcclusion, wall);
+}
+
+void tst_QAudioOcclusion::meshRooms_occludeLikeBoxRooms()
+{
+    QAudioListener listener(engine.get());
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    auto b = makeRoom(engine.get(), { 10, 0, 0 }, { 4, 4, 4 });
+    QList<QVector3D> vertices;
+    QList<int> indices;
+    boxMesh({ 4, 4, 4 }, vertices, indices);
+    b->setGeometry(vertices, indices, { QAudioRoom::BrickBare });
+
+    QSpatialSound outside(engine.get());
+    outside.setPosition({ 5, 0.5f, 0.3f });
+    QSpatialSound inOtherRoom(engine.get());
+    inOtherRoom.setPosition({ 10, 0.5f, 0.3f });
+
+    engine->setOcclusionUpdateRate(100);
+
+    auto *outsideData = QSpatialSoundPrivate::get(&outside);
+    QTRY_COMPARE_GT(outsideData->geometryOcclusion, 0.f);
+    QTRY_COMPARE(QSpatialSoundPrivate::get(&inOtherRoom)->geometryOcclusion,
+                 2 * outsideData->geometryOcclusion);
+}
+
+void tst_QAudioOcclusion::disabling_clearsOcclusion()
+{
+    QAudioListener listener(engine.get());
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    QSpatialSound sound(engine.get());
+    sound.setPosition({ 5, 0.5f, 0.3f });
+    auto *sp = QSpatialSoundPrivate::get(&sound);
+
+    engine->setOcclusionUpdateRate(100);
+    QTRY_COMPARE_GT(sp->geometryOcclusion, 0.f);
+
+    engine->setOcclusionUpdateRate(0);
+    QCOMPARE(sp->geometryOcclusion, 0.f);
+    // Results of an update still running are dropped
+    QTest::qWait(50);
+    QCOMPARE(sp->geometryOcclusion, 0.f);
+}
+
+void tst_QAudioOcclusion::soundIds_areNotReused()
+{
+    QSet<quint64> ids;
+    for (int i = 0; i < 10; ++i) {
+        // Likely to be allocated at the address of the previous one
+        auto sound = std::make_unique<QSpatialSound>(engine.get());
+        const quint64 id = QSpatialSoundPrivate::get(sound.get())->id;
+        QVERIFY(!ids.contains(id));
+        ids.insert(id);
+    }
+
+    // Removing a sound from the engine and adding it again makes it a new sound
+    QSpatialSound sound(engine.get());
+    const quint64 id = QSpatialSoundPrivate::get(&sound)->id;
+    sound.setEngine(nullptr);
+    sound.setEngine(engine.get());
+    QCOMPARE_NE(QSpatialSoundPrivate::get(&sound)->id, id);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioOcclusion)
+
+#include "tst_qaudioocclusion.moc"
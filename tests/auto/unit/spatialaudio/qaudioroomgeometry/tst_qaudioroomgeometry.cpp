@@ -0,0 +1,130 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <private/qaudioroomgeometry_p.h>
+
+#include <cmath>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+// A closed box, two triangles per side
+void addBox(const QVector3D &center, const QVector3D &dimensions, QList<QVector3D> &vertices,
+            QList<int> &indices)
+{
+    const int first = int(vertices.size());
+    const QVector3D h = dimensions / 2;
+    for (int i = 0; i < 8; ++i) {
+        vertices.append(center
+                        + QVector3D(i & 1 ? h.x() : -h.x(), i & 2 ? h.y() : -h.y(),
+                                    i & 4 ? h.z() : -h.z()));
+    }
+    const int quads[6][4] = { { 0, 2, 6, 4 }, { 1, 5, 7, 3 }, { 0, 4, 5, 1 },
+                              { 2, 3, 7, 6 }, { 0, 1, 3, 2 }, { 4, 6, 7, 5 } };
+    for (const auto &q : quads)
+        indices << first + q[0] << first + q[1] << first + q[2] << first + q[0] << first + q[2]
+                << first + q[3];
+}
+
+// Eyring's formula, with the air absorption the estimate uses
+float eyringRT60(const QVector3D &dimensions, float absorption, float airAbsorption)
+{
+    const float volume = dimensions.x() * dimensions.y() * dimensions.z();
+    const float surface = 2
+            * (dimensions.x() * dimensions.y() + dimensions.x() * dimensions.z()
+               + dimensions.y() * dimensions.z());
+    return 0.161f * volume
+            / (-surface * std::log(1 - absorption) + 4 * airAbsorption * volume);
+}
+
+} // namespace
+
+class tst_QAudioRoomGeometry : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void intersect_findsClosestTriangle();
+    void estimate_closedBox_matchesEyring_data();
+    void estimate_closedBox_matchesEyring();
+    void estimate_returnsEmptyResult_whenCancelled();
+};
+
+void tst_QAudioRoomGeometry::intersect_findsClosestTriangle()
+{
+    QList<QVector3D> vertices;
+    QList<int> indices;
+    addBox({}, { 4, 2, 2 }, vertices, indices);
+    addBox({}, { 2, 2, 2 }, vertices, indices);
+    const QAudioRoomGeometry geometry(vertices, indices, {});
+    QCOMPARE(geometry.triangles().size(), size_t(24));
+
+    float distance = 0;
+    QVERIFY(geometry.intersect({}, { 1, 0, 0 }, &distance) >= 0);
+    QCOMPARE(distance, 1.f);
+    QVERIFY(geometry.intersect({ 1.5f, 0, 0 }, { 1, 0, 0 }, &distance) >= 0);
+    QCOMPARE(distance, 0.5f);
+    QCOMPARE(geometry.intersect({ 3, 0, 0 }, { 1, 0, 0 }, &distance), -1);
+}
+
+void tst_QAudioRoomGeometry::estimate_closedBox_matchesEyring_data()
+{
+    QTest::addColumn<QVector3D>("center");
+    QTest::addColumn<QVector3D>("dimensions");
+    QTest::addColumn<QAudioRoom::Material>("material");
+    QTest::addColumn<float>("absorption");
+
+    // absorption in the 500Hz band, as in Resonance Audio's material table
+    QTest::newRow("uniform") << QVector3D() << QVector3D(8, 4, 6) << QAudioRoom::UniformMaterial
+                             << 0.5f;
+    QTest::newRow("uniform, off center") << QVector3D(20, 3, -7) << QVector3D(8, 4, 6)
+                                         << QAudioRoom::UniformMaterial << 0.5f;
+    QTest::newRow("painted concrete") << QVector3D() << QVector3D(10, 3, 5)
+                                      << QAudioRoom::ConcreteBlockPainted << 0.06f;
+}
+
+void tst_QAudioRoomGeometry::estimate_closedBox_matchesEyring()
+{
+    QFETCH(QVector3D, center);
+    QFETCH(QVector3D, dimensions);
+    QFETCH(QAudioRoom::Material, material);
+    QFETCH(float, absorption);
+
+    QList<QVector3D> vertices;
+    QList<int> indices;
+    addBox(center, dimensions, vertices, indices);
+    const QAudioRoomGeometry geometry(vertices, indices, { material });
+
+    const std::atomic<bool> cancelled = false;
+    const QAudioRoomAcoustics acoustics = QAudioRoomAcoustics::estimate(geometry, cancelled);
+
+    QVERIFY(qFuzzyCompare(acoustics.center, center));
+    QVERIFY(qFuzzyCompare(acoustics.dimensions, dimensions));
+
+    constexpr int band = 4; // 500Hz
+    const float expected = eyringRT60(dimensions, absorption, 0.0010f);
+    QVERIFY2(std::abs(acoustics.rt60[band] - expected) < 0.2f * expected,
+             qPrintable(QStringLiteral("RT60 %1s, expected %2s")
+                                .arg(acoustics.rt60[band])
+                                .arg(expected)));
+}
+
+void tst_QAudioRoomGeometry::estimate_returnsEmptyResult_whenCancelled()
+{
+    QList<QVector3D> vertices;
+    QList<int> indices;
+    addBox({}, { 8, 4, 6 }, vertices, indices);
+    const QAudioRoomGeometry geometry(vertices, indices, {});
+
+    const std::atomic<bool> cancelled = true;
+    const QAudioRoomAcoustics acoustics = QAudioRoomAcoustics::estimate(geometry, cancelled);
+    QCOMPARE(acoustics.dimensions, QVector3D());
+    QCOMPARE(acoustics.rt60[0], 0.f);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioRoomGeometry)
+
+#include "tst_qaudioroomgeometry.moc"
@@ -0,0 +1,275 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qaudiolistener.h>
+#include <QtSpatialAudio/qaudioroom.h>
+#include <QtSpatialAudio/qspatialsound.h>
+
+#include <private/qaudioengine_p.h>
+#include <private/qaudioroomindex_p.h>
+#include <private/qspatialsound_p.h>
+
+#include <memory>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+// Frames per block that fade the reflections by half per block
+constexpr qint64 halfFadeFrames = 44100 * QAudioEnginePrivate::roomCrossfadeMs / 2000 / 2;
+
+std::unique_ptr<QAudioRoom> makeRoom(QAudioEngine *engine, const QVector3D &position,
+                                     const QVector3D &dimensions,
+                                     const QQuaternion &rotation = {})
+{
+    auto room = std::make_unique<QAudioRoom>(engine);
+    room->setPosition(position);
+    room->setDimensions(dimensions);
+    room->setRotation(rotation);
+    return room;
+}
+
+// The reference, testing all rooms
+const QAudioRoom *findLinear(const std::vector<std::unique_ptr<QAudioRoom>> &rooms,
+                             const QVector3D &pos)
+{
+    const QAudioRoom *found = nullptr;
+    float foundVolume = 0;
+    for (const auto &room : rooms) {
+        const QVector3D dim2 = room->dimensions() / 2;
+        const QVector3D dist = room->rotation().rotatedVector(room->position() - pos);
+        if (qAbs(dist.x()) > dim2.x() || qAbs(dist.y()) > dim2.y() || qAbs(dist.z()) > dim2.z())
+            continue;
+        const float volume = dim2.x() * dim2.y() * dim2.z();
+        if (!found || volume < foundVolume) {
+            found = room.get();
+            foundVolume = volume;
+        }
+    }
+    return found;
+}
+
+const QAudioRoom *roomAt(const QAudioRoomIndex &index, const QVector3D &pos)
+{
+    const QAudioRoomIndex::Entry *e = index.find(pos);
+    return e ? e->room : nullptr;
+}
+
+} // namespace
+
+class tst_QAudioRoomIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void find_returnsNull_withoutRooms();
+    void find_returnsNull_outsideAllRooms();
+    void find_returnsSmallestRoom_whenRoomsOverlap();
+    void find_respectsRoomRotation();
+    void find_matchesLinearSearch();
+    void updateRooms_crossfadesReflections_whenListenerChangesRooms();
+    void updateRooms_keepsFade_whenRoomPropertiesChange();
+    void updateListenerRoom_appliesRoomEffectsToSounds();
+
+private:
+    std::unique_ptr<QAudioEngine> engine;
+    QAudioEnginePrivate *ep = nullptr;
+};
+
+void tst_QAudioRoomIndex::init()
+{
+    engine = std::make_unique<QAudioEngine>(44100);
+    // Work in meters
+    engine->setDistanceScale(100);
+    ep = QAudioEnginePrivate::get(engine.get());
+}
+
+void tst_QAudioRoomIndex::cleanup()
+{
+    ep = nullptr;
+    engine.reset();
+}
+
+void tst_QAudioRoomIndex::find_returnsNull_withoutRooms()
+{
+    const auto index = QAudioRoomIndex::build({});
+    QVERIFY(!index->find({}));
+    QVERIFY(!index->find({ 1, 2, 3 }));
+}
+
+void tst_QAudioRoomIndex::find_returnsNull_outsideAllRooms()
+{
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 2, 2, 2 });
+    auto b = makeRoom(engine.get(), { 10, 0, 0 }, { 2, 2, 2 });
+    const auto index = QAudioRoomIndex::build({ a.get(), b.get() });
+
+    QCOMPARE(roomAt(*index, { 0, 0, 0 }), a.get());
+    QCOMPARE(roomAt(*index, { 10, 0.9f, -0.9f }), b.get());
+    // Between the rooms, inside the bounds of the index
+    QVERIFY(!index->find({ 5, 0, 0 }));
+    // Outside the bounds of the index
+    QVERIFY(!index->find({ -5, 0, 0 }));
+    QVERIFY(!index->find({ 0, 100, 0 }));
+}
+
+void tst_QAudioRoomIndex::find_returnsSmallestRoom_whenRoomsOverlap()
+{
+    // Created from large to small, so that the order of creation doesn't decide
+    auto hall = makeRoom(engine.get(), { 0, 0, 0 }, { 20, 10, 20 });
+    auto office = makeRoom(engine.get(), { 5, 0, 5 }, { 4, 3, 4 });
+    auto closet = makeRoom(engine.get(), { 6, 0, 6 }, { 1, 2, 1 });
+    const auto index = QAudioRoomIndex::build({ hall.get(), office.get(), closet.get() });
+
+    QCOMPARE(roomAt(*index, { -5, 0, -5 }), hall.get());
+    QCOMPARE(roomAt(*index, { 4, 0, 4 }), office.get());
+    QCOMPARE(roomAt(*index, { 6, 0, 6 }), closet.get());
+    // Above the closet and the office, but still inside the hall
+    QCOMPARE(roomAt(*index, { 6, 1.8f, 6.4f }), hall.get());
+
+    const QAudioRoomIndex::Entry *e = index->find({ 6, 0, 6 });
+    QVERIFY(e);
+    QCOMPARE(e->position, QVector3D(6, 0, 6));
+    QCOMPARE(e->halfDimensions, QVector3D(0.5f, 1, 0.5f));
+}
+
+void tst_QAudioRoomIndex::find_respectsRoomRotation()
+{
+    // A corridor along x, rotated to run along y
+    auto corridor = makeRoom(engine.get(), { 0, 0, 0 }, { 10, 1, 1 },
+                             QQuaternion::fromAxisAndAngle(0, 0, 1, 90));
+    const auto index = QAudioRoomIndex::build({ corridor.get() });
+
+    QCOMPARE(roomAt(*index, { 0, 4, 0 }), corridor.get());
+    QCOMPARE(roomAt(*index, { 0, -4, 0 }), corridor.get());
+    QVERIFY(!index->find({ 4, 0, 0 }));
+    QVERIFY(!index->find({ -4, 0, 0 }));
+}
+
+void tst_QAudioRoomIndex::find_matchesLinearSearch()
+{
+    QRandomGenerator rng(42);
+    auto uniform = [&rng](float min, float max) {
+        return min + float(rng.generateDouble()) * (max - min);
+    };
+
+    std::vector<std::unique_ptr<QAudioRoom>> rooms;
+    QList<QAudioRoom *> roomList;
+    for (int i = 0; i < 100; ++i) {
+        const QVector3D position(uniform(-50, 50), uniform(-5, 5), uniform(-50, 50));
+        const QVector3D dimensions(uniform(1, 20), uniform(2, 6), uniform(1, 20));
+        const QQuaternion rotation = QQuaternion::fromAxisAndAngle(0, 1, 0, uniform(0, 360));
+        rooms.push_back(makeRoom(engine.get(), position, dimensions, rotation));
+        roomList.append(rooms.back().get());
+    }
+    const auto index = QAudioRoomIndex::build(roomList);
+
+    int inside = 0;
+    for (int i = 0; i < 10000; ++i) {
+        const QVector3D pos(uniform(-65, 65), uniform(-8, 8), uniform(-65, 65));
+        const QAudioRoom *expected = findLinear(rooms, pos);
+        QCOMPARE(roomAt(*index, pos), expected);
+        inside += expected ? 1 : 0;
+    }
+    // Make sure both cases got tested
+    QCOMPARE_GT(inside, 1000);
+    QCOMPARE_LT(inside, 9000);
+}
+
+void tst_QAudioRoomIndex::updateRooms_crossfadesReflections_whenListenerChangesRooms()
+{
+    QAudioListener listener(engine.get());
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    auto b = makeRoom(engine.get(), { 10, 0, 0 }, { 4, 4, 4 });
+    ep->updateRoomIndex();
+
+    // Entering the first room switches right away and fades the reflections in
+    listener.setPosition({ 0, 0, 0 });
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->currentRoom.room, a.get());
+    QCOMPARE(ep->roomFade, 0.f);
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->roomFade, 0.5f);
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->roomFade, 1.f);
+
+    // Fades the reflections of the old room out before switching to the new one
+    listener.setPosition({ 10, 0, 0 });
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->currentRoom.room, a.get());
+    QCOMPARE(ep->roomFade, 0.5f);
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->currentRoom.room, b.get());
+    QCOMPARE(ep->roomFade, 0.f);
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->roomFade, 0.5f);
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->roomFade, 1.f);
+
+    // Room effects stay active while the reverb tail fades after leaving all rooms
+    listener.setPosition({ 5, 0, 0 });
+    ep->updateRooms(halfFadeFrames);
+    ep->updateRooms(halfFadeFrames);
+    QVERIFY(!ep->currentRoom.room);
+    QVERIFY(ep->roomEffectsActive);
+    const qint64 tailFrames = 44100 * QAudioEnginePrivate::roomReverbFadeMs / 1000;
+    for (qint64 frames = 0; frames < tailFrames; frames += halfFadeFrames)
+        ep->updateRooms(halfFadeFrames);
+    QVERIFY(!ep->roomEffectsActive);
+}
+
+void tst_QAudioRoomIndex::updateRooms_keepsFade_whenRoomPropertiesChange()
+{
+    QAudioListener listener(engine.get());
+    auto room = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    ep->updateRoomIndex();
+    listener.setPosition({ 0, 0, 0 });
+    for (int i = 0; i < 3; ++i)
+        ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->roomFade, 1.f);
+    const quint64 revision = ep->currentRoom.revision;
+    const float reverbGain = ep->currentRoom.reverb.gain;
+
+    room->setReverbGain(room->reverbGain() / 2);
+    ep->updateRoomIndex();
+    ep->updateRooms(halfFadeFrames);
+    QCOMPARE(ep->currentRoom.room, room.get());
+    QCOMPARE_NE(ep->currentRoom.revision, revision);
+    QCOMPARE(ep->currentRoom.reverb.gain, reverbGain / 2);
+    // Resonance Audio interpolates the reverb, the reflections don't fade
+    QCOMPARE(ep->roomFade, 1.f);
+}
+
+void tst_QAudioRoomIndex::updateListenerRoom_appliesRoomEffectsToSounds()
+{
+    QAudioListener listener(engine.get());
+    auto a = makeRoom(engine.get(), { 0, 0, 0 }, { 4, 4, 4 });
+    auto b = makeRoom(engine.get(), { 10, 0, 0 }, { 4, 4, 4 });
+    for (auto *room : { a.get(), b.get() }) {
+        for (int wall = 0; wall < 6; ++wall)
+            room->setWallMaterial(QAudioRoom::Wall(wall), QAudioRoom::BrickBare);
+    }
+    QSpatialSound sound(engine.get());
+    sound.setPosition({ 0, 0, 0 });
+    auto *sp = QSpatialSoundPrivate::get(&sound);
+
+    listener.setPosition({ 1, 0, 0 });
+    ep->updateRoomIndex();
+    QCOMPARE(sp->wallDampening, 1.f);
+
+    // Applied by the thread owning the engine, without the audio thread running
+    listener.setPosition({ 10, 0, 0 });
+    QCOMPARE_LT(sp->wallDampening, 1.f);
+
+    listener.setPosition({ -1, 0, 0 });
+    QCOMPARE(sp->wallDampening, 1.f);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioRoomIndex)
+
+#include "tst_qaudioroomindex.moc"
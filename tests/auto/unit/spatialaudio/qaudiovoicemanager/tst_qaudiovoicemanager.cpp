@@ -0,0 +1,176 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qspatialsound.h>
+
+#include <private/qaudioengine_p.h>
+#include <private/qaudiovoicemanager_p.h>
+#include <private/qspatialsound_p.h>
+
+#include <memory>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+class tst_QAudioVoiceManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void update_rendersLoudestSounds();
+    void update_ranksByPriorityFirst();
+    void update_virtualizesInaudibleSounds();
+    void update_lowersQualityBeyondHighQualityLimit();
+    void update_keepsModes_whenSoundsAreSimilarlyLoud();
+    void setRenderingMode_replacesSource();
+
+private:
+    // Creates a sound at distance meters in front of the listener
+    QSpatialSoundPrivate *addSound(float distance);
+    bool isRendered(const QSpatialSoundPrivate *sp) const
+    {
+        return !sp->virtualized.load(std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<QAudioEngine> engine;
+    QAudioEnginePrivate *ep = nullptr;
+    std::vector<std::unique_ptr<QSpatialSound>> sounds;
+};
+
+void tst_QAudioVoiceManager::init()
+{
+    engine = std::make_unique<QAudioEngine>(44100);
+    // Work in meters
+    engine->setDistanceScale(100);
+    ep = QAudioEnginePrivate::get(engine.get());
+}
+
+void tst_QAudioVoiceManager::cleanup()
+{
+    sounds.clear();
+    ep = nullptr;
+    engine.reset();
+}
+
+QSpatialSoundPrivate *tst_QAudioVoiceManager::addSound(float distance)
+{
+    sounds.push_back(std::make_unique<QSpatialSound>(engine.get()));
+    sounds.back()->setPosition({ 0, 0, -distance });
+    return QSpatialSoundPrivate::get(sounds.back().get());
+}
+
+void tst_QAudioVoiceManager::update_rendersLoudestSounds()
+{
+    auto *far = addSound(8);
+    auto *near = addSound(1);
+    auto *farther = addSound(16);
+    auto *middle = addSound(2);
+
+    engine->setVoiceLimit(2);
+    QVERIFY(isRendered(near));
+    QVERIFY(isRendered(middle));
+    QVERIFY(!isRendered(far));
+    QVERIFY(!isRendered(farther));
+
+    engine->setVoiceLimit(-1);
+    for (auto *sp : { far, near, farther, middle })
+        QVERIFY(isRendered(sp));
+}
+
+void tst_QAudioVoiceManager::update_ranksByPriorityFirst()
+{
+    auto *near = addSound(1);
+    auto *middle = addSound(2);
+    auto *far = addSound(8);
+    sounds.back()->setPriority(1);
+
+    engine->setVoiceLimit(2);
+    QVERIFY(isRendered(far));
+    QVERIFY(isRendered(near));
+    QVERIFY(!isRendered(middle));
+}
+
+void tst_QAudioVoiceManager::update_virtualizesInaudibleSounds()
+{
+    auto *muted = addSound(1);
+    sounds.back()->setVolume(0);
+    auto *beyondCutoff = addSound(100);
+    auto *audible = addSound(2);
+
+    engine->setVoiceLimit(10);
+    QVERIFY(!isRendered(muted));
+    QVERIFY(!isRendered(beyondCutoff));
+    QVERIFY(isRendered(audible));
+}
+
+void tst_QAudioVoiceManager::update_lowersQualityBeyondHighQualityLimit()
+{
+    auto *near = addSound(1);
+    auto *middle = addSound(2);
+    auto *far = addSound(4);
+
+    engine->setHighQualityVoiceLimit(1);
+    QCOMPARE(near->renderingMode, vraudio::kBinauralHighQuality);
+    // Surround output can't use stereo panning
+    QCOMPARE(middle->renderingMode, vraudio::kBinauralLowQuality);
+    QCOMPARE(far->renderingMode, vraudio::kBinauralLowQuality);
+    for (auto *sp : { near, middle, far })
+        QVERIFY(isRendered(sp));
+}
+
+void tst_QAudioVoiceManager::update_keepsModes_whenSoundsAreSimilarlyLoud()
+{
+    auto *a = addSound(4);
+    auto *b = addSound(4.2f);
+    engine->setVoiceLimit(1);
+    QVERIFY(isRendered(a));
+    QVERIFY(!isRendered(b));
+
+    // Slightly louder than a now, but not by enough
+    sounds[1]->setPosition({ 0, 0, -3.8f });
+    ep->voiceManager->update();
+    QVERIFY(isRendered(a));
+    QVERIFY(!isRendered(b));
+
+    // Clearly louder
+    sounds[1]->setPosition({ 0, 0, -1.5f });
+    ep->voiceManager->update();
+    QVERIFY(!isRendered(a));
+    QVERIFY(isRendered(b));
+
+    // Same for the quality of rendered sounds
+    engine->setVoiceLimit(-1);
+    engine->setHighQualityVoiceLimit(1);
+    QCOMPARE(b->renderingMode, vraudio::kBinauralHighQuality);
+    QCOMPARE(a->renderingMode, vraudio::kBinauralLowQuality);
+    sounds[0]->setPosition({ 0, 0, -1.4f });
+    ep->voiceManager->update();
+    QCOMPARE(b->renderingMode, vraudio::kBinauralHighQuality);
+    QCOMPARE(a->renderingMode, vraudio::kBinauralLowQuality);
+    sounds[1]->setPosition({ 0, 0, -3 });
+    ep->voiceManager->update();
+    QCOMPARE(a->renderingMode, vraudio::kBinauralHighQuality);
+    QCOMPARE(b->renderingMode, vraudio::kBinauralLowQuality);
+}
+
+void tst_QAudioVoiceManager::setRenderingMode_replacesSource()
+{
+    auto *sp = addSound(1);
+    const int sourceId = sp->sourceId.load();
+    QCOMPARE_GE(sourceId, 0);
+
+    sp->setRenderingMode(vraudio::kBinauralLowQuality);
+    QCOMPARE_NE(sp->sourceId.load(), sourceId);
+    QCOMPARE_GE(sp->sourceId.load(), 0);
+    QCOMPARE(sp->renderingMode, vraudio::kBinauralLowQuality);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioVoiceManager)
+
+#include "tst_qaudiovoicemanager.moc"
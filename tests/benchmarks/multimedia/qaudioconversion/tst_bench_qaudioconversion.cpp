@@ -0,0 +1,110 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <private/qaudioconversionhelper_p.h>
+
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace QAudioHelperInternal;
+
+namespace {
+// one second of 48 kHz stereo
+constexpr qsizetype Frames = 48000;
+} // namespace
+
+class tst_bench_QAudioConversion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convertSamples_data();
+    void convertSamples();
+    void deinterleave_data();
+    void deinterleave();
+    void remixChannels_data();
+    void remixChannels();
+};
+
+void tst_bench_QAudioConversion::convertSamples_data()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("from");
+    QTest::addColumn<QAudioFormat::SampleFormat>("to");
+
+    QTest::newRow("Int16->Float") << QAudioFormat::Int16 << QAudioFormat::Float;
+    QTest::newRow("Float->Int16") << QAudioFormat::Float << QAudioFormat::Int16;
+    QTest::newRow("Int32->Float") << QAudioFormat::Int32 << QAudioFormat::Float;
+    QTest::newRow("Float->Int32") << QAudioFormat::Float << QAudioFormat::Int32;
+    QTest::newRow("UInt8->Int16") << QAudioFormat::UInt8 << QAudioFormat::Int16;
+}
+
+void tst_bench_QAudioConversion::convertSamples()
+{
+    QFETCH(QAudioFormat::SampleFormat, from);
+    QFETCH(QAudioFormat::SampleFormat, to);
+
+    const qsizetype samples = Frames * 2;
+    std::vector<char> src(samples * sizeof(qint32));
+    std::vector<char> dst(samples * sizeof(qint32));
+
+    QBENCHMARK {
+        QAudioHelperInternal::convertSamples(src.data(), from, dst.data(), to, samples);
+    }
+}
+
+void tst_bench_QAudioConversion::deinterleave_data()
+{
+    QTest::addColumn<int>("channels");
+
+    QTest::newRow("stereo") << 2;
+    QTest::newRow("5.1") << 6;
+}
+
+void tst_bench_QAudioConversion::deinterleave()
+{
+    QFETCH(int, channels);
+
+    std::vector<float> interleaved(Frames * channels);
+    std::vector<std::vector<float>> planes(channels, std::vector<float>(Frames));
+    std::vector<float *> planePointers;
+    for (auto &plane : planes)
+        planePointers.push_back(plane.data());
+
+    QBENCHMARK {
+        QAudioHelperInternal::deinterleave(interleaved.data(), channels, planePointers.data(),
+                                           Frames);
+    }
+}
+
+void tst_bench_QAudioConversion::remixChannels_data()
+{
+    QTest::addColumn<QAudioFormat::ChannelConfig>("from");
+    QTest::addColumn<QAudioFormat::ChannelConfig>("to");
+
+    QTest::newRow("stereo->mono")
+            << QAudioFormat::ChannelConfigStereo << QAudioFormat::ChannelConfigMono;
+    QTest::newRow("mono->stereo")
+            << QAudioFormat::ChannelConfigMono << QAudioFormat::ChannelConfigStereo;
+    QTest::newRow("5.1->stereo")
+            << QAudioFormat::ChannelConfigSurround5Dot1 << QAudioFormat::ChannelConfigStereo;
+}
+
+void tst_bench_QAudioConversion::remixChannels()
+{
+    QFETCH(QAudioFormat::ChannelConfig, from);
+    QFETCH(QAudioFormat::ChannelConfig, to);
+
+    std::vector<float> src(Frames * qPopulationCount(quint32(from)));
+    std::vector<float> dst(Frames * qPopulationCount(quint32(to)));
+
+    QBENCHMARK {
+        QAudioHelperInternal::remixChannels(src.data(), from, dst.data(), to, Frames);
+    }
+}
+
+QTEST_MAIN(tst_bench_QAudioConversion)
+
+#include "tst_bench_qaudioconversion.moc"
@@ -0,0 +1,91 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include <private/qambisonicdecoder_p.h>
+
+#include <vector>
+
+QT_USE_NAMESPACE
+
+namespace {
+// the engine's default block size
+constexpr int BlockSize = 128;
+constexpr int SampleRate = 48000;
+} // namespace
+
+class tst_bench_QAmbisonicDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void processBufferWithReverb_data();
+    void processBufferWithReverb();
+};
+
+void tst_bench_QAmbisonicDecoder::processBufferWithReverb_data()
+{
+    QTest::addColumn<QAmbisonicDecoder::AmbisonicLevel>("level");
+    QTest::addColumn<QAudioFormat::ChannelConfig>("channelConfig");
+    QTest::addColumn<bool>("floatOutput");
+
+    const std::pair<QAudioFormat::ChannelConfig, const char *> configs[] = {
+        { QAudioFormat::ChannelConfigStereo, "stereo" },
+        { QAudioFormat::ChannelConfigSurround5Dot1, "5.1" },
+        { QAudioFormat::ChannelConfigSurround7Dot1, "7.1" },
+    };
+    for (int level = QAmbisonicDecoder::AmbisonicLevel1;
+         level <= QAmbisonicDecoder::AmbisonicLevel3; ++level) {
+        for (const auto &[config, name] : configs) {
+            QTest::addRow("order %d, %s, int16", level, name)
+                    << QAmbisonicDecoder::AmbisonicLevel(level) << config << false;
+            QTest::addRow("order %d, %s, float", level, name)
+                    << QAmbisonicDecoder::AmbisonicLevel(level) << config << true;
+        }
+    }
+}
+
+void tst_bench_QAmbisonicDecoder::processBufferWithReverb()
+{
+    QFETCH(QAmbisonicDecoder::AmbisonicLevel, level);
+    QFETCH(QAudioFormat::ChannelConfig, channelConfig);
+    QFETCH(bool, floatOutput);
+
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelConfig(channelConfig);
+    format.setSampleFormat(floatOutput ? QAudioFormat::Float : QAudioFormat::Int16);
+
+    QAmbisonicDecoder decoder(level, format);
+    QVERIFY(decoder.hasValidConfig());
+
+    std::vector<std::vector<float>> inputBuffers(decoder.nInputChannels(),
+                                                 std::vector<float>(BlockSize));
+    for (auto &buffer : inputBuffers) {
+        for (int i = 0; i < BlockSize; ++i)
+            buffer[i] = std::sin(i * 0.1f) * 0.1f;
+    }
+    const float *input[QAmbisonicDecoder::maxAmbisonicChannels];
+    for (int j = 0; j < decoder.nInputChannels(); ++j)
+        input[j] = inputBuffers[j].data();
+
+    std::vector<float> reverbBuffer(BlockSize, 0.01f);
+    const float *reverb[2] = { reverbBuffer.data(), reverbBuffer.data() };
+
+    if (floatOutput) {
+        std::vector<float> output(decoder.outputSize(BlockSize));
+        QBENCHMARK {
+            decoder.processBufferWithReverb(input, reverb, output.data(), BlockSize);
+        }
+    } else {
+        std::vector<short> output(decoder.outputSize(BlockSize));
+        QBENCHMARK {
+            decoder.processBufferWithReverb(input, reverb, output.data(), BlockSize);
+        }
+    }
+}
+
+QTEST_MAIN(tst_bench_QAmbisonicDecoder)
+
+#include "tst_bench_qambisonicdecoder.moc"